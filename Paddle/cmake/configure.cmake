@@ -28,6 +28,12 @@ if(NOT WITH_PROFILER)
     add_definitions(-DPADDLE_DISABLE_PROFILER)
 endif(NOT WITH_PROFILER)
 
+# Eigen::ThreadPoolDevice, used by the intra-op thread pool of CPUDeviceContext.
+# Defined globally on purpose: every kernel calling platform::EigenDeviceRun
+# instantiates Eigen expressions on the pool, and the Eigen headers must be
+# configured the same way in all translation units.
+add_definitions(-DEIGEN_USE_THREADS)
+
 if(WITH_AVX AND AVX_FOUND)
     set(SIMD_FLAG ${AVX_FLAG})
     add_definitions(-DPADDLE_WITH_AVX)
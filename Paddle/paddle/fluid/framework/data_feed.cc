@@ -24,6 +24,7 @@ limitations under the License. */
 #include <sys/stat.h>
 #include <sys/types.h>
 #endif
+#include <algorithm>
 #include <utility>
 #include "gflags/gflags.h"
 #include "google/protobuf/io/zero_copy_stream_impl.h"
@@ -183,25 +184,148 @@ void PrivateQueueDataFeed<T>::ReadThread() {
     __fsetlocking(&*fp_, FSETLOCKING_BYCALLER);
     T instance;
     while (ParseOneInstanceFromPipe(&instance)) {
-      queue_->Put(instance);
+      PutInstance(instance);
     }
   }
-  queue_->Close();
+  FinishPutInstance();
 #endif
 }
 
+template <typename T>
+void PrivateQueueDataFeed<T>::SetStreamOptions(
+    const DataFeedDesc& data_feed_desc) {
+  PADDLE_ENFORCE(data_feed_desc.shuffle_buffer_size() >= 0,
+                 "Illegal shuffle buffer size: %d.",
+                 data_feed_desc.shuffle_buffer_size());
+  PADDLE_ENFORCE(data_feed_desc.batch_token_budget() >= 0,
+                 "Illegal batch token budget: %d.",
+                 data_feed_desc.batch_token_budget());
+  shuffle_buffer_size_ = data_feed_desc.shuffle_buffer_size();
+  shuffle_buffer_.clear();
+  shuffle_buffer_.reserve(shuffle_buffer_size_);
+  batch_token_budget_ = data_feed_desc.batch_token_budget();
+  bucket_pool_.clear();
+  batch_queue_ = nullptr;
+  if (batch_token_budget_ > 0) {
+    PADDLE_ENFORCE(data_feed_desc.bucket_pool_size() > 0,
+                   "Illegal bucket pool size: %d.",
+                   data_feed_desc.bucket_pool_size());
+    bucket_pool_size_ = data_feed_desc.bucket_pool_size();
+    // Holds about as many instances as queue_.
+    batch_queue_ = paddle::framework::MakeChannel<std::vector<T>>();
+    batch_queue_->SetCapacity(
+        std::max<size_t>(1, queue_size_ / default_batch_size_));
+  }
+}
+
+template <typename T>
+void PrivateQueueDataFeed<T>::PutInstance(const T& instance) {
+  if (shuffle_buffer_size_ == 0) {
+    PutToBatchQueue(instance);
+    return;
+  }
+  if (shuffle_buffer_.size() < shuffle_buffer_size_) {
+    shuffle_buffer_.push_back(instance);
+    return;
+  }
+  // Replaces a random instance of the buffer with the new one.
+  auto fleet_ptr = FleetWrapper::GetInstance();
+  size_t index = fleet_ptr->LocalRandomEngine()() % shuffle_buffer_.size();
+  T picked = instance;
+  std::swap(picked, shuffle_buffer_[index]);
+  PutToBatchQueue(std::move(picked));
+}
+
+template <typename T>
+void PrivateQueueDataFeed<T>::FinishPutInstance() {
+  if (!shuffle_buffer_.empty()) {
+    auto fleet_ptr = FleetWrapper::GetInstance();
+    std::shuffle(shuffle_buffer_.begin(), shuffle_buffer_.end(),
+                 fleet_ptr->LocalRandomEngine());
+    for (auto& instance : shuffle_buffer_) {
+      PutToBatchQueue(std::move(instance));
+    }
+    shuffle_buffer_.clear();
+  }
+  if (batch_queue_ != nullptr) {
+    PutBucketBatches();
+    batch_queue_->Close();
+  }
+  queue_->Close();
+}
+
+template <typename T>
+void PrivateQueueDataFeed<T>::PutToBatchQueue(T instance) {
+  if (batch_queue_ == nullptr) {
+    queue_->Put(std::move(instance));
+    return;
+  }
+  bucket_pool_.push_back(std::move(instance));
+  if (bucket_pool_.size() >= bucket_pool_size_) {
+    PutBucketBatches();
+  }
+}
+
+template <typename T>
+void PrivateQueueDataFeed<T>::PutBucketBatches() {
+  std::vector<std::pair<size_t, size_t>> lengths(bucket_pool_.size());
+  for (size_t i = 0; i < bucket_pool_.size(); ++i) {
+    lengths[i] = std::make_pair(GetInstanceLength(bucket_pool_[i]), i);
+  }
+  std::sort(lengths.begin(), lengths.end());
+
+  // Every batch has at most default_batch_size_ instances, and at most
+  // batch_token_budget_ tokens after padding, unless it has one instance.
+  std::vector<std::vector<T>> batches;
+  std::vector<T> batch;
+  size_t max_length = 0;
+  for (auto& length_and_index : lengths) {
+    size_t length = length_and_index.first;
+    if (!batch.empty() &&
+        (batch.size() >= static_cast<size_t>(default_batch_size_) ||
+         std::max(max_length, length) * (batch.size() + 1) >
+             batch_token_budget_)) {
+      batches.push_back(std::move(batch));
+      batch.clear();
+      max_length = 0;
+    }
+    batch.push_back(std::move(bucket_pool_[length_and_index.second]));
+    max_length = std::max(max_length, length);
+  }
+  if (!batch.empty()) {
+    batches.push_back(std::move(batch));
+  }
+  bucket_pool_.clear();
+
+  // Not to train on the batches in the order of length.
+  auto fleet_ptr = FleetWrapper::GetInstance();
+  std::shuffle(batches.begin(), batches.end(), fleet_ptr->LocalRandomEngine());
+  for (auto& b : batches) {
+    batch_queue_->Put(std::move(b));
+  }
+}
+
 template <typename T>
 int PrivateQueueDataFeed<T>::Next() {
 #ifdef _LINUX
   CheckStart();
   int index = 0;
   T ins_vec;
-  while (index < default_batch_size_) {
-    T instance;
-    if (!queue_->Get(instance)) {
-      break;
+  if (batch_queue_ != nullptr) {
+    std::vector<T> batch;
+    if (batch_queue_->Get(batch)) {
+      for (auto& instance : batch) {
+        AddInstanceToInsVec(&ins_vec, instance, index++);
+      }
+    }
+  } else {
+    while (index < default_batch_size_) {
+      T instance;
+      if (!queue_->Get(instance)) {
+        break;
+      }
+      AddInstanceToInsVec(&ins_vec, instance, index++);
     }
-    AddInstanceToInsVec(&ins_vec, instance, index++);
   }
   batch_size_ = index;
   if (batch_size_ != 0) {
@@ -364,6 +488,7 @@ void MultiSlotDataFeed::Init(
   SetBatchSize(data_feed_desc.batch_size());
   // temporarily set queue size = batch size * 100
   SetQueueSize(data_feed_desc.batch_size() * 100);
+  SetStreamOptions(data_feed_desc);
   size_t all_slot_num = multi_slot_desc.slots_size();
   all_slots_.resize(all_slot_num);
   all_slots_type_.resize(all_slot_num);
@@ -416,14 +541,24 @@ void MultiSlotDataFeed::ReadThread() {
     int ins_num = 0;
     while (ParseOneInstanceFromPipe(&instance)) {
       ins_num++;
-      queue_->Put(instance);
+      PutInstance(instance);
     }
     VLOG(3) << "filename: " << filename << " inst num: " << ins_num;
   }
-  queue_->Close();
+  FinishPutInstance();
 #endif
 }
 
+size_t MultiSlotDataFeed::GetInstanceLength(
+    const std::vector<MultiSlotType>& instance) {
+  size_t length = 0;
+  for (auto& slot : instance) {
+    length = std::max(length, slot.GetFloatData().size() +
+                                  slot.GetUint64Data().size());
+  }
+  return length;
+}
+
 bool MultiSlotDataFeed::CheckFile(const char* filename) {
 #ifdef _LINUX
   CheckInit();  // get info of slots
@@ -202,6 +202,20 @@ class PrivateQueueDataFeed : public DataFeed {
                                    int index) = 0;
   // This function is used to put ins_vec to feed_vec
   virtual void PutToFeedVec(const T& ins_vec) = 0;
+  // The length of instance when batching by length.
+  virtual size_t GetInstanceLength(const T& instance) { return 1; }
+
+  // Sets the shuffle buffer and the batching by length of data_feed_desc.
+  // It should be called after SetQueueSize.
+  void SetStreamOptions(const DataFeedDesc& data_feed_desc);
+  // The read thread puts every parsed instance here, instead of to queue_.
+  void PutInstance(const T& instance);
+  // The read thread calls this after reading all the files.
+  void FinishPutInstance();
+  void PutToBatchQueue(T instance);
+  // Sorts the pool by length, and puts it to batch_queue_ in batches of
+  // similar length in random order.
+  void PutBucketBatches();
 
   // The thread for read files
   std::thread read_thread_;
@@ -216,6 +230,19 @@ class PrivateQueueDataFeed : public DataFeed {
   string::LineFileReader reader_;
   // The queue for store parsed data
   std::shared_ptr<paddle::framework::ChannelObject<T>> queue_;
+
+  // The parsed instances are shuffled in shuffle_buffer_ if
+  // shuffle_buffer_size_ > 0, and then batched by length in bucket_pool_ if
+  // batch_token_budget_ > 0.
+  size_t shuffle_buffer_size_ = 0;
+  std::vector<T> shuffle_buffer_;
+  size_t batch_token_budget_ = 0;
+  size_t bucket_pool_size_ = 0;
+  std::vector<T> bucket_pool_;
+  // The batches of similar length, used instead of queue_ when batching by
+  // length.
+  std::shared_ptr<paddle::framework::ChannelObject<std::vector<T>>>
+      batch_queue_;
 };
 
 template <typename T>
@@ -545,6 +572,8 @@ class MultiSlotDataFeed
   virtual bool ParseOneInstance(std::vector<MultiSlotType>* instance);
   virtual bool ParseOneInstanceFromPipe(std::vector<MultiSlotType>* instance);
   virtual void PutToFeedVec(const std::vector<MultiSlotType>& ins_vec);
+  // The most values in a slot of instance.
+  virtual size_t GetInstanceLength(const std::vector<MultiSlotType>& instance);
 };
 
 class MultiSlotInMemoryDataFeed : public InMemoryDataFeed<Record> {
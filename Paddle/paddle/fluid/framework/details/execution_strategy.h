@@ -36,6 +36,10 @@ struct ExecutionStrategy {
   ExecutorType type_{kExperimental};
   // This debug option.
   bool dry_run_{false};
+  // Whether the kExperimental executor schedules ops on a work-stealing
+  // thread pool instead of a single shared task queue. It helps graphs with
+  // many small ops, whose runtime is dominated by scheduling.
+  bool use_work_stealing_{false};
 
   // only use with async_ssa_graph_executor
   // and pyreader with data queue
@@ -37,15 +37,23 @@ FastThreadedSSAGraphExecutor::FastThreadedSSAGraphExecutor(
       places_(places),
       graph_(graph),
       fetch_ctxs_(places),
-      pool_(strategy.num_threads_),
       // add one more thread for generate op_deps
       prepare_pool_(1) {
+  if (strategy_.use_work_stealing_) {
+    work_stealing_pool_.reset(
+        new WorkStealingThreadPool(strategy_.num_threads_));
+  } else {
+    pool_.reset(new ::ThreadPool(strategy_.num_threads_));
+  }
   for (auto &op : ir::FilterByNodeWrapper<OpHandleBase>(*graph_)) {
     int dep = static_cast<int>(op->NotReadyInputSize());
     op_deps_.emplace(op, dep);
     if (dep == 0) {
       bootstrap_ops_.emplace_back(op);
     }
+    if (work_stealing_pool_) {
+      op_tasks_[op].executor_ = this;
+    }
   }
   PADDLE_ENFORCE_GT(op_deps_.size(), 0, "The graph doesn't have operators.");
   PrepareAtomicOpDeps();
@@ -115,6 +123,7 @@ FeedFetchList FastThreadedSSAGraphExecutor::Run(
     }
   }
   // Wait FetchOps.
+  ClearFetchOpTasks(fetch_ops);
   ClearFetchOp(graph_, &fetch_ops);
   return fetches;
 }
@@ -165,6 +174,9 @@ void FastThreadedSSAGraphExecutor::InsertFetchOps(
     if (dep == 0) {
       ready_fetch_ops->emplace_back(op);
     }
+    if (work_stealing_pool_) {
+      op_tasks_[op].executor_ = this;
+    }
   }
 }
 
@@ -190,47 +202,72 @@ void FastThreadedSSAGraphExecutor::RunOpAsync(
     OpHandleBase *op,
     const std::shared_ptr<BlockingQueue<size_t>> &complete_q) {
   ++remaining_;
-  this->pool_.enqueue([=] {
-    std::deque<OpHandleBase *> op_queue;
-    op_queue.push_front(op);
+  if (work_stealing_pool_) {
+    auto &task = op_tasks_.at(op);
+    task.op_ = op;
+    task.op_deps_ = op_deps;
+    task.complete_q_ = complete_q;
+    work_stealing_pool_->Schedule(&task);
+  } else {
+    this->pool_->enqueue(
+        [=] { RunOpChain(op_deps, op, complete_q); });  // NOLINT
+  }
+}
 
-    size_t complete = 0;
-    while (!op_queue.empty()) {
-      OpHandleBase *op_to_run = op_queue.back();
-      op_queue.pop_back();
+void FastThreadedSSAGraphExecutor::OpTask::Run() {
+  // Take the arguments out first, the node may be rescheduled by the next
+  // iteration as soon as this chain reports its completion.
+  auto *op_deps = op_deps_;
+  auto complete_q = std::move(complete_q_);
+  executor_->RunOpChain(op_deps, op_, complete_q);
+}
 
-      if (!RunOp(op_to_run, complete_q, &complete)) {
-        return;
-      }
+void FastThreadedSSAGraphExecutor::RunOpChain(
+    std::unordered_map<OpHandleBase *, std::atomic<int>> *op_deps,
+    OpHandleBase *op,
+    const std::shared_ptr<BlockingQueue<size_t>> &complete_q) {
+  // Reused by every chain that runs on this thread, so that running a chain
+  // does not allocate.
+  static thread_local std::deque<OpHandleBase *> op_queue;
+  op_queue.clear();
+  op_queue.push_front(op);
 
-      auto &outputs = op_to_run->Outputs();
-      op_to_run = nullptr;
-      for (auto &output : outputs) {
-        for (auto &pending_op : output->PendingOps()) {
-          std::atomic<int> &deps = op_deps->at(pending_op);
-          if (deps.fetch_sub(1) != 1) continue;
+  size_t complete = 0;
+  while (!op_queue.empty()) {
+    OpHandleBase *op_to_run = op_queue.back();
+    op_queue.pop_back();
 
-          // NOTE(zjl): op with highest priority should run
-          // first without switching to another thread.
-          if (pending_op->GetPriority() == OpHandleBase::Priority::kHighest) {
-            op_queue.push_back(pending_op);
+    if (!RunOp(op_to_run, complete_q, &complete)) {
+      return;
+    }
+
+    auto &outputs = op_to_run->Outputs();
+    op_to_run = nullptr;
+    for (auto &output : outputs) {
+      for (auto &pending_op : output->PendingOps()) {
+        std::atomic<int> &deps = op_deps->at(pending_op);
+        if (deps.fetch_sub(1) != 1) continue;
+
+        // NOTE(zjl): op with highest priority should run
+        // first without switching to another thread.
+        if (pending_op->GetPriority() == OpHandleBase::Priority::kHighest) {
+          op_queue.push_back(pending_op);
+        } else {
+          if (op_to_run == nullptr) {
+            op_to_run = pending_op;
           } else {
-            if (op_to_run == nullptr) {
-              op_to_run = pending_op;
-            } else {
-              RunOpAsync(op_deps, pending_op, complete_q);
-            }
+            RunOpAsync(op_deps, pending_op, complete_q);
           }
         }
       }
+    }
 
-      if (op_to_run != nullptr) {
-        op_queue.push_front(op_to_run);
-      }
+    if (op_to_run != nullptr) {
+      op_queue.push_front(op_to_run);
     }
-    --remaining_;
-    complete_q->Push(complete);
-  });
+  }
+  --remaining_;
+  complete_q->Push(complete);
 }
 
 void FastThreadedSSAGraphExecutor::PrepareAtomicOpDeps() {
@@ -255,10 +292,18 @@ void FastThreadedSSAGraphExecutor::RecordOps(OpHandleBase *op) {
 void FastThreadedSSAGraphExecutor::ExecutionFinal(
     std::vector<OpHandleBase *> *fetch_ops) {
   VLOG(3) << "caught exception " << exception_.Type() << ", rethrow it";
+  ClearFetchOpTasks(*fetch_ops);
   ClearFetchOp(graph_, fetch_ops);
   exception_.ReThrow();
 }
 
+void FastThreadedSSAGraphExecutor::ClearFetchOpTasks(
+    const std::vector<OpHandleBase *> &fetch_ops) {
+  for (auto *fetch_op : fetch_ops) {
+    op_tasks_.erase(fetch_op);
+  }
+}
+
 void FastThreadedSSAGraphExecutor::RunTracedOps(
     const std::vector<OpHandleBase *> &traced_ops) {
   for (auto &op : traced_ops) {
@@ -22,6 +22,7 @@
 #include "paddle/fluid/framework/details/exception_holder.h"
 #include "paddle/fluid/framework/details/execution_strategy.h"
 #include "paddle/fluid/framework/details/ssa_graph_executor.h"
+#include "paddle/fluid/framework/work_stealing_thread_pool.h"
 
 namespace paddle {
 namespace framework {
@@ -59,8 +60,22 @@ class FastThreadedSSAGraphExecutor : public SSAGraphExecutor {
       atomic_op_deps_;
   ExceptionHolder exception_;
 
-  ::ThreadPool pool_;
+  // The task node of every op for the work-stealing scheduler. An op is
+  // scheduled at most once per iteration, so its node can be reused across
+  // iterations and scheduling needs no allocation.
+  struct OpTask : public WorkStealingTask {
+    void Run() override;
+
+    FastThreadedSSAGraphExecutor *executor_{nullptr};
+    OpHandleBase *op_{nullptr};
+    std::unordered_map<OpHandleBase *, std::atomic<int>> *op_deps_{nullptr};
+    std::shared_ptr<BlockingQueue<size_t>> complete_q_;
+  };
+  std::unordered_map<OpHandleBase *, OpTask> op_tasks_;
+
+  std::unique_ptr<::ThreadPool> pool_;
   ::ThreadPool prepare_pool_;
+  std::unique_ptr<WorkStealingThreadPool> work_stealing_pool_;
 
   std::vector<OpHandleBase *> traced_ops_;
 
@@ -72,12 +87,19 @@ class FastThreadedSSAGraphExecutor : public SSAGraphExecutor {
                   OpHandleBase *op,
                   const std::shared_ptr<BlockingQueue<size_t>> &complete_q);
 
+  // Runs op and, on the same thread, the first ready op following it.
+  void RunOpChain(std::unordered_map<OpHandleBase *, std::atomic<int>> *op_deps,
+                  OpHandleBase *op,
+                  const std::shared_ptr<BlockingQueue<size_t>> &complete_q);
+
   void PrepareAtomicOpDeps();
 
   inline void RecordOps(OpHandleBase *op);
 
   inline void ExecutionFinal(std::vector<OpHandleBase *> *fetch_ops);
 
+  void ClearFetchOpTasks(const std::vector<OpHandleBase *> &fetch_ops);
+
   inline void RunOpSync(OpHandleBase *op);
 
   void RunTracedOps(const std::vector<OpHandleBase *> &traced_ops);
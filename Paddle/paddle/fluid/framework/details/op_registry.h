@@ -170,6 +170,7 @@ struct OpInfoFiller<T, kOpProtoAndCheckerMaker> {
         info->proto_->IsInitialized(),
         "Fail to initialize %s's OpProto, because %s is not initialized",
         op_type, info->proto_->InitializationErrorString());
+    info->signature_ = new OpSignature(*info->proto_);
   }
 };
 
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <unordered_map>
 
 #include "paddle/fluid/framework/data_type.h"
@@ -90,9 +91,18 @@ struct DLContextVisitor : public boost::static_visitor<::DLContext> {
 #endif
   }
 };
+
+// The DLManagedTensor returned by ToDLManagedTensor, with its shape and the
+// memory it shares.
+struct SharedDLManagedTensor {
+  ::DLManagedTensor tensor;
+  int64_t shape[DDim::kMaxRank];
+  std::shared_ptr<memory::Allocation> holder;
+};
 }  // namespace internal
 
-DLPackTensor::DLPackTensor(const Tensor &tensor, LaneType lanes) {
+DLPackTensor::DLPackTensor(const Tensor &tensor, LaneType lanes)
+    : holder_(tensor.Holder()) {
   // init data, data buffer
   t_.data = const_cast<void *>(tensor.data<void>());
 
@@ -158,5 +168,20 @@ DLPackTensor::DLPackTensor(const Tensor &tensor, LaneType lanes) {
   return tensor;
 }
 
+::DLManagedTensor *DLPackTensor::ToDLManagedTensor() {
+  auto *shared = new internal::SharedDLManagedTensor;
+  shared->holder = holder_;
+  std::copy(t_.shape, t_.shape + t_.ndim, shared->shape);
+
+  shared->tensor.dl_tensor = t_;
+  shared->tensor.dl_tensor.shape = shared->shape;
+  shared->tensor.dl_tensor.strides = nullptr;
+  shared->tensor.manager_ctx = shared;
+  shared->tensor.deleter = [](DLManagedTensor *arg) {
+    delete static_cast<internal::SharedDLManagedTensor *>(arg->manager_ctx);
+  };
+  return &shared->tensor;
+}
+
 }  // namespace framework
 }  // namespace paddle
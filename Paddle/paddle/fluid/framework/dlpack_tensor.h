@@ -15,6 +15,7 @@
 #pragma once
 
 #include <dlpack/dlpack.h>
+#include <memory>
 #include "paddle/fluid/framework/tensor.h"
 
 namespace paddle {
@@ -35,8 +36,14 @@ class DLPackTensor {
 
   ::DLManagedTensor* ToCudfCompatibleDLManagedTensor();
 
+  // Exports the tensor of any rank without copying. The returned tensor
+  // shares the memory of the tensor and keeps it alive until its deleter is
+  // called by the consumer.
+  ::DLManagedTensor* ToDLManagedTensor();
+
  private:
   ::DLTensor t_;
+  std::shared_ptr<memory::Allocation> holder_;
 
   // The shape in DLTensor is defined as int64_t*
   // Add this member to make TVMTensor init without heap allocation
@@ -96,6 +96,31 @@ void TestToCudfCompatibleDLManagedTensor(const platform::Place &place,
   dl_managed_tensor->deleter(dl_managed_tensor);
 }
 
+template <typename T>
+void TestToDLManagedTensor(const platform::Place &place, uint16_t lanes) {
+  DDim dims{2, 3, 4};
+  Tensor tensor;
+  tensor.Resize(dims);
+  void *p = tensor.mutable_data<T>(place);
+  auto use_count = tensor.Holder().use_count();
+
+  ::DLManagedTensor *dl_managed_tensor =
+      DLPackTensor(tensor, lanes).ToDLManagedTensor();
+
+  CHECK_EQ(dl_managed_tensor->manager_ctx != nullptr, true);
+  CHECK_EQ(p, dl_managed_tensor->dl_tensor.data);
+  CHECK_EQ(dims.size(), dl_managed_tensor->dl_tensor.ndim);
+  for (auto i = 0; i < dims.size(); ++i) {
+    CHECK_EQ(dims[i], dl_managed_tensor->dl_tensor.shape[i]);
+  }
+  CHECK_EQ(dl_managed_tensor->dl_tensor.strides == nullptr, true);
+  // The memory is kept alive until the consumer deletes the tensor.
+  CHECK_EQ(use_count + 1, tensor.Holder().use_count());
+
+  dl_managed_tensor->deleter(dl_managed_tensor);
+  CHECK_EQ(use_count, tensor.Holder().use_count());
+}
+
 template <typename T>
 void TestMainLoop() {
 #ifdef PADDLE_WITH_CUDA
@@ -113,6 +138,7 @@ void TestMainLoop() {
     for (auto &l : lanes) {
       TestMain<T>(p, l);
       TestToCudfCompatibleDLManagedTensor<T>(p, l);
+      TestToDLManagedTensor<T>(p, l);
     }
   }
 }
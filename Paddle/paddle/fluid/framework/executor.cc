@@ -42,6 +42,8 @@ limitations under the License. */
 #endif
 
 DECLARE_bool(benchmark);
+DECLARE_int32(executor_plan_cache_capacity);
+DECLARE_bool(executor_plan_static_memory);
 DEFINE_bool(use_mkldnn, false, "Use MKLDNN to run");
 DEFINE_bool(use_ngraph, false, "Use NGRAPH to run");
 
@@ -441,17 +443,40 @@ void Executor::RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
       }
     } else if (platform::is_cpu_place(place_)) {
 #endif
-      gc.reset(new CPUGarbageCollector(boost::get<platform::CPUPlace>(place_),
-                                       max_memory_size));
+      if (IsAsyncCPUGarbageCollectionEnabled()) {
+        gc.reset(new AsyncCPUGarbageCollector(
+            boost::get<platform::CPUPlace>(place_), max_memory_size));
+      } else {
+        gc.reset(new CPUGarbageCollector(
+            boost::get<platform::CPUPlace>(place_), max_memory_size));
+      }
 #ifdef PADDLE_WITH_CUDA
     }
 #endif
   }
 
-  for (auto& op : ctx->ops_) {
-    op->Run(*local_scope, place_);
-    if (gc) {
-      DeleteUnusedTensors(*local_scope, op.get(), ctx->unused_vars_, gc.get());
+  // Plans cache variables of the scope, which only outlives the run when no
+  // local scope is created.
+  if (FLAGS_executor_plan_cache_capacity > 0 && local_scope == scope) {
+    if (ctx->plan_cache_ == nullptr) {
+      ctx->plan_cache_.reset(new ExecutorPlanCache(
+          ctx->prog_.Block(ctx->block_id_), ctx->ops_,
+          static_cast<size_t>(FLAGS_executor_plan_cache_capacity),
+          FLAGS_executor_plan_static_memory && gc ? &ctx->unused_vars_
+                                                  : nullptr));
+    }
+    ctx->plan_cache_->Run(*local_scope, place_, [&](const OperatorBase& op) {
+      if (gc) {
+        DeleteUnusedTensors(*local_scope, &op, ctx->unused_vars_, gc.get());
+      }
+    });
+  } else {
+    for (auto& op : ctx->ops_) {
+      op->Run(*local_scope, place_);
+      if (gc) {
+        DeleteUnusedTensors(*local_scope, op.get(), ctx->unused_vars_,
+                            gc.get());
+      }
     }
   }
 
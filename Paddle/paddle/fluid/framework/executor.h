@@ -21,6 +21,7 @@ limitations under the License. */
 #include <vector>
 #include "paddle/fluid/framework/data_set.h"
 #include "paddle/fluid/framework/executor_gc_helper.h"
+#include "paddle/fluid/framework/executor_plan.h"
 #include "paddle/fluid/framework/garbage_collector.h"
 #include "paddle/fluid/framework/op_info.h"
 #include "paddle/fluid/framework/program_desc.h"
@@ -48,6 +49,9 @@ struct ExecutorPrepareContext {
   std::unordered_map<const OperatorBase*, std::vector<std::string>>
       unused_vars_;
   bool force_disable_gc_{false};
+
+  // Created on the first run with FLAGS_executor_plan_cache_capacity > 0.
+  std::unique_ptr<ExecutorPlanCache> plan_cache_;
 };
 
 class Executor {
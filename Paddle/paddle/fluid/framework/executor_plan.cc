@@ -0,0 +1,544 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/executor_plan.h"
+#include <algorithm>
+#include <unordered_set>
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/feed_fetch_type.h"
+#include "paddle/fluid/framework/op_call_stack.h"
+#include "paddle/fluid/platform/profiler.h"
+
+namespace paddle {
+namespace framework {
+namespace {
+
+// Returns false if any variable in vars is not a LoDTensor without LoD.
+// Missing variables are allowed.
+bool AllDenseTensors(const VariableValueMap& vars) {
+  for (auto& pair : vars) {
+    for (auto* var : pair.second) {
+      if (var == nullptr) continue;
+      if (!var->IsType<LoDTensor>() || !var->Get<LoDTensor>().lod().empty()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+std::vector<std::pair<LoDTensor*, DDim>> OutputDims(
+    const RuntimeContext& ctx) {
+  std::vector<std::pair<LoDTensor*, DDim>> dims;
+  for (auto& pair : ctx.outputs) {
+    for (auto* var : pair.second) {
+      if (var == nullptr) continue;
+      auto* tensor = var->GetMutable<LoDTensor>();
+      dims.emplace_back(tensor, tensor->dims());
+    }
+  }
+  return dims;
+}
+
+bool ReadsAnyOf(const OperatorBase& op,
+                const std::unordered_set<std::string>& names) {
+  if (names.empty()) return false;
+  for (auto& pair : op.Inputs()) {
+    for (auto& name : pair.second) {
+      if (names.count(name) > 0) return true;
+    }
+  }
+  return false;
+}
+
+// Whether the op reads an integer tensor through a dispensable input, i.e.
+// probably a shape its kernel may resize the outputs by, while the values of
+// the tensor are not part of the signature.
+bool ReadsUnkeyedShapeTensor(
+    const OperatorBase& op, const RuntimeContext& ctx,
+    const std::unordered_set<std::string>& value_keyed_vars) {
+  auto* info = OpInfoMap::Instance().GetNullable(op.Type());
+  if (info == nullptr || !info->HasOpProtoAndChecker()) return false;
+  for (auto& input : info->Proto().inputs()) {
+    if (!input.dispensable()) continue;
+    auto names = op.Inputs().find(input.name());
+    auto vars = ctx.inputs.find(input.name());
+    if (names == op.Inputs().end() || vars == ctx.inputs.end()) continue;
+    for (size_t i = 0; i < vars->second.size(); ++i) {
+      auto* var = vars->second[i];
+      if (var == nullptr || !var->IsType<LoDTensor>()) continue;
+      auto& tensor = var->Get<LoDTensor>();
+      if (!tensor.IsInitialized() || (tensor.type() != proto::VarType::INT32 &&
+                                      tensor.type() != proto::VarType::INT64)) {
+        continue;
+      }
+      if (value_keyed_vars.count(names->second[i]) == 0 ||
+          tensor.numel() > ExecutorPlanCache::kMaxValueKeyNumel ||
+          !platform::is_cpu_place(tensor.place())) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void AppendDims(const DDim& dims, std::string* signature) {
+  signature->append("[");
+  for (int i = 0; i < dims.size(); ++i) {
+    signature->append(std::to_string(dims[i]));
+    signature->append(",");
+  }
+  signature->append("]");
+}
+
+void AppendTensorSignature(const LoDTensor& tensor, std::string* signature) {
+  if (!tensor.IsInitialized()) {
+    signature->append("u");
+    AppendDims(tensor.dims(), signature);
+    return;
+  }
+  auto type = tensor.type();
+  signature->append(std::to_string(static_cast<int>(type)));
+  AppendDims(tensor.dims(), signature);
+  for (auto& level : tensor.lod()) {
+    signature->append("(");
+    for (auto offset : level) {
+      signature->append(std::to_string(offset));
+      signature->append(",");
+    }
+    signature->append(")");
+  }
+  if (tensor.numel() <= ExecutorPlanCache::kMaxValueKeyNumel &&
+      platform::is_cpu_place(tensor.place())) {
+    if (type == proto::VarType::INT32) {
+      const int* data = tensor.data<int>();
+      for (int64_t i = 0; i < tensor.numel(); ++i) {
+        signature->append("=" + std::to_string(data[i]));
+      }
+    } else if (type == proto::VarType::INT64) {
+      const int64_t* data = tensor.data<int64_t>();
+      for (int64_t i = 0; i < tensor.numel(); ++i) {
+        signature->append("=" + std::to_string(data[i]));
+      }
+    }
+  }
+}
+
+// A slot of the arena of a plan. It keeps the arena alive while a tensor
+// still refers to it, e.g. after the plan is evicted.
+class ArenaSlotAllocation : public memory::Allocation {
+ public:
+  ArenaSlotAllocation(const std::shared_ptr<memory::Allocation>& arena,
+                      size_t offset, size_t size)
+      : Allocation(static_cast<uint8_t*>(arena->ptr()) + offset, size,
+                   arena->place()),
+        arena_(arena) {}
+
+ private:
+  std::shared_ptr<memory::Allocation> arena_;
+};
+
+// Collects the lifetimes, sizes and aliases of the variables written by the
+// prepared ops while a plan is compiled.
+class StaticMemoryTracker {
+ public:
+  // Aliased variables and the lifetime and size of their buffer.
+  using Group = std::pair<std::vector<std::string>, ir::StaticMemoryBlock>;
+
+  explicit StaticMemoryTracker(const OpUnusedVarsMap& unused_vars)
+      : unused_vars_(unused_vars) {}
+
+  // Must be called after the op has run, before its unused variables are
+  // deleted.
+  void AddPreparedOp(size_t index, const OperatorBase& op,
+                     const RuntimeContext& ctx) {
+    std::vector<std::pair<const memory::Allocation*, const std::string*>>
+        input_holders;
+    for (auto& pair : op.Inputs()) {
+      auto& vars = ctx.inputs.at(pair.first);
+      for (size_t i = 0; i < pair.second.size(); ++i) {
+        auto& name = pair.second[i];
+        // Read before written, the value comes from outside the block.
+        if (usages_.count(name) == 0) excluded_.insert(name);
+        if (vars[i] == nullptr) continue;
+        auto* holder = vars[i]->Get<LoDTensor>().Holder().get();
+        if (holder != nullptr) input_holders.emplace_back(holder, &name);
+      }
+    }
+    for (auto& pair : op.Outputs()) {
+      auto& vars = ctx.outputs.at(pair.first);
+      for (size_t i = 0; i < pair.second.size(); ++i) {
+        auto& name = pair.second[i];
+        if (vars[i] == nullptr) continue;
+        auto& tensor = vars[i]->Get<LoDTensor>();
+        if (!tensor.IsInitialized()) {
+          excluded_.insert(name);
+          continue;
+        }
+        size_t size = tensor.numel() * SizeOfType(tensor.type());
+        auto it = usages_.find(name);
+        if (it == usages_.end()) {
+          usages_.emplace(name, Usage{index, size});
+        } else {
+          it->second.size = std::max(it->second.size, size);
+        }
+        for (auto& input : input_holders) {
+          if (input.first != tensor.Holder().get() || *input.second == name) {
+            continue;
+          }
+          if (usages_.count(*input.second) == 0) {
+            // Shares the buffer of a variable that is not placed.
+            excluded_.insert(name);
+          } else {
+            Union(name, *input.second);
+          }
+        }
+      }
+    }
+    EndStep(index, op);
+  }
+
+  void AddOtherOp(size_t index, const OperatorBase& op) {
+    for (auto& pair : op.Inputs()) {
+      excluded_.insert(pair.second.begin(), pair.second.end());
+    }
+    for (auto& pair : op.Outputs()) {
+      excluded_.insert(pair.second.begin(), pair.second.end());
+    }
+    EndStep(index, op);
+  }
+
+  std::vector<Group> Groups() {
+    std::vector<Group> groups;
+    std::vector<bool> valid;
+    std::unordered_map<std::string, size_t> group_index;
+    for (auto& pair : usages_) {
+      auto& name = pair.first;
+      auto root = Find(name);
+      auto it = group_index.find(root);
+      if (it == group_index.end()) {
+        it = group_index.emplace(root, groups.size()).first;
+        groups.emplace_back();
+        groups.back().second = ir::StaticMemoryBlock{
+            0, pair.second.first_write, pair.second.first_write};
+        valid.push_back(true);
+      }
+      auto& group = groups[it->second];
+      group.first.push_back(name);
+      auto last_use = last_use_.find(name);
+      if (excluded_.count(name) > 0 || last_use == last_use_.end() ||
+          last_use->second < pair.second.first_write || pair.second.size == 0) {
+        valid[it->second] = false;
+        continue;
+      }
+      auto& block = group.second;
+      block.size = std::max(block.size, pair.second.size);
+      block.first_use = std::min(block.first_use, pair.second.first_write);
+      block.last_use = std::max(block.last_use, last_use->second);
+    }
+    std::vector<Group> result;
+    for (size_t i = 0; i < groups.size(); ++i) {
+      if (valid[i]) result.emplace_back(std::move(groups[i]));
+    }
+    return result;
+  }
+
+ private:
+  struct Usage {
+    size_t first_write;
+    size_t size;
+  };
+
+  void EndStep(size_t index, const OperatorBase& op) {
+    auto it = unused_vars_.find(&op);
+    if (it == unused_vars_.end()) return;
+    for (auto& name : it->second) {
+      last_use_[name] = index;
+    }
+  }
+
+  std::string Find(const std::string& name) {
+    auto it = alias_parent_.find(name);
+    if (it == alias_parent_.end() || it->second == name) return name;
+    auto root = Find(it->second);
+    alias_parent_[name] = root;
+    return root;
+  }
+
+  void Union(const std::string& a, const std::string& b) {
+    auto root_a = Find(a);
+    auto root_b = Find(b);
+    if (root_a != root_b) alias_parent_[root_a] = root_b;
+  }
+
+  const OpUnusedVarsMap& unused_vars_;
+  std::unordered_map<std::string, Usage> usages_;
+  std::unordered_map<std::string, size_t> last_use_;
+  std::unordered_set<std::string> excluded_;
+  std::unordered_map<std::string, std::string> alias_parent_;
+};
+
+}  // namespace
+
+ExecutorPlan::ExecutorPlan(
+    const std::vector<std::unique_ptr<OperatorBase>>& ops, const Scope& scope,
+    const platform::Place& place, const PlanOpCallback& callback,
+    const OpUnusedVarsMap* unused_vars,
+    const std::unordered_set<std::string>* value_keyed_vars)
+    : scope_(scope), place_(place) {
+  auto& pool = platform::DeviceContextPool::Instance();
+  std::unordered_set<std::string> keyed_vars;
+  if (value_keyed_vars != nullptr) keyed_vars = *value_keyed_vars;
+  std::unique_ptr<StaticMemoryTracker> tracker;
+  if (unused_vars != nullptr) {
+    tracker.reset(new StaticMemoryTracker(*unused_vars));
+  }
+  // The outputs of the ops that are not prepared. Their shapes may depend on
+  // more than the signature, so readers of them are not prepared either.
+  std::unordered_set<std::string> dynamic_vars;
+  steps_.resize(ops.size());
+  for (size_t i = 0; i < ops.size(); ++i) {
+    auto& step = steps_[i];
+    step.op = ops[i].get();
+    auto* kernel_op = dynamic_cast<const OperatorWithKernel*>(step.op);
+
+    bool prepared =
+        kernel_op != nullptr && !ReadsAnyOf(*step.op, dynamic_vars);
+    std::vector<std::pair<LoDTensor*, DDim>> inferred_dims;
+    if (prepared) {
+      step.runtime_ctx.reset(new RuntimeContext(
+          step.op->Inputs(), step.op->Outputs(), scope, step.op->Signature()));
+      prepared = AllDenseTensors(step.runtime_ctx->inputs) &&
+                 AllDenseTensors(step.runtime_ctx->outputs) &&
+                 !ReadsUnkeyedShapeTensor(*step.op, *step.runtime_ctx,
+                                          keyed_vars);
+    }
+    if (prepared) {
+      // Shape inference here sees the same inputs as the one in Run, the
+      // kernel changing the outputs afterwards means their shapes depend on
+      // the data.
+      kernel_op->RuntimeInferShape(scope, place, *step.runtime_ctx);
+      inferred_dims = OutputDims(*step.runtime_ctx);
+    }
+
+    step.op->Run(scope, place);
+
+    if (prepared) {
+      prepared = kernel_op->CanRunPreparedKernel(*step.runtime_ctx) &&
+                 AllDenseTensors(step.runtime_ctx->inputs) &&
+                 AllDenseTensors(step.runtime_ctx->outputs);
+    }
+    if (prepared) {
+      step.output_dims = OutputDims(*step.runtime_ctx);
+      for (size_t j = 0; j < step.output_dims.size() && prepared; ++j) {
+        prepared = step.output_dims[j].second == inferred_dims[j].second;
+      }
+    }
+    if (prepared) {
+      auto* dev_ctx = pool.Get(kernel_op->kernel_type()->place_);
+      step.kernel_op = kernel_op;
+      step.exe_ctx.reset(new ExecutionContext(
+          *kernel_op, scope, *dev_ctx, *step.runtime_ctx,
+          kernel_op->GetKernelConfig(*kernel_op->kernel_type())));
+      ++num_prepared_ops_;
+    } else {
+      step.runtime_ctx.reset();
+      step.output_dims.clear();
+      // The shapes of fed variables, and the values of the small integer
+      // ones, are part of the signature.
+      if (step.op->Type() != kFeedOpType) {
+        for (auto& name : step.op->OutputVars(true)) {
+          dynamic_vars.insert(name);
+        }
+      } else {
+        for (auto& name : step.op->OutputVars(true)) {
+          keyed_vars.insert(name);
+        }
+      }
+      VLOG(4) << "Op " << step.op->Type() << " is not prepared in the plan";
+    }
+
+    if (tracker) {
+      if (step.kernel_op != nullptr) {
+        tracker->AddPreparedOp(i, *step.op, *step.runtime_ctx);
+      } else {
+        tracker->AddOtherOp(i, *step.op);
+      }
+    }
+    if (callback) callback(*step.op);
+  }
+  VLOG(3) << "Compiled an execution plan with " << num_prepared_ops_ << " of "
+          << steps_.size() << " ops prepared";
+
+  if (tracker) PlanMemory(tracker->Groups());
+}
+
+void ExecutorPlan::PlanMemory(
+    const std::vector<std::pair<std::vector<std::string>,
+                                ir::StaticMemoryBlock>>& groups) {
+  if (groups.empty()) return;
+  std::vector<ir::StaticMemoryBlock> blocks;
+  blocks.reserve(groups.size());
+  for (auto& group : groups) {
+    blocks.push_back(group.second);
+  }
+  memory_plan_ = ir::PlanStaticMemory(blocks, kArenaAlignment);
+  arena_ = memory::AllocShared(place_, memory_plan_.arena_size);
+
+  std::unordered_map<std::string, const Tensor*> slot_of_var;
+  slots_.resize(groups.size());
+  for (size_t i = 0; i < groups.size(); ++i) {
+    slots_[i].ResetHolder(std::make_shared<ArenaSlotAllocation>(
+        arena_, memory_plan_.offsets[i], blocks[i].size));
+    for (auto& name : groups[i].first) {
+      slot_of_var[name] = &slots_[i];
+    }
+    num_planned_vars_ += groups[i].first.size();
+  }
+  for (auto& step : steps_) {
+    if (step.kernel_op == nullptr) continue;
+    for (auto& pair : step.op->Outputs()) {
+      auto& vars = step.runtime_ctx->outputs.at(pair.first);
+      for (size_t i = 0; i < pair.second.size(); ++i) {
+        auto it = slot_of_var.find(pair.second[i]);
+        if (it == slot_of_var.end() || vars[i] == nullptr) continue;
+        step.bindings.emplace_back(vars[i]->GetMutable<LoDTensor>(),
+                                   it->second);
+      }
+    }
+  }
+  VLOG(1) << "Placed " << num_planned_vars_ << " variables in a "
+          << memory_plan_.arena_size << " bytes workspace, while an allocator "
+          << "freeing them after their last use peaks at "
+          << memory_plan_.live_peak << " bytes, and "
+          << memory_plan_.total_size << " bytes without reuse";
+}
+
+void ExecutorPlan::Run(const PlanOpCallback& callback) const {
+  for (auto& step : steps_) {
+    if (step.kernel_op == nullptr) {
+      step.op->Run(scope_, place_);
+    } else {
+      for (auto& binding : step.bindings) {
+        binding.first->ShareBufferWith(*binding.second);
+      }
+      for (auto& pair : step.output_dims) {
+        pair.first->Resize(pair.second);
+        // An unprepared op of another plan may have left a LoD here.
+        if (!pair.first->lod().empty()) pair.first->set_lod(LoD());
+      }
+      try {
+        if (platform::IsProfileEnabled()) {
+          platform::RecordEvent record_event(step.op->Type());
+          step.kernel_op->RunPreparedKernel(*step.runtime_ctx, *step.exe_ctx);
+        } else {
+          step.kernel_op->RunPreparedKernel(*step.runtime_ctx, *step.exe_ctx);
+        }
+      } catch (platform::EnforceNotMet& exception) {
+        InsertCallStackInfo(step.op->Type(), step.op->Attrs(), &exception);
+        throw std::move(exception);
+      }
+    }
+    if (callback) callback(*step.op);
+  }
+}
+
+ExecutorPlanCache::ExecutorPlanCache(
+    const BlockDesc& block,
+    const std::vector<std::unique_ptr<OperatorBase>>& ops, size_t capacity,
+    const OpUnusedVarsMap* unused_vars)
+    : ops_(ops), capacity_(capacity), unused_vars_(unused_vars) {
+  PADDLE_ENFORCE_GT(capacity, 0UL,
+                    "The capacity of ExecutorPlanCache must be positive");
+  std::unordered_set<std::string> written;
+  std::unordered_set<std::string> inputs;
+  for (auto& op : ops) {
+    for (auto& pair : op->Inputs()) {
+      for (auto& name : pair.second) {
+        if (name == kEmptyVarName || written.count(name) > 0 ||
+            inputs.count(name) > 0) {
+          continue;
+        }
+        auto* var_desc = block.FindVarRecursive(name);
+        if (var_desc != nullptr && var_desc->Persistable() &&
+            var_desc->GetType() != proto::VarType::FEED_MINIBATCH) {
+          continue;
+        }
+        inputs.insert(name);
+        input_var_names_.push_back(name);
+      }
+    }
+    for (auto& name : op->OutputVars(true)) {
+      written.insert(name);
+    }
+  }
+  value_keyed_vars_.insert(input_var_names_.begin(), input_var_names_.end());
+}
+
+std::string ExecutorPlanCache::ShapeSignature(const Scope& scope) const {
+  std::string signature;
+  for (auto& name : input_var_names_) {
+    signature.append(name);
+    signature.append(":");
+    auto* var = scope.FindVar(name);
+    if (var == nullptr) {
+      signature.append("null;");
+      continue;
+    }
+    signature.append(std::to_string(var->Type()));
+    if (var->IsType<LoDTensor>()) {
+      AppendTensorSignature(var->Get<LoDTensor>(), &signature);
+    } else if (var->IsType<FeedFetchList>()) {
+      for (auto& tensor : var->Get<FeedFetchList>()) {
+        signature.append("|");
+        AppendTensorSignature(tensor, &signature);
+      }
+    }
+    signature.append(";");
+  }
+  return signature;
+}
+
+void ExecutorPlanCache::Run(const Scope& scope, const platform::Place& place,
+                            const PlanOpCallback& callback) {
+  // The generation of a scope is never reused, even if another scope is
+  // allocated at the same address, so the Variables the plans point to are
+  // still alive.
+  if (scope_generation_ != scope.Generation()) {
+    plans_.clear();
+    index_.clear();
+    scope_generation_ = scope.Generation();
+  }
+  auto signature = ShapeSignature(scope);
+  auto it = index_.find(signature);
+  if (it != index_.end()) {
+    plans_.splice(plans_.begin(), plans_, it->second);
+    plans_.front().second->Run(callback);
+    return;
+  }
+
+  VLOG(3) << "Compile an execution plan for signature " << signature;
+  std::unique_ptr<ExecutorPlan> plan(
+      new ExecutorPlan(ops_, scope, place, callback, unused_vars_,
+                       &value_keyed_vars_));
+  if (plans_.size() >= capacity_) {
+    index_.erase(plans_.back().first);
+    plans_.pop_back();
+  }
+  plans_.emplace_front(signature, std::move(plan));
+  index_[signature] = plans_.begin();
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,174 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/framework/ir/memory_optimize_pass/static_memory_planner.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/platform/macros.h"  // for DISABLE_COPY_AND_ASSIGN
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace framework {
+
+// Called after each op of a plan has run, e.g. to collect garbage.
+using PlanOpCallback = std::function<void(const OperatorBase&)>;
+
+// The variables that can be deleted after each op, see GetUnusedVars.
+using OpUnusedVarsMap =
+    std::unordered_map<const OperatorBase*, std::vector<std::string>>;
+
+// An ExecutorPlan is a block compiled for one shape signature of the
+// variables it reads (see ExecutorPlanCache). It is built by running the ops
+// once; every OperatorWithKernel whose output shapes turned out to depend on
+// the signature only becomes a prepared step, which keeps the chosen kernel,
+// a RuntimeContext and an ExecutionContext bound to the scope, and the dims
+// of its outputs. Running a prepared step resizes the outputs and calls the
+// kernel, without kernel selection, data transform or shape inference.
+//
+// The other ops, i.e. ops without kernels (feed, fetch, control flow), ops
+// with LoD or non-LoDTensor variables, ops that need a data transform, ops
+// whose kernels resize their outputs at runtime, ops reading an integer
+// tensor through a dispensable input (which conventionally carries a shape,
+// e.g. the ShapeTensor of reshape2) unless its values are keyed, and all ops
+// reading an output of those, run as usual.
+//
+// Given the lifetimes of the variables, i.e. the unused_vars of eager
+// deletion, the plan also places the intermediate outputs of prepared ops
+// into one preallocated arena (see ir::PlanStaticMemory), so that running
+// those ops allocates nothing. A variable is placed only if all the ops
+// using it are prepared and it is written before being read; outputs that
+// share the buffer of an input (e.g. reshape) are placed with that input.
+class ExecutorPlan {
+ public:
+  static constexpr size_t kArenaAlignment = 64;
+
+  // Compiles the plan. The ops are run once in scope, so the construction
+  // also executes the block. The memory is planned if unused_vars is not
+  // null. value_keyed_vars are the variables whose values are part of the
+  // signature if they are small integer tensors, the outputs of feed ops
+  // are always so.
+  ExecutorPlan(const std::vector<std::unique_ptr<OperatorBase>>& ops,
+               const Scope& scope, const platform::Place& place,
+               const PlanOpCallback& callback,
+               const OpUnusedVarsMap* unused_vars = nullptr,
+               const std::unordered_set<std::string>* value_keyed_vars =
+                   nullptr);
+
+  void Run(const PlanOpCallback& callback) const;
+
+  size_t NumOps() const { return steps_.size(); }
+  size_t NumPreparedOps() const { return num_prepared_ops_; }
+
+  // The number of variables placed in the arena.
+  size_t NumPlannedVars() const { return num_planned_vars_; }
+  const ir::StaticMemoryPlan& MemoryPlan() const { return memory_plan_; }
+
+ private:
+  struct Step {
+    OperatorBase* op;
+    // Null for the ops that run as usual.
+    const OperatorWithKernel* kernel_op{nullptr};
+    std::unique_ptr<RuntimeContext> runtime_ctx;
+    std::unique_ptr<ExecutionContext> exe_ctx;
+    std::vector<std::pair<LoDTensor*, DDim>> output_dims;
+    // Outputs placed in the arena, with the slot each one is bound to.
+    std::vector<std::pair<LoDTensor*, const Tensor*>> bindings;
+  };
+
+  // Places each group of aliased variables in the arena.
+  void PlanMemory(const std::vector<std::pair<std::vector<std::string>,
+                                              ir::StaticMemoryBlock>>& groups);
+
+  const Scope& scope_;
+  const platform::Place place_;
+  std::vector<Step> steps_;
+  size_t num_prepared_ops_{0};
+
+  ir::StaticMemoryPlan memory_plan_;
+  std::shared_ptr<memory::Allocation> arena_;
+  // Tensors holding the slots of the arena, one per group of aliased
+  // variables.
+  std::vector<Tensor> slots_;
+  size_t num_planned_vars_{0};
+
+  DISABLE_COPY_AND_ASSIGN(ExecutorPlan);
+};
+
+// An LRU cache of the ExecutorPlans of a block, keyed by the shape
+// signature of the variables the block reads before writing them: their
+// types, data types, dims and LoDs, plus the values of small integer
+// tensors, which usually carry shapes such as a maximum length. Persistable
+// variables are left out, except the feed holder. All plans are bound to one
+// generation of a scope (see Scope::Generation), which must outlive them;
+// running in another scope, or after variables of the scope are erased,
+// drops them.
+//
+// The plans assume that the output shapes of every prepared op are fully
+// determined by the signature.
+class ExecutorPlanCache {
+ public:
+  // Integer input tensors with at most this many elements are keyed by
+  // value.
+  static constexpr int64_t kMaxValueKeyNumel = 4;
+
+  // The plans also place intermediates in an arena if unused_vars is not
+  // null, which must then outlive the cache.
+  ExecutorPlanCache(const BlockDesc& block,
+                    const std::vector<std::unique_ptr<OperatorBase>>& ops,
+                    size_t capacity,
+                    const OpUnusedVarsMap* unused_vars = nullptr);
+
+  // Runs ops in scope with the plan of the current signature, compiling it
+  // first if it is not cached.
+  void Run(const Scope& scope, const platform::Place& place,
+           const PlanOpCallback& callback);
+
+  std::string ShapeSignature(const Scope& scope) const;
+
+  const std::vector<std::string>& InputVarNames() const {
+    return input_var_names_;
+  }
+
+  size_t Size() const { return plans_.size(); }
+
+ private:
+  using PlanList =
+      std::list<std::pair<std::string, std::unique_ptr<ExecutorPlan>>>;
+
+  const std::vector<std::unique_ptr<OperatorBase>>& ops_;
+  size_t capacity_;
+  const OpUnusedVarsMap* unused_vars_;
+  std::vector<std::string> input_var_names_;
+  std::unordered_set<std::string> value_keyed_vars_;
+  uint64_t scope_generation_{0};
+  // Most recently used first.
+  PlanList plans_;
+  std::unordered_map<std::string, PlanList::iterator> index_;
+
+  DISABLE_COPY_AND_ASSIGN(ExecutorPlanCache);
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,342 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/executor_plan.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/tensor_util.h"
+
+DECLARE_bool(check_nan_inf);
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+// Out = X, with a dispensable integer input as the ShapeTensor of reshape2.
+class ShapedCopyOp : public OperatorWithKernel {
+ public:
+  using OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(InferShapeContext* ctx) const override {
+    ctx->SetOutputDim("Out", ctx->GetInputDim("X"));
+  }
+
+ protected:
+  OpKernelType GetExpectedKernelType(
+      const ExecutionContext& ctx) const override {
+    return OpKernelType(IndicateVarDataType(ctx, "X"), ctx.GetPlace());
+  }
+};
+
+class ShapedCopyOpMaker : public OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X", "");
+    AddInput("Shape", "").AsDispensable();
+    AddOutput("Out", "");
+    AddComment("");
+  }
+};
+
+class ShapedCopyKernel : public OpKernel<float> {
+ public:
+  void Compute(const ExecutionContext& ctx) const override {
+    auto* x = ctx.Input<Tensor>("X");
+    auto* out = ctx.Output<Tensor>("Out");
+    TensorCopySync(*x, ctx.GetPlace(), out);
+  }
+};
+
+void AppendScale(BlockDesc* block, const std::string& x,
+                 const std::string& out, float scale) {
+  auto* op = block->AppendOp();
+  op->SetType("scale");
+  op->SetInput("X", {x});
+  op->SetOutput("Out", {out});
+  op->SetAttr("scale", scale);
+  op->SetAttr("bias", 0.0f);
+  op->SetAttr("bias_after_scale", true);
+}
+
+// d = scale(a, 2) + c, or scale(scale(a, 4), 0.5) + c with an intermediate e.
+void BuildProgram(ProgramDesc* program, bool two_scales = false) {
+  auto* block = program->MutableBlock(0);
+  for (auto* name : {"a", "b", "c", "d", "e"}) {
+    block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  if (two_scales) {
+    AppendScale(block, "a", "e", 4.0f);
+    AppendScale(block, "e", "b", 0.5f);
+  } else {
+    AppendScale(block, "a", "b", 2.0f);
+  }
+
+  auto* add = block->AppendOp();
+  add->SetType("elementwise_add");
+  add->SetInput("X", {"b"});
+  add->SetInput("Y", {"c"});
+  add->SetOutput("Out", {"d"});
+  add->SetAttr("axis", -1);
+}
+
+std::vector<std::unique_ptr<OperatorBase>> CreateOps(
+    const ProgramDesc& program) {
+  std::vector<std::unique_ptr<OperatorBase>> ops;
+  for (auto* op_desc : program.Block(0).AllOps()) {
+    ops.push_back(OpRegistry::CreateOp(*op_desc));
+  }
+  return ops;
+}
+
+void Feed(Scope* scope, const std::string& name, const DDim& dims,
+          float value) {
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  tensor->Resize(dims);
+  auto* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = value + i;
+  }
+}
+
+void CheckOutput(const Scope& scope, const DDim& dims, float a, float c) {
+  auto& d = scope.FindVar("d")->Get<LoDTensor>();
+  ASSERT_EQ(d.dims(), dims);
+  const float* data = d.data<float>();
+  for (int64_t i = 0; i < d.numel(); ++i) {
+    EXPECT_FLOAT_EQ(data[i], 2 * (a + i) + (c + i));
+  }
+}
+
+}  // namespace
+
+TEST(ExecutorPlan, PreparedOps) {
+  ProgramDesc program;
+  BuildProgram(&program);
+  auto ops = CreateOps(program);
+  Scope scope;
+  for (auto* name : {"b", "d"}) scope.Var(name)->GetMutable<LoDTensor>();
+  auto place = platform::CPUPlace();
+
+  DDim dims = make_ddim({2, 3});
+  Feed(&scope, "a", dims, 1);
+  Feed(&scope, "c", dims, 10);
+  int num_callbacks = 0;
+  auto callback = [&](const OperatorBase&) { ++num_callbacks; };
+  ExecutorPlan plan(ops, scope, place, callback);
+  EXPECT_EQ(num_callbacks, 2);
+  EXPECT_EQ(plan.NumOps(), 2UL);
+  EXPECT_EQ(plan.NumPreparedOps(), 2UL);
+  CheckOutput(scope, dims, 1, 10);
+
+  Feed(&scope, "a", dims, 5);
+  Feed(&scope, "c", dims, -3);
+  plan.Run(callback);
+  EXPECT_EQ(num_callbacks, 4);
+  CheckOutput(scope, dims, 5, -3);
+}
+
+TEST(ExecutorPlan, PreparedOpsCheckNanInf) {
+  ProgramDesc program;
+  BuildProgram(&program);
+  auto ops = CreateOps(program);
+  Scope scope;
+  for (auto* name : {"b", "d"}) scope.Var(name)->GetMutable<LoDTensor>();
+
+  DDim dims = make_ddim({2, 3});
+  Feed(&scope, "a", dims, 1);
+  Feed(&scope, "c", dims, 10);
+  ExecutorPlan plan(ops, scope, platform::CPUPlace(), nullptr);
+  ASSERT_EQ(plan.NumPreparedOps(), 2UL);
+
+  scope.FindVar("c")->GetMutable<LoDTensor>()->data<float>()[0] =
+      std::numeric_limits<float>::infinity();
+  FLAGS_check_nan_inf = true;
+  EXPECT_THROW(plan.Run(nullptr), platform::EnforceNotMet);
+  FLAGS_check_nan_inf = false;
+}
+
+TEST(ExecutorPlan, LoDInputsAreNotPrepared) {
+  ProgramDesc program;
+  BuildProgram(&program);
+  auto ops = CreateOps(program);
+  Scope scope;
+  for (auto* name : {"b", "d"}) scope.Var(name)->GetMutable<LoDTensor>();
+
+  DDim dims = make_ddim({4, 1});
+  Feed(&scope, "a", dims, 0);
+  Feed(&scope, "c", dims, 0);
+  scope.FindVar("a")->GetMutable<LoDTensor>()->set_lod({{0, 1, 4}});
+  ExecutorPlan plan(ops, scope, platform::CPUPlace(), nullptr);
+  // scale reads a LoD and elementwise_add reads the output of scale.
+  EXPECT_EQ(plan.NumPreparedOps(), 0UL);
+  CheckOutput(scope, dims, 0, 0);
+}
+
+TEST(ExecutorPlan, StaticMemory) {
+  ProgramDesc program;
+  BuildProgram(&program, true);
+  auto ops = CreateOps(program);
+  Scope scope;
+  for (auto* name : {"b", "d", "e"}) {
+    scope.Var(name)->GetMutable<LoDTensor>();
+  }
+  // e dies after the second scale and b after elementwise_add, d is kept.
+  OpUnusedVarsMap unused_vars;
+  unused_vars[ops[1].get()] = {"e"};
+  unused_vars[ops[2].get()] = {"b"};
+
+  DDim dims = make_ddim({3, 5});
+  Feed(&scope, "a", dims, 1);
+  Feed(&scope, "c", dims, 2);
+  ExecutorPlan plan(ops, scope, platform::CPUPlace(), nullptr, &unused_vars);
+  CheckOutput(scope, dims, 1, 2);
+  EXPECT_EQ(plan.NumPreparedOps(), 3UL);
+  EXPECT_EQ(plan.NumPlannedVars(), 2UL);
+  auto& memory_plan = plan.MemoryPlan();
+  // e and b are both live at the second scale.
+  EXPECT_EQ(memory_plan.arena_size, 2 * ExecutorPlan::kArenaAlignment);
+  EXPECT_EQ(memory_plan.live_peak, memory_plan.arena_size);
+
+  auto& b = scope.FindVar("b")->Get<LoDTensor>();
+  auto& e = scope.FindVar("e")->Get<LoDTensor>();
+  plan.Run(nullptr);
+  CheckOutput(scope, dims, 1, 2);
+  const float* b_data = b.data<float>();
+  const float* e_data = e.data<float>();
+  EXPECT_NE(b_data, e_data);
+  EXPECT_EQ(b.Holder()->size(), b.numel() * sizeof(float));
+
+  // Later runs reuse the same workspace.
+  Feed(&scope, "a", dims, 3);
+  plan.Run(nullptr);
+  CheckOutput(scope, dims, 3, 2);
+  EXPECT_EQ(b.data<float>(), b_data);
+  EXPECT_EQ(e.data<float>(), e_data);
+}
+
+TEST(ExecutorPlan, UnkeyedShapeTensorsAreNotPrepared) {
+  ProgramDesc program;
+  auto* block = program.MutableBlock(0);
+  for (auto* name : {"a", "s", "b", "c", "d"}) {
+    block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  auto* copy = block->AppendOp();
+  copy->SetType("shaped_copy");
+  copy->SetInput("X", {"a"});
+  copy->SetInput("Shape", {"s"});
+  copy->SetOutput("Out", {"b"});
+  auto* add = block->AppendOp();
+  add->SetType("elementwise_add");
+  add->SetInput("X", {"b"});
+  add->SetInput("Y", {"c"});
+  add->SetOutput("Out", {"d"});
+  add->SetAttr("axis", -1);
+  auto ops = CreateOps(program);
+
+  auto run = [&](int64_t shape_numel,
+                 const std::unordered_set<std::string>& keyed_vars) {
+    Scope scope;
+    for (auto* name : {"b", "d"}) scope.Var(name)->GetMutable<LoDTensor>();
+    DDim dims = make_ddim({2, 3});
+    Feed(&scope, "a", dims, 1);
+    Feed(&scope, "c", dims, 1);
+    auto* shape = scope.Var("s")->GetMutable<LoDTensor>();
+    int* data = shape->mutable_data<int>(make_ddim({shape_numel}),
+                                         platform::CPUPlace());
+    std::fill(data, data + shape_numel, 1);
+    ExecutorPlan plan(ops, scope, platform::CPUPlace(), nullptr, nullptr,
+                      &keyed_vars);
+    return plan.NumPreparedOps();
+  };
+
+  // The values of s are in the signature only if it is small and keyed.
+  EXPECT_EQ(run(2, {"a", "s", "c"}), 2UL);
+  EXPECT_EQ(run(ExecutorPlanCache::kMaxValueKeyNumel + 1, {"a", "s", "c"}),
+            0UL);
+  EXPECT_EQ(run(2, {"a", "c"}), 0UL);
+}
+
+TEST(ExecutorPlanCache, LRU) {
+  ProgramDesc program;
+  BuildProgram(&program);
+  auto ops = CreateOps(program);
+  ExecutorPlanCache cache(program.Block(0), ops, 2);
+  std::vector<std::string> expected_inputs({"a", "c"});
+  EXPECT_EQ(cache.InputVarNames(), expected_inputs);
+
+  Scope scope;
+  for (auto* name : {"b", "d"}) scope.Var(name)->GetMutable<LoDTensor>();
+  auto place = platform::CPUPlace();
+  auto run = [&](int batch_size, float a, float c) {
+    DDim dims = make_ddim({batch_size, 3});
+    Feed(&scope, "a", dims, a);
+    Feed(&scope, "c", dims, c);
+    cache.Run(scope, place, nullptr);
+    CheckOutput(scope, dims, a, c);
+  };
+
+  run(2, 1, 2);
+  auto signature = cache.ShapeSignature(scope);
+  run(2, 3, 4);
+  EXPECT_EQ(cache.Size(), 1UL);
+  // The values of float inputs are not part of the signature.
+  EXPECT_EQ(cache.ShapeSignature(scope), signature);
+
+  run(8, 1, 2);
+  EXPECT_EQ(cache.Size(), 2UL);
+  EXPECT_NE(cache.ShapeSignature(scope), signature);
+  // Evicts the plan of batch size 2, which is the least recently used.
+  run(4, 1, 2);
+  EXPECT_EQ(cache.Size(), 2UL);
+  run(2, 7, 8);
+  run(8, 5, 6);
+  EXPECT_EQ(cache.Size(), 2UL);
+
+  // Plans are bound to the scope they were compiled in.
+  Scope other_scope;
+  for (auto* name : {"b", "d"}) {
+    other_scope.Var(name)->GetMutable<LoDTensor>();
+  }
+  Feed(&other_scope, "a", make_ddim({1, 3}), 1);
+  Feed(&other_scope, "c", make_ddim({1, 3}), 1);
+  cache.Run(other_scope, place, nullptr);
+  EXPECT_EQ(cache.Size(), 1UL);
+  CheckOutput(other_scope, make_ddim({1, 3}), 1, 1);
+
+  // And to the variables of the scope at that time.
+  other_scope.EraseVars({"b"});
+  other_scope.Var("b")->GetMutable<LoDTensor>();
+  Feed(&other_scope, "a", make_ddim({1, 3}), 2);
+  cache.Run(other_scope, place, nullptr);
+  EXPECT_EQ(cache.Size(), 1UL);
+  CheckOutput(other_scope, make_ddim({1, 3}), 2, 1);
+}
+
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_OP_WITHOUT_GRADIENT(shaped_copy, paddle::framework::ShapedCopyOp,
+                             paddle::framework::ShapedCopyOpMaker);
+REGISTER_OP_CPU_KERNEL(shaped_copy, paddle::framework::ShapedCopyKernel);
+
+USE_OP(scale);
+USE_OP(elementwise_add);
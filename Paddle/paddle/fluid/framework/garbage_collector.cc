@@ -17,6 +17,7 @@
 #include <functional>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <thread>  // NOLINT
 #include <utility>
 #ifdef PADDLE_WITH_CUDA
 #include "paddle/fluid/platform/cuda_device_guard.h"
@@ -28,6 +29,7 @@
 DECLARE_double(eager_delete_tensor_gb);
 DECLARE_double(memory_fraction_of_eager_deletion);
 DECLARE_bool(fast_eager_deletion_mode);
+DECLARE_bool(async_cpu_garbage_collection);
 
 namespace paddle {
 namespace framework {
@@ -100,6 +102,116 @@ void StreamGarbageCollector::ClearCallback(
 }
 #endif
 
+// The thread releasing the garbages of all the AsyncCPUGarbageCollectors.
+// Producers push batches to a lock-free stack, which the thread takes as a
+// whole and releases in the order they were pushed.
+class GarbageReleaseThread {
+ public:
+  static GarbageReleaseThread &Instance() {
+    // Never destroyed, since garbages may be released at exit.
+    static auto *instance = new GarbageReleaseThread();
+    return *instance;
+  }
+
+  void Push(const std::function<void()> &callback, size_t bytes,
+            AsyncCPUGarbageCollector *owner) {
+    auto *batch = new Batch{callback, bytes, owner, nullptr};
+    batch->next = head_.load(std::memory_order_relaxed);
+    while (!head_.compare_exchange_weak(batch->next, batch)) {
+    }
+    if (sleeping_.load()) {
+      std::lock_guard<std::mutex> guard(mutex_);
+      cv_.notify_one();
+    }
+  }
+
+ private:
+  struct Batch {
+    std::function<void()> callback;
+    size_t bytes;
+    AsyncCPUGarbageCollector *owner;
+    Batch *next;
+  };
+
+  GarbageReleaseThread() {
+    std::thread([this] { Loop(); }).detach();
+  }
+
+  void Loop() {
+    while (true) {
+      Batch *batches = head_.exchange(nullptr);
+      if (batches == nullptr) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        sleeping_.store(true);
+        cv_.wait(lock, [this] { return head_.load() != nullptr; });
+        sleeping_.store(false);
+        continue;
+      }
+      // The stack holds the newest batch first.
+      Batch *reversed = nullptr;
+      while (batches != nullptr) {
+        Batch *next = batches->next;
+        batches->next = reversed;
+        reversed = batches;
+        batches = next;
+      }
+      while (reversed != nullptr) {
+        Batch *next = reversed->next;
+        reversed->callback();
+        reversed->owner->OnReleased(reversed->bytes);
+        delete reversed;
+        reversed = next;
+      }
+    }
+  }
+
+  std::atomic<Batch *> head_{nullptr};
+  std::atomic<bool> sleeping_{false};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+AsyncCPUGarbageCollector::AsyncCPUGarbageCollector(
+    const platform::CPUPlace &place, size_t max_memory_size)
+    : GarbageCollector(place, max_memory_size),
+      max_pending_bytes_(std::max(max_memory_size, kMinPendingBytes)) {}
+
+AsyncCPUGarbageCollector::~AsyncCPUGarbageCollector() { Wait(); }
+
+void AsyncCPUGarbageCollector::Wait() const {
+  std::unique_lock<std::mutex> lock(release_mutex_);
+  release_cv_.wait(lock, [this] { return pending_batches_.load() == 0; });
+}
+
+void AsyncCPUGarbageCollector::ClearCallback(
+    const std::function<void()> &callback) {
+  ReleaseGarbages(callback, 0);
+}
+
+void AsyncCPUGarbageCollector::ReleaseGarbages(
+    const std::function<void()> &callback, size_t bytes) {
+  ++pending_batches_;
+  size_t pending_bytes = pending_bytes_.fetch_add(bytes) + bytes;
+  GarbageReleaseThread::Instance().Push(callback, bytes, this);
+  // Back pressure, so that memory is not allocated faster than it is
+  // released.
+  if (pending_bytes > max_pending_bytes_) {
+    std::unique_lock<std::mutex> lock(release_mutex_);
+    release_cv_.wait(lock, [this] {
+      return pending_bytes_.load() <= max_pending_bytes_;
+    });
+  }
+}
+
+void AsyncCPUGarbageCollector::OnReleased(size_t bytes) {
+  // Under the lock, since the collector may be destroyed as soon as the
+  // last batch is released.
+  std::lock_guard<std::mutex> guard(release_mutex_);
+  pending_bytes_ -= bytes;
+  --pending_batches_;
+  release_cv_.notify_all();
+}
+
 int64_t GetEagerDeletionThreshold() {
   return FLAGS_eager_delete_tensor_gb < 0
              ? -1
@@ -109,6 +221,10 @@ int64_t GetEagerDeletionThreshold() {
 
 bool IsFastEagerDeletionModeEnabled() { return FLAGS_fast_eager_deletion_mode; }
 
+bool IsAsyncCPUGarbageCollectionEnabled() {
+  return FLAGS_async_cpu_garbage_collection;
+}
+
 void SetEagerDeletionMode(double threshold, double fraction, bool fast_mode) {
   FLAGS_eager_delete_tensor_gb = threshold;
   FLAGS_memory_fraction_of_eager_deletion = fraction;
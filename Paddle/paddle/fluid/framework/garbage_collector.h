@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
 #include <deque>
 #include <functional>
 #include <memory>
@@ -44,6 +46,12 @@ class GarbageCollector {
  protected:
   virtual void ClearCallback(const std::function<void()> &callback) = 0;
 
+  // Releases garbages of the given size in bytes by calling callback.
+  virtual void ReleaseGarbages(const std::function<void()> &callback,
+                               size_t bytes) {
+    ClearCallback(callback);
+  }
+
   platform::DeviceContext *dev_ctx_;
   std::unique_ptr<GarbageQueue> garbages_;
   mutable std::unique_ptr<std::mutex> mutex_;
@@ -59,6 +67,50 @@ class CPUGarbageCollector : public GarbageCollector {
   void ClearCallback(const std::function<void()> &callback) override;
 };
 
+/*
+ * Releases the garbages on a background thread shared by all the
+ * AsyncCPUGarbageCollectors, so that freeing memory is not on the critical
+ * path of the ops. The garbages are passed to the thread through a lock-free
+ * queue, and the thread releases all the batches queued at a time. Adding
+ * garbages blocks while the bytes not released yet exceed
+ * max(max_memory_size, kMinPendingBytes).
+ */
+class AsyncCPUGarbageCollector : public GarbageCollector {
+ public:
+  // The least bytes allowed to be pending, so that garbages are still
+  // released asynchronously when they are collected one by one.
+  static constexpr size_t kMinPendingBytes = 64 << 20;
+
+  AsyncCPUGarbageCollector(const platform::CPUPlace &place,
+                           size_t max_memory_size);
+
+  // Waits until all the garbages added are released.
+  ~AsyncCPUGarbageCollector();
+
+  void Wait() const override;
+
+  size_t PendingBytes() const { return pending_bytes_.load(); }
+
+ protected:
+  void ClearCallback(const std::function<void()> &callback) override;
+
+  void ReleaseGarbages(const std::function<void()> &callback,
+                       size_t bytes) override;
+
+ private:
+  friend class GarbageReleaseThread;
+
+  // Called by the release thread once a batch of garbages is released.
+  void OnReleased(size_t bytes);
+
+  const size_t max_pending_bytes_;
+  // Both only decrease while holding release_mutex_.
+  std::atomic<size_t> pending_bytes_{0};
+  std::atomic<size_t> pending_batches_{0};
+  mutable std::mutex release_mutex_;
+  mutable std::condition_variable release_cv_;
+};
+
 #ifdef PADDLE_WITH_CUDA
 class UnsafeFastGPUGarbageCollector : public GarbageCollector {
  public:
@@ -110,13 +162,18 @@ void GarbageCollector::Add(Container &&objs, Callback &&callback) {
   // Special case when FLAGS_eager_delete_tensor_gb=0.0
   // It speeds up GC about 2~3%.
   if (max_memory_size_ <= 1) {
+    size_t bytes = 0;
+    for (auto &obj : objs) {
+      if (obj) bytes += obj->size();
+    }
     callback();
     auto *container = new Container(std::move(objs));
-    ClearCallback([container] { delete container; });
+    ReleaseGarbages([container] { delete container; }, bytes);
     return;
   }
 
   GarbageQueue *garbage_queue = nullptr;
+  size_t bytes = 0;
   {
     std::lock_guard<std::mutex> guard(*mutex_);
     for (auto &obj : objs) {
@@ -125,6 +182,7 @@ void GarbageCollector::Add(Container &&objs, Callback &&callback) {
       garbages_->push_back(std::move(obj));
     }
     if (cur_memory_size_ >= max_memory_size_) {
+      bytes = cur_memory_size_;
       cur_memory_size_ = 0;
       garbage_queue = garbages_.release();
       garbages_.reset(new GarbageQueue());
@@ -133,12 +191,13 @@ void GarbageCollector::Add(Container &&objs, Callback &&callback) {
 
   if (garbage_queue) {
     callback();
-    ClearCallback([garbage_queue]() { delete garbage_queue; });
+    ReleaseGarbages([garbage_queue]() { delete garbage_queue; }, bytes);
   }
 }
 
 int64_t GetEagerDeletionThreshold();
 bool IsFastEagerDeletionModeEnabled();
+bool IsAsyncCPUGarbageCollectionEnabled();
 
 void SetEagerDeletionMode(double threshold, double fraction, bool fast_mode);
 
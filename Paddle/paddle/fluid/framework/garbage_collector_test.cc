@@ -0,0 +1,129 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/garbage_collector.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <deque>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+using Garbages = std::deque<std::shared_ptr<memory::Allocation>>;
+
+// Allocations of no memory which record how they are released.
+struct ReleaseRecorder {
+  std::atomic<int> num_released{0};
+  std::atomic<bool> released_on_caller{false};
+  std::chrono::milliseconds delay{0};
+
+  std::shared_ptr<memory::Allocation> Allocate(size_t size) {
+    auto caller = std::this_thread::get_id();
+    return std::shared_ptr<memory::Allocation>(
+        new memory::Allocation(nullptr, size, platform::CPUPlace()),
+        [this, caller](memory::Allocation* allocation) {
+          std::this_thread::sleep_for(delay);
+          if (std::this_thread::get_id() == caller) released_on_caller = true;
+          ++num_released;
+          delete allocation;
+        });
+  }
+};
+
+}  // namespace
+
+class AsyncCPUGarbageCollectorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    platform::DeviceContextPool::Init({platform::CPUPlace()});
+  }
+};
+
+TEST_F(AsyncCPUGarbageCollectorTest, ReleaseOnBackgroundThread) {
+  ReleaseRecorder recorder;
+  AsyncCPUGarbageCollector gc(platform::CPUPlace(), 0);
+  for (int i = 0; i < 100; ++i) {
+    Garbages garbages;
+    garbages.emplace_back(recorder.Allocate(16));
+    garbages.emplace_back(recorder.Allocate(32));
+    gc.Add(std::move(garbages));
+  }
+  gc.Wait();
+  EXPECT_EQ(recorder.num_released.load(), 200);
+  EXPECT_FALSE(recorder.released_on_caller.load());
+  EXPECT_EQ(gc.PendingBytes(), 0UL);
+}
+
+TEST_F(AsyncCPUGarbageCollectorTest, Threshold) {
+  ReleaseRecorder recorder;
+  AsyncCPUGarbageCollector gc(platform::CPUPlace(), 100);
+  Garbages garbages;
+  garbages.emplace_back(recorder.Allocate(60));
+  gc.Add(std::move(garbages));
+  gc.Wait();
+  // Held until the garbages reach max_memory_size.
+  EXPECT_EQ(recorder.num_released.load(), 0);
+
+  garbages.clear();
+  garbages.emplace_back(recorder.Allocate(60));
+  gc.Add(std::move(garbages));
+  gc.Wait();
+  EXPECT_EQ(recorder.num_released.load(), 2);
+}
+
+TEST_F(AsyncCPUGarbageCollectorTest, BackPressure) {
+  ReleaseRecorder recorder;
+  recorder.delay = std::chrono::milliseconds(20);
+  AsyncCPUGarbageCollector gc(platform::CPUPlace(), 0);
+  const size_t size = AsyncCPUGarbageCollector::kMinPendingBytes / 2 + 1;
+  Garbages garbages;
+  garbages.emplace_back(recorder.Allocate(size));
+  gc.Add(std::move(garbages));
+  garbages.clear();
+  garbages.emplace_back(recorder.Allocate(size));
+  // Blocks until the first allocation is released.
+  gc.Add(std::move(garbages));
+  EXPECT_GE(recorder.num_released.load(), 1);
+  EXPECT_LE(gc.PendingBytes(), size);
+}
+
+TEST_F(AsyncCPUGarbageCollectorTest, ConcurrentProducers) {
+  ReleaseRecorder recorder;
+  {
+    AsyncCPUGarbageCollector gc(platform::CPUPlace(), 1024);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([&] {
+        for (int i = 0; i < 1000; ++i) {
+          Garbages garbages;
+          garbages.emplace_back(recorder.Allocate(64));
+          gc.Add(std::move(garbages));
+        }
+      });
+    }
+    for (auto& thread : threads) thread.join();
+    // The destructor waits for the garbages to be released, but those below
+    // max_memory_size are kept in the collector until it is destroyed.
+  }
+  EXPECT_EQ(recorder.num_released.load(), 4000);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,188 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/constant_folding_pass.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+// Ops that produce different results on every run, or have side effects.
+const std::unordered_set<std::string>& UnfoldableOpTypes() {
+  static const std::unordered_set<std::string> types = {
+      "feed",
+      "fetch",
+      "dropout",
+      "uniform_random",
+      "uniform_random_batch_size_like",
+      "gaussian_random",
+      "gaussian_random_batch_size_like",
+      "truncated_gaussian_random",
+      "sampling_id",
+      "random_crop",
+      "randint",
+      "randperm",
+      "shuffle_batch",
+      "sample_logits",
+      "nce",
+      "print",
+      "save",
+      "save_combine",
+      "load",
+      "load_combine",
+      "increment",
+  };
+  return types;
+}
+
+bool HasCPUKernel(const std::string& type) {
+  auto& all_kernels = OperatorWithKernel::AllOpKernels();
+  auto it = all_kernels.find(type);
+  if (it == all_kernels.end()) return false;
+  for (auto& pair : it->second) {
+    if (platform::is_cpu_place(pair.first.place_)) return true;
+  }
+  return false;
+}
+
+bool HasBlockAttr(const OpDesc& op) {
+  for (auto& name : op.AttrNames()) {
+    auto type = op.GetAttrType(name);
+    if (type == proto::AttrType::BLOCK || type == proto::AttrType::BLOCKS) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+bool ConstantFoldingPass::IsFoldable(
+    const Node* op, const std::unordered_set<const Node*>& constants,
+    const std::unordered_set<std::string>& multi_written) const {
+  auto* op_desc = op->Op();
+  if (op_desc == nullptr) return false;
+  if (UnfoldableOpTypes().count(op_desc->Type()) > 0 ||
+      !HasCPUKernel(op_desc->Type()) || HasBlockAttr(*op_desc)) {
+    return false;
+  }
+  for (auto* in : op->inputs) {
+    if (constants.count(in) == 0) return false;
+  }
+  if (op->outputs.empty()) return false;
+  std::unordered_set<std::string> input_names;
+  for (auto* in : op->inputs) input_names.insert(in->Name());
+  for (auto* out : op->outputs) {
+    auto* var = out->Var();
+    // Do not overwrite parameters, nor variables that other ops write too.
+    if (var == nullptr || var->GetType() != proto::VarType::LOD_TENSOR ||
+        var->Persistable() || input_names.count(out->Name()) > 0 ||
+        multi_written.count(out->Name()) > 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ConstantFoldingPass::ApplyImpl(ir::Graph* graph) const {
+  PADDLE_ENFORCE_NOT_NULL(graph);
+  FusePassBase::Init(name_scope_, graph);
+  auto* scope = param_scope();
+  PADDLE_ENFORCE_NOT_NULL(scope, "The param scope should not be null.");
+
+  // Constant variables, as nodes since a name may have several nodes.
+  std::unordered_set<const Node*> constants;
+  std::unordered_map<std::string, int> num_writers;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && node->Var() != nullptr && node->Var()->Persistable()) {
+      auto* var = scope->FindVar(node->Name());
+      if (var != nullptr && var->IsType<LoDTensor>() &&
+          var->Get<LoDTensor>().IsInitialized()) {
+        constants.insert(node);
+      }
+    } else if (node->IsOp()) {
+      for (auto* out : node->outputs) ++num_writers[out->Name()];
+    }
+  }
+  std::unordered_set<std::string> multi_written;
+  for (auto& pair : num_writers) {
+    if (pair.second > 1) multi_written.insert(pair.first);
+  }
+
+  std::unordered_set<const Node*> folded_ops;
+  std::unordered_set<std::string> folded_vars;
+  platform::CPUPlace place;
+  for (auto* op : TopologySortOperations(*graph)) {
+    if (!IsFoldable(op, constants, multi_written)) continue;
+    // The outputs go to the param scope directly, where the inputs are.
+    for (auto* out : op->outputs) {
+      scope->Var(out->Name())->GetMutable<LoDTensor>();
+    }
+    VLOG(4) << "Fold op " << op->Op()->Type();
+    auto op_base = OpRegistry::CreateOp(*op->Op());
+    op_base->Run(*scope, place);
+    for (auto* out : op->outputs) {
+      constants.insert(out);
+      folded_vars.insert(out->Name());
+    }
+    folded_ops.insert(op);
+  }
+  if (folded_ops.empty()) return;
+
+  // Remove the folded ops and the variables only they read. The outputs
+  // still read by the remaining ops become parameters.
+  std::unordered_set<const Node*> nodes_to_remove(folded_ops.begin(),
+                                                  folded_ops.end());
+  std::vector<std::string> vars_to_erase;
+  for (auto* op : folded_ops) {
+    std::vector<Node*> vars(op->inputs.begin(), op->inputs.end());
+    vars.insert(vars.end(), op->outputs.begin(), op->outputs.end());
+    for (auto* var : vars) {
+      if (nodes_to_remove.count(var) > 0) continue;
+      bool used = false;
+      for (auto* reader : var->outputs) {
+        if (folded_ops.count(reader) == 0) used = true;
+      }
+      if (used) {
+        var->Var()->SetPersistable(true);
+        continue;
+      }
+      nodes_to_remove.insert(var);
+      // Parameters no longer used are left in the scope, which may be shared
+      // with other predictors.
+      if (folded_vars.count(var->Name()) > 0) {
+        vars_to_erase.push_back(var->Name());
+      }
+    }
+  }
+  GraphSafeRemoveNodes(graph, nodes_to_remove);
+  scope->EraseVars(vars_to_erase);
+  AddStatis(folded_ops.size());
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(constant_folding_pass,
+              paddle::framework::ir::ConstantFoldingPass);
@@ -0,0 +1,54 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <unordered_set>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Evaluates the ops whose inputs are all constant once with their CPU
+ * kernels, e.g. fill_constant, assign_value, or range and scale building
+ * position ids, and replaces their outputs with persistable variables in the
+ * param scope. Constant variables are the persistable variables held by the
+ * param scope and the outputs of folded ops. The folded ops, and the
+ * variables only they read, are removed from the graph.
+ *
+ * Ops with random outputs, side effects or sub-blocks, ops without a CPU
+ * kernel and ops writing a variable that is written elsewhere are kept.
+ */
+class ConstantFoldingPass : public FusePassBase {
+ public:
+  virtual ~ConstantFoldingPass() {}
+
+ protected:
+  void ApplyImpl(ir::Graph* graph) const override;
+
+ private:
+  bool IsFoldable(const Node* op,
+                  const std::unordered_set<const Node*>& constants,
+                  const std::unordered_set<std::string>& multi_written) const;
+
+  const std::string name_scope_{"constant_folding"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
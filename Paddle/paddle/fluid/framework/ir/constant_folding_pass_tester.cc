@@ -0,0 +1,103 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/constant_folding_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static Node* FindVarNode(const std::unique_ptr<Graph>& graph,
+                         const std::string& name) {
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && node->Name() == name) return node;
+  }
+  return nullptr;
+}
+
+TEST(ConstantFoldingPass, basic) {
+  Layers layers;
+  // (w) -> scale -> (tmp_0) -> scale -> (tmp_1)
+  // (x, tmp_1) -> elementwise_add -> (tmp_2)
+  // (x) -> scale -> (tmp_3)
+  auto* x = layers.data("x");
+  auto* w = layers.data("w", {2, 3}, true);
+  auto* scale_0 = layers.scale(w, 2.0f, 1.0f, true);
+  auto* scale_1 = layers.scale(scale_0, 0.5f, 0.0f, true);
+  auto* add = layers.elementwise_add(x, scale_1);
+  layers.scale(x, 3.0f, 0.0f, true);
+
+  Scope scope;
+  auto* w_tensor = scope.Var("w")->GetMutable<LoDTensor>();
+  w_tensor->Resize({2, 3});
+  float* w_data = w_tensor->mutable_data<float>(platform::CPUPlace());
+  for (int i = 0; i < 6; ++i) w_data[i] = i;
+
+  std::unique_ptr<Graph> graph(new Graph(layers.main_program()));
+  graph->SetNotOwned(kParamScopeAttr, &scope);
+  auto pass = PassRegistry::Instance().Get("constant_folding_pass");
+  EXPECT_EQ(GetNumOpNodes(graph, "scale"), 3);
+  graph.reset(pass->Apply(graph.release()));
+  VLOG(3) << DebugString(graph);
+
+  // Only the scale of x is left.
+  EXPECT_EQ(GetNumOpNodes(graph, "scale"), 1);
+  EXPECT_EQ(GetNumOpNodes(graph, "elementwise_add"), 1);
+  EXPECT_EQ(FindVarNode(graph, scale_0->Name()), nullptr);
+  EXPECT_EQ(FindVarNode(graph, w->Name()), nullptr);
+  EXPECT_EQ(scope.FindVar(scale_0->Name()), nullptr);
+  EXPECT_NE(scope.FindVar(w->Name()), nullptr);
+
+  auto* folded = FindVarNode(graph, scale_1->Name());
+  ASSERT_NE(folded, nullptr);
+  EXPECT_TRUE(folded->Var()->Persistable());
+  ASSERT_EQ(folded->outputs.size(), 1UL);
+  EXPECT_EQ(folded->outputs[0]->Op()->Output("Out")[0], add->Name());
+  auto& folded_tensor = scope.FindVar(scale_1->Name())->Get<LoDTensor>();
+  ASSERT_EQ(folded_tensor.numel(), 6);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_FLOAT_EQ(folded_tensor.data<float>()[i], (2.0f * i + 1.0f) * 0.5f);
+  }
+}
+
+TEST(ConstantFoldingPass, keep_random_ops) {
+  Layers layers;
+  auto* w = layers.data("w", {4}, true);
+  auto* dropout_out = layers.dropout(w, 0.5f, "upscale_in_train");
+  layers.scale(dropout_out, 2.0f, 0.0f, true);
+
+  Scope scope;
+  auto* w_tensor = scope.Var("w")->GetMutable<LoDTensor>();
+  w_tensor->Resize({4});
+  w_tensor->mutable_data<float>(platform::CPUPlace());
+
+  std::unique_ptr<Graph> graph(new Graph(layers.main_program()));
+  graph->SetNotOwned(kParamScopeAttr, &scope);
+  auto pass = PassRegistry::Instance().Get("constant_folding_pass");
+  graph.reset(pass->Apply(graph.release()));
+  EXPECT_EQ(GetNumOpNodes(graph, "dropout"), 1);
+  EXPECT_EQ(GetNumOpNodes(graph, "scale"), 1);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(constant_folding_pass);
+USE_OP(scale);
+USE_OP(elementwise_add);
@@ -0,0 +1,267 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/fusion_group_pass.h"
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/op_desc.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+// An op supported by fusion_group: its type in fusion_group, with the scale
+// and bias of scale, and its input and output variables.
+struct ElementwiseOp {
+  std::string type;
+  float scale{1.0f};
+  float bias{0.0f};
+  Node* x{nullptr};
+  Node* y{nullptr};
+  Node* out{nullptr};
+};
+
+Node* FindVarNode(const std::vector<Node*>& nodes, const std::string& name) {
+  for (auto* node : nodes) {
+    if (node->IsVar() && node->Name() == name) return node;
+  }
+  return nullptr;
+}
+
+// Whether var is a float tensor of the given shape. Unknown dims, e.g. the
+// batch size, are left to the runtime checks of fusion_group, which requires
+// the same dims for all its inputs.
+bool IsFloatTensor(const Node* var, const std::vector<int64_t>& shape) {
+  auto* desc = var->Var();
+  return desc != nullptr && desc->GetType() == proto::VarType::LOD_TENSOR &&
+         desc->GetDataType() == proto::VarType::FP32 && !shape.empty() &&
+         desc->GetShape() == shape;
+}
+
+// The single input of slot name, or nullptr.
+Node* SingleInput(Node* op, const std::string& name) {
+  auto& names = op->Op()->Input(name);
+  return names.size() == 1 ? FindVarNode(op->inputs, names[0]) : nullptr;
+}
+
+Node* SingleOutput(Node* op, const std::string& name) {
+  auto& names = op->Op()->Output(name);
+  return names.size() == 1 ? FindVarNode(op->outputs, names[0]) : nullptr;
+}
+
+bool ParseElementwiseOp(Node* op, ElementwiseOp* result) {
+  static const std::unordered_set<std::string> binary_types = {
+      "elementwise_add", "elementwise_sub", "elementwise_mul",
+      "elementwise_div", "elementwise_max", "elementwise_min"};
+  static const std::unordered_set<std::string> unary_types = {
+      "relu", "sigmoid", "tanh", "exp", "gelu"};
+
+  auto* desc = op->Op();
+  if (desc == nullptr) return false;
+  // Ops ordered by control dependencies, e.g. against in-place writes, must
+  // run where they are.
+  for (auto* nodes : {&op->inputs, &op->outputs}) {
+    for (auto* var : *nodes) {
+      if (var->IsCtrlVar()) return false;
+    }
+  }
+  if (desc->HasAttr("use_mkldnn") &&
+      boost::get<bool>(desc->GetAttr("use_mkldnn"))) {
+    return false;
+  }
+  const std::string& type = desc->Type();
+  result->type = type;
+  result->scale = 1.0f;
+  result->bias = 0.0f;
+  result->x = SingleInput(op, "X");
+  result->y = nullptr;
+  result->out = SingleOutput(op, "Out");
+  if (result->x == nullptr || result->out == nullptr) return false;
+  // Other outputs, e.g. the Mask of dropout which is not computed in test
+  // mode, must not be read.
+  for (auto* var : op->outputs) {
+    if (var != result->out && !var->outputs.empty()) return false;
+  }
+
+  if (binary_types.count(type) > 0) {
+    result->y = SingleInput(op, "Y");
+    if (result->y == nullptr) return false;
+  } else if (type == "scale") {
+    result->scale = boost::get<float>(desc->GetAttr("scale"));
+    float bias = boost::get<float>(desc->GetAttr("bias"));
+    bool bias_after = boost::get<bool>(desc->GetAttr("bias_after_scale"));
+    result->bias = bias_after ? bias : bias * result->scale;
+  } else if (type == "dropout") {
+    if (!desc->HasAttr("is_test") ||
+        !boost::get<bool>(desc->GetAttr("is_test"))) {
+      return false;
+    }
+    result->type = "scale";
+    if (desc->HasAttr("dropout_implementation") &&
+        boost::get<std::string>(desc->GetAttr("dropout_implementation")) ==
+            "upscale_in_train") {
+      result->scale = 1.0f;
+    } else {
+      result->scale =
+          1.0f - boost::get<float>(desc->GetAttr("dropout_prob"));
+    }
+  } else if (type == "cast") {
+    if (boost::get<int>(desc->GetAttr("in_dtype")) != proto::VarType::FP32 ||
+        boost::get<int>(desc->GetAttr("out_dtype")) != proto::VarType::FP32) {
+      return false;
+    }
+    result->type = "scale";
+  } else if (unary_types.count(type) == 0) {
+    return false;
+  }
+
+  // No broadcast, no in-place computation and no parameter written.
+  auto* out_desc = result->out->Var();
+  if (out_desc == nullptr || out_desc->Persistable()) return false;
+  auto shape = out_desc->GetShape();
+  for (auto* var : {result->x, result->y, result->out}) {
+    if (var == nullptr) continue;
+    if (!IsFloatTensor(var, shape)) return false;
+    if (var != result->out && var->Name() == result->out->Name()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+void FusionGroupPass::ApplyImpl(ir::Graph* graph) const {
+  PADDLE_ENFORCE_NOT_NULL(graph);
+  FusePassBase::Init(name_scope_, graph);
+
+  auto ops = TopologySortOperations(*graph);
+  std::unordered_map<Node*, size_t> op_index;
+  std::unordered_map<Node*, ElementwiseOp> supported;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    op_index[ops[i]] = i;
+    ElementwiseOp op;
+    if (ParseElementwiseOp(ops[i], &op)) supported.emplace(ops[i], op);
+  }
+
+  std::unordered_set<Node*> grouped;
+  int num_groups = 0;
+  // Roots are visited from the end, so every group is as large as possible.
+  for (auto it = ops.rbegin(); it != ops.rend(); ++it) {
+    Node* root = *it;
+    if (supported.count(root) == 0 || grouped.count(root) > 0) continue;
+
+    std::vector<Node*> group = {root};
+    std::unordered_set<Node*> internal_vars;
+    for (size_t i = 0; i < group.size(); ++i) {
+      auto& op = supported.at(group[i]);
+      for (auto* var : {op.x, op.y}) {
+        if (var == nullptr || var->Var()->Persistable() ||
+            var->inputs.size() != 1 || internal_vars.count(var) > 0) {
+          continue;
+        }
+        Node* producer = var->inputs[0];
+        if (supported.count(producer) == 0 || grouped.count(producer) > 0 ||
+            supported.at(producer).out != var) {
+          continue;
+        }
+        bool single_reader = std::all_of(
+            var->outputs.begin(), var->outputs.end(),
+            [&](const Node* reader) { return reader == group[i]; });
+        if (!single_reader) continue;
+        internal_vars.insert(var);
+        group.push_back(producer);
+        grouped.insert(producer);
+      }
+    }
+    grouped.insert(root);
+    if (group.size() < 2) continue;
+
+    std::sort(group.begin(), group.end(), [&](Node* a, Node* b) {
+      return op_index.at(a) < op_index.at(b);
+    });
+    // The inputs of the group are numbered first, then the outputs of its
+    // ops in execution order.
+    std::vector<Node*> inputs;
+    std::unordered_map<Node*, int> var_ids;
+    for (auto* op_node : group) {
+      auto& op = supported.at(op_node);
+      for (auto* var : {op.x, op.y}) {
+        if (var == nullptr || internal_vars.count(var) > 0 ||
+            var_ids.count(var) > 0) {
+          continue;
+        }
+        var_ids[var] = static_cast<int>(inputs.size());
+        inputs.push_back(var);
+      }
+    }
+    std::vector<std::string> input_names, op_types;
+    std::vector<int> op_args;
+    std::vector<float> op_scales, op_biases;
+    for (auto* var : inputs) input_names.push_back(var->Name());
+    for (auto* op_node : group) {
+      auto& op = supported.at(op_node);
+      var_ids[op.out] = static_cast<int>(var_ids.size());
+      op_types.push_back(op.type);
+      op_args.push_back(var_ids.at(op.x));
+      op_args.push_back(op.y == nullptr ? -1 : var_ids.at(op.y));
+      op_args.push_back(var_ids.at(op.out));
+      op_scales.push_back(op.scale);
+      op_biases.push_back(op.bias);
+    }
+    Node* out = supported.at(root).out;
+
+    OpDesc desc;
+    desc.SetType("fusion_group");
+    desc.SetInput("Inputs", input_names);
+    desc.SetOutput("Outs", {out->Name()});
+    desc.SetAttr("op_types", op_types);
+    desc.SetAttr("op_args", op_args);
+    desc.SetAttr("op_scales", op_scales);
+    desc.SetAttr("op_biases", op_biases);
+    desc.SetAttr("out_ids", std::vector<int>({var_ids.at(out)}));
+    auto* fused = graph->CreateOpNode(&desc);
+    for (auto* var : inputs) {
+      IR_NODE_LINK_TO(var, fused);
+    }
+    IR_NODE_LINK_TO(fused, out);
+
+    // The ops, their outputs but the root's, and the unused dropout masks.
+    std::unordered_set<const Node*> nodes_to_remove(group.begin(),
+                                                    group.end());
+    for (auto* op_node : group) {
+      for (auto* var : op_node->outputs) {
+        if (var != out) nodes_to_remove.insert(var);
+      }
+    }
+    VLOG(4) << "Fuse " << group.size() << " ops into fusion_group "
+            << out->Name();
+    GraphSafeRemoveNodes(graph, nodes_to_remove);
+    ++num_groups;
+  }
+  AddStatis(num_groups);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(fusion_group_pass, paddle::framework::ir::FusionGroupPass);
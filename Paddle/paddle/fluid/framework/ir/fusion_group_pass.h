@@ -0,0 +1,53 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Fuses groups of elementwise and activation ops on float tensors of the
+ * same compile-time shape into one fusion_group op, which runs all of them
+ * in a single pass over memory. For example, the attention mask
+ *   (1 - mask) * scores + scale(mask, -1e10)
+ * becomes one op reading mask and scores and writing the result.
+ *
+ * Supported ops are elementwise_add, elementwise_sub, elementwise_mul,
+ * elementwise_div, elementwise_max and elementwise_min without broadcast,
+ * relu, sigmoid, tanh, exp, gelu, scale, dropout in test mode and cast from
+ * float to float. A group is a tree of these ops rooted at its only output,
+ * grown from the root through the variables that are read by a single op of
+ * the group, so fusing it can not create cycles.
+ */
+class FusionGroupPass : public FusePassBase {
+ public:
+  virtual ~FusionGroupPass() {}
+
+ protected:
+  void ApplyImpl(ir::Graph* graph) const override;
+
+ private:
+  const std::string name_scope_{"fusion_group"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
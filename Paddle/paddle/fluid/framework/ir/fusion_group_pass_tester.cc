@@ -0,0 +1,181 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/fusion_group_pass.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static std::unique_ptr<Graph> ApplyFusionGroupPass(Layers* layers) {
+  std::unique_ptr<Graph> graph(new Graph(layers->main_program()));
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && node->Var() != nullptr) {
+      node->Var()->SetDataType(proto::VarType::FP32);
+      if (node->Var()->GetShape().empty()) {
+        node->Var()->SetShape({2, 8});
+      }
+    }
+  }
+  auto pass = PassRegistry::Instance().Get("fusion_group_pass");
+  graph.reset(pass->Apply(graph.release()));
+  VLOG(3) << DebugString(graph);
+  return graph;
+}
+
+static Node* FindOpNode(const std::unique_ptr<Graph>& graph,
+                        const std::string& type) {
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == type) return node;
+  }
+  return nullptr;
+}
+
+TEST(FusionGroupPass, attention_mask) {
+  Layers layers;
+  // (1 - mask) * scores + scale(mask, -1e10), then dropout
+  auto* mask = layers.data("mask");
+  auto* scores = layers.data("scores");
+  auto* one_minus_mask = layers.scale(mask, -1.0f, 1.0f, true);
+  auto* masked_scores = layers.elementwise_mul(one_minus_mask, scores);
+  auto* bias = layers.scale(mask, -1e10f, 0.0f, true);
+  auto* sum = layers.elementwise_add(masked_scores, bias);
+  auto* out = layers.dropout(sum, 0.1f, "downgrade_in_infer");
+
+  auto graph = ApplyFusionGroupPass(&layers);
+  EXPECT_EQ(GetNumOpNodes(graph, "fusion_group"), 1);
+  EXPECT_EQ(GetNumOpNodes(graph, "scale"), 0);
+  EXPECT_EQ(GetNumOpNodes(graph, "elementwise_mul"), 0);
+  EXPECT_EQ(GetNumOpNodes(graph, "elementwise_add"), 0);
+  EXPECT_EQ(GetNumOpNodes(graph, "dropout"), 0);
+
+  auto* fused = FindOpNode(graph, "fusion_group");
+  ASSERT_NE(fused, nullptr);
+  auto* desc = fused->Op();
+  auto inputs = desc->Input("Inputs");
+  std::sort(inputs.begin(), inputs.end());
+  EXPECT_EQ(inputs, std::vector<std::string>({"mask", "scores"}));
+  EXPECT_EQ(desc->Output("Outs"), std::vector<std::string>({out->Name()}));
+  auto op_types =
+      boost::get<std::vector<std::string>>(desc->GetAttr("op_types"));
+  ASSERT_EQ(op_types.size(), 5UL);
+  // The dropout, which is the root, runs last as a scale by 1 - p.
+  EXPECT_EQ(op_types.back(), "scale");
+  auto op_scales = boost::get<std::vector<float>>(desc->GetAttr("op_scales"));
+  EXPECT_FLOAT_EQ(op_scales.back(), 0.9f);
+  auto op_args = boost::get<std::vector<int>>(desc->GetAttr("op_args"));
+  EXPECT_EQ(op_args.size(), 15UL);
+  auto out_ids = boost::get<std::vector<int>>(desc->GetAttr("out_ids"));
+  EXPECT_EQ(out_ids, std::vector<int>({op_args.back()}));
+  EXPECT_EQ(fused->inputs.size(), 2UL);
+  ASSERT_EQ(fused->outputs.size(), 1UL);
+  EXPECT_EQ(fused->outputs[0]->Name(), out->Name());
+}
+
+TEST(FusionGroupPass, shared_intermediate) {
+  Layers layers;
+  // relu(x) is read by two ops, so only single ops are left.
+  auto* x = layers.data("x");
+  auto* y = layers.data("y");
+  auto* relu = layers.relu(x);
+  layers.elementwise_add(relu, y);
+  layers.elementwise_mul(relu, y);
+
+  auto graph = ApplyFusionGroupPass(&layers);
+  EXPECT_EQ(GetNumOpNodes(graph, "fusion_group"), 0);
+  EXPECT_EQ(GetNumOpNodes(graph, "relu"), 1);
+}
+
+TEST(FusionGroupPass, broadcast_and_parameters) {
+  Layers layers;
+  auto* x = layers.data("x", {4, 8});
+  auto* b = layers.data("b", {8}, true);
+  auto* w = layers.data("w", {4, 8}, true);
+  // The broadcast add is not fused, the parameter w is an input of the group.
+  auto* add = layers.elementwise_add(x, b);
+  auto* mul = layers.elementwise_mul(add, w);
+  auto* relu = layers.relu(mul);
+  for (auto* var : {add, mul, relu}) var->SetShape({4, 8});
+
+  auto graph = ApplyFusionGroupPass(&layers);
+  EXPECT_EQ(GetNumOpNodes(graph, "fusion_group"), 1);
+  EXPECT_EQ(GetNumOpNodes(graph, "elementwise_add"), 1);
+  auto* fused = FindOpNode(graph, "fusion_group");
+  ASSERT_NE(fused, nullptr);
+  auto inputs = fused->Op()->Input("Inputs");
+  std::sort(inputs.begin(), inputs.end());
+  EXPECT_EQ(inputs, std::vector<std::string>({add->Name(), "w"}));
+}
+
+TEST(FusionGroupPass, gelu) {
+  Layers layers;
+  // gelu(x * w + b), the activation of a feed-forward layer.
+  auto* x = layers.data("x");
+  auto* w = layers.data("w");
+  auto* b = layers.data("b");
+  auto* mul = layers.elementwise_mul(x, w);
+  auto* add = layers.elementwise_add(mul, b);
+  layers.gelu(add);
+
+  auto graph = ApplyFusionGroupPass(&layers);
+  EXPECT_EQ(GetNumOpNodes(graph, "fusion_group"), 1);
+  EXPECT_EQ(GetNumOpNodes(graph, "gelu"), 0);
+  auto* fused = FindOpNode(graph, "fusion_group");
+  ASSERT_NE(fused, nullptr);
+  auto op_types =
+      boost::get<std::vector<std::string>>(fused->Op()->GetAttr("op_types"));
+  EXPECT_EQ(op_types.back(), "gelu");
+}
+
+TEST(FusionGroupPass, unknown_batch_size) {
+  Layers layers;
+  // The batch size is only known at runtime, where fusion_group checks that
+  // the inputs have the same dims.
+  auto* x = layers.data("x", {-1, 8});
+  auto* y = layers.data("y", {-1, 8});
+  auto* sum = layers.elementwise_add(x, y);
+  auto* relu = layers.relu(sum);
+  for (auto* var : {sum, relu}) var->SetShape({-1, 8});
+
+  auto graph = ApplyFusionGroupPass(&layers);
+  EXPECT_EQ(GetNumOpNodes(graph, "fusion_group"), 1);
+  EXPECT_EQ(GetNumOpNodes(graph, "elementwise_add"), 0);
+  EXPECT_EQ(GetNumOpNodes(graph, "relu"), 0);
+}
+
+TEST(FusionGroupPass, broadcast_mask) {
+  Layers layers;
+  // A [B, 1, S, S] mask is broadcast over the heads of the scores.
+  auto* mask = layers.data("mask", {-1, 1, 8, 8});
+  auto* scores = layers.data("scores", {-1, 4, 8, 8});
+  auto* one_minus_mask = layers.scale(mask, -1.0f, 1.0f, true);
+  auto* masked_scores = layers.elementwise_mul(scores, one_minus_mask);
+  one_minus_mask->SetShape({-1, 1, 8, 8});
+  masked_scores->SetShape({-1, 4, 8, 8});
+
+  auto graph = ApplyFusionGroupPass(&layers);
+  EXPECT_EQ(GetNumOpNodes(graph, "fusion_group"), 0);
+  EXPECT_EQ(GetNumOpNodes(graph, "scale"), 1);
+  EXPECT_EQ(GetNumOpNodes(graph, "elementwise_mul"), 1);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(fusion_group_pass);
@@ -1297,6 +1297,24 @@ PDNode *patterns::ConvDequant::operator()() {
   return dequant_out;
 }
 
+PDNode *patterns::OpDequant::operator()(
+    const std::unordered_set<std::string> &op_types) {
+  auto any_op = pattern->NewNode(any_op_repr())->assert_is_ops(op_types);
+  auto dequant_op =
+      pattern->NewNode(dequant_op_repr())->assert_is_op("dequantize");
+
+  auto any_op_out = pattern->NewNode(any_op_out_repr())
+                        ->assert_is_ops_output(op_types, "Out");
+  auto dequant_out = pattern->NewNode(dequant_out_repr())
+                         ->AsOutput()
+                         ->assert_is_op_output("dequantize", "Output");
+
+  any_op->LinksTo({any_op_out});
+  dequant_op->LinksFrom({any_op_out}).LinksTo({dequant_out});
+
+  return dequant_out;
+}
+
 PDNode *patterns::PriorBox::operator()() {
   auto prior_box_op =
       pattern->NewNode(prior_box_op_repr())->assert_is_op("prior_box");
@@ -1322,6 +1340,45 @@ PDNode *patterns::PriorBox::operator()() {
   return boxes_var;
 }
 
+PDNode *patterns::Mul::operator()() {
+  auto mul_op = pattern->NewNode(mul_op_repr())->assert_is_op("mul");
+
+  auto input_x_var = pattern->NewNode(mul_x_repr())
+                         ->AsInput()
+                         ->assert_is_op_input("mul", "X");
+
+  auto input_y_var = pattern->NewNode(mul_y_repr())
+                         ->AsInput()
+                         ->assert_is_persistable_var()
+                         ->assert_is_op_input("mul", "Y");
+
+  auto output_var = pattern->NewNode(mul_out_repr())
+                        ->AsOutput()
+                        ->assert_is_op_output("mul", "Out");
+
+  mul_op->LinksFrom({input_x_var, input_y_var}).LinksTo({output_var});
+  return output_var;
+}
+
+PDNode *patterns::MatMul::operator()() {
+  auto matmul_op = pattern->NewNode(matmul_op_repr())->assert_is_op("matmul");
+
+  auto input_x_var = pattern->NewNode(matmul_in_x_repr())
+                         ->AsInput()
+                         ->assert_is_op_input("matmul", "X");
+
+  auto input_y_var = pattern->NewNode(matmul_in_y_repr())
+                         ->AsInput()
+                         ->assert_is_op_input("matmul", "Y");
+
+  auto output_var = pattern->NewNode(matmul_out_repr())
+                        ->AsOutput()
+                        ->assert_is_op_output("matmul", "Out");
+
+  matmul_op->LinksFrom({input_x_var, input_y_var}).LinksTo({output_var});
+  return output_var;
+}
+
 std::unordered_set<std::string> conv_act_set({"identity", "relu"});
 
 PDNode *patterns::ConvElementwiseaddAct::operator()(PDNode *conv_in) {
@@ -812,6 +812,25 @@ struct ConvDequant : public PatternBase {
   PATTERN_DECL_NODE(dequant_out);
 };
 
+// Fc, Mul or MatMul + Dequant
+// This pattern is used for squashing the dequantize into the output of the
+// quantized operators which can output FP32.
+// named nodes:
+// any_op, any_op_out
+// dequant_op, dequant_out
+struct OpDequant : public PatternBase {
+  OpDequant(PDPattern* pattern, const std::string& name_scope)
+      : PatternBase(pattern, name_scope, "op_dequant") {}
+
+  PDNode* operator()(const std::unordered_set<std::string>& op_types);
+
+  PATTERN_DECL_NODE(any_op);
+  PATTERN_DECL_NODE(any_op_out);
+
+  PATTERN_DECL_NODE(dequant_op);
+  PATTERN_DECL_NODE(dequant_out);
+};
+
 // PriorBox operator
 // operator: prior_box_op
 // inputs: prior_box_input, prior_box_image
@@ -829,6 +848,38 @@ struct PriorBox : public PatternBase {
   PATTERN_DECL_NODE(prior_box_variances);
 };
 
+// Mul operator with persistable Y
+// operator: mul_op
+// inputs: mul_x, mul_y
+// outputs: mul_out
+struct Mul : public PatternBase {
+  Mul(PDPattern* pattern, const std::string& name_scope)
+      : PatternBase(pattern, name_scope, "mul") {}
+
+  PDNode* operator()();
+
+  PATTERN_DECL_NODE(mul_op);
+  PATTERN_DECL_NODE(mul_x);
+  PATTERN_DECL_NODE(mul_y);
+  PATTERN_DECL_NODE(mul_out);
+};
+
+// MatMul operator
+// operator: matmul_op
+// inputs: matmul_in_x, matmul_in_y
+// outputs: matmul_out
+struct MatMul : public PatternBase {
+  MatMul(PDPattern* pattern, const std::string& name_scope)
+      : PatternBase(pattern, name_scope, "matmul") {}
+
+  PDNode* operator()();
+
+  PATTERN_DECL_NODE(matmul_op);
+  PATTERN_DECL_NODE(matmul_in_x);
+  PATTERN_DECL_NODE(matmul_in_y);
+  PATTERN_DECL_NODE(matmul_out);
+};
+
 // Conv + ElementwiseAdd + an activation
 // This pattern can futher fuse the conv related ops after the conv+bn fusion.
 struct ConvElementwiseaddAct : public PatternBase {
@@ -0,0 +1,105 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/memory_optimize_pass/static_memory_planner.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static inline bool LifetimesOverlap(const StaticMemoryBlock& a,
+                                    const StaticMemoryBlock& b) {
+  return a.first_use <= b.last_use && b.first_use <= a.last_use;
+}
+
+StaticMemoryPlan PlanStaticMemory(const std::vector<StaticMemoryBlock>& blocks,
+                                  size_t alignment) {
+  PADDLE_ENFORCE(alignment > 0 && (alignment & (alignment - 1)) == 0,
+                 "The alignment must be a power of 2, but got %d", alignment);
+  StaticMemoryPlan plan;
+  size_t n = blocks.size();
+  plan.offsets.resize(n, 0);
+  if (n == 0) return plan;
+
+  std::vector<size_t> sizes(n);
+  size_t num_steps = 0;
+  for (size_t i = 0; i < n; ++i) {
+    PADDLE_ENFORCE_LE(blocks[i].first_use, blocks[i].last_use,
+                      "Block %d ends before it starts", i);
+    sizes[i] = (blocks[i].size + alignment - 1) & ~(alignment - 1);
+    plan.total_size += sizes[i];
+    num_steps = std::max(num_steps, blocks[i].last_use + 1);
+  }
+
+  // live_peak, by a sweep over the steps.
+  std::vector<int64_t> delta(num_steps + 1, 0);
+  for (size_t i = 0; i < n; ++i) {
+    delta[blocks[i].first_use] += static_cast<int64_t>(sizes[i]);
+    delta[blocks[i].last_use + 1] -= static_cast<int64_t>(sizes[i]);
+  }
+  int64_t live = 0;
+  for (size_t step = 0; step < num_steps; ++step) {
+    live += delta[step];
+    plan.live_peak = std::max(plan.live_peak, static_cast<size_t>(live));
+  }
+
+  std::vector<size_t> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    if (sizes[a] != sizes[b]) return sizes[a] > sizes[b];
+    return blocks[a].first_use < blocks[b].first_use;
+  });
+
+  std::vector<size_t> placed;
+  std::vector<size_t> neighbors;
+  placed.reserve(n);
+  for (size_t idx : order) {
+    neighbors.clear();
+    for (size_t j : placed) {
+      if (LifetimesOverlap(blocks[idx], blocks[j])) neighbors.push_back(j);
+    }
+    std::sort(neighbors.begin(), neighbors.end(), [&](size_t a, size_t b) {
+      return plan.offsets[a] < plan.offsets[b];
+    });
+
+    size_t best_offset = std::numeric_limits<size_t>::max();
+    size_t best_gap = std::numeric_limits<size_t>::max();
+    size_t prev_end = 0;
+    for (size_t j : neighbors) {
+      if (plan.offsets[j] > prev_end) {
+        size_t gap = plan.offsets[j] - prev_end;
+        if (gap >= sizes[idx] && gap < best_gap) {
+          best_offset = prev_end;
+          best_gap = gap;
+        }
+      }
+      prev_end = std::max(prev_end, plan.offsets[j] + sizes[j]);
+    }
+    if (best_offset == std::numeric_limits<size_t>::max()) {
+      best_offset = prev_end;
+    }
+    plan.offsets[idx] = best_offset;
+    plan.arena_size = std::max(plan.arena_size, best_offset + sizes[idx]);
+    placed.push_back(idx);
+  }
+  return plan;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,57 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+// A buffer that is live from step first_use to step last_use, inclusive.
+struct StaticMemoryBlock {
+  size_t size;
+  size_t first_use;
+  size_t last_use;
+};
+
+struct StaticMemoryPlan {
+  // The offset of each block in the arena.
+  std::vector<size_t> offsets;
+  // The size of the arena holding all blocks.
+  size_t arena_size{0};
+  // The largest total size of the blocks live at one step. An allocator that
+  // frees every block after its last use needs at least this much memory,
+  // before fragmentation.
+  size_t live_peak{0};
+  // The total size of all blocks, i.e. the memory needed without any reuse.
+  size_t total_size{0};
+};
+
+// Packs the blocks into one arena such that blocks with overlapping
+// lifetimes never overlap in memory. Offsets and sizes are rounded up to
+// alignment, which must be a power of 2.
+//
+// The offsets are assigned greedily by decreasing size, each block taking
+// the smallest gap that fits between the blocks already placed whose
+// lifetimes overlap with it. The result is usually within a few percent of
+// live_peak, which is a lower bound of arena_size.
+StaticMemoryPlan PlanStaticMemory(const std::vector<StaticMemoryBlock>& blocks,
+                                  size_t alignment);
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
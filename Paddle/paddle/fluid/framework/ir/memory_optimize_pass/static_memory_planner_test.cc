@@ -0,0 +1,82 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/memory_optimize_pass/static_memory_planner.h"
+#include <random>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static void CheckNoConflict(const std::vector<StaticMemoryBlock>& blocks,
+                            const StaticMemoryPlan& plan) {
+  ASSERT_EQ(plan.offsets.size(), blocks.size());
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    EXPECT_LE(plan.offsets[i] + blocks[i].size, plan.arena_size);
+    for (size_t j = i + 1; j < blocks.size(); ++j) {
+      bool live_together = blocks[i].first_use <= blocks[j].last_use &&
+                           blocks[j].first_use <= blocks[i].last_use;
+      bool disjoint = plan.offsets[i] + blocks[i].size <= plan.offsets[j] ||
+                      plan.offsets[j] + blocks[j].size <= plan.offsets[i];
+      EXPECT_TRUE(!live_together || disjoint) << "blocks " << i << " and "
+                                              << j << " overlap";
+    }
+  }
+  EXPECT_GE(plan.arena_size, plan.live_peak);
+  EXPECT_LE(plan.arena_size, plan.total_size);
+}
+
+TEST(StaticMemoryPlanner, Chain) {
+  // A chain of ops, each output only read by the next op, needs two live
+  // buffers at a time.
+  std::vector<StaticMemoryBlock> blocks;
+  for (size_t i = 0; i < 10; ++i) {
+    blocks.push_back({1024, i, i + 1});
+  }
+  auto plan = PlanStaticMemory(blocks, 64);
+  CheckNoConflict(blocks, plan);
+  EXPECT_EQ(plan.total_size, 10240UL);
+  EXPECT_EQ(plan.live_peak, 2048UL);
+  EXPECT_EQ(plan.arena_size, 2048UL);
+}
+
+TEST(StaticMemoryPlanner, Alignment) {
+  std::vector<StaticMemoryBlock> blocks = {{1, 0, 1}, {100, 1, 2}, {3, 0, 2}};
+  auto plan = PlanStaticMemory(blocks, 64);
+  CheckNoConflict(blocks, plan);
+  for (auto offset : plan.offsets) {
+    EXPECT_EQ(offset % 64, 0UL);
+  }
+  EXPECT_EQ(plan.live_peak, 64UL + 128UL + 64UL);
+}
+
+TEST(StaticMemoryPlanner, Random) {
+  std::mt19937 rng(0);
+  for (int round = 0; round < 20; ++round) {
+    std::vector<StaticMemoryBlock> blocks;
+    for (int i = 0; i < 200; ++i) {
+      size_t first_use = rng() % 100;
+      size_t last_use = first_use + rng() % 10;
+      blocks.push_back({(rng() % 4096) + 1, first_use, last_use});
+    }
+    auto plan = PlanStaticMemory(blocks, 32);
+    CheckNoConflict(blocks, plan);
+  }
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -351,6 +351,177 @@ void CPUQuantizePass::QuantizePriorBox(Graph* graph) const {
                   quantize_prior_box_count);
 }
 
+void CPUQuantizePass::QuantizeFc(Graph* graph) const {
+  GraphPatternDetector gpd;
+  auto pattern = gpd.mutable_pattern();
+  auto* fc_input = pattern->NewNode(name_scope_ + "/fc_input")
+                       ->AsInput()
+                       ->assert_is_op_input("fc", "Input");
+  patterns::FCMKLDNN fc_pattern{pattern, name_scope_};
+  fc_pattern(fc_input, true /* with bias */);
+
+  int quantize_fc_count = 0;
+  auto handler = [&](const GraphPatternDetector::subgraph_t& subgraph,
+                     Graph* g) {
+    VLOG(4) << "Quantize fc op";
+    GET_IR_NODE_FROM_SUBGRAPH(fc_op, fc, fc_pattern);
+    auto* fc_op_desc = fc_op->Op();
+
+    // skip if should not be quantized
+    if (!fc_op_desc->HasAttr("use_quantizer") ||
+        !boost::get<bool>(fc_op_desc->GetAttr("use_quantizer")))
+      return;
+
+    GET_IR_NODE_FROM_SUBGRAPH(weights, weights, fc_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(output, output, fc_pattern);
+    auto* input = subgraph.at(fc_input);
+
+    // get scales calculated after warmup, they scale variables to MAX=1.0
+    auto scales = Get<VarQuantScale>("quant_var_scales");
+
+    auto input_scale = scales[input->Name()].second.data<double>()[0];
+    bool is_input_unsigned = scales[input->Name()].first;
+    QuantizeInput(g, fc_op, input, "Input", input_scale, is_input_unsigned,
+                  "Scale_in");
+
+    auto weight_scale_tensor = scales[weights->Name()].second;
+    EigenVectorArrayMap eigen_tensor{weight_scale_tensor.data<double>(),
+                                     weight_scale_tensor.numel(), 1};
+    eigen_tensor *= static_cast<double>(S8_MAX);
+    std::vector<float> weight_scale{
+        weight_scale_tensor.data<double>(),
+        weight_scale_tensor.data<double>() + weight_scale_tensor.numel()};
+    fc_op_desc->SetAttr("Scale_weights", weight_scale);
+
+    // the int8 kernel outputs u8 only when relu is fused
+    bool is_output_unsigned =
+        fc_op_desc->GetAttrIfExists<std::string>("activation_type") == "relu";
+    auto output_scale = scales[output->Name()].second.data<double>()[0];
+    DequantizeOutput(g, fc_op, output, "Out", output_scale, is_output_unsigned,
+                     "Scale_out");
+
+    // the int8 kernel of fc is only implemented with MKL-DNN
+    fc_op_desc->SetAttr("use_mkldnn", true);
+
+    ++quantize_fc_count;
+  };
+
+  gpd(graph, handler);
+  AddStatis(quantize_fc_count);
+
+  PrettyLogDetail("---    quantized %d fc ops", quantize_fc_count);
+}
+
+void CPUQuantizePass::QuantizeMul(Graph* graph) const {
+  GraphPatternDetector gpd;
+  auto pattern = gpd.mutable_pattern();
+  patterns::Mul mul_pattern{pattern, name_scope_};
+  mul_pattern();
+
+  int quantize_mul_count = 0;
+  auto handler = [&](const GraphPatternDetector::subgraph_t& subgraph,
+                     Graph* g) {
+    VLOG(4) << "Quantize mul op";
+    GET_IR_NODE_FROM_SUBGRAPH(mul_op, mul_op, mul_pattern);
+    auto* mul_op_desc = mul_op->Op();
+
+    // skip if should not be quantized
+    if (!mul_op_desc->HasAttr("use_quantizer") ||
+        !boost::get<bool>(mul_op_desc->GetAttr("use_quantizer")))
+      return;
+
+    GET_IR_NODE_FROM_SUBGRAPH(mul_x, mul_x, mul_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(mul_y, mul_y, mul_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(mul_out, mul_out, mul_pattern);
+
+    // get scales calculated after warmup, they scale variables to MAX=1.0
+    auto scales = Get<VarQuantScale>("quant_var_scales");
+
+    auto x_scale = scales[mul_x->Name()].second.data<double>()[0];
+    bool is_x_unsigned = scales[mul_x->Name()].first;
+    QuantizeInput(g, mul_op, mul_x, "X", x_scale, is_x_unsigned, "scale_x");
+
+    // Y is quantized by the kernel, with a scale per output column
+    auto y_scale_tensor = scales[mul_y->Name()].second;
+    EigenVectorArrayMap eigen_tensor{y_scale_tensor.data<double>(),
+                                     y_scale_tensor.numel(), 1};
+    eigen_tensor *= static_cast<double>(S8_MAX);
+    std::vector<float> y_scale{
+        y_scale_tensor.data<double>(),
+        y_scale_tensor.data<double>() + y_scale_tensor.numel()};
+    mul_op_desc->SetAttr("scale_y", y_scale);
+
+    // the int8 kernel of mul always outputs s8
+    auto output_scale = scales[mul_out->Name()].second.data<double>()[0];
+    DequantizeOutput(g, mul_op, mul_out, "Out", output_scale, false,
+                     "scale_out");
+
+    mul_op_desc->SetAttr("use_mkldnn", true);
+
+    ++quantize_mul_count;
+  };
+
+  gpd(graph, handler);
+  AddStatis(quantize_mul_count);
+
+  PrettyLogDetail("---    quantized %d mul ops", quantize_mul_count);
+}
+
+void CPUQuantizePass::QuantizeMatmul(Graph* graph) const {
+  GraphPatternDetector gpd;
+  auto pattern = gpd.mutable_pattern();
+  patterns::MatMul matmul_pattern{pattern, name_scope_};
+  matmul_pattern();
+
+  int quantize_matmul_count = 0;
+  auto handler = [&](const GraphPatternDetector::subgraph_t& subgraph,
+                     Graph* g) {
+    VLOG(4) << "Quantize matmul op";
+    GET_IR_NODE_FROM_SUBGRAPH(matmul_op, matmul_op, matmul_pattern);
+    auto* matmul_op_desc = matmul_op->Op();
+
+    // skip if should not be quantized
+    if (!matmul_op_desc->HasAttr("use_quantizer") ||
+        !boost::get<bool>(matmul_op_desc->GetAttr("use_quantizer")))
+      return;
+    // the int8 kernel does not split the heads of the MKLML matmul
+    if (matmul_op_desc->HasAttr("head_number") &&
+        boost::get<int>(matmul_op_desc->GetAttr("head_number")) > 1)
+      return;
+
+    GET_IR_NODE_FROM_SUBGRAPH(matmul_in_x, matmul_in_x, matmul_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(matmul_in_y, matmul_in_y, matmul_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(matmul_out, matmul_out, matmul_pattern);
+
+    // get scales calculated after warmup, they scale variables to MAX=1.0
+    auto scales = Get<VarQuantScale>("quant_var_scales");
+
+    auto x_scale = scales[matmul_in_x->Name()].second.data<double>()[0];
+    bool is_x_unsigned = scales[matmul_in_x->Name()].first;
+    QuantizeInput(g, matmul_op, matmul_in_x, "X", x_scale, is_x_unsigned,
+                  "Scale_x");
+
+    // Y is the weights of the inner products of the kernel, so it is
+    // always quantized to s8
+    auto y_scale = scales[matmul_in_y->Name()].second.data<double>()[0];
+    QuantizeInput(g, matmul_op, matmul_in_y, "Y", y_scale, false, "Scale_y");
+
+    // the int8 kernel of matmul always outputs s8
+    auto output_scale = scales[matmul_out->Name()].second.data<double>()[0];
+    DequantizeOutput(g, matmul_op, matmul_out, "Out", output_scale, false,
+                     "Scale_out");
+
+    matmul_op_desc->SetAttr("use_mkldnn", true);
+
+    ++quantize_matmul_count;
+  };
+
+  gpd(graph, handler);
+  AddStatis(quantize_matmul_count);
+
+  PrettyLogDetail("---    quantized %d matmul ops", quantize_matmul_count);
+}
+
 void CPUQuantizePass::ApplyImpl(ir::Graph* graph) const {
   VLOG(3) << "Quantizing the graph.";
   PADDLE_ENFORCE(graph);
@@ -363,6 +534,9 @@ void CPUQuantizePass::ApplyImpl(ir::Graph* graph) const {
   QuantizePool(graph);
   QuantizeConcat(graph);
   QuantizePriorBox(graph);
+  QuantizeFc(graph);
+  QuantizeMul(graph);
+  QuantizeMatmul(graph);
 }
 
 }  // namespace ir
@@ -52,6 +52,12 @@ class CPUQuantizePass : public FusePassBase {
 
   void QuantizePriorBox(Graph* graph) const;
 
+  void QuantizeFc(Graph* graph) const;
+
+  void QuantizeMul(Graph* graph) const;
+
+  void QuantizeMatmul(Graph* graph) const;
+
   void QuantizeInput(Graph* g, Node* op, Node* input, std::string input_name,
                      double scale_to_one, bool is_unsigned,
                      std::string scale_attr_name = "") const;
@@ -60,6 +60,12 @@ void SetOp(ProgramDesc* prog, const std::string& type, const std::string& name,
     if (inputs.size() > 1) op->SetInput("W", {inputs[1]});
     if (inputs.size() > 2) op->SetInput("Bias", {inputs[2]});
     op->SetOutput("Out", {outputs[0]});
+    op->SetAttr("use_quantizer", use_quantizer);
+  } else if (type == "mul" || type == "matmul") {
+    op->SetInput("X", {inputs[0]});
+    op->SetInput("Y", {inputs[1]});
+    op->SetOutput("Out", {outputs[0]});
+    op->SetAttr("use_quantizer", use_quantizer);
   } else if (type == "concat") {
     op->SetInput("X", inputs);
     op->SetOutput("Out", outputs);
@@ -303,6 +309,105 @@ TEST(CpuQuantizePass, concat) {
 
 }  // namespace
 
+namespace {
+static const std::initializer_list<std::string> variable_names_fc_mul_matmul =
+    {"a", "w1", "b1", "c", "w2", "d", "e", "f"};
+
+// (a,w1,b1)->Fc1->c
+// (c,w2)->Mul1->d
+// (d,e)->Matmul1->f
+ProgramDesc BuildProgramDescFcMulMatmul() {
+  ProgramDesc prog;
+  for (auto& v : variable_names_fc_mul_matmul) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    if (v.find("w") == 0 || v.find("b") == 0) {
+      var->SetPersistable(true);
+    }
+  }
+
+  SetOp(&prog, "fc", "Fc1", {"a", "w1", "b1"}, {"c"}, false, true);
+  SetOp(&prog, "mul", "Mul1", {"c", "w2"}, {"d"}, false, true);
+  SetOp(&prog, "matmul", "Matmul1", {"d", "e"}, {"f"}, false, true);
+
+  return prog;
+}
+
+TEST(CpuQuantizePass, fc_mul_matmul) {
+  auto prog = BuildProgramDescFcMulMatmul();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+
+  // Init scope, as it is used in pass
+  auto place = paddle::platform::CPUPlace();
+  NaiveExecutor exe{place};
+  Scope scope;
+  exe.CreateVariables(prog, 0, true, &scope);
+
+  auto* scales = new VarQuantScale();
+
+  for (auto& v : variable_names_fc_mul_matmul) {
+    InitTensorHolder(&scope, place, v.c_str());
+    LoDTensor tensor;
+    tensor.Resize({1});
+    auto* ptr = tensor.mutable_data<double>(place);
+    ptr[0] = 2.0;
+
+    (*scales)[v] = std::make_pair(false, std::move(tensor));
+  }
+
+  graph->SetNotOwned(kParamScopeAttr, &scope);
+
+  auto pass = PassRegistry::Instance().Get("cpu_quantize_pass");
+  pass->Set("quant_var_scales", scales);
+
+  int original_nodes_num = graph->Nodes().size();
+
+  graph.reset(pass->Apply(graph.release()));
+
+  int current_nodes_num = graph->Nodes().size();
+
+  // a->QUANT1->IN1, Fc1->OUT1->DEQUANT1->c
+  // c->QUANT2->IN2, Mul1->OUT2->DEQUANT2->d
+  // d->QUANT3->IN3, e->QUANT4->IN4, Matmul1->OUT3->DEQUANT3->f
+  // Insert nodes: 4 Quant + 4 IN + 3 OUT + 3 DEQUANT
+  int added_nodes_count = 4 + 4 + 3 + 3;
+  float scale = 2.0f * 127;
+
+  int quantize_nodes_count = 0;
+  int dequantize_nodes_count = 0;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    auto* op = node->Op();
+    if (op->Type() == "fc") {
+      EXPECT_EQ(boost::get<float>(op->GetAttr("Scale_in")), scale);
+      EXPECT_EQ(
+          boost::get<std::vector<float>>(op->GetAttr("Scale_weights"))[0],
+          scale);
+      EXPECT_EQ(boost::get<float>(op->GetAttr("Scale_out")), scale);
+      EXPECT_TRUE(boost::get<bool>(op->GetAttr("use_mkldnn")));
+    } else if (op->Type() == "mul") {
+      EXPECT_EQ(boost::get<float>(op->GetAttr("scale_x")), scale);
+      EXPECT_EQ(boost::get<std::vector<float>>(op->GetAttr("scale_y"))[0],
+                scale);
+      EXPECT_EQ(boost::get<float>(op->GetAttr("scale_out")), scale);
+      EXPECT_TRUE(boost::get<bool>(op->GetAttr("use_mkldnn")));
+    } else if (op->Type() == "matmul") {
+      EXPECT_EQ(boost::get<float>(op->GetAttr("Scale_x")), scale);
+      EXPECT_EQ(boost::get<float>(op->GetAttr("Scale_y")), scale);
+      EXPECT_EQ(boost::get<float>(op->GetAttr("Scale_out")), scale);
+      EXPECT_TRUE(boost::get<bool>(op->GetAttr("use_mkldnn")));
+    } else if (op->Type() == "quantize") {
+      quantize_nodes_count++;
+    } else if (op->Type() == "dequantize") {
+      dequantize_nodes_count++;
+    }
+  }
+  EXPECT_EQ(quantize_nodes_count, 4);
+  EXPECT_EQ(dequantize_nodes_count, 3);
+  EXPECT_EQ(original_nodes_num + added_nodes_count, current_nodes_num);
+}
+
+}  // namespace
+
 }  // namespace ir
 }  // namespace framework
 }  // namespace paddle
@@ -195,6 +195,37 @@ void CPUQuantizeSquashPass::ConvDequantSquash(Graph* graph) const {
                   found_conv_dequant_squash_count);
 }
 
+void CPUQuantizeSquashPass::OpDequantSquash(Graph* graph) const {
+  GraphPatternDetector gpd;
+  patterns::OpDequant op_dequant_pattern{gpd.mutable_pattern(), "op_dequant"};
+  op_dequant_pattern({"fc", "mul", "matmul"});
+
+  int found_op_dequant_squash_count = 0;
+  auto handler = [&](const GraphPatternDetector::subgraph_t& subgraph,
+                     Graph* g) {
+    VLOG(4) << "squash op-dequant ops pair";
+
+    GET_IR_NODE_FROM_SUBGRAPH(any_op, any_op, op_dequant_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(any_op_out, any_op_out, op_dequant_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(dequant_op, dequant_op, op_dequant_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(dequant_out, dequant_out, op_dequant_pattern);
+
+    // if the op has one output
+    if (any_op_out->outputs.size() == 1) {
+      any_op->Op()->SetAttr("force_fp32_output", true);
+      any_op->Op()->SetOutput("Out",
+                              std::vector<std::string>({dequant_out->Name()}));
+      IR_NODE_LINK_TO(any_op, dequant_out);
+      GraphSafeRemoveNodes(graph, {any_op_out, dequant_op});
+      found_op_dequant_squash_count++;
+    }
+  };
+  gpd(graph, handler);
+  AddStatis(found_op_dequant_squash_count);
+  PrettyLogDetail("---    squashed %d dequant with fc, mul or matmul",
+                  found_op_dequant_squash_count);
+}
+
 void CPUQuantizeSquashPass::ApplyImpl(ir::Graph* graph) const {
   PADDLE_ENFORCE(graph);
   FusePassBase::Init("cpu_quantize_squash_pass", graph);
@@ -203,6 +234,7 @@ void CPUQuantizeSquashPass::ApplyImpl(ir::Graph* graph) const {
   FindNodesToKeep(graph, &nodes_keep_counter);
   DequantQuantSquash(graph, &nodes_keep_counter);
   ConvDequantSquash(graph);
+  OpDequantSquash(graph);
 }
 
 }  // namespace ir
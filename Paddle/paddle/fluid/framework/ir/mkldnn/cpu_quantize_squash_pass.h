@@ -60,6 +60,12 @@ class CPUQuantizeSquashPass : public FusePassBase {
   */
   void ConvDequantSquash(Graph* graph) const;
 
+  /*
+   * Squash fc, mul or matmul with dequant when dequant is the only op after
+   * them
+   */
+  void OpDequantSquash(Graph* graph) const;
+
   const std::string name_scope_{"squash"};
 };
 
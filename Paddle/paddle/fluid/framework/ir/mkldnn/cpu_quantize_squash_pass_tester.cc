@@ -50,6 +50,17 @@ void SetOp(ProgramDesc* prog, const std::string& type, const std::string& name,
   } else if (type == "concat") {
     op->SetInput("X", inputs);
     op->SetOutput("Out", outputs);
+  } else if (type == "fc") {
+    op->SetInput("Input", {inputs[0]});
+    op->SetOutput("Out", {outputs[0]});
+    op->SetAttr("Scale_out", scale);
+    op->SetAttr("force_fp32_output", false);
+  } else if (type == "matmul") {
+    op->SetInput("X", {inputs[0]});
+    if (inputs.size() > 1) op->SetInput("Y", {inputs[1]});
+    op->SetOutput("Out", {outputs[0]});
+    op->SetAttr("Scale_out", scale);
+    op->SetAttr("force_fp32_output", false);
   }
 }
 
@@ -191,6 +202,23 @@ ProgramDesc BuildConvDequantConvProgramDesc(bool use_mkldnn, float scale_out,
   return prog;
 }
 
+// a->Fc1->b
+// b->Dequant1(Scale)->c
+// (c,d)->Matmul1->e
+// e->Dequant2(Scale)->f
+ProgramDesc BuildFcMatmulDequantProgramDesc(bool use_mkldnn, float scale_out,
+                                            float scale) {
+  ProgramDesc prog;
+  for (auto& v : variable_names) {
+    prog.MutableBlock(0)->Var(v);
+  }
+  SetOp(&prog, "fc", "Fc1", {"a"}, {"b"}, use_mkldnn, scale_out);
+  SetOp(&prog, "dequantize", "Dequant1", {"b"}, {"c"}, use_mkldnn, scale);
+  SetOp(&prog, "matmul", "Matmul1", {"c", "d"}, {"e"}, use_mkldnn, scale_out);
+  SetOp(&prog, "dequantize", "Dequant2", {"e"}, {"f"}, use_mkldnn, scale);
+  return prog;
+}
+
 void InitTensorHolder(Scope* scope, const paddle::platform::Place& place,
                       const char* var_name) {
   auto x = scope->Var(var_name);
@@ -374,6 +402,29 @@ TEST(CpuQuantizeSquashPass, conv_dequant_more_than_one_op_after_conv) {
                 remove_nodes);
 }
 
+// a->Fc1->c
+// (c,d)->Matmul1->f
+TEST(CpuQuantizeSquashPass, fc_and_matmul_dequant_force_fp32_output) {
+  auto scale_out = 1.0f;
+  auto scale = 1.2345f;
+  auto use_mkldnn = true;
+  // remove 4 nodes: b, Dequant1, e, Dequant2
+  auto remove_nodes = 4;
+  CountNodeTest(BuildFcMatmulDequantProgramDesc(use_mkldnn, scale_out, scale),
+                remove_nodes);
+
+  auto prog = BuildFcMatmulDequantProgramDesc(use_mkldnn, scale_out, scale);
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  PrepareGraph(&graph, prog);
+  RegisterPass(&graph);
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() &&
+        (node->Op()->Type() == "fc" || node->Op()->Type() == "matmul")) {
+      EXPECT_TRUE(boost::get<bool>(node->Op()->GetAttr("force_fp32_output")));
+    }
+  }
+}
+
 }  // namespace ir
 }  // namespace framework
 }  // namespace paddle
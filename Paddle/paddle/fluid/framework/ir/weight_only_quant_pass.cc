@@ -0,0 +1,267 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/weight_only_quant_pass.h"
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/operators/math/weight_only_fc.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+Node* FindInput(Node* op, const std::string& name) {
+  for (auto* in : op->inputs) {
+    if (in->Name() == name) return in;
+  }
+  return nullptr;
+}
+
+Node* FindOutput(Node* op, const std::string& name) {
+  for (auto* out : op->outputs) {
+    if (out->Name() == name) return out;
+  }
+  return nullptr;
+}
+
+// The argument names and attributes of an op replaced by weight_only_fc
+struct FCArgs {
+  std::string x;
+  std::string w;
+  std::string bias;
+  std::string out;
+  int in_num_col_dims{1};
+  std::string activation_type;
+  bool trans_w{false};
+  float alpha{1.0f};
+};
+
+bool GetFCArgs(const OpDesc& op, FCArgs* args) {
+  auto type = op.Type();
+  if (op.GetAttrIfExists<bool>("use_quantizer")) return false;
+  if (type == "fc") {
+    args->x = op.Input("Input")[0];
+    args->w = op.Input("W")[0];
+    if (!op.Input("Bias").empty()) args->bias = op.Input("Bias")[0];
+    args->out = op.Output("Out")[0];
+    args->in_num_col_dims = boost::get<int>(op.GetAttr("in_num_col_dims"));
+    args->activation_type =
+        op.GetAttrIfExists<std::string>("activation_type");
+    return true;
+  }
+  if (type == "mul") {
+    if (op.HasAttr("y_num_col_dims") &&
+        boost::get<int>(op.GetAttr("y_num_col_dims")) != 1) {
+      return false;
+    }
+    args->x = op.Input("X")[0];
+    args->w = op.Input("Y")[0];
+    args->out = op.Output("Out")[0];
+    if (op.HasAttr("x_num_col_dims")) {
+      args->in_num_col_dims = boost::get<int>(op.GetAttr("x_num_col_dims"));
+    }
+    return true;
+  }
+  if (type == "matmul") {
+    if (op.GetAttrIfExists<bool>("transpose_X") ||
+        op.GetAttrIfExists<int>("head_number") > 1) {
+      return false;
+    }
+    args->x = op.Input("X")[0];
+    args->w = op.Input("Y")[0];
+    args->out = op.Output("Out")[0];
+    // a transposed weight, e.g. the tied embedding of the output layer, is
+    // already (N, K)
+    args->trans_w = op.GetAttrIfExists<bool>("transpose_Y");
+    if (op.HasAttr("alpha")) {
+      args->alpha = boost::get<float>(op.GetAttr("alpha"));
+    }
+    return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+bool WeightOnlyQuantPass::QuantizeOp(
+    Graph* graph, Node* op, const std::string& weight_type, int group_size,
+    std::unordered_map<std::string, PackedWeight>* packed) const {
+  FCArgs args;
+  if (!GetFCArgs(*op->Op(), &args)) return false;
+  auto* x_node = FindInput(op, args.x);
+  auto* w_node = FindInput(op, args.w);
+  auto* out_node = FindOutput(op, args.out);
+  if (x_node == nullptr || w_node == nullptr || out_node == nullptr ||
+      x_node->Var() == nullptr || w_node->Var() == nullptr ||
+      !w_node->Var()->Persistable()) {
+    return false;
+  }
+  auto* w_var = param_scope()->FindVar(args.w);
+  if (w_var == nullptr || !w_var->IsType<LoDTensor>()) return false;
+  auto& w = w_var->Get<LoDTensor>();
+  if (!w.IsInitialized() || w.type() != proto::VarType::FP32 ||
+      w.dims().size() != 2) {
+    return false;
+  }
+  if (op->Op()->Type() == "matmul") {
+    // matmul multiplies the last dim of a 2-D or higher X by the weight
+    auto x_rank = x_node->Var()->GetShape().size();
+    if (x_rank < 2) return false;
+    args.in_num_col_dims = static_cast<int>(x_rank) - 1;
+  }
+  const int K = args.trans_w ? w.dims()[1] : w.dims()[0];
+  const int N = args.trans_w ? w.dims()[0] : w.dims()[1];
+  const bool is_int8 = weight_type == "int8";
+  const int groups = (K + group_size - 1) / group_size;
+
+  // A weight read by several ops, e.g. the tied embedding, is packed once
+  // per layout it is read in: a matmul with transpose_Y and a mul reading
+  // the same weight need different packed weights.
+  const std::string key =
+      args.w + (args.trans_w ? "@weight_only_trans" : "@weight_only");
+  auto it = packed->find(key);
+  if (it == packed->end()) {
+    PackedWeight names;
+    names.source = args.w;
+    names.weight = key;
+    auto* packed_w =
+        param_scope()->Var(names.weight)->GetMutable<LoDTensor>();
+    packed_w->Resize({N, K});
+    if (is_int8) {
+      names.scales = key + "_scales";
+      auto* scales =
+          param_scope()->Var(names.scales)->GetMutable<LoDTensor>();
+      scales->Resize({N, groups});
+      operators::math::PackWeightInt8(
+          w.data<float>(), K, N, args.trans_w, group_size,
+          packed_w->mutable_data<int8_t>(platform::CPUPlace()),
+          scales->mutable_data<float>(platform::CPUPlace()));
+    } else {
+      operators::math::PackWeightBF16(
+          w.data<float>(), K, N, args.trans_w,
+          reinterpret_cast<uint16_t*>(
+              packed_w->mutable_data<int16_t>(platform::CPUPlace())));
+    }
+    it = packed->emplace(key, names).first;
+  }
+
+  VarDesc packed_w_desc(it->second.weight);
+  packed_w_desc.SetPersistable(true);
+  packed_w_desc.SetDataType(is_int8 ? proto::VarType::INT8
+                                    : proto::VarType::INT16);
+  packed_w_desc.SetShape({N, K});
+  auto* packed_w_node = graph->CreateVarNode(&packed_w_desc);
+
+  OpDesc desc;
+  desc.SetType("weight_only_fc");
+  desc.SetInput("Input", {args.x});
+  desc.SetInput("W", {it->second.weight});
+  desc.SetOutput("Out", {args.out});
+  desc.SetAttr("in_num_col_dims", args.in_num_col_dims);
+  desc.SetAttr("activation_type", args.activation_type);
+  desc.SetAttr("weight_type", weight_type);
+  desc.SetAttr("group_size", group_size);
+  desc.SetAttr("alpha", args.alpha);
+  Node* scales_node = nullptr;
+  if (is_int8) {
+    VarDesc scales_desc(it->second.scales);
+    scales_desc.SetPersistable(true);
+    scales_desc.SetDataType(proto::VarType::FP32);
+    scales_desc.SetShape({N, groups});
+    scales_node = graph->CreateVarNode(&scales_desc);
+    desc.SetInput("Scales", {it->second.scales});
+  }
+  Node* bias_node = nullptr;
+  if (!args.bias.empty()) {
+    bias_node = FindInput(op, args.bias);
+    PADDLE_ENFORCE_NOT_NULL(bias_node, "The bias %s of %s is not found.",
+                            args.bias, op->Op()->Type());
+    desc.SetInput("Bias", {args.bias});
+  }
+  auto* new_op = graph->CreateOpNode(&desc);
+
+  IR_NODE_LINK_TO(x_node, new_op);
+  IR_NODE_LINK_TO(packed_w_node, new_op);
+  if (scales_node) {
+    IR_NODE_LINK_TO(scales_node, new_op);
+  }
+  if (bias_node) {
+    IR_NODE_LINK_TO(bias_node, new_op);
+  }
+  IR_NODE_LINK_TO(new_op, out_node);
+  GraphSafeRemoveNodes(graph, {op});
+  return true;
+}
+
+void WeightOnlyQuantPass::ApplyImpl(ir::Graph* graph) const {
+  PADDLE_ENFORCE_NOT_NULL(graph);
+  FusePassBase::Init(name_scope_, graph);
+  PADDLE_ENFORCE_NOT_NULL(param_scope(),
+                          "The param scope should not be null.");
+
+  std::string weight_type =
+      Has("weight_type") ? Get<std::string>("weight_type") : "int8";
+  int group_size = Has("group_size") ? Get<int>("group_size") : 64;
+  PADDLE_ENFORCE(weight_type == "bf16" || weight_type == "int8",
+                 "The weight_type should be bf16 or int8, but got %s.",
+                 weight_type);
+  PADDLE_ENFORCE_GT(group_size, 0, "The group_size should be positive.");
+
+  std::vector<Node*> ops;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op() != nullptr) ops.push_back(node);
+  }
+  std::unordered_map<std::string, PackedWeight> packed;
+  int count = 0;
+  for (auto* op : ops) {
+    if (QuantizeOp(graph, op, weight_type, group_size, &packed)) ++count;
+  }
+
+  // The fp32 weights no op reads any more are removed, which is where the
+  // memory is saved.
+  std::unordered_set<std::string> sources;
+  for (auto& pair : packed) sources.insert(pair.second.source);
+  std::unordered_set<const Node*> nodes_to_remove;
+  std::vector<std::string> vars_to_erase;
+  std::unordered_set<std::string> still_read;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && sources.count(node->Name()) &&
+        !node->outputs.empty()) {
+      still_read.insert(node->Name());
+    }
+  }
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && sources.count(node->Name()) &&
+        !still_read.count(node->Name())) {
+      nodes_to_remove.insert(node);
+    }
+  }
+  for (auto& source : sources) {
+    if (!still_read.count(source)) vars_to_erase.push_back(source);
+  }
+  GraphSafeRemoveNodes(graph, nodes_to_remove);
+  param_scope()->EraseVars(vars_to_erase);
+  AddStatis(count);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(weight_only_quant_pass,
+              paddle::framework::ir::WeightOnlyQuantPass);
@@ -0,0 +1,63 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Replaces the fc, mul and matmul ops multiplying by a persistable 2-D
+ * weight with weight_only_fc ops, which keep the weight in bf16 or in
+ * per-group int8 and dequantize it in the GEMM kernel. The packed weight,
+ * and the scales of the int8 weight, are new persistable variables in the
+ * param scope, and the fp32 weight is erased once no op reads it.
+ *
+ * Attrs:
+ *   weight_type: "bf16" or "int8", default "int8".
+ *   group_size: the int8 weights of a row sharing a scale, default 64.
+ */
+class WeightOnlyQuantPass : public FusePassBase {
+ public:
+  virtual ~WeightOnlyQuantPass() {}
+
+ protected:
+  void ApplyImpl(ir::Graph* graph) const override;
+
+ private:
+  // The packed weight of a source weight read with or without transpose,
+  // keyed by the source weight name suffixed with the layout.
+  struct PackedWeight {
+    std::string source;
+    std::string weight;
+    std::string scales;
+  };
+
+  // Returns whether the op is replaced.
+  bool QuantizeOp(Graph* graph, Node* op, const std::string& weight_type,
+                  int group_size,
+                  std::unordered_map<std::string, PackedWeight>* packed) const;
+
+  const std::string name_scope_{"weight_only_quant"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
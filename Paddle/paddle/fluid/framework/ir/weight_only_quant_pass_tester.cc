@@ -0,0 +1,220 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/weight_only_quant_pass.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstring>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static void InitWeight(Scope* scope, const std::string& name,
+                       const std::vector<int64_t>& shape) {
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  tensor->Resize(make_ddim(shape));
+  float* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = std::sin(static_cast<float>(i));
+  }
+}
+
+static float BF16ToFloat(int16_t x) {
+  uint32_t bits = static_cast<uint32_t>(static_cast<uint16_t>(x)) << 16;
+  float res;
+  std::memcpy(&res, &bits, sizeof(res));
+  return res;
+}
+
+// x -> fc(w0, bias) -> mul(w1) -> matmul(emb^T) -> out, and emb is also
+// read by lookup_table, so it is kept.
+static std::unique_ptr<Graph> BuildGraph(Scope* scope) {
+  Layers layers;
+  auto* x = layers.data("x", {2, 16});
+  auto* w0 = layers.data("w0", {16, 32}, true);
+  auto* bias = layers.data("bias", {32}, true);
+  auto* w1 = layers.data("w1", {32, 24}, true);
+  auto* emb = layers.data("emb", {10, 24}, true);
+  auto* ids = layers.data("ids", {2, 1});
+  auto* fc_out = layers.fc(x, w0, bias);
+  auto* mul_out = layers.mul(fc_out, w1);
+  layers.matmul(mul_out, emb);
+
+  ProgramDesc program(layers.main_program());
+  auto* block = program.MutableBlock(0);
+  // matmul needs the rank of X
+  block->Var(mul_out->Name())->SetShape({2, 24});
+  auto* matmul = block->AllOps().back();
+  matmul->SetAttr("transpose_X", false);
+  matmul->SetAttr("transpose_Y", true);
+  matmul->SetAttr("alpha", 0.5f);
+  auto* lookup = block->AppendOp();
+  lookup->SetType("lookup_table");
+  lookup->SetInput("W", {emb->Name()});
+  lookup->SetInput("Ids", {ids->Name()});
+  lookup->SetOutput("Out", {block->Var("emb_out")->Name()});
+
+  InitWeight(scope, "w0", {16, 32});
+  InitWeight(scope, "bias", {32});
+  InitWeight(scope, "w1", {32, 24});
+  InitWeight(scope, "emb", {10, 24});
+
+  std::unique_ptr<Graph> graph(new Graph(program));
+  graph->SetNotOwned(kParamScopeAttr, scope);
+  return graph;
+}
+
+static Node* FindOpNode(const std::unique_ptr<Graph>& graph,
+                        const std::string& type, const std::string& input) {
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == type &&
+        node->Op()->Input("Input")[0] == input) {
+      return node;
+    }
+  }
+  return nullptr;
+}
+
+TEST(WeightOnlyQuantPass, int8) {
+  Scope scope;
+  auto graph = BuildGraph(&scope);
+  auto pass = PassRegistry::Instance().Get("weight_only_quant_pass");
+  pass->Set("weight_type", new std::string("int8"));
+  pass->Set("group_size", new int(8));
+  graph.reset(pass->Apply(graph.release()));
+  VLOG(3) << DebugString(graph);
+
+  EXPECT_EQ(GetNumOpNodes(graph, "fc"), 0);
+  EXPECT_EQ(GetNumOpNodes(graph, "mul"), 0);
+  EXPECT_EQ(GetNumOpNodes(graph, "matmul"), 0);
+  EXPECT_EQ(GetNumOpNodes(graph, "weight_only_fc"), 3);
+
+  // the fp32 weights only read by the replaced ops are erased
+  EXPECT_EQ(scope.FindVar("w0"), nullptr);
+  EXPECT_EQ(scope.FindVar("w1"), nullptr);
+  EXPECT_NE(scope.FindVar("emb"), nullptr);
+  EXPECT_NE(scope.FindVar("bias"), nullptr);
+
+  // w1 is (32, 24), so the packed weight is (24, 32) with 4 groups a row
+  auto& packed = scope.FindVar("w1@weight_only")->Get<LoDTensor>();
+  auto& scales = scope.FindVar("w1@weight_only_scales")->Get<LoDTensor>();
+  ASSERT_EQ(packed.dims(), make_ddim({24, 32}));
+  ASSERT_EQ(scales.dims(), make_ddim({24, 4}));
+  for (int n = 0; n < 24; ++n) {
+    for (int k = 0; k < 32; ++k) {
+      float scale = scales.data<float>()[n * 4 + k / 8];
+      float w = packed.data<int8_t>()[n * 32 + k] * scale;
+      EXPECT_NEAR(w, std::sin(static_cast<float>(k * 24 + n)),
+                  scale / 2 + 1e-6);
+    }
+  }
+
+  auto* matmul = FindOpNode(graph, "weight_only_fc", "tmp_1");
+  ASSERT_NE(matmul, nullptr);
+  EXPECT_EQ(matmul->Op()->Input("W")[0], "emb@weight_only_trans");
+  EXPECT_EQ(boost::get<int>(matmul->Op()->GetAttr("in_num_col_dims")), 1);
+  EXPECT_FLOAT_EQ(boost::get<float>(matmul->Op()->GetAttr("alpha")), 0.5f);
+  // emb is transposed by matmul, so it is packed as it is
+  auto& packed_emb =
+      scope.FindVar("emb@weight_only_trans")->Get<LoDTensor>();
+  ASSERT_EQ(packed_emb.dims(), make_ddim({10, 24}));
+
+  auto* fc = FindOpNode(graph, "weight_only_fc", "x");
+  ASSERT_NE(fc, nullptr);
+  EXPECT_EQ(fc->Op()->Input("Bias")[0], "bias");
+}
+
+TEST(WeightOnlyQuantPass, bf16) {
+  Scope scope;
+  auto graph = BuildGraph(&scope);
+  auto pass = PassRegistry::Instance().Get("weight_only_quant_pass");
+  pass->Set("weight_type", new std::string("bf16"));
+  pass->Set("group_size", new int(64));
+  graph.reset(pass->Apply(graph.release()));
+
+  EXPECT_EQ(GetNumOpNodes(graph, "weight_only_fc"), 3);
+  EXPECT_EQ(scope.FindVar("w0@weight_only_scales"), nullptr);
+  auto& packed = scope.FindVar("w0@weight_only")->Get<LoDTensor>();
+  ASSERT_EQ(packed.type(), proto::VarType::INT16);
+  ASSERT_EQ(packed.dims(), make_ddim({32, 16}));
+  for (int n = 0; n < 32; ++n) {
+    for (int k = 0; k < 16; ++k) {
+      float w = std::sin(static_cast<float>(k * 32 + n));
+      EXPECT_NEAR(BF16ToFloat(packed.data<int16_t>()[n * 16 + k]), w,
+                  std::fabs(w) / 256 + 1e-6);
+    }
+  }
+}
+
+TEST(WeightOnlyQuantPass, tied_weight_layouts) {
+  // emb is read by matmul with transpose_Y and by mul, which need it packed
+  // in different layouts.
+  Layers layers;
+  auto* x = layers.data("x", {2, 24});
+  auto* emb = layers.data("emb", {10, 24}, true);
+  auto* logits = layers.matmul(x, emb);
+  layers.mul(logits, emb);
+
+  ProgramDesc program(layers.main_program());
+  auto* block = program.MutableBlock(0);
+  block->Var(logits->Name())->SetShape({2, 10});
+  for (auto* op : block->AllOps()) {
+    if (op->Type() == "matmul") {
+      op->SetAttr("transpose_X", false);
+      op->SetAttr("transpose_Y", true);
+    }
+  }
+  Scope scope;
+  InitWeight(&scope, "emb", {10, 24});
+  std::unique_ptr<Graph> graph(new Graph(program));
+  graph->SetNotOwned(kParamScopeAttr, &scope);
+
+  auto pass = PassRegistry::Instance().Get("weight_only_quant_pass");
+  pass->Set("weight_type", new std::string("bf16"));
+  pass->Set("group_size", new int(64));
+  graph.reset(pass->Apply(graph.release()));
+
+  EXPECT_EQ(GetNumOpNodes(graph, "weight_only_fc"), 2);
+  EXPECT_EQ(scope.FindVar("emb"), nullptr);
+  auto* matmul = FindOpNode(graph, "weight_only_fc", "x");
+  auto* mul = FindOpNode(graph, "weight_only_fc", logits->Name());
+  ASSERT_NE(matmul, nullptr);
+  ASSERT_NE(mul, nullptr);
+  EXPECT_EQ(matmul->Op()->Input("W")[0], "emb@weight_only_trans");
+  EXPECT_EQ(mul->Op()->Input("W")[0], "emb@weight_only");
+
+  // Both are (N, K): emb as it is for matmul, emb^T for mul.
+  auto& trans = scope.FindVar("emb@weight_only_trans")->Get<LoDTensor>();
+  auto& plain = scope.FindVar("emb@weight_only")->Get<LoDTensor>();
+  ASSERT_EQ(trans.dims(), make_ddim({10, 24}));
+  ASSERT_EQ(plain.dims(), make_ddim({24, 10}));
+  for (int n = 0; n < 24; ++n) {
+    for (int k = 0; k < 10; ++k) {
+      float w = std::sin(static_cast<float>(k * 24 + n));
+      EXPECT_NEAR(BF16ToFloat(plain.data<int16_t>()[n * 10 + k]), w,
+                  std::fabs(w) / 256 + 1e-6);
+      EXPECT_NEAR(BF16ToFloat(trans.data<int16_t>()[k * 24 + n]), w,
+                  std::fabs(w) / 256 + 1e-6);
+    }
+  }
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(weight_only_quant_pass);
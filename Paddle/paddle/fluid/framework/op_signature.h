@@ -0,0 +1,76 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/framework.pb.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * An input, output or attribute of an op, addressed by its dense index in
+ * the OpSignature of the op, i.e. the order of the AddInput, AddOutput and
+ * AddAttr calls in the Make() of its maker. Kernels declare the slots they
+ * read as constants at namespace scope, e.g.
+ *
+ *   constexpr OpSlot kX{0, "X"};
+ *   auto* x = ctx.Input<Tensor>(kX);
+ *
+ * The name is checked against the signature on every access, and a slot
+ * whose index does not match falls back to the lookup by name, so a wrong
+ * index only costs speed.
+ */
+struct OpSlot {
+  size_t index;
+  const char* name;
+};
+
+/*
+ * The names of the inputs, outputs and attributes of an op type in the order
+ * of its OpProto, compiled once at registration.
+ */
+class OpSignature {
+ public:
+  explicit OpSignature(const proto::OpProto& proto) {
+    for (auto& var : proto.inputs()) inputs_.push_back(var.name());
+    for (auto& var : proto.outputs()) outputs_.push_back(var.name());
+    for (auto& attr : proto.attrs()) attrs_.push_back(attr.name());
+  }
+
+  const std::vector<std::string>& Inputs() const { return inputs_; }
+  const std::vector<std::string>& Outputs() const { return outputs_; }
+  const std::vector<std::string>& Attrs() const { return attrs_; }
+
+  bool MatchInput(const OpSlot& slot) const { return Match(inputs_, slot); }
+  bool MatchOutput(const OpSlot& slot) const { return Match(outputs_, slot); }
+  bool MatchAttr(const OpSlot& slot) const { return Match(attrs_, slot); }
+
+ private:
+  static bool Match(const std::vector<std::string>& names,
+                    const OpSlot& slot) {
+    return slot.index < names.size() &&
+           std::strcmp(names[slot.index].c_str(), slot.name) == 0;
+  }
+
+  std::vector<std::string> inputs_;
+  std::vector<std::string> outputs_;
+  std::vector<std::string> attrs_;
+};
+
+}  // namespace framework
+}  // namespace paddle
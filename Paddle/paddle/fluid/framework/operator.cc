@@ -29,6 +29,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/shape_inference.h"
 #include "paddle/fluid/framework/transfer_scope_cache.h"
 #include "paddle/fluid/framework/var_type.h"
+#include "paddle/fluid/platform/op_metrics.h"
 #include "paddle/fluid/platform/profiler.h"
 
 DECLARE_bool(benchmark);
@@ -130,7 +131,9 @@ static LoD GetLoDDebug(const Scope& scope, const std::string& name) {
 
 RuntimeContext::RuntimeContext(const VariableNameMap& innames,
                                const VariableNameMap& outnames,
-                               const Scope& scope) {
+                               const Scope& scope,
+                               const OpSignature* signature)
+    : signature_(signature) {
   for (auto& var_name_item : innames) {
     std::vector<Variable*>& input_vars = inputs[var_name_item.first];
     input_vars.reserve(var_name_item.second.size());
@@ -145,6 +148,38 @@ RuntimeContext::RuntimeContext(const VariableNameMap& innames,
       output_vars.push_back(scope.FindVar(var_name));
     }
   }
+  BuildSlots();
+}
+
+RuntimeContext::RuntimeContext(const RuntimeContext& other)
+    : inputs(other.inputs),
+      outputs(other.outputs),
+      signature_(other.signature_) {
+  BuildSlots();
+}
+
+RuntimeContext& RuntimeContext::operator=(const RuntimeContext& other) {
+  if (this != &other) {
+    inputs = other.inputs;
+    outputs = other.outputs;
+    signature_ = other.signature_;
+    BuildSlots();
+  }
+  return *this;
+}
+
+void RuntimeContext::BuildSlots() {
+  input_slots_.clear();
+  output_slots_.clear();
+  if (signature_ == nullptr) return;
+  for (auto& name : signature_->Inputs()) {
+    auto it = inputs.find(name);
+    input_slots_.push_back(it == inputs.end() ? nullptr : &it->second);
+  }
+  for (auto& name : signature_->Outputs()) {
+    auto it = outputs.find(name);
+    output_slots_.push_back(it == outputs.end() ? nullptr : &it->second);
+  }
 }
 
 void OperatorBase::Run(const Scope& scope, const platform::Place& place) {
@@ -319,6 +354,18 @@ OperatorBase::OperatorBase(const std::string& type,
       info_(OpInfoMap::Instance().GetNullable(type)) {
   GenerateTemporaryNames();
   CheckAllInputOutputSet();
+  BuildAttrSlots();
+}
+
+void OperatorBase::BuildAttrSlots() {
+  if (info_ == nullptr || info_->signature_ == nullptr) return;
+  signature_ = info_->signature_;
+  // attrs_ is not modified after construction, and the elements of an
+  // unordered_map keep their address on rehash.
+  for (auto& name : signature_->Attrs()) {
+    auto it = attrs_.find(name);
+    attr_slots_.push_back(it == attrs_.end() ? nullptr : &it->second);
+  }
 }
 
 std::vector<std::string> OperatorBase::InputVars() const {
@@ -445,6 +492,17 @@ bool ExecutionContext::HasOutput(const std::string& name) const {
   return var != nullptr;
 }
 
+bool ExecutionContext::HasInput(const OpSlot& slot) const {
+  auto* vars = ctx_.InputSlot(slot);
+  if (vars == nullptr || vars->empty()) {
+    return false;
+  }
+  PADDLE_ENFORCE_EQ(vars->size(), 1UL,
+                    "Input %s should not have more than one inputs",
+                    slot.name);
+  return (*vars)[0] != nullptr;
+}
+
 const Variable* ExecutionContext::InputVar(const std::string& name) const {
   auto it = ctx_.inputs.find(name);
   if (it == ctx_.inputs.end()) return nullptr;
@@ -465,6 +523,26 @@ Variable* ExecutionContext::OutputVar(const std::string& name) const {
   return it->second.empty() ? nullptr : it->second[0];
 }
 
+const Variable* ExecutionContext::InputVar(const OpSlot& slot) const {
+  auto* vars = ctx_.InputSlot(slot);
+  if (vars == nullptr) return nullptr;
+
+  PADDLE_ENFORCE_LE(vars->size(), 1UL,
+                    "Operator %s's input %s should contain only one variable.",
+                    op_.Type(), slot.name);
+  return vars->empty() ? nullptr : (*vars)[0];
+}
+
+Variable* ExecutionContext::OutputVar(const OpSlot& slot) const {
+  auto* vars = ctx_.OutputSlot(slot);
+  if (vars == nullptr) return nullptr;
+
+  PADDLE_ENFORCE_LE(vars->size(), 1UL,
+                    "Operator %s's output %s should contain only one variable.",
+                    op_.Type(), slot.name);
+  return vars->empty() ? nullptr : (*vars)[0];
+}
+
 template <>
 const Tensor* ExecutionContext::Input<Tensor>(const std::string& name) const {
   return Input<LoDTensor>(name);
@@ -515,6 +593,54 @@ std::vector<Tensor*> ExecutionContext::MultiOutput<Tensor>(
   return res;
 }
 
+template <>
+const Tensor* ExecutionContext::Input<Tensor>(const OpSlot& slot) const {
+  return Input<LoDTensor>(slot);
+}
+
+template <>
+const std::vector<const Tensor*> ExecutionContext::MultiInput<Tensor>(
+    const OpSlot& slot) const {
+  auto* vars = ctx_.InputSlot(slot);
+  if (vars == nullptr) {
+    return {};
+  }
+  std::vector<const Tensor*> res;
+  res.reserve(vars->size());
+  std::transform(vars->begin(), vars->end(), std::back_inserter(res),
+                 [&](Variable* var) -> const Tensor* {
+                   if (var == nullptr) return nullptr;
+                   PADDLE_ENFORCE(
+                       var->IsType<LoDTensor>(),
+                       "should be LoDTensor, but the received type is %s",
+                       ToTypeName(var->Type()));
+                   return &(var->Get<LoDTensor>());
+                 });
+  return res;
+}
+
+template <>
+Tensor* ExecutionContext::Output<Tensor>(const OpSlot& slot) const {
+  return Output<LoDTensor>(slot);
+}
+
+template <>
+std::vector<Tensor*> ExecutionContext::MultiOutput<Tensor>(
+    const OpSlot& slot) const {
+  auto* vars = ctx_.OutputSlot(slot);
+  if (vars == nullptr) {
+    return {};
+  }
+  std::vector<Tensor*> res;
+  res.reserve(vars->size());
+  std::transform(vars->begin(), vars->end(), std::back_inserter(res),
+                 [&](Variable* var) -> Tensor* {
+                   return var == nullptr ? nullptr
+                                         : var->GetMutable<LoDTensor>();
+                 });
+  return res;
+}
+
 bool OpSupportGPU(const std::string& op_type) {
   auto& all_kernels = OperatorWithKernel::AllOpKernels();
   auto it = all_kernels.find(op_type);
@@ -845,6 +971,25 @@ static void CheckTensorNANOrInf(const std::string& op_type,
                  "Operator %s output Tensor %s contains NAN", op_type, name);
 }
 
+int64_t MaxInputNumel(const RuntimeContext& ctx) {
+  int64_t max_numel = 0;
+  for (auto& pair : ctx.inputs) {
+    for (auto* var : pair.second) {
+      if (var == nullptr) continue;
+      const Tensor* tensor = nullptr;
+      if (var->IsType<LoDTensor>()) {
+        tensor = &var->Get<LoDTensor>();
+      } else if (var->IsType<SelectedRows>()) {
+        tensor = &var->Get<SelectedRows>().value();
+      }
+      if (tensor != nullptr && tensor->IsInitialized()) {
+        max_numel = std::max(max_numel, tensor->numel());
+      }
+    }
+  }
+  return max_numel;
+}
+
 void OperatorWithKernel::RuntimeInferShape(const Scope& scope,
                                            const platform::Place& place,
                                            const RuntimeContext& ctx) const {
@@ -872,14 +1017,15 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
       HasAttr(kAllKernelsMustComputeRuntimeShape))
     all_kernels_must_compute_runtime_shape_ = true;
   if (!enable_cache_runtime_context_) {
-    RuntimeContext ctx(Inputs(), Outputs(), scope);
+    RuntimeContext ctx(Inputs(), Outputs(), scope, Signature());
     RunImpl(scope, place, &ctx);
   } else {
     const Scope* cur_scope = &scope;
     if (runtime_ctx_.get() == nullptr || pre_scope_ != cur_scope) {
       std::lock_guard<std::mutex> lock(cache_update_mutex_);
       if (runtime_ctx_.get() == nullptr || pre_scope_ != cur_scope) {
-        runtime_ctx_.reset(new RuntimeContext(Inputs(), Outputs(), scope));
+        runtime_ctx_.reset(
+            new RuntimeContext(Inputs(), Outputs(), scope, Signature()));
         pre_scope_ = cur_scope;
       }
     }
@@ -899,6 +1045,11 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
 
   std::vector<KernelConfig>* kernel_configs = GetKernelConfig(*kernel_type_);
 
+  int metrics_key = MetricsKey();
+  // Covers data transform, infer shape and the kernel itself.
+  platform::RecordOpMetrics record_metrics(
+      metrics_key, metrics_key < 0 ? 0 : MaxInputNumel(*runtime_ctx));
+
   // do data transformScope &transfer_scope;
   std::vector<std::string> transfered_inplace_vars;
   auto* transfer_scope =
@@ -926,9 +1077,21 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
     TransferInplaceVarsBack(scope, transfered_inplace_vars, *transfer_scope);
   }
 
+  CheckOutputs(exec_scope, *dev_ctx);
+
+  // To solve issue #15032, have a discussion with @Luotao for cpu inference,
+  // do not cache transfer scope, hence in this case delete transfer scope
+  // after run to avoid memory leak
+  if (transfer_scope && !run_by_executor_ && !enable_cache_transfer_scope_) {
+    scope.DeleteScope(transfer_scope);
+  }
+}
+
+void OperatorWithKernel::CheckOutputs(
+    const Scope& exec_scope, const platform::DeviceContext& dev_ctx) const {
   /*For profiling/benchmark only*/
   if (FLAGS_benchmark) {
-    dev_ctx->Wait();
+    dev_ctx.Wait();
   }
 
   if (FLAGS_fast_check_nan_inf) {
@@ -962,13 +1125,53 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
       }
     }
   }
+}
 
-  // To solve issue #15032, have a discussion with @Luotao for cpu inference,
-  // do not cache transfer scope, hence in this case delete transfer scope
-  // after run to avoid memory leak
-  if (transfer_scope && !run_by_executor_ && !enable_cache_transfer_scope_) {
-    scope.DeleteScope(transfer_scope);
+int OperatorWithKernel::MetricsKey() const {
+  if (!FLAGS_enable_op_metrics) return -1;
+  int key = metrics_key_.load(std::memory_order_acquire);
+  if (key < 0) {
+    std::lock_guard<std::mutex> lock(cache_update_mutex_);
+    key = metrics_key_.load(std::memory_order_relaxed);
+    if (key < 0) {
+      key = platform::OpMetricsRegistry::Instance().GetOrCreateKey(
+          type_, KernelTypeToString(*kernel_type_));
+      metrics_key_.store(key, std::memory_order_release);
+    }
+  }
+  return key;
+}
+
+bool OperatorWithKernel::CanRunPreparedKernel(
+    const RuntimeContext& ctx) const {
+  if (kernel_type_.get() == nullptr || kernel_func_.get() == nullptr) {
+    return false;
+  }
+  auto no_buffer_ins = NoNeedBufferInputs();
+  for (auto& pair : ctx.inputs) {
+    if (!no_buffer_ins.empty() && no_buffer_ins.count(pair.first) > 0) {
+      continue;
+    }
+    for (auto* var : pair.second) {
+      if (var == nullptr || !VarIsTensor(*var)) continue;
+      auto* tensor = GetLoDTensorOrSelectedRowsValueFromVar(*var);
+      if (!tensor->IsInitialized()) continue;
+      if (NeedTransform(GetKernelTypeForVar(pair.first, *tensor, *kernel_type_),
+                        *kernel_type_)) {
+        return false;
+      }
+    }
   }
+  return true;
+}
+
+void OperatorWithKernel::RunPreparedKernel(
+    const RuntimeContext& runtime_ctx, const ExecutionContext& exe_ctx) const {
+  int metrics_key = MetricsKey();
+  platform::RecordOpMetrics record_metrics(
+      metrics_key, metrics_key < 0 ? 0 : MaxInputNumel(runtime_ctx));
+  (*kernel_func_)(exe_ctx);
+  CheckOutputs(exe_ctx.scope(), exe_ctx.device_context());
 }
 
 void OperatorWithKernel::ChooseKernel(const RuntimeContext& ctx,
@@ -1032,12 +1235,8 @@ void OperatorWithKernel::TransferInplaceVarsBack(
   }
 }
 
-Scope* OperatorWithKernel::PrepareData(
-    const Scope& scope, const OpKernelType& expected_kernel_key,
-    std::vector<std::string>* transfered_inplace_vars,
-    RuntimeContext* ctx) const {
-  Scope* new_scope = nullptr;
-
+std::unordered_set<std::string> OperatorWithKernel::NoNeedBufferInputs()
+    const {
   std::unordered_set<std::string> no_buffer_ins;
   if (info_) {
     auto& no_buffer_inferer = info_->NoNeedBufferVarsInferer();
@@ -1046,7 +1245,16 @@ Scope* OperatorWithKernel::PrepareData(
       no_buffer_ins = no_buffer_inferer(Inputs(), Outputs(), Attrs());
     }
   }
+  return no_buffer_ins;
+}
+
+Scope* OperatorWithKernel::PrepareData(
+    const Scope& scope, const OpKernelType& expected_kernel_key,
+    std::vector<std::string>* transfered_inplace_vars,
+    RuntimeContext* ctx) const {
+  Scope* new_scope = nullptr;
 
+  auto no_buffer_ins = NoNeedBufferInputs();
   for (auto& var_name_item : Inputs()) {
     // NOTE(zjl): STL does not guarantee fast std::unordered_set::count when set
     // is empty. At least STL implemented on my mac does calculate hash code
@@ -21,6 +21,7 @@ limitations under the License. */
 #include <string>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -110,17 +111,59 @@ class ExecutionContext;
 
 class RuntimeContext {
  public:
+  /// If signature is given, the variables of the inputs and outputs are also
+  /// indexed by their OpSlot, see InputSlot and OutputSlot.
   RuntimeContext(const VariableNameMap& innames,
-                 const VariableNameMap& outnames, const Scope& scope);
+                 const VariableNameMap& outnames, const Scope& scope,
+                 const OpSignature* signature = nullptr);
 
   RuntimeContext(const VariableValueMap& invars,
                  const VariableValueMap& outvars)
       : inputs(invars), outputs(outvars) {}
 
+  RuntimeContext(const RuntimeContext& other);
+  RuntimeContext& operator=(const RuntimeContext& other);
+  // Moving a std::map keeps its nodes, so the slots stay valid.
+  RuntimeContext(RuntimeContext&& other) = default;
+  RuntimeContext& operator=(RuntimeContext&& other) = default;
+
+  /// The variables of the input, or nullptr if the op has no such input.
+  const std::vector<Variable*>* InputSlot(const OpSlot& slot) const {
+    if (signature_ != nullptr && signature_->MatchInput(slot) &&
+        input_slots_[slot.index] != nullptr) {
+      return input_slots_[slot.index];
+    }
+    auto it = inputs.find(slot.name);
+    return it == inputs.end() ? nullptr : &it->second;
+  }
+
+  /// The variables of the output, or nullptr if the op has no such output.
+  const std::vector<Variable*>* OutputSlot(const OpSlot& slot) const {
+    if (signature_ != nullptr && signature_->MatchOutput(slot) &&
+        output_slots_[slot.index] != nullptr) {
+      return output_slots_[slot.index];
+    }
+    auto it = outputs.find(slot.name);
+    return it == outputs.end() ? nullptr : &it->second;
+  }
+
   VariableValueMap inputs;
   VariableValueMap outputs;
+
+ private:
+  void BuildSlots();
+
+  const OpSignature* signature_{nullptr};
+  // In the order of signature_, pointing into inputs and outputs, nullptr if
+  // the op has no such argument.
+  std::vector<std::vector<Variable*>*> input_slots_;
+  std::vector<std::vector<Variable*>*> output_slots_;
 };
 
+/// The numel of the largest LoDTensor or SelectedRows input of ctx, used to
+/// bucket the op metrics by input size.
+int64_t MaxInputNumel(const RuntimeContext& ctx);
+
 /**
  * OperatorBase has the basic elements that Net will call to do computation.
  * Only CreateOperator from OpRegistry will new Operator directly. User
@@ -156,6 +199,16 @@ class OperatorBase {
                    "%s should be in AttributeMap", name);
     return boost::get<T>(attrs_.at(name));
   }
+  /// Same as Attr(slot.name), without hashing the name if the slot matches
+  /// the signature of the op.
+  template <typename T>
+  inline const T& Attr(const OpSlot& slot) const {
+    if (signature_ != nullptr && signature_->MatchAttr(slot) &&
+        attr_slots_[slot.index] != nullptr) {
+      return boost::get<T>(*attr_slots_[slot.index]);
+    }
+    return Attr<T>(slot.name);
+  }
   const AttributeMap& Attrs() const { return attrs_; }
 
   const VariableNameMap& Inputs() const { return inputs_; }
@@ -166,6 +219,9 @@ class OperatorBase {
     return *info_;
   }
 
+  /// The compiled signature of the op type, nullptr if the op has no proto.
+  const OpSignature* Signature() const { return signature_; }
+
   bool HasInputs(const std::string& name) const;
   //! Get a input with argument's name described in `op_proto`
   std::string Input(const std::string& name) const;
@@ -208,10 +264,16 @@ class OperatorBase {
   bool run_by_executor_{true};
 
  private:
+  void BuildAttrSlots();
   void GenerateTemporaryNames();
   void CheckAllInputOutputSet() const;
   virtual void RunImpl(const Scope& scope,
                        const platform::Place& place) const = 0;
+
+  const OpSignature* signature_{nullptr};
+  // In the order of the attrs of signature_, pointing into attrs_, nullptr if
+  // the attr is not set.
+  std::vector<const Attribute*> attr_slots_;
 };
 
 #ifdef PADDLE_WITH_CUDA
@@ -248,10 +310,17 @@ class ExecutionContext {
     return op_.Attr<T>(name);
   }
 
+  template <typename T>
+  inline const T& Attr(const OpSlot& slot) const {
+    return op_.Attr<T>(slot);
+  }
+
   bool HasAttr(const std::string& name) const { return op_.HasAttr(name); }
 
   bool HasInput(const std::string& name) const;
 
+  bool HasInput(const OpSlot& slot) const;
+
   bool HasOutput(const std::string& name) const;
 
   size_t InputSize(const std::string& name) const {
@@ -266,6 +335,10 @@ class ExecutionContext {
 
   Variable* OutputVar(const std::string& name) const;
 
+  const Variable* InputVar(const OpSlot& slot) const;
+
+  Variable* OutputVar(const OpSlot& slot) const;
+
   const std::vector<const Variable*> MultiInputVar(
       const std::string& name) const {
     auto it = ctx_.inputs.find(name);
@@ -296,6 +369,18 @@ class ExecutionContext {
     return var == nullptr ? nullptr : var->GetMutable<T>();
   }
 
+  template <typename T>
+  const T* Input(const OpSlot& slot) const {
+    auto* var = InputVar(slot);
+    return var == nullptr ? nullptr : &var->Get<T>();
+  }
+
+  template <typename T>
+  T* Output(const OpSlot& slot) const {
+    auto var = OutputVar(slot);
+    return var == nullptr ? nullptr : var->GetMutable<T>();
+  }
+
   template <typename T>
   const std::vector<const T*> MultiInput(const std::string& name) const {
     auto it = ctx_.inputs.find(name);
@@ -328,6 +413,36 @@ class ExecutionContext {
     return res;
   }
 
+  template <typename T>
+  const std::vector<const T*> MultiInput(const OpSlot& slot) const {
+    auto* vars = ctx_.InputSlot(slot);
+    if (vars == nullptr) {
+      return {};
+    }
+    std::vector<const T*> res;
+    res.reserve(vars->size());
+    std::transform(vars->begin(), vars->end(), std::back_inserter(res),
+                   [&](Variable* var) -> const T* {
+                     return var == nullptr ? nullptr : &var->Get<T>();
+                   });
+    return res;
+  }
+
+  template <typename T>
+  std::vector<T*> MultiOutput(const OpSlot& slot) const {
+    auto* vars = ctx_.OutputSlot(slot);
+    if (vars == nullptr) {
+      return {};
+    }
+    std::vector<T*> res;
+    res.reserve(vars->size());
+    std::transform(vars->begin(), vars->end(), std::back_inserter(res),
+                   [&](Variable* var) -> T* {
+                     return var == nullptr ? nullptr : var->GetMutable<T>();
+                   });
+    return res;
+  }
+
   platform::Place GetPlace() const { return device_context_.GetPlace(); }
 
   template <typename DeviceContextType>
@@ -407,6 +522,20 @@ template <>
 std::vector<Tensor*> ExecutionContext::MultiOutput<Tensor>(
     const std::string& name) const;
 
+template <>
+const Tensor* ExecutionContext::Input<Tensor>(const OpSlot& slot) const;
+
+template <>
+const std::vector<const Tensor*> ExecutionContext::MultiInput<Tensor>(
+    const OpSlot& slot) const;
+
+template <>
+Tensor* ExecutionContext::Output<Tensor>(const OpSlot& slot) const;
+
+template <>
+std::vector<Tensor*> ExecutionContext::MultiOutput<Tensor>(
+    const OpSlot& slot) const;
+
 class OpKernelBase {
  public:
   /**
@@ -471,6 +600,20 @@ class OperatorWithKernel : public OperatorBase {
       const std::string& var_name, const Tensor& tensor,
       const OpKernelType& expected_kernel_type) const;
 
+  // The kernel chosen by the first run of this op, or nullptr if it has not
+  // run yet.
+  const OpKernelType* kernel_type() const { return kernel_type_.get(); }
+
+  // Returns true if the kernel has been chosen and no input in ctx needs a
+  // data transform for it, in which case RunPreparedKernel can replace Run.
+  bool CanRunPreparedKernel(const RuntimeContext& ctx) const;
+
+  // Calls the chosen kernel directly, skipping kernel selection, data
+  // transform and shape inference: the caller has resized the outputs
+  // already. exe_ctx must be built on runtime_ctx. Used by ExecutorPlan.
+  void RunPreparedKernel(const RuntimeContext& runtime_ctx,
+                         const ExecutionContext& exe_ctx) const;
+
  private:
   void ParseInputDataType(const ExecutionContext& ctx, const std::string& name,
                           proto::VarType::Type* type) const;
@@ -496,9 +639,20 @@ class OperatorWithKernel : public OperatorBase {
                                const std::vector<std::string>& inplace_vars,
                                const Scope& exec_scope) const;
 
+  // The checks after a kernel run, enabled by FLAGS_benchmark and the nan/inf
+  // checking flags.
+  void CheckOutputs(const Scope& exec_scope,
+                    const platform::DeviceContext& dev_ctx) const;
+
   void ChooseKernel(const RuntimeContext& ctx, const Scope& scope,
                     const platform::Place& place) const;
 
+  // The key of this op in platform::OpMetricsRegistry, or -1 if
+  // FLAGS_enable_op_metrics is off.
+  int MetricsKey() const;
+
+  std::unordered_set<std::string> NoNeedBufferInputs() const;
+
  protected:
   mutable OpKernelConfigsMap kernel_configs_map_;
   mutable std::unique_ptr<OpKernelType> kernel_type_;
@@ -509,6 +663,10 @@ class OperatorWithKernel : public OperatorBase {
   mutable bool all_kernels_must_compute_runtime_shape_ = false;
   mutable std::mutex cache_update_mutex_;
   mutable bool enable_cache_transfer_scope_ = false;
+  // The key of this op in platform::OpMetricsRegistry, -1 until the first
+  // run with FLAGS_enable_op_metrics. Read without cache_update_mutex_ once
+  // it is set.
+  mutable std::atomic<int> metrics_key_{-1};
 };
 
 extern bool OpSupportGPU(const std::string& op_type);
@@ -494,3 +494,69 @@ TEST(IndicateVarDataTypeTest, other) {
   }
   ASSERT_TRUE(caught);
 }
+
+namespace paddle {
+namespace framework {
+
+// The slots of OpKernelTestMultiInputsProtoAndCheckerMaker
+constexpr OpSlot kXs{0, "xs"};
+constexpr OpSlot kK{1, "k"};
+constexpr OpSlot kYs{0, "ys"};
+constexpr OpSlot kScale{0, "scale"};
+// k with a wrong index, which falls back to the lookup by name
+constexpr OpSlot kStaleK{0, "k"};
+
+static int slot_kernel_run_num = 0;
+
+class CPUKernelSlotsTest : public OpKernel<float> {
+ public:
+  void Compute(const ExecutionContext& ctx) const {
+    slot_kernel_run_num++;
+    ASSERT_EQ(ctx.MultiInput<Tensor>(kXs), ctx.MultiInput<Tensor>("xs"));
+    ASSERT_EQ(ctx.InputVar(kK), ctx.InputVar("k"));
+    ASSERT_EQ(ctx.Input<Tensor>(kK), ctx.Input<Tensor>("k"));
+    ASSERT_EQ(ctx.InputVar(kStaleK), ctx.InputVar("k"));
+    ASSERT_TRUE(ctx.HasInput(kK));
+    ASSERT_EQ(ctx.MultiOutput<Tensor>(kYs), ctx.MultiOutput<Tensor>("ys"));
+    ASSERT_EQ(ctx.Attr<float>(kScale), ctx.Attr<float>("scale"));
+    ASSERT_EQ(ctx.InputVar(OpSlot{1, "missing"}), nullptr);
+  }
+};
+
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_OP_WITHOUT_GRADIENT(
+    op_with_slots, paddle::framework::OpWithKernelTest,
+    paddle::framework::OpKernelTestMultiInputsProtoAndCheckerMaker);
+REGISTER_OP_CPU_KERNEL(op_with_slots, paddle::framework::CPUKernelSlotsTest);
+
+TEST(OpKernel, slots) {
+  paddle::framework::InitDevices(true);
+  paddle::framework::proto::OpDesc op_desc;
+
+  op_desc.set_type("op_with_slots");
+  BuildVar("xs", {"x0", "x1"}, op_desc.add_inputs());
+  BuildVar("k", {"k0"}, op_desc.add_inputs());
+  BuildVar("ys", {"y0"}, op_desc.add_outputs());
+
+  auto attr = op_desc.mutable_attrs()->Add();
+  attr->set_name("scale");
+  attr->set_type(paddle::framework::proto::AttrType::FLOAT);
+  attr->set_f(3.14);
+
+  paddle::platform::CPUPlace cpu_place;
+  paddle::framework::Scope scope;
+  scope.Var("x0")->GetMutable<paddle::framework::LoDTensor>();
+  scope.Var("x1")->GetMutable<paddle::framework::LoDTensor>();
+  scope.Var("k0")->GetMutable<paddle::framework::LoDTensor>();
+  scope.Var("y0")->GetMutable<paddle::framework::LoDTensor>();
+
+  auto op = paddle::framework::OpRegistry::CreateOp(op_desc);
+  ASSERT_NE(op->Signature(), nullptr);
+  ASSERT_TRUE(op->Signature()->MatchInput(paddle::framework::kK));
+  ASSERT_FALSE(op->Signature()->MatchInput(paddle::framework::kStaleK));
+  ASSERT_FLOAT_EQ(op->Attr<float>(paddle::framework::kScale), 3.14f);
+  op->Run(scope, cpu_place);
+  ASSERT_EQ(paddle::framework::slot_kernel_run_num, 1);
+}
@@ -341,8 +341,13 @@ ir::Graph *ParallelExecutorPrivate::ApplyMemoryOptimizePass(ir::Graph *graph) {
     } else {
 #endif
       if (platform::is_cpu_place(place)) {
-        gc.reset(new CPUGarbageCollector(boost::get<platform::CPUPlace>(place),
-                                         max_memory_size));
+        if (IsAsyncCPUGarbageCollectionEnabled()) {
+          gc.reset(new AsyncCPUGarbageCollector(
+              boost::get<platform::CPUPlace>(place), max_memory_size));
+        } else {
+          gc.reset(new CPUGarbageCollector(
+              boost::get<platform::CPUPlace>(place), max_memory_size));
+        }
         VLOG(10) << "Created GarbageCollector at " << place;
       } else {
         PADDLE_THROW("Unsupported place for garbage collection");
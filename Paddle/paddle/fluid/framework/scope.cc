@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/scope.h"
 
+#include <atomic>
 #include <memory>  // for unique_ptr
 #include <queue>
 #include <set>
@@ -141,6 +142,7 @@ void Scope::EraseVars(const std::vector<std::string>& var_names) {
       ++it;
     }
   }
+  generation_ = NewGeneration();
 }
 
 void Scope::Rename(const std::string& origin_name,
@@ -184,6 +186,7 @@ void Scope::RenameInternal(const std::string& origin_name,
                  "The variable with name %s is already in the scope", new_name);
   vars_[new_name].reset(origin_it->second.release());
   vars_.erase(origin_it);
+  generation_ = NewGeneration();
 }
 
 Variable* Scope::FindVarInternal(const std::string& name) const {
@@ -209,6 +212,12 @@ void Scope::EraseVarsExcept(const std::unordered_set<Variable*>& vars) {
       vars_.erase(iter++);
     }
   }
+  generation_ = NewGeneration();
+}
+
+uint64_t Scope::NewGeneration() {
+  static std::atomic<uint64_t> generation{0};
+  return ++generation;
 }
 
 std::string GenScopeTreeDebugInfo(Scope* root) {
@@ -18,6 +18,7 @@ extern "C" {
 #include <xxhash.h>
 }
 
+#include <cstdint>
 #include <list>
 #include <memory>
 #include <string>
@@ -45,7 +46,7 @@ class Scope;
  */
 class Scope {
  public:
-  Scope() {}
+  Scope() : generation_(NewGeneration()) {}
   ~Scope();
 
   /// Create a sub-scope. Returns a reference other than a pointer so
@@ -105,6 +106,12 @@ class Scope {
   // Rename variable to a new name and return the new name
   std::string Rename(const std::string& origin_name) const;
 
+  /// A number unique among all the scopes of the process, which changes
+  /// whenever variables of this scope are erased or renamed. Objects keeping
+  /// Variable pointers of the scope, e.g. execution plans, check it to tell
+  /// whether the pointers are still valid.
+  uint64_t Generation() const { return generation_; }
+
  protected:
   struct KeyHasher {
     std::size_t operator()(const std::string& key) const {
@@ -117,7 +124,10 @@ class Scope {
 
  private:
   // Call Scope::NewScope for a sub-scope.
-  explicit Scope(Scope const* parent) : parent_(parent) {}
+  explicit Scope(Scope const* parent)
+      : parent_(parent), generation_(NewGeneration()) {}
+
+  static uint64_t NewGeneration();
 
   // Called by Var.
   Variable* VarInternal(const std::string& name);
@@ -138,6 +148,7 @@ class Scope {
   // Scope in `kids_` are owned by this class.
   mutable std::list<Scope*> kids_;
   const Scope* parent_{nullptr};
+  mutable uint64_t generation_;
 
   DISABLE_COPY_AND_ASSIGN(Scope);
 
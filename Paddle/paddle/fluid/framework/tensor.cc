@@ -113,5 +113,15 @@ void Tensor::ResetHolder(std::shared_ptr<memory::Allocation> holder) {
   holder_ = holder;
 }
 
+void Tensor::ResetHolderWithType(std::shared_ptr<memory::Allocation> holder,
+                                 const proto::VarType::Type type) {
+  PADDLE_ENFORCE_NOT_NULL(holder);
+  PADDLE_ENFORCE_GE(holder->size(), numel() * SizeOfType(type),
+                    "The memory block is smaller than the tensor");
+  holder_ = holder;
+  type_ = type;
+  offset_ = 0;
+}
+
 }  // namespace framework
 }  // namespace paddle
@@ -168,6 +168,11 @@ class Tensor {
 
   void ResetHolder(std::shared_ptr<memory::Allocation> holder);
 
+  // Adopts an external memory block, e.g. of a numpy array, as the data of
+  // this tensor of the given type. The block must hold the whole tensor.
+  void ResetHolderWithType(std::shared_ptr<memory::Allocation> holder,
+                           const proto::VarType::Type type);
+
  private:
   /*! holds the memory block if allocated. */
   std::shared_ptr<memory::Allocation> holder_;
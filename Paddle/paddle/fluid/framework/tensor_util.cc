@@ -495,40 +495,30 @@ void TensorFromStream(std::istream& is, Tensor* tensor,
   }
 }
 
-// get tensor data point by DLDataType
-void* GetDstPtrByDLDataType(DLDataType type, framework::Tensor* dst,
-                            const platform::Place& dst_place) {
+// get tensor data type by DLDataType
+static proto::VarType::Type GetTypeByDLDataType(DLDataType type) {
   // vector types not currently supported
   PADDLE_ENFORCE_LE(type.lanes, 1, "vector types not currently supported");
 
   switch (type.bits) {
     case 8:
-      if (type.code == kDLInt)
-        return static_cast<void*>(dst->mutable_data<int8_t>(dst_place));
-      if (type.code == kDLUInt)
-        return static_cast<void*>(dst->mutable_data<uint8_t>(dst_place));
+      if (type.code == kDLInt) return proto::VarType::INT8;
+      if (type.code == kDLUInt) return proto::VarType::UINT8;
       PADDLE_THROW("There is no this type.code <%d> when type.bits is <%d>.",
                    type.code, type.bits);
     case 16:
-      if (type.code == kDLInt)
-        return static_cast<void*>(dst->mutable_data<int16_t>(dst_place));
-      if (type.code == kDLFloat)
-        return static_cast<void*>(
-            dst->mutable_data<paddle::platform::float16>(dst_place));
+      if (type.code == kDLInt) return proto::VarType::INT16;
+      if (type.code == kDLFloat) return proto::VarType::FP16;
       PADDLE_THROW("There is no this type.code <%d> when type.bits is <%d>.",
                    type.code, type.bits);
     case 32:
-      if (type.code == kDLInt)
-        return static_cast<void*>(dst->mutable_data<int32_t>(dst_place));
-      if (type.code == kDLFloat)
-        return static_cast<void*>(dst->mutable_data<float>(dst_place));
+      if (type.code == kDLInt) return proto::VarType::INT32;
+      if (type.code == kDLFloat) return proto::VarType::FP32;
       PADDLE_THROW("There is no this type.code <%d> when type.bits is <%d>.",
                    type.code, type.bits);
     case 64:
-      if (type.code == kDLInt)
-        return static_cast<void*>(dst->mutable_data<int64_t>(dst_place));
-      if (type.code == kDLFloat)
-        return static_cast<void*>(dst->mutable_data<double>(dst_place));
+      if (type.code == kDLInt) return proto::VarType::INT64;
+      if (type.code == kDLFloat) return proto::VarType::FP64;
       PADDLE_THROW("There is no this type.code <%d> when type.bits is <%d>.",
                    type.code, type.bits);
     default:
@@ -536,6 +526,12 @@ void* GetDstPtrByDLDataType(DLDataType type, framework::Tensor* dst,
   }
 }
 
+// get tensor data point by DLDataType
+void* GetDstPtrByDLDataType(DLDataType type, framework::Tensor* dst,
+                            const platform::Place& dst_place) {
+  return dst->mutable_data(dst_place, GetTypeByDLDataType(type));
+}
+
 void TensorFromDLPack(const ::DLTensor& dl_tensor, framework::Tensor* dst) {
   platform::CPUPlace dst_place = platform::CPUPlace();
   platform::CPUPlace src_place = platform::CPUPlace();
@@ -571,6 +567,68 @@ void TensorFromDLPack(const ::DLTensor& dl_tensor, framework::Tensor* dst) {
 #endif
 }
 
+namespace {
+// The memory of a DLManagedTensor, which is returned to its producer when the
+// allocation is released.
+class DLManagedTensorAllocation : public memory::Allocation {
+ public:
+  DLManagedTensorAllocation(::DLManagedTensor* dl_managed_tensor, size_t size,
+                            const platform::Place& place)
+      : Allocation(static_cast<char*>(dl_managed_tensor->dl_tensor.data) +
+                       dl_managed_tensor->dl_tensor.byte_offset,
+                   size, place),
+        dl_managed_tensor_(dl_managed_tensor) {}
+
+  ~DLManagedTensorAllocation() {
+    if (dl_managed_tensor_->deleter != nullptr) {
+      dl_managed_tensor_->deleter(dl_managed_tensor_);
+    }
+  }
+
+ private:
+  ::DLManagedTensor* dl_managed_tensor_;
+};
+
+bool IsCompact(const ::DLTensor& dl_tensor) {
+  if (dl_tensor.strides == nullptr) return true;
+  int64_t stride = 1;
+  for (int i = dl_tensor.ndim - 1; i >= 0; --i) {
+    if (dl_tensor.shape[i] != 1 && dl_tensor.strides[i] != stride) {
+      return false;
+    }
+    stride *= dl_tensor.shape[i];
+  }
+  return true;
+}
+}  // namespace
+
+bool TensorFromDLManagedTensor(::DLManagedTensor* dl_managed_tensor,
+                               framework::Tensor* dst) {
+  const ::DLTensor& dl_tensor = dl_managed_tensor->dl_tensor;
+  platform::Place place;
+  if (dl_tensor.ctx.device_type == kDLCPU) {
+    place = platform::CPUPlace();
+#ifdef PADDLE_WITH_CUDA
+  } else if (dl_tensor.ctx.device_type == kDLGPU) {
+    place = platform::CUDAPlace(dl_tensor.ctx.device_id);
+#endif
+  } else {
+    return false;
+  }
+  if (dl_tensor.dtype.lanes != 1 || !IsCompact(dl_tensor)) return false;
+  auto type = GetTypeByDLDataType(dl_tensor.dtype);
+
+  std::vector<int64_t> vec;
+  std::copy(dl_tensor.shape, dl_tensor.shape + dl_tensor.ndim,
+            std::back_inserter(vec));
+  dst->Resize(framework::make_ddim(vec));
+  size_t size = dst->numel() * SizeOfType(type);
+  dst->ResetHolderWithType(std::make_shared<DLManagedTensorAllocation>(
+                               dl_managed_tensor, size, place),
+                           type);
+  return true;
+}
+
 template <typename T>
 std::ostream& print_tensor(std::ostream& os, const framework::Tensor& tensor) {
   auto inspect = tensor.data<T>();
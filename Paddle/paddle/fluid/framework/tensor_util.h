@@ -76,6 +76,13 @@ void TensorFromStream(std::istream& is, Tensor* tensor,
 // convert dlpack's DLTensor to tensor
 void TensorFromDLPack(const ::DLTensor& dl_tensor, framework::Tensor* dst);
 
+// Adopts the memory of a compact dlpack tensor on CPU or GPU without copying,
+// and takes the ownership of dl_managed_tensor, whose deleter is called when
+// dst and the tensors sharing its memory are released. Returns false without
+// taking the ownership if the tensor can not be adopted, e.g. it is strided.
+bool TensorFromDLManagedTensor(::DLManagedTensor* dl_managed_tensor,
+                               framework::Tensor* dst);
+
 //
 // The implementation of template functions.
 //
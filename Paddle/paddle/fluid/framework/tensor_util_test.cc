@@ -305,6 +305,43 @@ TEST(TensorFromDLPack, Tensor) {
 #endif
 }
 
+TEST(TensorFromDLManagedTensor, Tensor) {
+  std::vector<int> src_vec = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+  paddle::framework::Tensor cpu_tensor;
+  paddle::platform::CPUPlace cpu_place;
+  paddle::platform::CPUDeviceContext cpu_ctx(cpu_place);
+  paddle::framework::TensorFromVector<int>(src_vec, cpu_ctx, &cpu_tensor);
+  cpu_tensor.Resize(paddle::framework::make_ddim({3, 3}));
+  std::weak_ptr<paddle::memory::Allocation> holder = cpu_tensor.Holder();
+
+  paddle::framework::Tensor dst_tensor;
+  {
+    paddle::framework::DLPackTensor dlpack_tensor(cpu_tensor, 1);
+    ::DLManagedTensor* dl_managed_tensor = dlpack_tensor.ToDLManagedTensor();
+    ASSERT_TRUE(paddle::framework::TensorFromDLManagedTensor(dl_managed_tensor,
+                                                             &dst_tensor));
+  }
+  // The memory is shared, and kept alive by dst_tensor.
+  EXPECT_EQ(dst_tensor.data<int>(), cpu_tensor.data<int>());
+  EXPECT_EQ(dst_tensor.dims(), cpu_tensor.dims());
+  cpu_tensor.clear();
+  EXPECT_FALSE(holder.expired());
+  EXPECT_EQ(dst_tensor.data<int>()[8], 9);
+  dst_tensor.clear();
+  EXPECT_TRUE(holder.expired());
+
+  // A strided tensor is not adopted.
+  paddle::framework::TensorFromVector<int>(src_vec, cpu_ctx, &cpu_tensor);
+  cpu_tensor.Resize(paddle::framework::make_ddim({3, 3}));
+  paddle::framework::DLPackTensor dlpack_tensor(cpu_tensor, 1);
+  ::DLManagedTensor* dl_managed_tensor = dlpack_tensor.ToDLManagedTensor();
+  int64_t strides[] = {1, 3};
+  dl_managed_tensor->dl_tensor.strides = strides;
+  EXPECT_FALSE(paddle::framework::TensorFromDLManagedTensor(dl_managed_tensor,
+                                                            &dst_tensor));
+  dl_managed_tensor->deleter(dl_managed_tensor);
+}
+
 TEST(TensorContainsNAN, CPU) {
   {
     paddle::framework::Tensor src;
@@ -0,0 +1,226 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/work_stealing_thread_pool.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+WorkStealingDeque::WorkStealingDeque(size_t capacity)
+    : buffer_(new std::atomic<WorkStealingTask*>[capacity]),
+      mask_(static_cast<int64_t>(capacity) - 1),
+      top_(0),
+      bottom_(0) {
+  PADDLE_ENFORCE(capacity > 0 && (capacity & (capacity - 1)) == 0,
+                 "The capacity of WorkStealingDeque must be a power of 2");
+  for (size_t i = 0; i < capacity; ++i) {
+    buffer_[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+bool WorkStealingDeque::Push(WorkStealingTask* task) {
+  int64_t b = bottom_.load(std::memory_order_relaxed);
+  int64_t t = top_.load(std::memory_order_acquire);
+  if (b - t > mask_) return false;
+  buffer_[b & mask_].store(task, std::memory_order_relaxed);
+  // Publishes the task to thieves, which load bottom_ with acquire.
+  bottom_.store(b + 1, std::memory_order_release);
+  return true;
+}
+
+WorkStealingTask* WorkStealingDeque::Pop() {
+  int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+  bottom_.store(b, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t t = top_.load(std::memory_order_relaxed);
+  if (t > b) {
+    // Empty.
+    bottom_.store(b + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  WorkStealingTask* task = buffer_[b & mask_].load(std::memory_order_relaxed);
+  if (t == b) {
+    // The last task, race against the thieves for it.
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      task = nullptr;
+    }
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+  return task;
+}
+
+WorkStealingTask* WorkStealingDeque::Steal() {
+  int64_t t = top_.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t b = bottom_.load(std::memory_order_acquire);
+  if (t >= b) return nullptr;
+  WorkStealingTask* task = buffer_[t & mask_].load(std::memory_order_relaxed);
+  if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                    std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  return task;
+}
+
+bool WorkStealingDeque::Empty() const {
+  int64_t t = top_.load(std::memory_order_relaxed);
+  int64_t b = bottom_.load(std::memory_order_relaxed);
+  return t >= b;
+}
+
+namespace {
+struct CurrentWorker {
+  const WorkStealingThreadPool* pool = nullptr;
+  int index = -1;
+};
+thread_local CurrentWorker current_worker;
+
+// xorshift64*, to pick steal victims without touching shared state.
+inline uint64_t NextRandom(uint64_t* state) {
+  uint64_t x = *state;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  *state = x;
+  return x * 0x2545F4914F6CDD1DULL;
+}
+}  // namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool(size_t num_threads) {
+  PADDLE_ENFORCE_GT(num_threads, 0UL,
+                    "WorkStealingThreadPool needs at least one thread");
+  workers_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(new Worker());
+  }
+  // Start the threads only after every deque exists, since workers steal
+  // from each other as soon as they run.
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_[i]->thread = std::thread([this, i] { WorkerLoop(i); });
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    running_.store(false);
+  }
+  sleep_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+int WorkStealingThreadPool::CurrentWorkerIndex() const {
+  return current_worker.pool == this ? current_worker.index : -1;
+}
+
+void WorkStealingThreadPool::Schedule(WorkStealingTask* task) {
+  int index = CurrentWorkerIndex();
+  if (index < 0 || !workers_[index]->deque.Push(task)) {
+    std::lock_guard<std::mutex> lock(global_mutex_);
+    global_queue_.push_back(task);
+    global_size_.fetch_add(1);
+  }
+  // Pairs with the fence in WorkerLoop: either the sleeping worker observes
+  // the new task, or we observe it going to sleep and wake it up.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (num_sleeping_.load(std::memory_order_relaxed) > 0) {
+    NotifyOne();
+  }
+}
+
+void WorkStealingThreadPool::NotifyOne() {
+  { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+  sleep_cv_.notify_one();
+}
+
+WorkStealingTask* WorkStealingThreadPool::PopGlobal() {
+  if (global_size_.load(std::memory_order_relaxed) == 0) return nullptr;
+  std::lock_guard<std::mutex> lock(global_mutex_);
+  if (global_queue_.empty()) return nullptr;
+  WorkStealingTask* task = global_queue_.front();
+  global_queue_.pop_front();
+  global_size_.fetch_sub(1);
+  return task;
+}
+
+bool WorkStealingThreadPool::HasPendingTask() const {
+  if (global_size_.load() > 0) return true;
+  for (auto& worker : workers_) {
+    if (!worker->deque.Empty()) return true;
+  }
+  return false;
+}
+
+WorkStealingTask* WorkStealingThreadPool::FindTask(size_t index,
+                                                   uint64_t* rand_state) {
+  WorkStealingTask* task = workers_[index]->deque.Pop();
+  if (task != nullptr) return task;
+
+  task = PopGlobal();
+  if (task != nullptr) return task;
+
+  size_t num_workers = workers_.size();
+  if (num_workers > 1) {
+    size_t start = NextRandom(rand_state) % num_workers;
+    for (size_t i = 0; i < num_workers; ++i) {
+      size_t victim = (start + i) % num_workers;
+      if (victim == index) continue;
+      task = workers_[victim]->deque.Steal();
+      if (task != nullptr) return task;
+    }
+  }
+  return nullptr;
+}
+
+void WorkStealingThreadPool::WorkerLoop(size_t index) {
+  current_worker.pool = this;
+  current_worker.index = static_cast<int>(index);
+  uint64_t rand_state = 0x9E3779B97F4A7C15ULL * (index + 1);
+
+  // Spin a little before parking, ops of a graph tend to become ready in
+  // quick succession.
+  constexpr int kSpinRounds = 64;
+  int idle_rounds = 0;
+  while (true) {
+    WorkStealingTask* task = FindTask(index, &rand_state);
+    if (task != nullptr) {
+      idle_rounds = 0;
+      task->Run();
+      continue;
+    }
+    if (++idle_rounds < kSpinRounds) {
+      std::this_thread::yield();
+      continue;
+    }
+    idle_rounds = 0;
+
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    num_sleeping_.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    sleep_cv_.wait(lock, [this] {
+      return !running_.load() || HasPendingTask();
+    });
+    num_sleeping_.fetch_sub(1);
+    if (!running_.load() && !HasPendingTask()) break;
+  }
+  current_worker.pool = nullptr;
+  current_worker.index = -1;
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,126 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+#include "paddle/fluid/platform/macros.h"  // for DISABLE_COPY_AND_ASSIGN
+
+namespace paddle {
+namespace framework {
+
+// A unit of work for WorkStealingThreadPool. The pool never owns or copies
+// tasks: the caller keeps a task alive until it has run, which lets callers
+// reuse task storage instead of allocating on every submission.
+class WorkStealingTask {
+ public:
+  virtual ~WorkStealingTask() {}
+  virtual void Run() = 0;
+};
+
+// A bounded Chase-Lev work-stealing deque, following "Correct and Efficient
+// Work-Stealing for Weak Memory Models" (Le et al., PPoPP 2013). The owner
+// thread pushes and pops at the bottom, other threads steal from the top.
+// Push fails instead of growing when the deque is full.
+class WorkStealingDeque {
+ public:
+  explicit WorkStealingDeque(size_t capacity);
+
+  // Owner only.
+  bool Push(WorkStealingTask* task);
+  // Owner only. Returns nullptr if the deque is empty.
+  WorkStealingTask* Pop();
+  // Any thread. Returns nullptr if the deque is empty or the steal lost a
+  // race with another thread.
+  WorkStealingTask* Steal();
+
+  bool Empty() const;
+
+ private:
+  static constexpr size_t kCacheLineSize = 64;
+
+  std::unique_ptr<std::atomic<WorkStealingTask*>[]> buffer_;
+  int64_t mask_;
+  // Thieves write top_ and the owner writes bottom_, so they are padded onto
+  // different cache lines. The padding is explicit rather than alignas(64),
+  // which the deques allocated by new do not honor before C++17.
+  char top_pad_[kCacheLineSize];
+  std::atomic<int64_t> top_;
+  char bottom_pad_[kCacheLineSize - sizeof(std::atomic<int64_t>)];
+  std::atomic<int64_t> bottom_;
+  char end_pad_[kCacheLineSize - sizeof(std::atomic<int64_t>)];
+
+  DISABLE_COPY_AND_ASSIGN(WorkStealingDeque);
+};
+
+// WorkStealingThreadPool runs WorkStealingTasks on a fixed number of threads.
+// Each worker owns a WorkStealingDeque: tasks scheduled from a worker go to
+// its own deque and are run LIFO, while idle workers steal FIFO from the
+// others. Tasks scheduled from non-worker threads, or that overflow a full
+// deque, go to a shared mutex-protected queue.
+//
+// Unlike ThreadPool, scheduling does not allocate and returns no future;
+// callers track completion themselves. Exceptions must not escape
+// WorkStealingTask::Run.
+class WorkStealingThreadPool {
+ public:
+  static constexpr size_t kDequeCapacity = 4096;
+
+  explicit WorkStealingThreadPool(size_t num_threads);
+  ~WorkStealingThreadPool();
+
+  void Schedule(WorkStealingTask* task);
+
+  size_t NumThreads() const { return workers_.size(); }
+
+  // The index of the calling thread in this pool, or -1 if the calling thread
+  // is not one of its workers.
+  int CurrentWorkerIndex() const;
+
+ private:
+  struct Worker {
+    Worker() : deque(kDequeCapacity) {}
+    WorkStealingDeque deque;
+    std::thread thread;
+  };
+
+  void WorkerLoop(size_t index);
+  WorkStealingTask* FindTask(size_t index, uint64_t* rand_state);
+  WorkStealingTask* PopGlobal();
+  bool HasPendingTask() const;
+  void NotifyOne();
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  std::mutex global_mutex_;
+  std::deque<WorkStealingTask*> global_queue_;
+  std::atomic<size_t> global_size_{0};
+
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+  std::atomic<int> num_sleeping_{0};
+  std::atomic<bool> running_{true};
+
+  DISABLE_COPY_AND_ASSIGN(WorkStealingThreadPool);
+};
+
+}  // namespace framework
+}  // namespace paddle
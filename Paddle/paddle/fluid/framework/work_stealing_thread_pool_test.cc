@@ -0,0 +1,157 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/work_stealing_thread_pool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace framework = paddle::framework;
+
+namespace {
+
+class CountTask : public framework::WorkStealingTask {
+ public:
+  explicit CountTask(std::atomic<int>* counter = nullptr) : counter_(counter) {}
+  void Run() override { counter_->fetch_add(1); }
+
+ private:
+  std::atomic<int>* counter_;
+};
+
+// Spawns `fanout` children from inside the pool until `depth` reaches zero,
+// so that most tasks are scheduled from worker threads.
+class TreeTask : public framework::WorkStealingTask {
+ public:
+  TreeTask() = default;
+  void Init(framework::WorkStealingThreadPool* pool, TreeTask* nodes,
+            int index, int num_nodes, int fanout, std::atomic<int>* done) {
+    pool_ = pool;
+    nodes_ = nodes;
+    index_ = index;
+    num_nodes_ = num_nodes;
+    fanout_ = fanout;
+    done_ = done;
+  }
+  void Run() override {
+    EXPECT_GE(pool_->CurrentWorkerIndex(), 0);
+    for (int i = 1; i <= fanout_; ++i) {
+      int child = index_ * fanout_ + i;
+      if (child < num_nodes_) pool_->Schedule(&nodes_[child]);
+    }
+    done_->fetch_add(1);
+  }
+
+ private:
+  framework::WorkStealingThreadPool* pool_;
+  TreeTask* nodes_;
+  int index_;
+  int num_nodes_;
+  int fanout_;
+  std::atomic<int>* done_;
+};
+
+template <typename Pred>
+void WaitUntil(Pred pred) {
+  while (!pred()) std::this_thread::yield();
+}
+
+}  // namespace
+
+TEST(WorkStealingDeque, PushPopSteal) {
+  framework::WorkStealingDeque deque(4);
+  std::vector<CountTask> tasks(5);
+  EXPECT_TRUE(deque.Empty());
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(deque.Push(&tasks[i]));
+  }
+  EXPECT_FALSE(deque.Push(&tasks[4]));
+  // Owner pops LIFO, thieves steal FIFO.
+  EXPECT_EQ(deque.Pop(), &tasks[3]);
+  EXPECT_EQ(deque.Steal(), &tasks[0]);
+  EXPECT_EQ(deque.Steal(), &tasks[1]);
+  EXPECT_EQ(deque.Pop(), &tasks[2]);
+  EXPECT_EQ(deque.Pop(), nullptr);
+  EXPECT_EQ(deque.Steal(), nullptr);
+  EXPECT_TRUE(deque.Empty());
+}
+
+TEST(WorkStealingDeque, ConcurrentSteal) {
+  const int kNumTasks = 100000;
+  const int kNumThieves = 3;
+  framework::WorkStealingDeque deque(1024);
+  std::vector<CountTask> tasks(kNumTasks);
+  std::vector<std::atomic<int>> taken(kNumTasks);
+  for (auto& t : taken) t = 0;
+  std::atomic<int> num_taken{0};
+  auto take = [&](framework::WorkStealingTask* task) {
+    taken[static_cast<CountTask*>(task) - tasks.data()].fetch_add(1);
+    num_taken.fetch_add(1);
+  };
+
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < kNumThieves; ++i) {
+    thieves.emplace_back([&] {
+      while (num_taken.load() < kNumTasks) {
+        auto* task = deque.Steal();
+        if (task != nullptr) take(task);
+      }
+    });
+  }
+  for (int i = 0; i < kNumTasks; ++i) {
+    while (!deque.Push(&tasks[i])) {
+      auto* task = deque.Pop();
+      if (task != nullptr) take(task);
+    }
+    if (i % 3 == 0) {
+      auto* task = deque.Pop();
+      if (task != nullptr) take(task);
+    }
+  }
+  while (num_taken.load() < kNumTasks) {
+    auto* task = deque.Pop();
+    if (task != nullptr) take(task);
+  }
+  for (auto& th : thieves) th.join();
+  // Every task is taken exactly once.
+  for (auto& t : taken) EXPECT_EQ(t.load(), 1);
+}
+
+TEST(WorkStealingThreadPool, ScheduleFromOutside) {
+  const int kNumTasks = 1000;
+  std::atomic<int> counter{0};
+  std::vector<CountTask> tasks(kNumTasks, CountTask(&counter));
+  framework::WorkStealingThreadPool pool(4);
+  EXPECT_EQ(pool.CurrentWorkerIndex(), -1);
+  for (auto& task : tasks) pool.Schedule(&task);
+  WaitUntil([&] { return counter.load() == kNumTasks; });
+}
+
+TEST(WorkStealingThreadPool, ScheduleFromWorkers) {
+  // More nodes than a single deque can hold, to exercise the overflow path.
+  const int kNumNodes = 20000;
+  const int kFanout = 8;
+  std::atomic<int> done{0};
+  framework::WorkStealingThreadPool pool(4);
+  std::vector<TreeTask> nodes(kNumNodes);
+  for (int i = 0; i < kNumNodes; ++i) {
+    nodes[i].Init(&pool, nodes.data(), i, kNumNodes, kFanout, &done);
+  }
+  for (int round = 0; round < 3; ++round) {
+    done = 0;
+    pool.Schedule(&nodes[0]);
+    WaitUntil([&] { return done.load() == kNumNodes; });
+  }
+}
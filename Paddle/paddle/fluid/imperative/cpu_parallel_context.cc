@@ -0,0 +1,474 @@
+//   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/imperative/cpu_parallel_context.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/string/split.h"
+
+DECLARE_bool(cpu_parallel_use_shm);
+
+namespace paddle {
+namespace imperative {
+
+#if !defined(_WIN32)
+namespace detail {
+
+static std::pair<std::string, int> ParseEndpoint(const std::string &ep) {
+  auto addr = paddle::string::Split(ep, ':');
+  PADDLE_ENFORCE_EQ(addr.size(), 2UL,
+                    "The endpoint should contain host and port: %s", ep);
+  return std::make_pair(addr[0], std::stoi(addr[1]));
+}
+
+static void SendAll(int fd, const void *data, size_t size) {
+  auto *p = static_cast<const char *>(data);
+  while (size > 0) {
+    ssize_t n = send(fd, p, size, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) continue;
+    PADDLE_ENFORCE_GT(n, 0, "Sending to the trainer failed: %s",
+                      strerror(errno));
+    p += n;
+    size -= n;
+  }
+}
+
+static void RecvAll(int fd, void *data, size_t size) {
+  auto *p = static_cast<char *>(data);
+  while (size > 0) {
+    ssize_t n = recv(fd, p, size, 0);
+    if (n < 0 && errno == EINTR) continue;
+    PADDLE_ENFORCE_GT(n, 0, "Receiving from the trainer failed: %s",
+                      n == 0 ? "connection closed" : strerror(errno));
+    p += n;
+    size -= n;
+  }
+}
+
+// Sends and receives at the same time, so that the trainers of a ring, which
+// all send first, do not block each other on full socket buffers.
+static void SendRecv(int send_fd, const void *send_data, size_t send_size,
+                     int recv_fd, void *recv_data, size_t recv_size) {
+  auto *send_p = static_cast<const char *>(send_data);
+  auto *recv_p = static_cast<char *>(recv_data);
+  while (send_size > 0 || recv_size > 0) {
+    pollfd fds[2];
+    int num_fds = 0, send_idx = -1, recv_idx = -1;
+    if (send_size > 0) {
+      fds[num_fds] = {send_fd, POLLOUT, 0};
+      send_idx = num_fds++;
+    }
+    if (recv_size > 0) {
+      fds[num_fds] = {recv_fd, POLLIN, 0};
+      recv_idx = num_fds++;
+    }
+    int ret = poll(fds, num_fds, -1);
+    if (ret < 0 && errno == EINTR) continue;
+    PADDLE_ENFORCE_GT(ret, 0, "Polling the trainers failed: %s",
+                      strerror(errno));
+
+    if (send_idx >= 0 && fds[send_idx].revents != 0) {
+      ssize_t n = send(send_fd, send_p, send_size, MSG_DONTWAIT | MSG_NOSIGNAL);
+      if (n > 0) {
+        send_p += n;
+        send_size -= n;
+      } else {
+        PADDLE_ENFORCE(
+            errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR,
+            "Sending to the trainer failed: %s", strerror(errno));
+      }
+    }
+    if (recv_idx >= 0 && fds[recv_idx].revents != 0) {
+      ssize_t n = recv(recv_fd, recv_p, recv_size, MSG_DONTWAIT);
+      if (n > 0) {
+        recv_p += n;
+        recv_size -= n;
+      } else {
+        PADDLE_ENFORCE(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK ||
+                                 errno == EINTR),
+                       "Receiving from the trainer failed: %s",
+                       n == 0 ? "connection closed" : strerror(errno));
+      }
+    }
+  }
+}
+
+static void SetNoDelay(int fd) {
+  int opt = 1;
+  PADDLE_ENFORCE_EQ(setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt)),
+                    0, "Setting TCP_NODELAY failed: %s", strerror(errno));
+}
+
+// The trainers connected in a ring over TCP, each to the next one.
+class TCPRing : public CPUCollective {
+ public:
+  explicit TCPRing(const ParallelStrategy &strategy)
+      : rank_(strategy.local_rank_), nranks_(strategy.nranks_) {
+    if (nranks_ > 1) Connect(strategy);
+  }
+
+  ~TCPRing() {
+    if (next_fd_ >= 0) close(next_fd_);
+    if (prev_fd_ >= 0) close(prev_fd_);
+  }
+
+  void AllReduce(float *data, size_t numel) override {
+    if (nranks_ == 1) return;
+    // The data is split into a slice per trainer, the last ones may be
+    // shorter or empty.
+    size_t slice = (numel + nranks_ - 1) / nranks_;
+    auto begin = [&](int i) { return std::min(numel, i * slice); };
+    auto size = [&](int i) { return begin(i + 1) - begin(i); };
+    buffer_.resize(slice);
+
+    // Reduce-scatter, after which the trainer holds the sum of the slice
+    // (rank + 1) % nranks.
+    for (int step = 0; step < nranks_ - 1; ++step) {
+      int send_i = Mod(rank_ - step);
+      int recv_i = Mod(rank_ - step - 1);
+      SendRecv(next_fd_, data + begin(send_i), size(send_i) * sizeof(float),
+               prev_fd_, buffer_.data(), size(recv_i) * sizeof(float));
+      float *dst = data + begin(recv_i);
+      for (size_t j = 0; j < size(recv_i); ++j) dst[j] += buffer_[j];
+    }
+    // All-gather the summed slices.
+    for (int step = 0; step < nranks_ - 1; ++step) {
+      int send_i = Mod(rank_ + 1 - step);
+      int recv_i = Mod(rank_ - step);
+      SendRecv(next_fd_, data + begin(send_i), size(send_i) * sizeof(float),
+               prev_fd_, data + begin(recv_i), size(recv_i) * sizeof(float));
+    }
+  }
+
+  void Broadcast(void *data, size_t size, int root) override {
+    if (nranks_ == 1) return;
+    // Pipelined along the ring, which ends at the trainer before root.
+    constexpr size_t kChunkSize = 1 << 20;
+    auto *p = static_cast<char *>(data);
+    int last = Mod(root - 1);
+    for (size_t offset = 0; offset < size; offset += kChunkSize) {
+      size_t len = std::min(kChunkSize, size - offset);
+      if (rank_ != root) RecvAll(prev_fd_, p + offset, len);
+      if (rank_ != last) SendAll(next_fd_, p + offset, len);
+    }
+  }
+
+ private:
+  int Mod(int i) const { return (i % nranks_ + nranks_) % nranks_; }
+
+  void Connect(const ParallelStrategy &strategy) {
+    auto &eps = strategy.trainer_endpoints_;
+    int port = ParseEndpoint(strategy.current_endpoint_).second;
+
+    // Listen before connecting, so that the connection from the previous
+    // trainer waits in the backlog until it is accepted.
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    PADDLE_ENFORCE_GE(listen_fd, 0, "Creating socket failed: %s",
+                      strerror(errno));
+    int opt = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = htons(port);
+    PADDLE_ENFORCE_EQ(
+        bind(listen_fd, reinterpret_cast<sockaddr *>(&address),
+             sizeof(address)),
+        0, "Binding failed on ep %s: %s", strategy.current_endpoint_,
+        strerror(errno));
+    PADDLE_ENFORCE_EQ(listen(listen_fd, nranks_), 0,
+                      "Listening on ep %s failed: %s",
+                      strategy.current_endpoint_, strerror(errno));
+
+    next_fd_ = ConnectTo(eps[Mod(rank_ + 1)]);
+    SendAll(next_fd_, &rank_, sizeof(rank_));
+
+    prev_fd_ = accept(listen_fd, nullptr, nullptr);
+    PADDLE_ENFORCE_GE(prev_fd_, 0, "Accepting the trainer failed: %s",
+                      strerror(errno));
+    close(listen_fd);
+    int prev_rank = -1;
+    RecvAll(prev_fd_, &prev_rank, sizeof(prev_rank));
+    PADDLE_ENFORCE_EQ(prev_rank, Mod(rank_ - 1),
+                      "Trainer %d is connected by trainer %d instead of %d",
+                      rank_, prev_rank, Mod(rank_ - 1));
+    SetNoDelay(next_fd_);
+    SetNoDelay(prev_fd_);
+  }
+
+  static int ConnectTo(const std::string &ep) {
+    auto host_port = ParseEndpoint(ep);
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *result = nullptr;
+    PADDLE_ENFORCE_EQ(
+        getaddrinfo(host_port.first.c_str(),
+                    std::to_string(host_port.second).c_str(), &hints, &result),
+        0, "Invalid address: %s", ep);
+
+    for (int try_times = 0;; ++try_times) {
+      int fd = socket(AF_INET, SOCK_STREAM, 0);
+      PADDLE_ENFORCE_GE(fd, 0, "Creating socket failed: %s", strerror(errno));
+      if (connect(fd, result->ai_addr, result->ai_addrlen) == 0) {
+        freeaddrinfo(result);
+        return fd;
+      }
+      close(fd);
+      if (try_times % 30 == 0) {
+        VLOG(0) << "trainer: " << ep
+                << " is not ready, will retry after 100 milliseconds...";
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+  }
+
+  int rank_;
+  int nranks_;
+  int next_fd_{-1};
+  int prev_fd_{-1};
+  std::vector<float> buffer_;
+};
+
+// The trainers on one host, which share a memory segment with a slot for
+// each trainer and a barrier. The segment is created by trainer 0 and
+// unlinked once all trainers mapped it, so it is freed when they exit.
+class SharedMemoryCollective : public CPUCollective {
+ public:
+  static constexpr size_t kCacheLineSize = 64;
+  static constexpr size_t kSlotSize = 4 << 20;
+
+  SharedMemoryCollective(const ParallelStrategy &strategy, TCPRing *ring)
+      : rank_(strategy.local_rank_), nranks_(strategy.nranks_) {
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+                  "The barrier in shared memory must be lock free");
+    size_ = nranks_ * (kCacheLineSize + kSlotSize);
+
+    char name[64] = {0};
+    int fd = -1;
+    if (rank_ == 0) {
+      auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+      snprintf(name, sizeof(name), "/paddle_dygraph_%d_%lld",
+               static_cast<int>(getpid()),
+               static_cast<long long>(now));  // NOLINT
+      fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+      PADDLE_ENFORCE_GE(fd, 0, "Creating shared memory %s failed: %s", name,
+                        strerror(errno));
+      // Allocate the memory now, instead of failing with SIGBUS on first
+      // touch when /dev/shm is full.
+      int err = posix_fallocate(fd, 0, size_);
+      if (err != 0) {
+        close(fd);
+        shm_unlink(name);
+        PADDLE_THROW(
+            "Allocating %d bytes of shared memory failed: %s. Enlarge "
+            "/dev/shm or set FLAGS_cpu_parallel_use_shm=false",
+            size_, strerror(err));
+      }
+    }
+    ring->Broadcast(name, sizeof(name), 0);
+    if (rank_ != 0) {
+      fd = shm_open(name, O_RDWR, 0600);
+      PADDLE_ENFORCE_GE(fd, 0, "Opening shared memory %s failed: %s", name,
+                        strerror(errno));
+    }
+
+    void *base =
+        mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    PADDLE_ENFORCE(base != MAP_FAILED, "Mapping shared memory %s failed: %s",
+                   name, strerror(errno));
+    base_ = static_cast<char *>(base);
+    if (rank_ == 0) {
+      for (int r = 0; r < nranks_; ++r) {
+        new (Counter(r)) std::atomic<uint64_t>(0);
+      }
+    }
+    // The counters are initialized before anyone uses the segment.
+    ring->Broadcast(name, sizeof(name), 0);
+    Barrier();
+    if (rank_ == 0) shm_unlink(name);
+  }
+
+  ~SharedMemoryCollective() { munmap(base_, size_); }
+
+  // Every trainer copies its data into its slot, sums one slice of the
+  // slots, and then gathers the summed slices of the others.
+  void AllReduce(float *data, size_t numel) override {
+    constexpr size_t kChunkNumel = kSlotSize / sizeof(float);
+    constexpr size_t kAlignNumel = kCacheLineSize / sizeof(float);
+    for (size_t offset = 0; offset < numel; offset += kChunkNumel) {
+      size_t len = std::min(kChunkNumel, numel - offset);
+      std::memcpy(Slot(rank_), data + offset, len * sizeof(float));
+      Barrier();
+
+      size_t slice = (len + nranks_ - 1) / nranks_;
+      slice = (slice + kAlignNumel - 1) / kAlignNumel * kAlignNumel;
+      size_t begin = std::min(len, rank_ * slice);
+      size_t end = std::min(len, begin + slice);
+      float *dst = Slot(rank_);
+      for (int r = 0; r < nranks_; ++r) {
+        if (r == rank_) continue;
+        const float *src = Slot(r);
+        for (size_t j = begin; j < end; ++j) dst[j] += src[j];
+      }
+      Barrier();
+
+      for (int r = 0; r < nranks_; ++r) {
+        size_t r_begin = std::min(len, r * slice);
+        size_t r_end = std::min(len, r_begin + slice);
+        std::memcpy(data + offset + r_begin, Slot(r) + r_begin,
+                    (r_end - r_begin) * sizeof(float));
+      }
+      // The slots are free to be overwritten by the next chunk.
+      Barrier();
+    }
+  }
+
+  void Broadcast(void *data, size_t size, int root) override {
+    auto *p = static_cast<char *>(data);
+    for (size_t offset = 0; offset < size; offset += kSlotSize) {
+      size_t len = std::min(kSlotSize, size - offset);
+      if (rank_ == root) std::memcpy(Slot(root), p + offset, len);
+      Barrier();
+      if (rank_ != root) std::memcpy(p + offset, Slot(root), len);
+      Barrier();
+    }
+  }
+
+ private:
+  std::atomic<uint64_t> *Counter(int rank) {
+    return reinterpret_cast<std::atomic<uint64_t> *>(base_ +
+                                                     rank * kCacheLineSize);
+  }
+
+  float *Slot(int rank) {
+    return reinterpret_cast<float *>(base_ + nranks_ * kCacheLineSize +
+                                     rank * kSlotSize);
+  }
+
+  // Every trainer counts the barriers it reached, and waits for the others
+  // to reach the same count.
+  void Barrier() {
+    ++generation_;
+    Counter(rank_)->store(generation_, std::memory_order_release);
+    for (int r = 0; r < nranks_; ++r) {
+      for (size_t spins = 0;
+           Counter(r)->load(std::memory_order_acquire) < generation_;
+           ++spins) {
+        if (spins < 1024) continue;
+        if (spins < 4096) {
+          std::this_thread::yield();
+        } else {
+          std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+      }
+    }
+  }
+
+  int rank_;
+  int nranks_;
+  size_t size_;
+  char *base_{nullptr};
+  uint64_t generation_{0};
+};
+
+}  // namespace detail
+
+CPUParallelContext::CPUParallelContext(const ParallelStrategy &strategy,
+                                       const platform::Place &place)
+    : ParallelContext(strategy, place) {}
+
+CPUParallelContext::~CPUParallelContext() {}
+
+void CPUParallelContext::Init() {
+  PADDLE_ENFORCE(platform::is_cpu_place(place_),
+                 "CPUParallelContext only supports CPUPlace");
+  PADDLE_ENFORCE_EQ(strategy_.trainer_endpoints_.size(),
+                    static_cast<size_t>(strategy_.nranks_),
+                    "There should be an endpoint for each trainer");
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::unique_ptr<detail::TCPRing> ring(new detail::TCPRing(strategy_));
+
+  auto host = detail::ParseEndpoint(strategy_.current_endpoint_).first;
+  bool on_one_host = std::all_of(
+      strategy_.trainer_endpoints_.begin(), strategy_.trainer_endpoints_.end(),
+      [&](const std::string &ep) {
+        return detail::ParseEndpoint(ep).first == host;
+      });
+  use_shm_ = FLAGS_cpu_parallel_use_shm && on_one_host && strategy_.nranks_ > 1;
+  if (use_shm_) {
+    collective_.reset(
+        new detail::SharedMemoryCollective(strategy_, ring.get()));
+  } else {
+    collective_ = std::move(ring);
+  }
+  VLOG(0) << "init cpu parallel context nranks: " << strategy_.nranks_
+          << " local rank: " << strategy_.local_rank_
+          << (use_shm_ ? " over shared memory" : " over tcp");
+}
+
+void CPUParallelContext::AllReduce(framework::LoDTensor *tensor) {
+  PADDLE_ENFORCE(tensor->IsInitialized() &&
+                     platform::is_cpu_place(tensor->place()),
+                 "The tensor to all-reduce should be initialized on CPU");
+  PADDLE_ENFORCE_EQ(tensor->type(), framework::proto::VarType::FP32,
+                    "Only float tensors can be all-reduced on CPU");
+  AllReduce(tensor->mutable_data<float>(tensor->place()), tensor->numel());
+}
+
+void CPUParallelContext::AllReduce(float *data, size_t numel) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  PADDLE_ENFORCE_NOT_NULL(collective_, "CPUParallelContext is not initialized");
+  collective_->AllReduce(data, numel);
+}
+
+void CPUParallelContext::Broadcast(framework::LoDTensor *tensor, int root) {
+  PADDLE_ENFORCE(tensor->IsInitialized() &&
+                     platform::is_cpu_place(tensor->place()),
+                 "The tensor to broadcast should be initialized on CPU");
+  std::lock_guard<std::mutex> guard(mutex_);
+  PADDLE_ENFORCE_NOT_NULL(collective_, "CPUParallelContext is not initialized");
+  auto type = tensor->type();
+  collective_->Broadcast(tensor->mutable_data(tensor->place(), type),
+                         tensor->numel() * framework::SizeOfType(type), root);
+}
+
+bool CPUParallelContext::UseSharedMemory() const { return use_shm_; }
+#endif
+
+}  //  namespace imperative
+}  //  namespace paddle
@@ -0,0 +1,83 @@
+//   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/imperative/nccl_context.h"
+
+namespace paddle {
+namespace imperative {
+
+#if !defined(_WIN32)
+namespace detail {
+
+// The connections between trainers used by CPUParallelContext.
+class CPUCollective {
+ public:
+  virtual ~CPUCollective() {}
+
+  // Sums data over all trainers in place.
+  virtual void AllReduce(float* data, size_t numel) = 0;
+
+  // Copies the data of root to all trainers.
+  virtual void Broadcast(void* data, size_t size, int root) = 0;
+};
+
+}  // namespace detail
+
+/*
+ * The parallel context of data parallel dygraph training on CPU, where
+ * every trainer is a process, e.g. pinned to one NUMA node of the host.
+ *
+ * The trainers connect to each other in a ring over TCP through their
+ * endpoints. When all of them are on one host, they all-reduce through a
+ * POSIX shared memory segment instead, which every trainer reduces one slice
+ * of and then gathers the others from. Otherwise they run a ring all-reduce
+ * over TCP. See FLAGS_cpu_parallel_use_shm.
+ */
+class CPUParallelContext : public ParallelContext {
+ public:
+  CPUParallelContext(const ParallelStrategy& strategy,
+                     const platform::Place& place);
+
+  ~CPUParallelContext();
+
+  void Init() override;
+
+  // Sums the float tensor over all trainers in place. All trainers must
+  // call the collectives in the same order.
+  void AllReduce(framework::LoDTensor* tensor);
+
+  void AllReduce(float* data, size_t numel);
+
+  // Copies the tensor of root to all trainers.
+  void Broadcast(framework::LoDTensor* tensor, int root);
+
+  // Whether the trainers communicate through shared memory.
+  bool UseSharedMemory() const;
+
+ private:
+  std::unique_ptr<detail::CPUCollective> collective_;
+  bool use_shm_{false};
+  std::mutex mutex_;
+};
+#endif
+
+}  //  namespace imperative
+}  //  namespace paddle
@@ -30,6 +30,80 @@
 namespace paddle {
 namespace imperative {
 
+void CheckpointSegment::AddOp(std::shared_ptr<OpBase> op,
+                              const NameVarBaseMap& ins,
+                              const NameVarBaseMap& outs) {
+  // The ops only writing persistable variables, e.g. the initializers of the
+  // parameters created in the first forward, must not be run again.
+  bool only_persistable = true;
+  for (auto& pair : outs) {
+    for (auto& var : pair.second) {
+      if (var && !var->Persistable()) only_persistable = false;
+    }
+  }
+  if (only_persistable) return;
+
+  for (auto& pair : ins) {
+    for (auto& var : pair.second) {
+      if (var && written_.count(var.get()) == 0) {
+        inputs_.insert(var.get());
+      }
+    }
+  }
+  // The persistable outputs, e.g. the running statistics of batch_norm, were
+  // updated by the forward already, so the recomputation writes them to
+  // scratch variables instead of updating them twice.
+  NameVarBaseMap replay_outs = outs;
+  for (auto& pair : replay_outs) {
+    for (auto& var : pair.second) {
+      if (!var) continue;
+      if (!var->Persistable()) {
+        written_.insert(var.get());
+        continue;
+      }
+      auto scratch = std::make_shared<VarBase>(false, var->Name());
+      scratch->SetType(var->Type());
+      scratch->SetDataType(var->DataType());
+      var = std::move(scratch);
+    }
+  }
+  ops_.emplace_back(ForwardOp{std::move(op), ins, std::move(replay_outs)});
+}
+
+size_t CheckpointSegment::Release(
+    const std::vector<std::shared_ptr<VarBase>>& outputs) {
+  // The inputs of the segment, e.g. the running statistics updated in place,
+  // are kept as well as the outputs.
+  std::unordered_set<VarBase*> kept(inputs_);
+  for (auto& var : outputs) {
+    kept.insert(var.get());
+  }
+  size_t released = 0;
+  for (auto* var : written_) {
+    if (kept.count(var) > 0 || var->Persistable() ||
+        !var->Var().IsType<framework::LoDTensor>()) {
+      continue;
+    }
+    auto* tensor = var->MutableVar()->GetMutable<framework::LoDTensor>();
+    if (!tensor->IsInitialized()) continue;
+    released += tensor->memory_size();
+    ReleaseMemoryAsync(var->MutableVar());
+    tensor->clear();
+  }
+  return released;
+}
+
+void CheckpointSegment::Recompute() {
+  if (recomputed_) return;
+  platform::RecordEvent record_event("recompute");
+  VLOG(3) << "Recompute " << ops_.size() << " forward op(s) of checkpoint";
+  for (auto& fwd_op : ops_) {
+    fwd_op.op->Run(fwd_op.ins, fwd_op.outs);
+  }
+  ops_.clear();
+  recomputed_ = true;
+}
+
 void Engine::RunOp(paddle::imperative::OpBase* op,
                    const paddle::imperative::NameVarBaseMap& ins,
                    const paddle::imperative::NameVarBaseMap& outs,
@@ -176,6 +250,9 @@ void BasicEngine::SumGradient(OpBase* op, std::shared_ptr<VarBase> src,
   PADDLE_ENFORCE_EQ(iter != accumulators_.end(), true,
                     "Cannot find gradient of variable %s", dst->Name());
   iter->second->Add(std::move(src), op->id());
+  if (iter->second->SumGradCompleted()) {
+    OnGradReady(dst);
+  }
 }
 void BasicEngine::Execute() {
   PrepareDeps();
@@ -211,6 +288,7 @@ void BasicEngine::Execute() {
     }
 
     VLOG(3) << "Start to execute grad op " << cur_op->Type();
+    RecomputeIfNeeded(cur_op);
     RunOp(cur_op, bwd_ins, tmp_outs, cur_op->place());
     // Step 2: Sum Gradient
     {
@@ -16,6 +16,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
@@ -28,6 +29,39 @@
 namespace paddle {
 namespace imperative {
 
+// The forward ops traced inside a checkpointed layer. The outputs which are
+// only used inside the layer are released after the forward, and the ops are
+// run again to recompute them before the first grad op of the layer runs.
+// The random seeds of the ops are fixed by the tracer, so the recomputed
+// outputs are the same as the released ones. Persistable outputs are not
+// written again by the recomputation.
+class CheckpointSegment {
+ public:
+  void AddOp(std::shared_ptr<OpBase> op, const NameVarBaseMap& ins,
+             const NameVarBaseMap& outs);
+
+  // Releases the memory of the outputs of the ops except the given outputs
+  // of the layer, and returns the number of the released bytes.
+  size_t Release(const std::vector<std::shared_ptr<VarBase>>& outputs);
+
+  // Runs the forward ops again, only once. The ops are dropped afterwards so
+  // that the recomputed outputs are released along with the grad ops.
+  void Recompute();
+
+ private:
+  struct ForwardOp {
+    std::shared_ptr<OpBase> op;
+    NameVarBaseMap ins;
+    NameVarBaseMap outs;
+  };
+
+  std::vector<ForwardOp> ops_;
+  // The variables read by the ops before any op writes them.
+  std::unordered_set<VarBase*> inputs_;
+  std::unordered_set<VarBase*> written_;
+  bool recomputed_{false};
+};
+
 // It seems there is no need for Engine to be an
 // singleton, we can have multi-engine to run
 // mutil-graoh. For future use we may expose a interface
@@ -45,6 +79,7 @@ class Engine {
     auto iter = grad_ops_.find(op);
     PADDLE_ENFORCE_EQ(iter != grad_ops_.end(), true, "Op is not inside tracer");
     grad_ops_.erase(iter);
+    checkpoint_ops_.erase(op);
   }
 
   void InsertOp(OpBase* op, std::shared_ptr<OpBase> op_shared) {
@@ -53,17 +88,49 @@ class Engine {
 
   void InsertGradVar(VarBase* grad) { grad_vars_.emplace(grad); }
 
+  // Marks op as a grad op of the checkpointed segment.
+  void InsertCheckpointOp(OpBase* op, std::shared_ptr<CheckpointSegment> seg) {
+    checkpoint_ops_[op] = std::move(seg);
+  }
+
   bool IsGrad(VarBase* var) { return grad_vars_.count(var) > 0; }
 
   void Clear() {
     grad_ops_.clear();
     grad_vars_.clear();
+    checkpoint_ops_.clear();
+  }
+
+  // The hook is called with the gradient of a variable as soon as all its
+  // gradients are summed during backward, e.g. to communicate the gradient
+  // while the rest of backward runs.
+  void AddGradReadyHook(std::function<void(VarBase*)> hook) {
+    grad_ready_hooks_.emplace_back(std::move(hook));
+  }
+
+ protected:
+  void OnGradReady(VarBase* grad) {
+    for (auto& hook : grad_ready_hooks_) {
+      hook(grad);
+    }
+  }
+
+  // Recomputes the forward outputs needed by op if it is a grad op of a
+  // checkpointed segment.
+  void RecomputeIfNeeded(OpBase* op) {
+    auto iter = checkpoint_ops_.find(op);
+    if (iter != checkpoint_ops_.end()) {
+      iter->second->Recompute();
+    }
   }
 
  private:
   std::unordered_map<OpBase*, std::shared_ptr<OpBase>>
       grad_ops_;  // opBase for remove - grad_op
   std::unordered_set<VarBase*> grad_vars_;
+  std::unordered_map<OpBase*, std::shared_ptr<CheckpointSegment>>
+      checkpoint_ops_;
+  std::vector<std::function<void(VarBase*)>> grad_ready_hooks_;
 };
 
 class BasicEngine : public Engine {
@@ -16,11 +16,13 @@
 #include <algorithm>
 #include <memory>
 #include <utility>
+#include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/imperative/layer.h"
 #include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/math/selected_rows_functor.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/profiler.h"
 
@@ -102,13 +104,90 @@ void TensorAdd(const framework::Variable& src, framework::Variable* dst) {
                framework::DataTypeToString(data_type));
 }
 
+static platform::Place GetPlaceOfVar(const framework::Variable& var) {
+  if (var.IsType<framework::SelectedRows>()) {
+    return var.Get<framework::SelectedRows>().value().place();
+  }
+  return var.Get<framework::LoDTensor>().place();
+}
+
+template <typename DeviceContext>
+static void SelectedRowsAddToDense(const framework::SelectedRows& src,
+                                   framework::Tensor* dst) {
+  auto* dev_ctx = dynamic_cast<DeviceContext*>(
+      platform::DeviceContextPool::Instance().Get(src.value().place()));
+  auto data_type = src.value().type();
+
+#define PADDLE_SELECTED_ROWS_ADD_MACRO(cpp_type)                              \
+  if (data_type == framework::DataTypeTrait<cpp_type>::DataType()) {          \
+    operators::math::SelectedRowsAddToTensor<DeviceContext, cpp_type> func;   \
+    func(*dev_ctx, src, dst);                                                 \
+    return;                                                                   \
+  }
+
+  PADDLE_SELECTED_ROWS_ADD_MACRO(float);
+  PADDLE_SELECTED_ROWS_ADD_MACRO(double);
+
+#undef PADDLE_SELECTED_ROWS_ADD_MACRO
+
+  PADDLE_THROW("Not supported data type %s for AddTo",
+               framework::DataTypeToString(data_type));
+}
+
+// Sums src into the gradient of var kept from the previous backward. The
+// kept gradient is always dense, so a sparse src is scattered into it.
+static void AccumulateGrad(framework::Variable* src, VarBase* var) {
+  auto* dst = var->MutableVar();
+  bool dst_is_dense = dst->IsInitialized() &&
+                      dst->IsType<framework::LoDTensor>() &&
+                      dst->Get<framework::LoDTensor>().IsInitialized();
+  if (src->IsType<framework::LoDTensor>()) {
+    if (dst_is_dense) {
+      TensorAdd(*src, dst);
+    } else {
+      *dst = std::move(*src);
+    }
+    return;
+  }
+
+  PADDLE_ENFORCE_EQ(src->IsType<framework::SelectedRows>(), true,
+                    "Only LoDTensor and SelectedRows gradients of %s can be "
+                    "accumulated",
+                    var->Name());
+  auto& rows = src->Get<framework::SelectedRows>();
+  auto place = rows.value().place();
+  if (!dst_is_dense) {
+    dst->Clear();
+    auto* tensor = dst->GetMutable<framework::LoDTensor>();
+    auto dims = rows.value().dims();
+    dims[0] = rows.height();
+    tensor->Resize(dims);
+    tensor->mutable_data(place, rows.value().type());
+    auto* dev_ctx = platform::DeviceContextPool::Instance().Get(place);
+    operators::math::set_constant(*dev_ctx, tensor, 0.0);
+  }
+
+  auto* dst_tensor = dst->GetMutable<framework::LoDTensor>();
+  if (platform::is_cpu_place(place)) {
+    SelectedRowsAddToDense<platform::CPUDeviceContext>(rows, dst_tensor);
+#ifdef PADDLE_WITH_CUDA
+  } else if (platform::is_gpu_place(place)) {
+    SelectedRowsAddToDense<platform::CUDADeviceContext>(rows, dst_tensor);
+#endif
+  } else {
+    PADDLE_THROW("Do NOT support gradient merge in place %s", place);
+  }
+}
+
 void EagerGradientAccumulator::Add(std::shared_ptr<VarBase> var,
                                    size_t trace_id) {
   auto* dst_var = var_->MutableVar();
-  auto place = var->Var().Get<framework::LoDTensor>().place();
+  auto place = GetPlaceOfVar(var->Var());
   if (!var_->OverridedStopGradient()) {
     VLOG(3) << "Sum Gradient for: " << var_->Name();
-    if (cur_cnt_ == 0) {
+    if (var_->AccumulateGrad()) {
+      AccumulateGrad(var->MutableVar(), var_);
+    } else if (cur_cnt_ == 0) {
       *dst_var = std::move(*(var->MutableVar()));
     } else {
       TensorAdd(var->Var(), dst_var);
@@ -138,11 +217,16 @@ void EagerGradientAccumulator::Add(std::shared_ptr<VarBase> var,
 
 void SortedGradientAccumulator::Add(std::shared_ptr<VarBase> var,
                                     size_t trace_id) {
+  ++cur_cnt_;
   auto* dst_var = var_->MutableVar();
-  auto place = var->Var().Get<framework::LoDTensor>().place();
+  auto place = GetPlaceOfVar(var->Var());
   if (!var_->OverridedStopGradient()) {
     if (ref_cnt_ == 1) {
-      *dst_var = std::move(*(var->MutableVar()));
+      if (var_->AccumulateGrad()) {
+        AccumulateGrad(var->MutableVar(), var_);
+      } else {
+        *dst_var = std::move(*(var->MutableVar()));
+      }
     } else {
       if (tmp_grad_vars_.empty()) {
         tmp_grad_vars_.reserve(ref_cnt_);
@@ -160,9 +244,15 @@ void SortedGradientAccumulator::Add(std::shared_ptr<VarBase> var,
                   return p1.second > p2.second;
                 });
 
-      *dst_var = std::move(*(tmp_grad_vars_[0].first->MutableVar()));
-      for (size_t i = 1; i < tmp_grad_vars_.size(); ++i) {
-        TensorAdd(tmp_grad_vars_[i].first->Var(), dst_var);
+      if (var_->AccumulateGrad()) {
+        for (auto& pair : tmp_grad_vars_) {
+          AccumulateGrad(pair.first->MutableVar(), var_);
+        }
+      } else {
+        *dst_var = std::move(*(tmp_grad_vars_[0].first->MutableVar()));
+        for (size_t i = 1; i < tmp_grad_vars_.size(); ++i) {
+          TensorAdd(tmp_grad_vars_[i].first->Var(), dst_var);
+        }
       }
 
       tmp_grad_vars_.clear();
@@ -190,5 +280,88 @@ void SortedGradientAccumulator::Add(std::shared_ptr<VarBase> var,
   }
 }
 
+GradientBuffer::GradientBuffer(
+    const std::vector<std::shared_ptr<VarBase>>& params)
+    : params_(params),
+      buffer_(std::make_shared<VarBase>(false, "@GRAD_BUFFER@")) {
+  PADDLE_ENFORCE_EQ(params_.empty(), false,
+                    "There should be parameters to buffer the gradients of");
+  auto& first = params_[0]->Var().Get<framework::LoDTensor>();
+  PADDLE_ENFORCE(first.IsInitialized(), "Parameter %s is not initialized",
+                 params_[0]->Name());
+  auto place = first.place();
+  auto data_type = first.type();
+  int64_t numel = 0;
+  for (auto& param : params_) {
+    PADDLE_ENFORCE(param->HasGradVar(), "Parameter %s has no gradient",
+                   param->Name());
+    auto& tensor = param->Var().Get<framework::LoDTensor>();
+    PADDLE_ENFORCE(tensor.IsInitialized(), "Parameter %s is not initialized",
+                   param->Name());
+    PADDLE_ENFORCE_EQ(tensor.type(), data_type,
+                      "Parameter %s should be of the same data type as the "
+                      "others",
+                      param->Name());
+    PADDLE_ENFORCE(platform::is_same_place(tensor.place(), place),
+                   "Parameter %s should be on the same place as the others",
+                   param->Name());
+    PADDLE_ENFORCE_GT(tensor.numel(), 0, "Parameter %s is empty",
+                      param->Name());
+    offsets_.emplace_back(numel);
+    numel += tensor.numel();
+  }
+
+  buffer_->SetDataType(data_type);
+  auto* buffer = buffer_->MutableVar()->GetMutable<framework::LoDTensor>();
+  buffer->Resize({numel});
+  buffer->mutable_data(place, data_type);
+  for (size_t i = 0; i < params_.size(); ++i) {
+    ShareBuffer(i);
+    params_[i]->SetAccumulateGrad(true);
+  }
+  Clear();
+  VLOG(3) << "Buffer the gradients of " << params_.size() << " parameters in "
+          << numel << " elements";
+}
+
+void GradientBuffer::Clear() {
+  platform::RecordEvent record_event("clear_grad_buffer");
+  auto* buffer = buffer_->MutableVar()->GetMutable<framework::LoDTensor>();
+  auto* dev_ctx = platform::DeviceContextPool::Instance().Get(buffer->place());
+  operators::math::set_constant(*dev_ctx, buffer, 0.0);
+  for (size_t i = 0; i < params_.size(); ++i) {
+    if (!IsView(i)) {
+      VLOG(3) << "Share the gradient buffer with " << params_[i]->Name()
+              << " again";
+      ShareBuffer(i);
+    }
+  }
+}
+
+bool GradientBuffer::IsView(size_t i) const {
+  auto& var = params_[i]->GradVar();
+  if (!var.IsType<framework::LoDTensor>()) return false;
+  auto& grad = var.Get<framework::LoDTensor>();
+  auto& buffer = buffer_->Var().Get<framework::LoDTensor>();
+  return grad.Holder() == buffer.Holder() &&
+         grad.offset() == static_cast<size_t>(offsets_[i]) *
+                              framework::SizeOfType(buffer.type());
+}
+
+void GradientBuffer::ShareBuffer(size_t i) {
+  auto& param = params_[i]->Var().Get<framework::LoDTensor>();
+  auto& buffer = buffer_->Var().Get<framework::LoDTensor>();
+  auto* var = params_[i]->MutableGradVar();
+  if (var->IsInitialized() && !var->IsType<framework::LoDTensor>()) {
+    // A sparse gradient left from before buffering is dropped; the sparse
+    // gradients of later backwards are scattered into this dense view.
+    var->Clear();
+  }
+  auto* grad = var->GetMutable<framework::LoDTensor>();
+  grad->ShareDataWith(buffer.Slice(offsets_[i], offsets_[i] + param.numel()));
+  grad->Resize(param.dims());
+  grad->set_lod(framework::LoD());
+}
+
 }  // namespace imperative
 }  // namespace paddle
@@ -34,9 +34,13 @@ class GradientAccumulator {
 
   inline size_t RefCnt() const { return ref_cnt_; }
 
+  // Whether all the gradients of the variable are added.
+  inline bool SumGradCompleted() const { return cur_cnt_ == ref_cnt_; }
+
  protected:
   VarBase* var_;
   size_t ref_cnt_{0};
+  size_t cur_cnt_{0};
 };
 
 class EagerGradientAccumulator : public GradientAccumulator {
@@ -44,9 +48,6 @@ class EagerGradientAccumulator : public GradientAccumulator {
   using GradientAccumulator::GradientAccumulator;
 
   void Add(std::shared_ptr<VarBase> var, size_t trace_id) override;
-
- private:
-  size_t cur_cnt_{0};
 };
 
 class SortedGradientAccumulator : public GradientAccumulator {
@@ -59,5 +60,36 @@ class SortedGradientAccumulator : public GradientAccumulator {
   std::vector<std::pair<std::shared_ptr<VarBase>, size_t>> tmp_grad_vars_;
 };
 
+/*
+ * Keeps the gradients of parameters in one contiguous buffer.
+ *
+ * The gradient of each parameter is a view of the buffer with the shape of
+ * the parameter, and is accumulated across backward in place. So all the
+ * gradients are cleared by one memset, and the buffer can be all-reduced or
+ * read as a whole. The parameters should be initialized, and be of the same
+ * data type and place.
+ */
+class GradientBuffer {
+ public:
+  explicit GradientBuffer(const std::vector<std::shared_ptr<VarBase>>& params);
+
+  // Zeros the buffer. The gradients replaced by other tensors since, e.g.
+  // by an op writing them, are views of the buffer again.
+  void Clear();
+
+  const std::shared_ptr<VarBase>& Buffer() const { return buffer_; }
+
+  size_t NumParams() const { return params_.size(); }
+
+ private:
+  bool IsView(size_t i) const;
+
+  void ShareBuffer(size_t i);
+
+  std::vector<std::shared_ptr<VarBase>> params_;
+  std::vector<int64_t> offsets_;
+  std::shared_ptr<VarBase> buffer_;
+};
+
 }  // namespace imperative
 }  // namespace paddle
@@ -14,8 +14,10 @@
 
 #include "paddle/fluid/imperative/layer.h"
 #include <algorithm>
+#include <deque>
 #include <queue>
 #include <utility>
+#include "paddle/fluid/framework/garbage_collector.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/variable_helper.h"
 #include "paddle/fluid/imperative/prepared_operator.h"
@@ -28,6 +30,27 @@ namespace paddle {
 namespace imperative {
 
 using framework::Variable;
+
+void ReleaseMemoryAsync(Variable* var) {
+  if (!framework::IsAsyncCPUGarbageCollectionEnabled()) return;
+  framework::Tensor* tensor = nullptr;
+  if (var->IsType<framework::LoDTensor>()) {
+    tensor = var->GetMutable<framework::LoDTensor>();
+  } else if (var->IsType<framework::SelectedRows>()) {
+    tensor = var->GetMutable<framework::SelectedRows>()->mutable_value();
+  }
+  if (tensor == nullptr || !tensor->IsInitialized() ||
+      !platform::is_cpu_place(tensor->place())) {
+    return;
+  }
+  // Never destroyed, since variables may be destroyed at exit.
+  static auto* gc =
+      new framework::AsyncCPUGarbageCollector(platform::CPUPlace(), 0);
+  std::deque<std::shared_ptr<memory::Allocation>> garbages;
+  garbages.emplace_back(tensor->MoveMemoryHolder());
+  gc->Add(std::move(garbages));
+}
+
 void ThreadSafeNameSet::Insert(const std::string& name) {
   std::lock_guard<std::mutex> guard(mtx_);
   set_.insert(name);
@@ -39,6 +39,10 @@ namespace imperative {
 
 class OpBase;
 
+// Moves the memory of a CPU tensor held by var to the background garbage
+// collection thread when FLAGS_async_cpu_garbage_collection is set.
+void ReleaseMemoryAsync(framework::Variable* var);
+
 class ThreadSafeNameSet {
  public:
   void Insert(const std::string& name);
@@ -73,6 +77,7 @@ class VarBase {
     if (IsDebugEnabled()) {
       name_set_.Remove(name_);
     }
+    ReleaseMemoryAsync(&var_);
   }
 
   const framework::Variable& Var() const { return var_; }
@@ -136,6 +141,17 @@ class VarBase {
 
   bool Persistable() const { return persistable_; }
 
+  // Whether the gradients of successive backward are summed into the
+  // gradient kept so far instead of replacing it.
+  void SetAccumulateGrad(bool accumulate) {
+    accumulate_grad_ = accumulate;
+    if (grad_var_) {
+      grad_var_->SetAccumulateGrad(accumulate);
+    }
+  }
+
+  bool AccumulateGrad() const { return accumulate_grad_; }
+
   void AddGradOps(const std::weak_ptr<OpBase>& op);
 
   std::vector<OpBase*> GradOps() {
@@ -192,6 +208,7 @@ class VarBase {
   int overrided_stop_gradient_{-1};
   bool grad_generated_{false};
   bool persistable_{false};
+  bool accumulate_grad_{false};
 
   framework::proto::VarType::Type type_{framework::proto::VarType::LOD_TENSOR};
   framework::proto::VarType::Type data_type_{framework::proto::VarType::FP32};
@@ -14,6 +14,8 @@
 
 #include "paddle/fluid/imperative/prepared_operator.h"
 #include <sstream>
+#include <unordered_map>
+#include "paddle/fluid/platform/op_metrics.h"
 
 namespace paddle {
 namespace imperative {
@@ -58,16 +60,34 @@ void PreparedOp::PrepareData(
   }
 }
 
+// Every dygraph op is prepared anew, so the interned metrics key is cached
+// per thread to avoid formatting the kernel key on each run.
+static int GetOpMetricsKey(const std::string& op_type,
+                           const framework::OpKernelType& kernel_key) {
+  static thread_local std::unordered_map<
+      std::string, std::unordered_map<size_t, int>>
+      cache;
+  auto& keys = cache[op_type];
+  auto iter = keys.find(kernel_key.hash_key());
+  if (iter != keys.end()) return iter->second;
+  int key = platform::OpMetricsRegistry::Instance().GetOrCreateKey(
+      op_type, framework::KernelTypeToString(kernel_key));
+  keys.emplace(kernel_key.hash_key(), key);
+  return key;
+}
+
 PreparedOp::PreparedOp(const framework::OperatorBase& op,
                        const framework::RuntimeContext& ctx,
                        framework::OperatorWithKernel::OpKernelFunc func,
                        platform::DeviceContext* dev_ctx,
-                       std::vector<framework::KernelConfig>* kernel_configs)
+                       std::vector<framework::KernelConfig>* kernel_configs,
+                       int metrics_key)
     : op_(op),
       ctx_(ctx),
       func_(std::move(func)),
       dev_ctx_(dev_ctx),
-      kernel_configs_(kernel_configs) {}
+      kernel_configs_(kernel_configs),
+      metrics_key_(metrics_key) {}
 
 PreparedOp PreparedOp::Prepare(const framework::RuntimeContext& ctx,
                                const framework::OperatorWithKernel& op,
@@ -107,10 +127,17 @@ PreparedOp PreparedOp::Prepare(const framework::RuntimeContext& ctx,
   }
 
   PrepareData(place, ins, op, expected_kernel_key);
-  return PreparedOp(op, ctx, kernel_iter->second, dev_ctx, kernel_configs);
+  int metrics_key = FLAGS_enable_op_metrics
+                        ? GetOpMetricsKey(op.Type(), expected_kernel_key)
+                        : -1;
+  return PreparedOp(op, ctx, kernel_iter->second, dev_ctx, kernel_configs,
+                    metrics_key);
 }
 
 void PreparedOp::Run() {
+  platform::RecordOpMetrics record_metrics(
+      metrics_key_,
+      metrics_key_ < 0 ? 0 : framework::MaxInputNumel(ctx_));
   // TODO(zjl): remove scope in dygraph
   framework::Scope scope;
   op_.RuntimeInferShape(scope, dev_ctx_->GetPlace(), ctx_);
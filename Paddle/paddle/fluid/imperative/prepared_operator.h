@@ -48,7 +48,8 @@ class PreparedOp {
              const framework::RuntimeContext& ctx,
              framework::OperatorWithKernel::OpKernelFunc func,
              platform::DeviceContext* dev_ctx,
-             std::vector<framework::KernelConfig>* kernel_configs);
+             std::vector<framework::KernelConfig>* kernel_configs,
+             int metrics_key);
 
  private:
   const framework::OperatorBase& op_;
@@ -56,6 +57,7 @@ class PreparedOp {
   framework::OperatorWithKernel::OpKernelFunc func_;
   platform::DeviceContext* dev_ctx_;
   std::vector<framework::KernelConfig>* kernel_configs_;
+  int metrics_key_;
 };
 
 }  // namespace imperative
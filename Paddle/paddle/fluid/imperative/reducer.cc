@@ -0,0 +1,168 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/imperative/reducer.h"
+
+#if !defined(_WIN32)
+#include <algorithm>
+#include <cstring>
+
+namespace paddle {
+namespace imperative {
+
+static bool IsInitializedTensor(const framework::Variable& var) {
+  if (!var.IsInitialized()) return false;
+  PADDLE_ENFORCE(var.IsType<framework::LoDTensor>(),
+                 "Only dense gradients can be all-reduced on CPU");
+  return var.Get<framework::LoDTensor>().IsInitialized();
+}
+
+Reducer::Reducer(std::shared_ptr<CPUParallelContext> ctx,
+                 const std::vector<std::shared_ptr<VarBase>>& params,
+                 size_t bucket_size)
+    : ctx_(std::move(ctx)), params_(params) {
+  PADDLE_ENFORCE_NOT_NULL(ctx_, "The parallel context should not be null");
+  size_t bucket_bytes = 0;
+  for (auto& param : params_) {
+    PADDLE_ENFORCE(param->HasGradVar(), "Parameter %s has no gradient",
+                   param->Name());
+    PADDLE_ENFORCE_EQ(param->DataType(), framework::proto::VarType::FP32,
+                      "Only float parameters can be all-reduced on CPU");
+    auto& tensor = param->Var().Get<framework::LoDTensor>();
+    PADDLE_ENFORCE(tensor.IsInitialized(), "Parameter %s is not initialized",
+                   param->Name());
+
+    if (buckets_.empty() || bucket_bytes >= bucket_size) {
+      buckets_.emplace_back();
+      bucket_bytes = 0;
+    }
+    auto& bucket = buckets_.back();
+    auto* grad = param->GradVarBase().get();
+    PADDLE_ENFORCE(locations_.count(grad) == 0,
+                   "Parameter %s is reduced twice", param->Name());
+    locations_[grad] = std::make_pair(buckets_.size() - 1, bucket.grads.size());
+    bucket.grads.emplace_back(grad);
+    bucket.offsets.emplace_back(bucket.numel);
+    bucket.numels.emplace_back(tensor.numel());
+    bucket.ready.emplace_back(false);
+    bucket.numel += tensor.numel();
+    bucket.pending = bucket.grads.size();
+    bucket_bytes += tensor.numel() * sizeof(float);
+  }
+  VLOG(3) << "Reduce " << params_.size() << " parameters in "
+          << buckets_.size() << " buckets";
+  thread_ = std::thread([this] { Run(); });
+}
+
+Reducer::~Reducer() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stop_ = true;
+  }
+  ready_cv_.notify_all();
+  thread_.join();
+}
+
+void Reducer::MarkGradReady(VarBase* grad) {
+  auto iter = locations_.find(grad);
+  if (iter == locations_.end()) return;
+  bool notify = false;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto& bucket = buckets_[iter->second.first];
+    if (bucket.ready[iter->second.second]) return;
+    bucket.ready[iter->second.second] = true;
+    notify = --bucket.pending == 0;
+  }
+  if (notify) ready_cv_.notify_all();
+}
+
+void Reducer::Finalize() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (auto& bucket : buckets_) {
+    bucket.pending = 0;
+  }
+  ready_cv_.notify_all();
+  done_cv_.wait(lock, [this] { return next_bucket_ == buckets_.size(); });
+
+  next_bucket_ = 0;
+  for (auto& bucket : buckets_) {
+    bucket.pending = bucket.grads.size();
+    std::fill(bucket.ready.begin(), bucket.ready.end(), false);
+  }
+  if (exception_) {
+    auto exception = exception_;
+    exception_ = nullptr;
+    std::rethrow_exception(exception);
+  }
+}
+
+void Reducer::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    ready_cv_.wait(lock, [this] {
+      return stop_ || (next_bucket_ < buckets_.size() &&
+                       buckets_[next_bucket_].pending == 0);
+    });
+    if (stop_) return;
+
+    lock.unlock();
+    try {
+      AllReduce(buckets_[next_bucket_]);
+      lock.lock();
+      ++next_bucket_;
+    } catch (...) {
+      lock.lock();
+      // The trainers are out of step, the rest buckets are dropped.
+      exception_ = std::current_exception();
+      next_bucket_ = buckets_.size();
+    }
+    done_cv_.notify_all();
+  }
+}
+
+void Reducer::AllReduce(const Bucket& bucket) {
+  buffer_.resize(bucket.numel);
+  for (size_t i = 0; i < bucket.grads.size(); ++i) {
+    auto& var = bucket.grads[i]->Var();
+    float* dst = buffer_.data() + bucket.offsets[i];
+    if (IsInitializedTensor(var)) {
+      auto& tensor = var.Get<framework::LoDTensor>();
+      PADDLE_ENFORCE(platform::is_cpu_place(tensor.place()),
+                     "The gradient %s should be on CPU",
+                     bucket.grads[i]->Name());
+      PADDLE_ENFORCE_EQ(tensor.numel(), bucket.numels[i],
+                        "The gradient %s does not match its parameter",
+                        bucket.grads[i]->Name());
+      std::memcpy(dst, tensor.data<float>(), bucket.numels[i] * sizeof(float));
+    } else {
+      std::fill(dst, dst + bucket.numels[i], 0.0f);
+    }
+  }
+
+  ctx_->AllReduce(buffer_.data(), bucket.numel);
+
+  for (size_t i = 0; i < bucket.grads.size(); ++i) {
+    auto* var = bucket.grads[i]->MutableVar();
+    if (!IsInitializedTensor(*var)) continue;
+    auto* tensor = var->GetMutable<framework::LoDTensor>();
+    std::memcpy(tensor->mutable_data<float>(tensor->place()),
+                buffer_.data() + bucket.offsets[i],
+                bucket.numels[i] * sizeof(float));
+  }
+}
+
+}  // namespace imperative
+}  // namespace paddle
+#endif
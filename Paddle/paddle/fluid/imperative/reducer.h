@@ -0,0 +1,94 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#if !defined(_WIN32)
+#include <condition_variable>  // NOLINT
+#include <exception>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/imperative/cpu_parallel_context.h"
+#include "paddle/fluid/imperative/layer.h"
+
+namespace paddle {
+namespace imperative {
+
+/*
+ * Sums the gradients of parameters over all trainers while backward runs.
+ *
+ * The parameters are grouped into buckets of about bucket_size bytes, in the
+ * order their gradients are expected to be ready, i.e. the reverse order of
+ * forward. Once all gradients of a bucket are ready, they are fused into one
+ * buffer and all-reduced on a communication thread. The buckets are always
+ * all-reduced in order, so all trainers run the same collectives.
+ *
+ * MarkGradReady is called by the engine for every summed gradient, and
+ * Finalize once after each backward.
+ */
+class Reducer {
+ public:
+  Reducer(std::shared_ptr<CPUParallelContext> ctx,
+          const std::vector<std::shared_ptr<VarBase>>& params,
+          size_t bucket_size);
+
+  ~Reducer();
+
+  void MarkGradReady(VarBase* grad);
+
+  // Waits until all gradients are all-reduced. The gradients not generated
+  // in this backward are all-reduced as they are, or as zeros if they are
+  // not initialized, in which case they stay uninitialized.
+  void Finalize();
+
+  size_t NumBuckets() const { return buckets_.size(); }
+
+ private:
+  struct Bucket {
+    std::vector<VarBase*> grads;
+    std::vector<size_t> offsets;
+    std::vector<int64_t> numels;
+    std::vector<bool> ready;
+    size_t numel{0};
+    size_t pending{0};
+  };
+
+  void Run();
+
+  void AllReduce(const Bucket& bucket);
+
+  std::shared_ptr<CPUParallelContext> ctx_;
+  std::vector<std::shared_ptr<VarBase>> params_;
+  std::vector<Bucket> buckets_;
+  // The bucket of a gradient and its index in the bucket.
+  std::unordered_map<VarBase*, std::pair<size_t, size_t>> locations_;
+  // Only used by the communication thread.
+  std::vector<float> buffer_;
+
+  std::mutex mutex_;
+  std::condition_variable ready_cv_;
+  std::condition_variable done_cv_;
+  size_t next_bucket_{0};
+  bool stop_{false};
+  std::exception_ptr exception_;
+  std::thread thread_;
+};
+
+}  // namespace imperative
+}  // namespace paddle
+#endif
@@ -0,0 +1,154 @@
+//   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/imperative/cpu_parallel_context.h"
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gflags/gflags.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/imperative/reducer.h"
+
+DECLARE_bool(cpu_parallel_use_shm);
+
+namespace imperative = paddle::imperative;
+namespace framework = paddle::framework;
+namespace platform = paddle::platform;
+
+#if !defined(_WIN32)
+imperative::ParallelStrategy GetStrategy(int nranks, int local_rank,
+                                         int port) {
+  imperative::ParallelStrategy strategy;
+  for (int i = 0; i < nranks; ++i) {
+    strategy.trainer_endpoints_.emplace_back("127.0.0.1:" +
+                                             std::to_string(port + i));
+  }
+  strategy.current_endpoint_ = strategy.trainer_endpoints_[local_rank];
+  strategy.nranks_ = nranks;
+  strategy.local_rank_ = local_rank;
+  return strategy;
+}
+
+// Runs every trainer in a thread.
+template <typename Callback>
+void RunTrainers(int nranks, int port, bool use_shm, Callback callback) {
+  FLAGS_cpu_parallel_use_shm = use_shm;
+  std::vector<std::thread> threads;
+  for (int rank = 0; rank < nranks; ++rank) {
+    threads.emplace_back([=] {
+      auto ctx = std::make_shared<imperative::CPUParallelContext>(
+          GetStrategy(nranks, rank, port), platform::CPUPlace());
+      ctx->Init();
+      EXPECT_EQ(ctx->UseSharedMemory(), use_shm);
+      callback(rank, ctx);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  FLAGS_cpu_parallel_use_shm = true;
+}
+
+void TestAllReduce(int nranks, int port, bool use_shm) {
+  // Larger than a slot of shared memory, and smaller than the trainers.
+  for (size_t numel : {(1UL << 20) + 37, 2UL}) {
+    RunTrainers(nranks, port, use_shm,
+                [&](int rank,
+                    std::shared_ptr<imperative::CPUParallelContext> ctx) {
+                  std::vector<float> data(numel);
+                  for (size_t i = 0; i < numel; ++i) data[i] = rank + i % 7;
+                  ctx->AllReduce(data.data(), numel);
+                  float rank_sum = nranks * (nranks - 1) / 2;
+                  for (size_t i = 0; i < numel; ++i) {
+                    ASSERT_EQ(data[i], rank_sum + nranks * (i % 7));
+                  }
+                });
+  }
+}
+
+void TestBroadcast(int nranks, int port, bool use_shm) {
+  RunTrainers(
+      nranks, port, use_shm,
+      [&](int rank, std::shared_ptr<imperative::CPUParallelContext> ctx) {
+        framework::LoDTensor tensor;
+        tensor.Resize({1 << 20, 3});
+        auto* data = tensor.mutable_data<int64_t>(platform::CPUPlace());
+        for (int64_t i = 0; i < tensor.numel(); ++i) data[i] = rank * i;
+        ctx->Broadcast(&tensor, 1);
+        for (int64_t i = 0; i < tensor.numel(); ++i) ASSERT_EQ(data[i], i);
+      });
+}
+
+TEST(CPUParallelContext, AllReduceTCP) { TestAllReduce(3, 9870, false); }
+
+TEST(CPUParallelContext, AllReduceSharedMemory) {
+  TestAllReduce(3, 9873, true);
+}
+
+TEST(CPUParallelContext, BroadcastTCP) { TestBroadcast(3, 9876, false); }
+
+TEST(CPUParallelContext, BroadcastSharedMemory) {
+  TestBroadcast(3, 9879, true);
+}
+
+float* SetGrad(imperative::VarBase* param, float value) {
+  auto* tensor = param->MutableGradVar()->GetMutable<framework::LoDTensor>();
+  tensor->Resize(param->Var().Get<framework::LoDTensor>().dims());
+  auto* data = tensor->mutable_data<float>(platform::CPUPlace());
+  std::fill(data, data + tensor->numel(), value);
+  return data;
+}
+
+TEST(Reducer, AllReduceInBuckets) {
+  RunTrainers(
+      2, 9882, true,
+      [&](int rank, std::shared_ptr<imperative::CPUParallelContext> ctx) {
+        std::vector<std::shared_ptr<imperative::VarBase>> params;
+        for (int64_t numel : {10, 5, 1000}) {
+          auto param = std::make_shared<imperative::VarBase>(
+              "param" + std::to_string(params.size()));
+          auto* tensor =
+              param->MutableVar()->GetMutable<framework::LoDTensor>();
+          tensor->Resize({numel});
+          tensor->mutable_data<float>(platform::CPUPlace());
+          params.emplace_back(param);
+        }
+        // The first parameter fills a bucket.
+        imperative::Reducer reducer(ctx, params, 40);
+        EXPECT_EQ(reducer.NumBuckets(), 2UL);
+
+        for (int step = 0; step < 2; ++step) {
+          float* grad0 = SetGrad(params[0].get(), rank + 1);
+          reducer.MarkGradReady(params[0]->GradVarBase().get());
+          // Only generated by trainer 0.
+          float* grad1 = nullptr;
+          if (rank == 0) {
+            grad1 = SetGrad(params[1].get(), 3);
+            reducer.MarkGradReady(params[1]->GradVarBase().get());
+          }
+          // Not marked ready, and not initialized on trainer 1.
+          float* grad2 = rank == 0 ? SetGrad(params[2].get(), 5) : nullptr;
+          reducer.Finalize();
+
+          for (int i = 0; i < 10; ++i) ASSERT_EQ(grad0[i], 3);
+          if (rank == 0) {
+            for (int i = 0; i < 5; ++i) ASSERT_EQ(grad1[i], 3);
+            for (int i = 0; i < 1000; ++i) ASSERT_EQ(grad2[i], 5);
+          } else {
+            EXPECT_FALSE(params[1]->GradVar().IsInitialized());
+            EXPECT_FALSE(params[2]->GradVar().IsInitialized());
+          }
+        }
+      });
+}
+#endif
@@ -12,7 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <memory>
+#include <string>
 #include <vector>
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/variable.h"
@@ -117,5 +119,49 @@ TEST(test_add_functor, add_functor) {
 #endif
 }
 
+static std::shared_ptr<VarBase> CreateVarBase(
+    bool has_grad, const std::string& name, const std::vector<int64_t>& dims,
+    float value) {
+  auto var = std::make_shared<VarBase>(has_grad, name);
+  var->SetOverridedStopGradient(false);
+  auto* tensor = var->MutableVar()->GetMutable<framework::LoDTensor>();
+  tensor->Resize(framework::make_ddim(dims));
+  auto* data = tensor->mutable_data<float>(platform::CPUPlace());
+  std::fill(data, data + tensor->numel(), value);
+  return var;
+}
+
+TEST(test_gradient_buffer, accumulate_gradients) {
+  auto param1 = CreateVarBase(true, "param1", {2, 3}, 0.0f);
+  auto param2 = CreateVarBase(true, "param2", {4}, 0.0f);
+  GradientBuffer buffer({param1, param2});
+  ASSERT_EQ(buffer.NumParams(), 2UL);
+  auto& flat = buffer.Buffer()->Var().Get<framework::LoDTensor>();
+  ASSERT_EQ(flat.numel(), 10);
+
+  // Two backward, the gradients are summed into the views of the buffer.
+  for (int i = 0; i < 2; ++i) {
+    EagerGradientAccumulator eager(param1->GradVarBase().get());
+    eager.IncreaseRefCnt();
+    eager.IncreaseRefCnt();
+    eager.Add(CreateVarBase(false, "grad1_0", {2, 3}, 1.0f), 0);
+    eager.Add(CreateVarBase(false, "grad1_1", {2, 3}, 2.0f), 1);
+    SortedGradientAccumulator sorted(param2->GradVarBase().get());
+    sorted.IncreaseRefCnt();
+    sorted.Add(CreateVarBase(false, "grad2_0", {4}, 4.0f), 0);
+  }
+  auto& grad1 = param1->GradVar().Get<framework::LoDTensor>();
+  EXPECT_EQ(grad1.dims(), framework::make_ddim({2, 3}));
+  EXPECT_EQ(grad1.data<float>(), flat.data<float>());
+  for (int64_t i = 0; i < flat.numel(); ++i) {
+    EXPECT_EQ(flat.data<float>()[i], i < 6 ? 6.0f : 8.0f);
+  }
+
+  buffer.Clear();
+  for (int64_t i = 0; i < flat.numel(); ++i) {
+    EXPECT_EQ(flat.data<float>()[i], 0.0f);
+  }
+}
+
 }  // namespace imperative
 }  // namespace paddle
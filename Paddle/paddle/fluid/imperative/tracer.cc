@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include "paddle/fluid/imperative/tracer.h"
+#include <limits>
+#include <random>
 #include <unordered_set>
 #include <utility>
 #include "paddle/fluid/platform/profiler.h"
@@ -42,14 +44,61 @@ static void PassStopGradient(const NameVarBaseMap& outs, bool generate_grad) {
   }
 }
 
+// The ops of a checkpointed segment must draw the same random numbers when
+// they are recomputed, so the seed is fixed for every op drawing its own.
+static void FixRandomSeed(const std::string& type,
+                          framework::AttributeMap* attrs) {
+  const auto& info = framework::OpInfoMap::Instance().Get(type);
+  if (info.Checker() != nullptr) {
+    info.Checker()->Check(attrs);
+  }
+  auto seed = attrs->find("seed");
+  if (seed == attrs->end() || seed->second.type() != typeid(int)) return;
+  auto fix_seed = attrs->find("fix_seed");
+  if (fix_seed != attrs->end() && fix_seed->second.type() == typeid(bool)) {
+    // e.g. dropout
+    if (boost::get<bool>(fix_seed->second)) return;
+    fix_seed->second = true;
+  } else if (boost::get<int>(seed->second) != 0) {
+    // e.g. uniform_random, whose seed is random if it is 0
+    return;
+  }
+  std::random_device rnd;
+  std::uniform_int_distribution<int> dist(1, std::numeric_limits<int>::max());
+  seed->second = dist(rnd);
+  VLOG(6) << "Fix the random seed of " << type << " in checkpoint";
+}
+
+void Tracer::BeginCheckpoint() {
+  if (checkpoint_depth_++ == 0) {
+    checkpoint_ = std::make_shared<CheckpointSegment>();
+  }
+}
+
+void Tracer::EndCheckpoint(
+    const std::vector<std::shared_ptr<VarBase>>& outputs) {
+  PADDLE_ENFORCE_GT(checkpoint_depth_, 0,
+                    "EndCheckpoint should be called after BeginCheckpoint");
+  if (--checkpoint_depth_ > 0) return;
+  size_t released = checkpoint_->Release(outputs);
+  VLOG(3) << "Release " << released << " bytes of checkpoint";
+  checkpoint_.reset();
+}
+
 void Tracer::TraceOp(const std::string& type, const NameVarBaseMap& ins,
                      const NameVarBaseMap& outs, framework::AttributeMap attrs,
                      const platform::Place& place, bool trace_backward) {
   platform::RecordEvent event(type);
   VLOG(1) << "Trace Op: " << type;
   size_t op_id = GenerateUniqueId();
+  if (checkpoint_) {
+    FixRandomSeed(type, &attrs);
+  }
   auto op = OpBase::Create(op_id, type, ins, outs, std::move(attrs), place);
   op->Run(ins, outs);
+  if (checkpoint_) {
+    checkpoint_->AddOp(op, ins, outs);
+  }
 
   if (ComputeRequiredGrad(ins, outs, trace_backward)) {
     TraceBackward(op, framework::OpDesc(op->Type(), op->InputNameMap(),
@@ -135,6 +184,9 @@ void Tracer::TraceBackward(const std::shared_ptr<OpBase>& fwd_op,
 
     // this OpBase* is just used to manage op's life time
     engine_->InsertOp(grad_op.get(), grad_op);
+    if (checkpoint_) {
+      engine_->InsertCheckpointOp(grad_op.get(), checkpoint_);
+    }
 
     std::unordered_set<OpBase*> visited_preceding_ops;
     // Step2 : prepare grad_in vars and bind them with grad_op,
@@ -48,6 +48,13 @@ class Tracer {
                      const NameVarBaseMap& ins, const NameVarBaseMap& outs);
   Engine* GetDefaultEngine() const { return engine_.get(); }
 
+  // The ops traced between BeginCheckpoint and EndCheckpoint form a
+  // checkpointed segment, only its inputs and the given outputs keep their
+  // memory until backward. Checkpoints can be nested, the outermost one wins.
+  void BeginCheckpoint();
+
+  void EndCheckpoint(const std::vector<std::shared_ptr<VarBase>>& outputs);
+
  private:
   static size_t GenerateUniqueId() {
     static std::atomic<size_t> id{0};
@@ -56,6 +63,8 @@ class Tracer {
 
  private:
   std::unique_ptr<Engine> engine_;
+  std::shared_ptr<CheckpointSegment> checkpoint_;
+  int checkpoint_depth_{0};
 };
 
 }  // namespace imperative
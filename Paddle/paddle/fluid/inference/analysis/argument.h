@@ -168,6 +168,11 @@ struct Argument {
   DECL_ARGUMENT_FIELD(quant_var_scales, QuantVarScales, VarQuantScale);
 #endif
 
+  // The storage of the weights compressed by the weight_only_quant_pass
+  DECL_ARGUMENT_FIELD(weight_only_precision, WeightOnlyPrecision,
+                      AnalysisConfig::Precision);
+  DECL_ARGUMENT_FIELD(weight_only_group_size, WeightOnlyGroupSize, int);
+
   // Passed from config.
   DECL_ARGUMENT_FIELD(use_gpu, UseGPU, bool);
   DECL_ARGUMENT_FIELD(gpu_device_id, GPUDeviceId, int);
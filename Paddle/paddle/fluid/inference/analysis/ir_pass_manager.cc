@@ -79,6 +79,11 @@ void IRPassManager::CreatePasses(Argument *argument,
       pass->Set("quant_var_scales",
                 new VarQuantScale(argument->quant_var_scales()));
 #endif
+    } else if (pass_name == "weight_only_quant_pass") {
+      bool is_bf16 =
+          argument->weight_only_precision() == AnalysisConfig::Precision::kHalf;
+      pass->Set("weight_type", new std::string(is_bf16 ? "bf16" : "int8"));
+      pass->Set("group_size", new int(argument->weight_only_group_size()));
     } else if (pass_name == "tensorrt_subgraph_pass") {
       pass->Set("workspace_size", new int(argument->tensorrt_workspace_size()));
       pass->Set("max_batch_size", new int(argument->tensorrt_max_batch_size()));
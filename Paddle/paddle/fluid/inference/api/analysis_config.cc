@@ -118,6 +118,9 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   // Quantization related.
   CP_MEMBER(use_mkldnn_quantizer_);
   CP_MEMBER(mkldnn_quantizer_config_);
+  CP_MEMBER(use_weight_only_quant_);
+  CP_MEMBER(weight_only_precision_);
+  CP_MEMBER(weight_only_group_size_);
 
   CP_MEMBER(use_anakin_);
   CP_MEMBER(anakin_max_batchsize_);
@@ -201,6 +204,19 @@ void AnalysisConfig::EnableMkldnnQuantizer() {
   Update();
 }
 
+void AnalysisConfig::EnableWeightOnlyQuant(Precision precision,
+                                           int group_size) {
+  PADDLE_ENFORCE(
+      precision == Precision::kHalf || precision == Precision::kInt8,
+      "The weight-only quantization supports kHalf(bf16) and kInt8 only.");
+  PADDLE_ENFORCE_GT(group_size, 0, "The group_size should be positive.");
+  use_weight_only_quant_ = true;
+  weight_only_precision_ = precision;
+  weight_only_group_size_ = group_size;
+
+  Update();
+}
+
 void AnalysisConfig::EnableNgraph() {
 #ifdef PADDLE_WITH_NGRAPH
   pass_builder()->EnableNgraph();
@@ -323,6 +339,20 @@ void AnalysisConfig::Update() {
 #endif
   }
 
+  // After the fc fusion, so that the fused fc weights are compressed.
+  if (use_weight_only_quant_) {
+    if (!enable_ir_optim_) {
+      LOG(ERROR) << "EnableWeightOnlyQuant() only works when IR optimization "
+                    "is enabled.";
+    } else if (use_gpu()) {
+      LOG(ERROR) << "EnableWeightOnlyQuant() only works on CPU.";
+    } else {
+      // The pass builder may be copied from the last update
+      pass_builder()->DeletePass("weight_only_quant_pass");
+      pass_builder()->AppendPass("weight_only_quant_pass");
+    }
+  }
+
 #ifdef PADDLE_WITH_MKLDNN
   // Do not optimize before quantization
   if (enable_memory_optim_ && !use_mkldnn_quantizer_) {
@@ -381,6 +411,9 @@ std::string AnalysisConfig::SerializeInfoCache() {
   ss << ";";
 
   ss << use_mkldnn_quantizer_;
+  ss << use_weight_only_quant_;
+  ss << static_cast<int>(weight_only_precision_);
+  ss << weight_only_group_size_;
   ss << model_from_memory_;
 
   ss << with_profile_;
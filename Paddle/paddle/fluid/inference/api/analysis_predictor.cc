@@ -446,6 +446,12 @@ void AnalysisPredictor::PrepareArgument() {
   }
 #endif
 
+  if (config_.weight_only_quant_enabled()) {
+    LOG(INFO) << "Weight-only quantization is enabled";
+    argument_.SetWeightOnlyPrecision(config_.weight_only_precision_);
+    argument_.SetWeightOnlyGroupSize(config_.weight_only_group_size_);
+  }
+
   auto passes = config_.pass_builder()->AllPasses();
   if (!config_.ir_optim()) {
     passes.clear();
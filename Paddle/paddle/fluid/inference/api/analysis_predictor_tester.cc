@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "paddle/fluid/inference/api/analysis_predictor.h"
+#include <algorithm>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 #include <thread>  // NOLINT
@@ -193,6 +194,42 @@ TEST(AnalysisPredictor, Clone) {
   }
 }
 
+TEST(AnalysisPredictor, weight_only_quant) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+  config.EnableWeightOnlyQuant(AnalysisConfig::Precision::kHalf);
+  // enabled again with another precision, the pass is not appended twice
+  config.EnableWeightOnlyQuant(AnalysisConfig::Precision::kInt8, 32);
+  auto passes = config.pass_builder()->AllPasses();
+  ASSERT_EQ(std::count(passes.begin(), passes.end(), "weight_only_quant_pass"),
+            1);
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+
+  auto native_predictor =
+      CreatePaddlePredictor<NativeConfig>(config.ToNativeConfig());
+  std::vector<PaddleTensor> native_outputs;
+  ASSERT_TRUE(native_predictor->Run(inputs, &native_outputs));
+
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  std::vector<PaddleTensor> outputs;
+  ASSERT_TRUE(predictor->Run(inputs, &outputs));
+  ASSERT_EQ(outputs.size(), native_outputs.size());
+  size_t size = outputs[0].data.length() / sizeof(float);
+  ASSERT_EQ(size, native_outputs[0].data.length() / sizeof(float));
+  auto* out = static_cast<const float*>(outputs[0].data.data());
+  auto* ref = static_cast<const float*>(native_outputs[0].data.data());
+  for (size_t i = 0; i < size; ++i) {
+    EXPECT_NEAR(out[i], ref[i], 1e-2);
+  }
+}
+
 // This function is not released yet, will fail on some machine.
 // TODO(Superjomn) Turn on it latter.
 /*
@@ -275,8 +312,10 @@ class MkldnnQuantizerTest : public testing::Test {
   }
 
   std::pair<bool, framework::LoDTensor> GetMaxChScalingFactor(
-      const framework::LoDTensor& var_tensor, bool is_unsigned) const {
-    return mkldnn_quantizer->GetMaxChScalingFactor(var_tensor, is_unsigned);
+      const framework::LoDTensor& var_tensor, bool is_unsigned,
+      bool is_transposed = false) const {
+    return mkldnn_quantizer->GetMaxChScalingFactor(var_tensor, is_unsigned,
+                                                   is_transposed);
   }
 
   std::pair<bool, framework::LoDTensor> GetKLScalingFactor(
@@ -466,6 +505,34 @@ TEST_F(MkldnnQuantizerTest, max_scaling_factor_chwise_unsigned) {
   }
 }
 
+TEST_F(MkldnnQuantizerTest, max_scaling_factor_chwise_transposed) {
+  const auto& values = non_negative_values;
+  int rows = values.size();
+  int channels = 3;
+
+  // the column i of the [rows, channels] tensor is values * (i + 1)
+  framework::LoDTensor var_tensor;
+  var_tensor.Resize(framework::make_dim(rows, channels));
+  auto* data = var_tensor.mutable_data<float>(platform::CPUPlace());
+  for (int r = 0; r < rows; r++)
+    for (int i = 0; i < channels; i++)
+      data[r * channels + i] = values[r] * (i + 1);
+
+  bool is_unsigned;
+  framework::LoDTensor lod_tensor;
+
+  std::tie(is_unsigned, lod_tensor) =
+      GetMaxChScalingFactor(var_tensor, true, /*is_transposed*/ true);
+
+  auto max_val = *std::max_element(values.begin(), values.end());
+  ASSERT_EQ(is_unsigned, true);
+  ASSERT_EQ(lod_tensor.numel(), channels);
+  for (int i = 0; i < channels; i++) {
+    ASSERT_NEAR(lod_tensor.data<double>()[i], 1.0 / (max_val * (i + 1)),
+                abs_error);
+  }
+}
+
 TEST_F(MkldnnQuantizerTest, kl_scaling_factor_unsigned) {
   const auto& values = non_negative_values;
 
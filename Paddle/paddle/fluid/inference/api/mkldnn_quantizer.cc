@@ -37,6 +37,8 @@ using framework::LoDTensor;
 using framework::ir::Graph;
 using ConstEigenVectorArrayMap =
     Eigen::Map<const Eigen::Array<float, Eigen::Dynamic, 1>>;
+using ConstEigenMatrixArrayMap =
+    Eigen::Map<const Eigen::Array<float, Eigen::Dynamic, Eigen::Dynamic>>;
 using string::PrettyLogH1;
 static LoDTensor CreateScaleTensor(int64_t channels_num = 1);
 
@@ -72,6 +74,11 @@ bool AnalysisPredictor::MkldnnQuantizer::CalculateScales() {
                     op->GetAttrIfExists<std::string>("fuse_activation");
                 is_unsigned =
                     (fuse_activation == "relu" || fuse_activation == "relu6");
+              } else if (op->Type() == "fc") {
+                // output of fc with relu must be unsigned
+                is_unsigned =
+                    op->GetAttrIfExists<std::string>("activation_type") ==
+                    "relu";
               } else if (op->Type() == "relu") {
                 is_unsigned = true;
               } else if (op->Type() == "transpose2" ||
@@ -138,7 +145,12 @@ void AnalysisPredictor::MkldnnQuantizer::CalculateSingleScale(
       scales_[var_name] = GetMaxScalingFactor(var_tensor, is_unsigned);
       break;
     case ScaleAlgo::MAX_CH:
-      scales_[var_name] = GetMaxChScalingFactor(var_tensor, is_unsigned);
+      scales_[var_name] = GetMaxChScalingFactor(var_tensor, is_unsigned,
+                                                /*is_transposed*/ false);
+      break;
+    case ScaleAlgo::MAX_CH_T:
+      scales_[var_name] = GetMaxChScalingFactor(var_tensor, is_unsigned,
+                                                /*is_transposed*/ true);
       break;
     case ScaleAlgo::KL:
       scales_[var_name] = GetKLScalingFactor(var_tensor, is_unsigned);
@@ -319,7 +331,7 @@ AnalysisPredictor::MkldnnQuantizer::GetMaxScalingFactor(
 
 std::pair<bool, LoDTensor>
 AnalysisPredictor::MkldnnQuantizer::GetMaxChScalingFactor(
-    const LoDTensor& var_tensor, bool is_unsigned) const {
+    const LoDTensor& var_tensor, bool is_unsigned, bool is_transposed) const {
   PADDLE_ENFORCE(var_tensor.dims().size() > 0, "Tensor dimension is empty.");
 
   ConstEigenVectorArrayMap eigen_tensor{var_tensor.data<float>(),
@@ -331,6 +343,23 @@ AnalysisPredictor::MkldnnQuantizer::GetMaxChScalingFactor(
         "Tensor is claimed to be unsigned, but its min value (%f) is < 0.0",
         min_val);
 
+  if (is_transposed) {
+    // the channels are the columns of the tensor flattened to
+    // [dims[0], numel / dims[0]]
+    int64_t rows = var_tensor.dims()[0];
+    int64_t channels = var_tensor.numel() / rows;
+    ConstEigenMatrixArrayMap eigen_matrix{var_tensor.data<float>(), channels,
+                                          rows};
+    Eigen::ArrayXf max_abs = eigen_matrix.abs().rowwise().maxCoeff();
+
+    LoDTensor scale_tensor = CreateScaleTensor(channels);
+    auto* scale_ptr = scale_tensor.mutable_data<double>(CPUPlace());
+    for (int64_t i = 0; i < channels; ++i) {
+      scale_ptr[i] = 1.0 / max_abs[i];
+    }
+    return std::make_pair(is_unsigned, scale_tensor);
+  }
+
   int channels = var_tensor.dims()[0];
   LoDTensor scale_tensor = CreateScaleTensor(channels);
   auto* scale_ptr = scale_tensor.mutable_data<double>(CPUPlace());
@@ -78,8 +78,11 @@ class AnalysisPredictor::MkldnnQuantizer {
   std::pair<bool, framework::LoDTensor> GetKLScalingFactor(
       const framework::LoDTensor& var_tensor, bool is_unsigned) const;
 
+  // Computes a scale per channel along dims[0], or along the columns of the
+  // tensor flattened to 2-D if is_transposed is true.
   std::pair<bool, framework::LoDTensor> GetMaxChScalingFactor(
-      const framework::LoDTensor& var_tensor, bool is_unsigned) const;
+      const framework::LoDTensor& var_tensor, bool is_unsigned,
+      bool is_transposed) const;
 
   std::pair<bool, framework::LoDTensor> GetMaxScalingFactor(
       const framework::LoDTensor& var_tensor, bool is_unsigned) const;
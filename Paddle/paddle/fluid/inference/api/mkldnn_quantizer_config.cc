@@ -34,6 +34,19 @@ MkldnnQuantizerConfig::MkldnnQuantizerConfig() {
   rules_["prior_box"]["Image"] = ScaleAlgo::NONE;
   rules_["prior_box"]["Boxes"] = ScaleAlgo::NONE;
   rules_["prior_box"]["Variances"] = ScaleAlgo::NONE;
+
+  rules_["fc"]["Input"] = ScaleAlgo::KL;
+  rules_["fc"]["W"] = ScaleAlgo::MAX_CH_T;
+  rules_["fc"]["Bias"] = ScaleAlgo::NONE;
+  rules_["fc"]["Out"] = ScaleAlgo::KL;
+
+  rules_["mul"]["X"] = ScaleAlgo::KL;
+  rules_["mul"]["Y"] = ScaleAlgo::MAX_CH_T;
+  rules_["mul"]["Out"] = ScaleAlgo::KL;
+
+  rules_["matmul"]["X"] = ScaleAlgo::KL;
+  rules_["matmul"]["Y"] = ScaleAlgo::KL;
+  rules_["matmul"]["Out"] = ScaleAlgo::KL;
 }
 
 ScaleAlgo MkldnnQuantizerConfig::scale_algo(
@@ -229,6 +229,19 @@ struct AnalysisConfig {
 
   MkldnnQuantizerConfig* mkldnn_quantizer_config() const;
 
+  /** Turn on the weight-only quantization on CPU, which stores the weights
+   * of fc, mul and matmul in low precision and dequantizes them in the GEMM
+   * kernels, while the activations stay in float.
+   * @param precision kHalf stores the weights in bf16, and kInt8 in int8
+   * with a scale for every group_size weights of a row.
+   * @param group_size the number of int8 weights sharing a scale.
+   */
+  void EnableWeightOnlyQuant(Precision precision = Precision::kInt8,
+                             int group_size = 64);
+  /** A boolean state telling whether the weight-only quantization is enabled.
+   */
+  bool weight_only_quant_enabled() const { return use_weight_only_quant_; }
+
   /** Specify the memory buffer of program and parameter
    * @param prog_buffer the memory buffer of program.
    * @param prog_buffer_size the size of the data.
@@ -355,6 +368,11 @@ struct AnalysisConfig {
   bool use_mkldnn_quantizer_{false};
   std::shared_ptr<MkldnnQuantizerConfig> mkldnn_quantizer_config_;
 
+  // weight-only quantization related.
+  bool use_weight_only_quant_{false};
+  Precision weight_only_precision_{Precision::kInt8};
+  int weight_only_group_size_{64};
+
   // If the config is already used on a predictor, it becomes invalid.
   // Any config can only be used with one predictor.
   // Variables held by config can take up a lot of memory in some cases.
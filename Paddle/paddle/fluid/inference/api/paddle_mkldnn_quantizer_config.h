@@ -26,10 +26,13 @@ namespace paddle {
 
 // Algorithms for finding scale of quantized Tensors.
 enum class ScaleAlgo {
-  NONE,    // Do not compute scale
-  MAX,     // Find scale based on the maximum absolute value
-  MAX_CH,  // Find scale based on the maximum absolute value per channel
-  KL,      // Find scale based on KL Divergence
+  NONE,      // Do not compute scale
+  MAX,       // Find scale based on the maximum absolute value
+  MAX_CH,    // Find scale based on the maximum absolute value per channel
+  MAX_CH_T,  // Find scale based on the maximum absolute value per channel
+             // of the transposed tensor, i.e. per column of the weights
+             // with the shape [in, out]
+  KL,        // Find scale based on KL Divergence
 };
 
 struct MkldnnQuantizerConfig {
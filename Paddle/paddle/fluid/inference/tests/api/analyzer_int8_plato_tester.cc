@@ -0,0 +1,193 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Compares the accuracy and latency of the FP32 and the INT8 (post-training
+// quantized) MKL-DNN inference of a saved PLATO inference model.
+//
+// Every line of --infer_data is one batch of the feeds in the order of the
+// feed targets of the model, separated by ';'. A feed is
+// "dtype:shape:values", dtype is int64 or float32, and the shape and the
+// values are separated by spaces. The first batch is the quantization warmup
+// data. The logits of the last fetch target are compared: their abs diff is
+// reported, and the top-1 token of INT8 should agree with FP32 for at least
+// (1 - --quantized_accuracy) of the positions.
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include "paddle/fluid/inference/api/paddle_analysis_config.h"
+#include "paddle/fluid/inference/tests/api/tester_helper.h"
+
+namespace paddle {
+namespace inference {
+namespace analysis {
+
+void SetConfig(AnalysisConfig *cfg) {
+  cfg->SetModel(FLAGS_infer_model);
+  cfg->DisableGpu();
+  cfg->SwitchIrOptim();
+  cfg->SetCpuMathLibraryNumThreads(FLAGS_paddle_num_threads);
+  cfg->EnableMKLDNN();
+}
+
+template <typename T>
+void ParseValues(const std::string &str, std::vector<T> *values) {
+  std::stringstream ss(str);
+  T value;
+  while (ss >> value) values->push_back(value);
+}
+
+template <typename T>
+void FillTensor(const std::vector<int> &shape, const std::string &str,
+                PaddleTensor *tensor) {
+  std::vector<T> values;
+  ParseValues(str, &values);
+  auto numel = std::accumulate(shape.begin(), shape.end(), size_t{1},
+                               std::multiplies<size_t>());
+  PADDLE_ENFORCE_EQ(values.size(), numel,
+                    "The number of values does not match the shape.");
+  tensor->shape = shape;
+  tensor->dtype = GetPaddleDType<T>();
+  tensor->data.Resize(numel * sizeof(T));
+  std::copy(values.begin(), values.end(),
+            static_cast<T *>(tensor->data.data()));
+}
+
+// Parses "dtype:shape:values"
+void ParseTensor(const std::string &field, PaddleTensor *tensor) {
+  auto first = field.find(':');
+  auto second = field.find(':', first + 1);
+  PADDLE_ENFORCE(first != std::string::npos && second != std::string::npos,
+                 "The feed should be dtype:shape:values, but got %s", field);
+  auto dtype = field.substr(0, first);
+  std::vector<int> shape;
+  ParseValues(field.substr(first + 1, second - first - 1), &shape);
+  auto values = field.substr(second + 1);
+  if (dtype == "int64") {
+    FillTensor<int64_t>(shape, values, tensor);
+  } else if (dtype == "float32") {
+    FillTensor<float>(shape, values, tensor);
+  } else {
+    PADDLE_THROW("Unsupported dtype %s of the feed", dtype);
+  }
+}
+
+void SetInput(std::vector<std::vector<PaddleTensor>> *inputs) {
+  std::ifstream file(FLAGS_infer_data);
+  if (!file) {
+    FAIL() << "Couldn't open file: " << FLAGS_infer_data;
+  }
+
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.empty()) continue;
+    std::vector<PaddleTensor> feeds;
+    std::stringstream ss(line);
+    std::string field;
+    while (std::getline(ss, field, ';')) {
+      feeds.emplace_back();
+      ParseTensor(field, &feeds.back());
+    }
+    inputs->push_back(std::move(feeds));
+    if (FLAGS_iterations > 0 &&
+        inputs->size() >= static_cast<size_t>(FLAGS_iterations))
+      break;
+  }
+  LOG(INFO) << "number of batches: " << inputs->size();
+}
+
+void CompareLogits(const std::vector<std::vector<PaddleTensor>> &quantized,
+                   const std::vector<std::vector<PaddleTensor>> &ref) {
+  PADDLE_ENFORCE_EQ(quantized.size(), ref.size(),
+                    "The FP32 and INT8 runs have different batches.");
+  double max_diff = 0;
+  double sum_diff = 0;
+  size_t numel = 0;
+  size_t positions = 0;
+  size_t agreed = 0;
+  for (size_t i = 0; i < ref.size(); ++i) {
+    auto &q_out = quantized[i].back();
+    auto &out = ref[i].back();
+    PADDLE_ENFORCE(out.dtype == PaddleDType::FLOAT32 &&
+                       q_out.dtype == PaddleDType::FLOAT32,
+                   "The logits should be float.");
+    PADDLE_ENFORCE(out.shape == q_out.shape,
+                   "The FP32 and INT8 logits have different shapes.");
+    size_t size = out.data.length() / sizeof(float);
+    size_t vocab = out.shape.back();
+    auto *q_data = static_cast<const float *>(q_out.data.data());
+    auto *data = static_cast<const float *>(out.data.data());
+    for (size_t j = 0; j < size; ++j) {
+      double diff = std::fabs(q_data[j] - data[j]);
+      max_diff = std::max(max_diff, diff);
+      sum_diff += diff;
+    }
+    numel += size;
+    for (size_t pos = 0; pos + vocab <= size; pos += vocab) {
+      auto q_top1 = std::max_element(q_data + pos, q_data + pos + vocab);
+      auto top1 = std::max_element(data + pos, data + pos + vocab);
+      if (q_top1 - q_data == top1 - data) ++agreed;
+      ++positions;
+    }
+  }
+  CHECK_GT(positions, 0UL);
+
+  double agreement = static_cast<double>(agreed) / positions;
+  LOG(INFO) << "--- Accuracy summary --- ";
+  LOG(INFO) << "logits max abs diff: " << max_diff
+            << ", mean abs diff: " << sum_diff / numel;
+  LOG(INFO) << "top1 agreement: " << std::fixed << std::setprecision(4)
+            << agreement << ", accepted drop threshold: "
+            << FLAGS_quantized_accuracy;
+  CHECK_LE(1.0 - agreement, FLAGS_quantized_accuracy);
+}
+
+TEST(Analyzer_int8_plato, quantization) {
+  AnalysisConfig cfg;
+  SetConfig(&cfg);
+
+  AnalysisConfig q_cfg;
+  SetConfig(&q_cfg);
+
+  std::vector<std::vector<PaddleTensor>> input_slots_all;
+  SetInput(&input_slots_all);
+  ASSERT_GT(input_slots_all.size(), 0UL);
+
+  // the first batch is the warmup data
+  auto warmup_data =
+      std::make_shared<std::vector<PaddleTensor>>(input_slots_all[0]);
+  q_cfg.EnableMkldnnQuantizer();
+  q_cfg.mkldnn_quantizer_config()->SetWarmupData(warmup_data);
+  q_cfg.mkldnn_quantizer_config()->SetWarmupBatchSize(
+      input_slots_all[0][0].shape[0]);
+
+  std::vector<std::vector<PaddleTensor>> outputs;
+  std::vector<std::vector<PaddleTensor>> quantized_outputs;
+  float sample_latency_fp32{-1};
+  float sample_latency_int8{-1};
+  TestOneThreadPrediction(reinterpret_cast<PaddlePredictor::Config *>(&cfg),
+                          input_slots_all, &outputs, true, VarType::FP32,
+                          &sample_latency_fp32);
+  TestOneThreadPrediction(reinterpret_cast<PaddlePredictor::Config *>(&q_cfg),
+                          input_slots_all, &quantized_outputs, true,
+                          VarType::INT8, &sample_latency_int8);
+  SummarizePerformance(sample_latency_fp32, sample_latency_int8);
+
+  CompareLogits(quantized_outputs, outputs);
+}
+
+}  // namespace analysis
+}  // namespace inference
+}  // namespace paddle
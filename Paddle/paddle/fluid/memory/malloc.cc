@@ -17,6 +17,7 @@ limitations under the License. */
 #include <vector>
 #include "paddle/fluid/memory/allocation/allocator_facade.h"
 #include "paddle/fluid/memory/allocation/allocator_strategy.h"
+#include "paddle/fluid/platform/op_metrics.h"
 #include "paddle/fluid/platform/place.h"
 
 namespace paddle {
@@ -24,10 +25,12 @@ namespace memory {
 
 std::shared_ptr<Allocation> AllocShared(const platform::Place &place,
                                         size_t size) {
+  if (FLAGS_enable_op_metrics) platform::RecordThreadAllocatedBytes(size);
   return allocation::AllocatorFacade::Instance().AllocShared(place, size);
 }
 
 AllocationPtr Alloc(const platform::Place &place, size_t size) {
+  if (FLAGS_enable_op_metrics) platform::RecordThreadAllocatedBytes(size);
   return allocation::AllocatorFacade::Instance().Alloc(place, size);
 }
 
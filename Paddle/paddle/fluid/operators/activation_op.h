@@ -192,14 +192,14 @@ class ActivationGradKernel
     auto out = framework::EigenVector<T>::Flatten(detail::Ref(Out));
     auto dx = framework::EigenVector<T>::Flatten(detail::Ref(dX));
     auto x = framework::EigenVector<T>::Flatten(detail::Ref(X));
-    auto* place =
-        context.template device_context<DeviceContext>().eigen_device();
     Functor functor;
     auto attrs = functor.GetAttrs();
     for (auto& attr : attrs) {
       *attr.second = context.Attr<float>(attr.first);
     }
-    functor(*place, x, out, dout, dx);
+    // Large gradients run on the intra-op thread pool on CPU.
+    platform::EigenDeviceRun(context.template device_context<DeviceContext>(),
+                             dX->numel(), &functor, x, out, dout, dx);
   }
 };
 
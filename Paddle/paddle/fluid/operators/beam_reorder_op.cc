@@ -0,0 +1,93 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/beam_reorder_op.h"
+
+namespace paddle {
+namespace operators {
+
+class BeamReorderOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInputs("X"),
+                   "Inputs(X) of BeamReorderOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("ParentIdx"),
+                   "Input(ParentIdx) of BeamReorderOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutputs("Out"),
+                   "Outputs(Out) of BeamReorderOp should not be null.");
+
+    auto parent_dims = ctx->GetInputDim("ParentIdx");
+    PADDLE_ENFORCE_EQ(parent_dims.size(), 2,
+                      "Input(ParentIdx) should be [batch_size, beam_size].");
+    auto x_dims = ctx->GetInputsDim("X");
+    PADDLE_ENFORCE_EQ(x_dims.size(), ctx->Outputs("Out").size(),
+                      "Inputs(X) and Outputs(Out) should have the same "
+                      "number of variables.");
+    if (ctx->IsRuntime()) {
+      for (auto& dims : x_dims) {
+        PADDLE_ENFORCE_EQ(dims[0], parent_dims[0] * parent_dims[1],
+                          "The rows of every Inputs(X) should be batch_size "
+                          "* beam_size.");
+      }
+    }
+    ctx->SetOutputsDim("Out", x_dims);
+  }
+
+ protected:
+  // The states are moved as bytes, so the kernel only depends on the type of
+  // ParentIdx.
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        OperatorWithKernel::IndicateVarDataType(ctx, "ParentIdx"),
+        platform::CPUPlace());
+  }
+};
+
+class BeamReorderOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X",
+             "(Tensors) The states of the beams, the rows of every tensor are "
+             "[batch_size * beam_size].")
+        .AsDuplicable();
+    AddInput("ParentIdx",
+             "(Tensor<int64>) [batch_size, beam_size], the ParentIdx of "
+             "beam_search_step.");
+    AddOutput("Out",
+              "(Tensors) The reordered states, which can be the same variables "
+              "as X.")
+        .AsDuplicable();
+    AddComment(R"DOC(
+BeamReorder Operator.
+
+Reorders the states of the beams after a step of beam_search_step, i.e.
+
+    Out[i][b * beam_size + k] = X[i][b * beam_size + ParentIdx[b, k]]
+
+for every state i. When Out is X, the states are reordered in place, and the
+batches whose beams all keep their parents are not touched.
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(beam_reorder, ops::BeamReorderOp,
+                             ops::BeamReorderOpMaker);
+REGISTER_OP_CPU_KERNEL(beam_reorder, ops::BeamReorderKernel<int64_t>);
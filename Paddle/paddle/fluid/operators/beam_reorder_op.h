@@ -0,0 +1,92 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <cstring>
+#include <vector>
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace operators {
+
+using LoDTensor = framework::LoDTensor;
+
+// T is the type of ParentIdx, the states are moved as bytes.
+template <typename T>
+class BeamReorderKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto xs = ctx.MultiInput<LoDTensor>("X");
+    auto outs = ctx.MultiOutput<LoDTensor>("Out");
+    auto* parent_idx = ctx.Input<LoDTensor>("ParentIdx");
+
+    const int64_t batch_size = parent_idx->dims()[0];
+    const int64_t beam_size = parent_idx->dims()[1];
+    const T* parents = parent_idx->data<T>();
+    for (int64_t i = 0; i < batch_size * beam_size; ++i) {
+      PADDLE_ENFORCE(parents[i] >= 0 && parents[i] < beam_size,
+                     "ParentIdx should be in [0, %d), but got %d.", beam_size,
+                     parents[i]);
+    }
+
+    std::vector<char> buffer;
+    for (size_t i = 0; i < xs.size(); ++i) {
+      auto* x = xs[i];
+      auto* out = outs[i];
+      PADDLE_ENFORCE_EQ(x->dims()[0], batch_size * beam_size,
+                        "The rows of Inputs(X) should be batch_size * "
+                        "beam_size.");
+      const size_t row_bytes = x->numel() / x->dims()[0] *
+                               framework::SizeOfType(x->type());
+      if (x == static_cast<const LoDTensor*>(out)) {
+        // Copies the rows of a batch aside before overwriting them.
+        char* data = reinterpret_cast<char*>(
+            out->mutable_data(ctx.GetPlace(), out->type()));
+        buffer.resize(beam_size * row_bytes);
+        for (int64_t b = 0; b < batch_size; ++b) {
+          const T* batch_parents = parents + b * beam_size;
+          bool unchanged = true;
+          for (int64_t k = 0; k < beam_size && unchanged; ++k) {
+            unchanged = batch_parents[k] == k;
+          }
+          if (unchanged) continue;
+          char* batch_data = data + b * beam_size * row_bytes;
+          std::memcpy(buffer.data(), batch_data, buffer.size());
+          for (int64_t k = 0; k < beam_size; ++k) {
+            std::memcpy(batch_data + k * row_bytes,
+                        buffer.data() + batch_parents[k] * row_bytes,
+                        row_bytes);
+          }
+        }
+      } else {
+        out->Resize(x->dims());
+        const char* src = reinterpret_cast<const char*>(x->data<void>());
+        char* dst = reinterpret_cast<char*>(
+            out->mutable_data(ctx.GetPlace(), x->type()));
+        for (int64_t b = 0; b < batch_size; ++b) {
+          for (int64_t k = 0; k < beam_size; ++k) {
+            const int64_t row = b * beam_size + k;
+            std::memcpy(dst + row * row_bytes,
+                        src + (b * beam_size + parents[row]) * row_bytes,
+                        row_bytes);
+          }
+        }
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
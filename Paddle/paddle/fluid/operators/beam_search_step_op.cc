@@ -0,0 +1,162 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/beam_search_step_op.h"
+
+namespace paddle {
+namespace operators {
+
+class BeamSearchStepOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("Scores"),
+                   "Input(Scores) of BeamSearchStepOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("SelectedIds"),
+                   "Output(SelectedIds) of BeamSearchStepOp should not be "
+                   "null.");
+    PADDLE_ENFORCE(ctx->HasOutput("SelectedScores"),
+                   "Output(SelectedScores) of BeamSearchStepOp should not be "
+                   "null.");
+    PADDLE_ENFORCE(ctx->HasOutput("ParentIdx"),
+                   "Output(ParentIdx) of BeamSearchStepOp should not be null.");
+    PADDLE_ENFORCE_EQ(ctx->HasInput("PreIds"), ctx->HasInput("PreScores"),
+                      "Input(PreIds) and Input(PreScores) of "
+                      "BeamSearchStepOp should be given together.");
+
+    auto scores_dims = ctx->GetInputDim("Scores");
+    PADDLE_ENFORCE_GE(scores_dims.size(), 2,
+                      "Input(Scores) should be at least 2-D.");
+    if (ctx->HasInput("Ids")) {
+      PADDLE_ENFORCE_EQ(ctx->GetInputDim("Ids"), scores_dims,
+                        "Input(Ids) should have the shape of Input(Scores).");
+    }
+    int64_t batch_size = -1;
+    if (ctx->HasInput("PreIds")) {
+      auto pre_ids_dims = ctx->GetInputDim("PreIds");
+      PADDLE_ENFORCE_EQ(pre_ids_dims.size(), 2,
+                        "Input(PreIds) should be [batch_size, beam_size].");
+      PADDLE_ENFORCE_EQ(pre_ids_dims, ctx->GetInputDim("PreScores"),
+                        "Input(PreScores) should have the shape of "
+                        "Input(PreIds).");
+      batch_size = pre_ids_dims[0];
+    } else {
+      // The first step, every row of Scores is a batch.
+      auto rows_dims = framework::slice_ddim(scores_dims, 0,
+                                             scores_dims.size() - 1);
+      if (framework::product(rows_dims) > 0) {
+        batch_size = framework::product(rows_dims);
+      }
+    }
+
+    int beam_size = ctx->Attrs().Get<int>("beam_size");
+    auto out_dims = framework::make_ddim({batch_size, beam_size});
+    ctx->SetOutputDim("SelectedIds", out_dims);
+    ctx->SetOutputDim("SelectedScores", out_dims);
+    ctx->SetOutputDim("ParentIdx", out_dims);
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        OperatorWithKernel::IndicateVarDataType(ctx, "Scores"),
+        platform::CPUPlace());
+  }
+};
+
+class BeamSearchStepOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Scores",
+             "(Tensor) The log probabilities of the next tokens, whose last "
+             "dimension is vocab_size and whose rows are "
+             "[batch_size * beam_size], or [batch_size] in the first step. "
+             "With Ids, the last dimension is the number of the candidates "
+             "of every beam.");
+    AddInput("Ids",
+             "(Tensor<int64>) The tokens of Scores, e.g. the Indices of "
+             "logits_to_topk. Every token of the vocabulary is a candidate if "
+             "it is not given.")
+        .AsDispensable();
+    AddInput("PreIds",
+             "(Tensor<int64>) [batch_size, beam_size], the tokens selected in "
+             "the previous step. Not given in the first step.")
+        .AsDispensable();
+    AddInput("PreScores",
+             "(Tensor) [batch_size, beam_size], the accumulated scores of the "
+             "beams selected in the previous step. Not given in the first "
+             "step.")
+        .AsDispensable();
+    AddInput("Step",
+             "(Tensor<int>) A scalar tensor holding the 1-based step, it has "
+             "higher priority than Attr(step).")
+        .AsDispensable();
+    AddOutput("SelectedIds",
+              "(Tensor<int64>) [batch_size, beam_size], the selected tokens.");
+    AddOutput("SelectedScores",
+              "(Tensor) [batch_size, beam_size], the accumulated scores of the "
+              "selected beams, in descending order.");
+    AddOutput("ParentIdx",
+              "(Tensor<int64>) [batch_size, beam_size], the index of the beam "
+              "of the previous step that every selected beam extends, in "
+              "[0, beam_size).");
+    AddAttr<int>("beam_size", "(int) The beam size.");
+    AddAttr<int>("step", "(int, default 1) The 1-based step.").SetDefault(1);
+    AddAttr<int>("eos_id", "(int) The id of [EOS].");
+    AddAttr<int>("pad_id", "(int) The id of [PAD].");
+    AddAttr<int>("unk_id", "(int, default -1) The id of [UNK].")
+        .SetDefault(-1);
+    AddAttr<bool>("ignore_unk",
+                  "(bool, default false) Whether [UNK] is never generated.")
+        .SetDefault(false);
+    AddAttr<int>("min_gen_len",
+                 "(int, default 1) [EOS] is not generated until this step.")
+        .SetDefault(1);
+    AddAttr<bool>("length_average",
+                  "(bool, default false) Whether the score of a beam is the "
+                  "average of the scores of its tokens.")
+        .SetDefault(false);
+    AddAttr<float>("length_penalty",
+                   "(float, default -1.0) The alpha of the length penalty "
+                   "((5 + step) / 6)^alpha, disabled if it is negative.")
+        .SetDefault(-1.0f);
+    AddComment(R"DOC(
+BeamSearchStep Operator.
+
+One step of the beam search on dense tensors. In one pass over the scores of
+the [batch_size, beam_size, vocab_size] candidates, it penalizes [UNK] and
+early [EOS], normalizes the scores by the length, and selects the best
+beam_size candidates of every batch. The beams which ended with [EOS] or
+[PAD] only go on with [PAD] and keep their scores.
+
+If Ids is given, only the tokens of Ids are the candidates of a beam. The
+result is the same as the dense one if they are the top beam_size + 2 tokens
+of every beam, which leaves room for the penalized [UNK] and [EOS].
+
+The ParentIdx of all the steps can be backtraced by gather_tree, and the
+states of the beams can be reordered by beam_reorder.
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(beam_search_step, ops::BeamSearchStepOp,
+                             ops::BeamSearchStepOpMaker);
+REGISTER_OP_CPU_KERNEL(beam_search_step, ops::BeamSearchStepKernel<float>,
+                       ops::BeamSearchStepKernel<double>);
@@ -0,0 +1,172 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+// The score added to the tokens which must not be generated.
+constexpr float kBeamSearchPenalty = -1e10f;
+
+// The 1-based step of the generation, from Input(Step) if it is given.
+inline int GetBeamSearchStep(const framework::ExecutionContext& ctx) {
+  auto* step_t = ctx.Input<Tensor>("Step");
+  if (step_t == nullptr) {
+    return ctx.Attr<int>("step");
+  }
+  PADDLE_ENFORCE_EQ(step_t->numel(), 1, "Input(Step) should be a scalar.");
+  if (step_t->type() == framework::proto::VarType::INT32) {
+    return step_t->data<int32_t>()[0];
+  }
+  return static_cast<int>(step_t->data<int64_t>()[0]);
+}
+
+template <typename T>
+class BeamSearchStepKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* scores = ctx.Input<Tensor>("Scores");
+    auto* ids = ctx.Input<Tensor>("Ids");
+    auto* pre_ids = ctx.Input<Tensor>("PreIds");
+    auto* pre_scores = ctx.Input<Tensor>("PreScores");
+    auto* selected_ids = ctx.Output<Tensor>("SelectedIds");
+    auto* selected_scores = ctx.Output<Tensor>("SelectedScores");
+    auto* parent_idx = ctx.Output<Tensor>("ParentIdx");
+
+    const int beam_size = ctx.Attr<int>("beam_size");
+    const int64_t unk_id = ctx.Attr<bool>("ignore_unk")
+                               ? static_cast<int64_t>(ctx.Attr<int>("unk_id"))
+                               : -1;
+    const int64_t eos_id = ctx.Attr<int>("eos_id");
+    const int64_t pad_id = ctx.Attr<int>("pad_id");
+    const int step = GetBeamSearchStep(ctx);
+    const int64_t banned_eos =
+        step <= ctx.Attr<int>("min_gen_len") ? eos_id : -1;
+
+    // The candidates of a row are the whole vocabulary, or the tokens of Ids.
+    auto& dims = scores->dims();
+    const int64_t width = dims[dims.size() - 1];
+    const int64_t rows = scores->numel() / width;
+    const bool has_pre = pre_ids != nullptr;
+    const int64_t pre_beam = has_pre ? pre_ids->dims()[1] : 1;
+    const int64_t batch_size = rows / pre_beam;
+    PADDLE_ENFORCE_EQ(batch_size * pre_beam, rows,
+                      "The rows of Input(Scores) should be batch_size * "
+                      "beam_size of Input(PreIds).");
+    PADDLE_ENFORCE_LE(beam_size, pre_beam * width,
+                      "There are fewer candidates than beam_size.");
+    if (ids != nullptr) {
+      PADDLE_ENFORCE_EQ(ids->dims(), dims,
+                        "Input(Ids) should have the shape of Input(Scores).");
+    }
+
+    // The accumulated score of an unfinished beam is pre_score * pre_scale +
+    // score * scale. The first step only ranks the scores of the tokens.
+    T pre_scale = 1;
+    T scale = 1;
+    if (!has_pre) {
+      pre_scale = 0;
+    } else if (ctx.Attr<bool>("length_average")) {
+      pre_scale = 1 - static_cast<T>(1) / step;
+      scale = static_cast<T>(1) / step;
+    } else if (ctx.Attr<float>("length_penalty") >= 0) {
+      const T alpha = ctx.Attr<float>("length_penalty");
+      pre_scale = std::pow(static_cast<T>(4 + step) / (5 + step), alpha);
+      scale = std::pow(static_cast<T>(1) / (5 + step), alpha);
+    }
+
+    const T* scores_data = scores->data<T>();
+    const int64_t* ids_data = ids ? ids->data<int64_t>() : nullptr;
+    const int64_t* pre_ids_data = has_pre ? pre_ids->data<int64_t>() : nullptr;
+    const T* pre_scores_data = has_pre ? pre_scores->data<T>() : nullptr;
+    selected_ids->Resize({batch_size, beam_size});
+    selected_scores->Resize({batch_size, beam_size});
+    parent_idx->Resize({batch_size, beam_size});
+    auto* out_ids_data = selected_ids->mutable_data<int64_t>(ctx.GetPlace());
+    auto* out_scores_data = selected_scores->mutable_data<T>(ctx.GetPlace());
+    auto* parent_data = parent_idx->mutable_data<int64_t>(ctx.GetPlace());
+
+    // A candidate is pre_beam_index * (width + 1) + c, c is the column of
+    // Scores, or width for the [PAD] after a finished beam.
+    const int64_t stride = width + 1;
+    auto token = [&](int64_t row, int64_t c) -> int64_t {
+      if (c == width) return pad_id;
+      return ids_data ? ids_data[row * width + c] : c;
+    };
+
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int64_t b = 0; b < batch_size; ++b) {
+      // A min-heap of the best beam_size candidates.
+      std::vector<std::pair<T, int64_t>> heap;
+      heap.reserve(beam_size);
+      auto greater = std::greater<std::pair<T, int64_t>>();
+      auto push = [&](T score, int64_t index) {
+        if (heap.size() < static_cast<size_t>(beam_size)) {
+          heap.emplace_back(score, index);
+          std::push_heap(heap.begin(), heap.end(), greater);
+        } else if (score > heap.front().first) {
+          std::pop_heap(heap.begin(), heap.end(), greater);
+          heap.back() = std::make_pair(score, index);
+          std::push_heap(heap.begin(), heap.end(), greater);
+        }
+      };
+
+      for (int64_t j = 0; j < pre_beam; ++j) {
+        const int64_t row = b * pre_beam + j;
+        if (has_pre) {
+          // A finished beam only goes on with [PAD], keeping its score.
+          const int64_t pre_id = pre_ids_data[row];
+          if (pre_id == eos_id || pre_id == pad_id) {
+            push(pre_scores_data[row], j * stride + width);
+            continue;
+          }
+        }
+        const T base = has_pre ? pre_scores_data[row] * pre_scale : 0;
+        const T* row_scores = scores_data + row * width;
+        for (int64_t c = 0; c < width; ++c) {
+          T score = row_scores[c];
+          const int64_t v = token(row, c);
+          if (v == unk_id || v == banned_eos) {
+            score += kBeamSearchPenalty;
+          }
+          push(base + score * scale, j * stride + c);
+        }
+      }
+
+      std::sort_heap(heap.begin(), heap.end(), greater);
+      for (int k = 0; k < beam_size; ++k) {
+        const int64_t out = b * beam_size + k;
+        const int64_t parent = heap[k].second / stride;
+        out_scores_data[out] = heap[k].first;
+        out_ids_data[out] =
+            token(b * pre_beam + parent, heap[k].second % stride);
+        parent_data[out] = parent;
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
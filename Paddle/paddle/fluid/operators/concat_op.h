@@ -67,17 +67,24 @@ static inline int64_t ComputeAxis(int64_t axis, int64_t rank) {
   return axis > 0 ? axis : 0;
 }
 
+// The slots of ConcatOpMaker read by ConcatKernel. AxisTensor is added after
+// the attrs, but it is still the second input.
+constexpr framework::OpSlot kConcatX{0, "X"};
+constexpr framework::OpSlot kConcatAxisTensor{1, "AxisTensor"};
+constexpr framework::OpSlot kConcatOut{0, "Out"};
+constexpr framework::OpSlot kConcatAxis{1, "axis"};
+
 template <typename DeviceContext, typename T>
 class ConcatKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext& ctx) const override {
-    auto ins = ctx.MultiInput<framework::Tensor>("X");
-    framework::Tensor* out = ctx.Output<framework::Tensor>("Out");
+    auto ins = ctx.MultiInput<framework::Tensor>(kConcatX);
+    framework::Tensor* out = ctx.Output<framework::Tensor>(kConcatOut);
     PADDLE_ENFORCE_EQ(ins[0] != nullptr, true, "The input should not be null.");
-    auto axis = ctx.Attr<int>("axis");
+    auto axis = ctx.Attr<int>(kConcatAxis);
     bool need_resize_out_dims = false;
-    if (ctx.HasInput("AxisTensor")) {
-      auto* axis_tensor = ctx.Input<framework::Tensor>("AxisTensor");
+    if (ctx.HasInput(kConcatAxisTensor)) {
+      auto* axis_tensor = ctx.Input<framework::Tensor>(kConcatAxisTensor);
       axis = GetDataFromTensor<int>(axis_tensor)[0];
       need_resize_out_dims = true;
     }
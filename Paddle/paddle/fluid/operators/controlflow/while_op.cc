@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
+#include <mutex>  // NOLINT
 #include <vector>
 #include "paddle/fluid/framework/executor.h"
 #include "paddle/fluid/framework/lod_tensor_array.h"
@@ -63,7 +65,15 @@ class WhileOp : public framework::OperatorBase {
     auto step_scopes =
         scope.FindVar(Output(kStepScopes))->GetMutable<StepScopeVar>();
 
-    if (step_scopes->size() > 0) {
+    bool is_test = Attr<bool>("is_test");
+    // In inference the step scope is owned by the op and reused by every run,
+    // so the variables and tensor buffers of the step block survive across
+    // runs. It is not a kid of scope, thus not freed when scope drops kids.
+    framework::Scope *pooled_scope =
+        is_test ? PooledScope(scope, &executor, *program, block->ID())
+                : nullptr;
+    if (step_scopes->size() > 0 &&
+        !(step_scopes->size() == 1 && step_scopes->front() == pooled_scope)) {
       platform::DeviceContextPool::Instance().Get(dev_place)->Wait();
       for (auto &s : *step_scopes) {
         if (scope.HasKid(s)) {
@@ -73,28 +83,25 @@ class WhileOp : public framework::OperatorBase {
       step_scopes->clear();
     }
 
-    PADDLE_ENFORCE_EQ(step_scopes->size(), 0, "The StepScope should be empty.");
     PADDLE_ENFORCE(platform::is_cpu_place(cond.place()),
                    "Condition of while op must in CPU memory.");
 
-    bool is_test = Attr<bool>("is_test");
-    auto &skip_vars = Attr<std::vector<std::string>>(kSkipEagerDeletionVars);
-    VLOG(2) << GetSkipEagerDeletionVarsDebugString(skip_vars);
-
-    auto ctx = executor.Prepare(*program, block->ID(), skip_vars);
+    auto *ctx = PreparedContext(&executor, *program, block->ID());
     if (!is_test) {
+      PADDLE_ENFORCE_EQ(step_scopes->size(), 0,
+                        "The StepScope should be empty.");
       while (cond.data<bool>()[0]) {
         auto &current_scope = scope.NewScope();
         step_scopes->push_back(&current_scope);
-        executor.RunPreparedContext(ctx.get(), &current_scope, false, true,
-                                    true);
+        executor.RunPreparedContext(ctx, &current_scope, false, true, true);
       }
     } else {
-      auto &current_scope = scope.NewScope();
-      executor.CreateVariables(*program, &current_scope, block->ID());
+      if (step_scopes->empty()) {
+        step_scopes->push_back(pooled_scope);
+      }
       while (cond.data<bool>()[0]) {
-        for (auto &name : current_scope.LocalVarNames()) {
-          auto *var = current_scope.Var(name);
+        for (auto &name : pooled_scope->LocalVarNames()) {
+          auto *var = pooled_scope->Var(name);
           if (var->IsType<framework::LoDTensor>()) {
             // Clear all lod information for all lod_tensors.
             auto *t = var->GetMutable<framework::LoDTensor>();
@@ -106,12 +113,44 @@ class WhileOp : public framework::OperatorBase {
             t->clear();
           }
         }
-        executor.RunPreparedContext(ctx.get(), &current_scope, false, false,
-                                    false);
+        executor.RunPreparedContext(ctx, pooled_scope, false, false, false);
       }
-      scope.DeleteScope(&current_scope);
     }
   }
+
+  // The step scope used in inference, created again when the op runs in
+  // another scope.
+  framework::Scope *PooledScope(const framework::Scope &scope,
+                                framework::Executor *executor,
+                                const framework::ProgramDesc &program,
+                                int block_id) const {
+    std::lock_guard<std::mutex> guard(pooled_scope_mutex_);
+    if (pooled_scope_ == nullptr || pooled_scope_parent_ != &scope) {
+      pooled_scope_ = scope.NewTmpScope();
+      pooled_scope_parent_ = &scope;
+      executor->CreateVariables(program, pooled_scope_.get(), block_id);
+    }
+    return pooled_scope_.get();
+  }
+
+  // The ops of the step block are created once and reused by every run.
+  framework::ExecutorPrepareContext *PreparedContext(
+      framework::Executor *executor, const framework::ProgramDesc &program,
+      int block_id) const {
+    std::lock_guard<std::mutex> guard(prepared_ctx_mutex_);
+    if (prepared_ctx_ == nullptr) {
+      auto &skip_vars = Attr<std::vector<std::string>>(kSkipEagerDeletionVars);
+      VLOG(2) << GetSkipEagerDeletionVarsDebugString(skip_vars);
+      prepared_ctx_ = executor->Prepare(program, block_id, skip_vars);
+    }
+    return prepared_ctx_.get();
+  }
+
+  mutable std::unique_ptr<framework::ExecutorPrepareContext> prepared_ctx_;
+  mutable std::mutex prepared_ctx_mutex_;
+  mutable std::unique_ptr<framework::Scope> pooled_scope_;
+  mutable const framework::Scope *pooled_scope_parent_{nullptr};
+  mutable std::mutex pooled_scope_mutex_;
 };
 
 class WhileOpMaker : public framework::OpProtoAndCheckerMaker {
@@ -0,0 +1,120 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+
+USE_NO_KERNEL_OP(while);
+USE_OP(less_than);
+USE_OP(increment);
+USE_OP(scale);
+USE_OP(elementwise_add);
+
+namespace paddle {
+namespace operators {
+
+using StepScopeVar = std::vector<framework::Scope *>;
+
+static void AddOp(framework::BlockDesc *block, const std::string &type,
+                  const framework::VariableNameMap &inputs,
+                  const framework::VariableNameMap &outputs,
+                  const framework::AttributeMap &attrs) {
+  auto *op = block->AppendOp();
+  op->SetType(type);
+  for (auto &in : inputs) op->SetInput(in.first, in.second);
+  for (auto &out : outputs) op->SetOutput(out.first, out.second);
+  op->SetAttrMap(attrs);
+}
+
+template <typename T>
+static void SetCPUTensor(framework::Scope *scope, const std::string &name,
+                         const std::vector<T> &data) {
+  auto *t = scope->Var(name)->GetMutable<framework::LoDTensor>();
+  t->Resize(framework::make_ddim({static_cast<int64_t>(data.size())}));
+  std::copy(data.begin(), data.end(),
+            t->mutable_data<T>(platform::CPUPlace()));
+}
+
+// out += 2 * x for n steps, with 2 * x stored in a local of the step block.
+static std::unique_ptr<framework::OperatorBase> CreateWhileOp(
+    framework::ProgramDesc *program) {
+  auto *global = program->MutableBlock(0);
+  auto *step = program->AppendBlock(*global);
+  step->Var("y")->SetType(framework::proto::VarType::LOD_TENSOR);
+  AddOp(step, "scale", {{"X", {"x"}}}, {{"Out", {"y"}}}, {{"scale", 2.0f}});
+  AddOp(step, "elementwise_add", {{"X", {"out"}}, {"Y", {"y"}}},
+        {{"Out", {"out"}}}, {});
+  AddOp(step, "increment", {{"X", {"i"}}}, {{"Out", {"i"}}}, {{"step", 1.0f}});
+  AddOp(step, "less_than", {{"X", {"i"}}, {"Y", {"n"}}}, {{"Out", {"cond"}}},
+        {});
+
+  auto *op = global->AppendOp();
+  op->SetType("while");
+  op->SetInput("X", {"x", "out", "i", "n"});
+  op->SetInput("Condition", {"cond"});
+  op->SetOutput("Out", {"out", "i", "cond"});
+  op->SetOutput("StepScopes", {"step_scopes"});
+  op->SetBlockAttr("sub_block", step);
+  op->SetAttr("is_test", true);
+  op->SetAttr("skip_eager_deletion_vars",
+              std::vector<std::string>({"x", "out", "i", "n", "cond"}));
+  return framework::OpRegistry::CreateOp(*op);
+}
+
+static std::vector<float> RunWhileOp(framework::OperatorBase *op,
+                                     framework::Scope *scope,
+                                     const std::vector<float> &x) {
+  SetCPUTensor<float>(scope, "x", x);
+  SetCPUTensor<float>(scope, "out", std::vector<float>(x.size(), 0.f));
+  SetCPUTensor<int64_t>(scope, "i", {0});
+  SetCPUTensor<int64_t>(scope, "n", {3});
+  SetCPUTensor<bool>(scope, "cond", {true});
+  op->Run(*scope, platform::CPUPlace());
+
+  auto &out = scope->FindVar("out")->Get<framework::LoDTensor>();
+  return std::vector<float>(out.data<float>(), out.data<float>() + x.size());
+}
+
+TEST(WhileOp, is_test_reuses_step_scope) {
+  framework::ProgramDesc program;
+  auto op = CreateWhileOp(&program);
+  framework::Scope scope;
+  scope.Var("step_scopes")->GetMutable<StepScopeVar>();
+
+  auto out = RunWhileOp(op.get(), &scope, {1.f, 2.f});
+  EXPECT_EQ(out, std::vector<float>({6.f, 12.f}));
+  auto &step_scopes = scope.FindVar("step_scopes")->Get<StepScopeVar>();
+  ASSERT_EQ(step_scopes.size(), 1UL);
+  auto *step_scope = step_scopes.front();
+  ASSERT_NE(step_scope->FindLocalVar("y"), nullptr);
+
+  // The step scope is not a kid, dropping the kids must not free it.
+  EXPECT_FALSE(scope.HasKid(step_scope));
+  scope.DropKids();
+
+  out = RunWhileOp(op.get(), &scope, {-1.f, 0.5f});
+  EXPECT_EQ(out, std::vector<float>({-6.f, 3.f}));
+  ASSERT_EQ(step_scopes.size(), 1UL);
+  EXPECT_EQ(step_scopes.front(), step_scope);
+  EXPECT_TRUE(scope.kids().empty());
+}
+
+}  // namespace operators
+}  // namespace paddle
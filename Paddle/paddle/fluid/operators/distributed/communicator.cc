@@ -45,6 +45,11 @@ DEFINE_bool(communicator_merge_sparse_grad, true,
             "merge sparse gradient before sending");
 DEFINE_int32(communicator_merge_sparse_bucket, 2000,
              "number of threads for sparse var");
+DEFINE_string(communicator_grad_compression, "",
+              "compress the dense gradients sent to the parameter servers, "
+              "a ';' separated list of [var_name=]codec, where codec is "
+              "topk[:ratio], int8[:block_size], fp16 or none, and the codec "
+              "without var_name is the default, e.g. \"int8;w@GRAD=topk\"");
 
 namespace paddle {
 namespace operators {
@@ -91,6 +96,8 @@ void AsyncCommunicator::InitImpl(const RpcCtxMap &send_varname_to_ctx,
           << FLAGS_communicator_merge_sparse_grad;
   VLOG(0) << "communicator_is_sgd_optimizer: "
           << FLAGS_communicator_is_sgd_optimizer;
+  VLOG(0) << "communicator_grad_compression: "
+          << FLAGS_communicator_grad_compression;
 
   if (send_varname_to_ctx.size() == 0) {
     VLOG(0) << "nothing need to be send, will not start send_thread";
@@ -100,6 +107,15 @@ void AsyncCommunicator::InitImpl(const RpcCtxMap &send_varname_to_ctx,
       send_varname_to_queue_[iter.first] =
           std::make_shared<BlockingQueue<std::shared_ptr<Variable>>>(
               FLAGS_communicator_send_queue_size);
+      if (!iter.second.use_send_handler) continue;
+      auto codec =
+          GetGradientCodec(FLAGS_communicator_grad_compression, iter.first);
+      for (auto &splited_var_name : iter.second.splited_var_names) {
+        auto compressor = CreateGradientCompressor(codec);
+        if (compressor == nullptr) break;
+        VLOG(1) << "compress " << splited_var_name << " with " << codec;
+        compressors_[splited_var_name] = std::move(compressor);
+      }
     }
     send_threadpool_.reset(
         new ::ThreadPool(FLAGS_communicator_thread_pool_size));
@@ -150,8 +166,13 @@ void AsyncCommunicator::InitImpl(const paddle::framework::ProgramDesc &program,
       auto epmap =
           boost::get<std::vector<std::string>>(op->GetNullableAttr("epmap"));
       auto trainer_id = boost::get<int>(op->GetNullableAttr("trainer_id"));
+      std::vector<int64_t> height_section;
+      if (op->HasAttr("sections")) {
+        height_section =
+            boost::get<std::vector<int64_t>>(op->GetNullableAttr("sections"));
+      }
       recv_varname_to_ctx[recv_var_name] = operators::distributed::RpcContext(
-          recv_var_name, recv_varnames, epmap, {}, trainer_id);
+          recv_var_name, recv_varnames, epmap, height_section, trainer_id);
     }
   }
 
@@ -226,7 +247,7 @@ void AsyncCommunicator::SendThread() {
           VLOG(3) << "merge " << merged_var_num << " " << var_name
                   << " use time " << after_merge - before_merge;
           auto send_functor = distributed::ParameterSend<float>();
-          if (!FLAGS_communicator_fake_rpc) {
+          if (!FLAGS_communicator_fake_rpc && !SendCompressed(ctx)) {
             send_functor(ctx, *send_scope_, true, 1);
           }
           auto after_send = GetCurrentUS();
@@ -251,6 +272,44 @@ void AsyncCommunicator::SendThread() {
   VLOG(0) << "communicator stopped, send thread exit";
 }
 
+bool AsyncCommunicator::SendCompressed(const RpcContext &ctx) {
+  auto *send_var = send_scope_->FindVar(ctx.var_name);
+  if (!send_var->IsType<framework::LoDTensor>() ||
+      compressors_.count(ctx.splited_var_names[0]) == 0) {
+    return false;
+  }
+  auto &send_tensor = send_var->Get<framework::LoDTensor>();
+  std::unique_ptr<Scope> local_scope = send_scope_->NewTmpScope();
+  platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
+  auto &cpu_ctx = *pool.Get(platform::CPUPlace());
+  distributed::RPCClient *rpc_client =
+      distributed::RPCClient::GetInstance<RPCCLIENT_T>(ctx.trainer_id);
+
+  std::vector<distributed::VarHandlePtr> rets;
+  int64_t row_offset = 0;
+  for (size_t i = 0; i < ctx.splited_var_names.size(); ++i) {
+    auto &send_var_name = ctx.splited_var_names[i];
+    int64_t height = ctx.splited_var_names.size() > 1
+                         ? ctx.height_sections[i]
+                         : send_tensor.dims()[0];
+    auto *out =
+        local_scope->Var(send_var_name)->GetMutable<framework::LoDTensor>();
+    compressors_.at(send_var_name)
+        ->Encode(send_tensor.Slice(row_offset, row_offset + height), out);
+    row_offset += height;
+    VLOG(4) << "send " << send_var_name << " compressed from "
+            << height * send_tensor.numel() / send_tensor.dims()[0] *
+                   sizeof(float)
+            << " to " << out->numel() << " bytes";
+    rets.push_back(rpc_client->AsyncSendVar(ctx.epmap[i], cpu_ctx,
+                                            *local_scope, send_var_name));
+  }
+  for (auto &ret : rets) {
+    PADDLE_ENFORCE(ret->Wait(), "internal error in RPCClient");
+  }
+  return true;
+}
+
 void AsyncCommunicator::RecvThread() {
   VLOG(3) << "RecvThread start!";
   while (running_) {
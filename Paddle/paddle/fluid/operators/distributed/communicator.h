@@ -29,6 +29,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/framework/variable.h"
 #include "paddle/fluid/operators/distributed/distributed.h"
+#include "paddle/fluid/operators/distributed/gradient_compressor.h"
 #include "paddle/fluid/operators/distributed/rpc_client.h"
 #include "paddle/fluid/operators/distributed/rpc_common.h"
 #include "paddle/fluid/operators/distributed_ops/send_recv_util.h"
@@ -315,11 +316,19 @@ class AsyncCommunicator : public Communicator {
       const int& trainers, const int& geo_need_push_nums) override;
 
  private:
+  // Sends the merged gradient in send_scope_ compressed, returns false if
+  // it is not compressed.
+  bool SendCompressed(const RpcContext& ctx);
+
   std::unordered_map<std::string,
                      std::shared_ptr<BlockingQueue<std::shared_ptr<Variable>>>>
       send_varname_to_queue_;
   RpcCtxMap send_varname_to_ctx_;
   RpcCtxMap recv_varname_to_ctx_;
+  // The compressors of the splits of the dense gradients, see
+  // FLAGS_communicator_grad_compression.
+  std::unordered_map<std::string, std::unique_ptr<GradientCompressor>>
+      compressors_;
   std::unique_ptr<std::thread> send_thread_{nullptr};
   std::unique_ptr<std::thread> recv_thread_{nullptr};
   Scope* recv_scope_;                  // should be global scope
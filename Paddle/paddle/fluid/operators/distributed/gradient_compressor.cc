@@ -0,0 +1,288 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/distributed/gradient_compressor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/float16.h"
+#include "paddle/fluid/string/split.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+namespace {
+
+constexpr uint32_t kCompressedMagic = 0x43475244;
+
+enum GradientCodec : uint32_t { kTopK = 1, kInt8 = 2, kFP16 = 3 };
+
+// Followed by the dims of the gradient and the payload of the codec.
+struct CompressedHeader {
+  uint32_t magic;
+  uint32_t codec;
+  uint32_t rank;
+  // The number of elements of topk, or the block size of int8.
+  uint32_t param;
+};
+
+// Writes the header of grad to out, and returns the payload of out.
+uint8_t* InitCompressed(const framework::Tensor& grad, uint32_t codec,
+                        uint32_t param, size_t payload_size,
+                        framework::LoDTensor* out) {
+  auto dims = framework::vectorize(grad.dims());
+  size_t header_size = sizeof(CompressedHeader) + dims.size() * sizeof(int64_t);
+  out->Resize({static_cast<int64_t>(header_size + payload_size)});
+  uint8_t* data = out->mutable_data<uint8_t>(platform::CPUPlace());
+  CompressedHeader header{kCompressedMagic, codec,
+                          static_cast<uint32_t>(dims.size()), param};
+  std::memcpy(data, &header, sizeof(header));
+  std::memcpy(data + sizeof(header), dims.data(),
+              dims.size() * sizeof(int64_t));
+  return data + header_size;
+}
+
+const float* GradData(const framework::Tensor& grad) {
+  PADDLE_ENFORCE(platform::is_cpu_place(grad.place()),
+                 "Only the gradients on CPU can be compressed");
+  PADDLE_ENFORCE_EQ(grad.type(), framework::proto::VarType::FP32,
+                    "Only float gradients can be compressed");
+  PADDLE_ENFORCE_LE(grad.numel(), std::numeric_limits<uint32_t>::max(),
+                    "The gradient is too large to be compressed");
+  return grad.data<float>();
+}
+
+class TopKCompressor : public GradientCompressor {
+ public:
+  explicit TopKCompressor(double ratio) : ratio_(ratio) {
+    PADDLE_ENFORCE(ratio_ > 0 && ratio_ <= 1,
+                   "The ratio of topk should be in (0, 1], but got %f", ratio_);
+  }
+
+  void Encode(const framework::Tensor& grad,
+              framework::LoDTensor* out) override {
+    const float* x = GradData(grad);
+    size_t numel = grad.numel();
+    if (residual_.size() != numel) {
+      residual_.assign(numel, 0.0f);
+    }
+    for (size_t i = 0; i < numel; ++i) {
+      residual_[i] += x[i];
+    }
+
+    size_t k = std::min(
+        numel, std::max<size_t>(1, static_cast<size_t>(std::ceil(
+                                       ratio_ * static_cast<double>(numel)))));
+    indices_.resize(numel);
+    std::iota(indices_.begin(), indices_.end(), 0);
+    std::nth_element(indices_.begin(), indices_.begin() + k, indices_.end(),
+                     [this](uint32_t a, uint32_t b) {
+                       return std::fabs(residual_[a]) > std::fabs(residual_[b]);
+                     });
+    std::sort(indices_.begin(), indices_.begin() + k);
+
+    uint8_t* payload = InitCompressed(
+        grad, kTopK, k, k * (sizeof(uint32_t) + sizeof(float)), out);
+    auto* out_indices = reinterpret_cast<uint32_t*>(payload);
+    auto* out_values = reinterpret_cast<float*>(payload + k * sizeof(uint32_t));
+    for (size_t i = 0; i < k; ++i) {
+      uint32_t index = indices_[i];
+      out_indices[i] = index;
+      out_values[i] = residual_[index];
+      residual_[index] = 0.0f;
+    }
+  }
+
+ private:
+  double ratio_;
+  // The sum of the elements not sent yet.
+  std::vector<float> residual_;
+  std::vector<uint32_t> indices_;
+};
+
+class Int8Compressor : public GradientCompressor {
+ public:
+  explicit Int8Compressor(int block_size) : block_size_(block_size) {
+    PADDLE_ENFORCE_GT(block_size, 0, "The block size of int8 should be > 0");
+  }
+
+  void Encode(const framework::Tensor& grad,
+              framework::LoDTensor* out) override {
+    const float* x = GradData(grad);
+    size_t numel = grad.numel();
+    size_t num_blocks = (numel + block_size_ - 1) / block_size_;
+    uint8_t* payload = InitCompressed(
+        grad, kInt8, block_size_, num_blocks * sizeof(float) + numel, out);
+    auto* scales = reinterpret_cast<float*>(payload);
+    auto* values =
+        reinterpret_cast<int8_t*>(payload + num_blocks * sizeof(float));
+    for (size_t block = 0; block < num_blocks; ++block) {
+      size_t begin = block * block_size_;
+      size_t end = std::min(numel, begin + block_size_);
+      float max_abs = 0.0f;
+      for (size_t i = begin; i < end; ++i) {
+        max_abs = std::max(max_abs, std::fabs(x[i]));
+      }
+      float scale = max_abs / 127.0f;
+      float inv_scale = max_abs > 0.0f ? 127.0f / max_abs : 0.0f;
+      scales[block] = scale;
+      for (size_t i = begin; i < end; ++i) {
+        float value = std::round(x[i] * inv_scale);
+        values[i] = static_cast<int8_t>(
+            std::min(127.0f, std::max(-127.0f, value)));
+      }
+    }
+  }
+
+ private:
+  size_t block_size_;
+};
+
+class FP16Compressor : public GradientCompressor {
+ public:
+  void Encode(const framework::Tensor& grad,
+              framework::LoDTensor* out) override {
+    const float* x = GradData(grad);
+    size_t numel = grad.numel();
+    uint8_t* payload =
+        InitCompressed(grad, kFP16, 0, numel * sizeof(platform::float16), out);
+    auto* values = reinterpret_cast<platform::float16*>(payload);
+    for (size_t i = 0; i < numel; ++i) {
+      values[i] = static_cast<platform::float16>(x[i]);
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<GradientCompressor> CreateGradientCompressor(
+    const std::string& codec) {
+  auto pos = codec.find(':');
+  std::string name = codec.substr(0, pos);
+  std::string param = pos == std::string::npos ? "" : codec.substr(pos + 1);
+  if (name.empty() || name == "none") {
+    return nullptr;
+  } else if (name == "topk") {
+    return std::unique_ptr<GradientCompressor>(
+        new TopKCompressor(param.empty() ? 0.01 : std::stod(param)));
+  } else if (name == "int8") {
+    return std::unique_ptr<GradientCompressor>(
+        new Int8Compressor(param.empty() ? 256 : std::stoi(param)));
+  } else if (name == "fp16") {
+    return std::unique_ptr<GradientCompressor>(new FP16Compressor());
+  }
+  PADDLE_THROW("Unknown gradient codec %s, should be topk, int8 or fp16",
+               codec);
+}
+
+std::string GetGradientCodec(const std::string& config,
+                             const std::string& var_name) {
+  std::string default_codec;
+  for (auto& entry : string::Split(config, ';')) {
+    auto pos = entry.find('=');
+    if (pos == std::string::npos) {
+      default_codec = entry;
+    } else if (entry.substr(0, pos) == var_name) {
+      return entry.substr(pos + 1);
+    }
+  }
+  return default_codec;
+}
+
+bool IsCompressedGradient(const framework::Variable& var) {
+  if (!var.IsType<framework::LoDTensor>()) return false;
+  auto& tensor = var.Get<framework::LoDTensor>();
+  if (!tensor.IsInitialized() ||
+      tensor.type() != framework::proto::VarType::UINT8 ||
+      tensor.numel() < static_cast<int64_t>(sizeof(CompressedHeader))) {
+    return false;
+  }
+  uint32_t magic;
+  std::memcpy(&magic, tensor.data<uint8_t>(), sizeof(magic));
+  return magic == kCompressedMagic;
+}
+
+void DecodeGradient(framework::Variable* var) {
+  PADDLE_ENFORCE(IsCompressedGradient(*var), "The gradient is not compressed");
+  auto& in = var->Get<framework::LoDTensor>();
+  const uint8_t* data = in.data<uint8_t>();
+  CompressedHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  size_t header_size = sizeof(header) + header.rank * sizeof(int64_t);
+  PADDLE_ENFORCE_GE(static_cast<size_t>(in.numel()), header_size,
+                    "The compressed gradient is truncated");
+  std::vector<int64_t> dims(header.rank);
+  std::memcpy(dims.data(), data + sizeof(header),
+              header.rank * sizeof(int64_t));
+  const uint8_t* payload = data + header_size;
+  size_t payload_size = in.numel() - header_size;
+
+  framework::LoDTensor out;
+  out.Resize(framework::make_ddim(dims));
+  float* y = out.mutable_data<float>(platform::CPUPlace());
+  size_t numel = out.numel();
+  switch (header.codec) {
+    case kTopK: {
+      size_t k = header.param;
+      PADDLE_ENFORCE_EQ(payload_size, k * (sizeof(uint32_t) + sizeof(float)),
+                        "The compressed gradient is truncated");
+      auto* indices = reinterpret_cast<const uint32_t*>(payload);
+      auto* values =
+          reinterpret_cast<const float*>(payload + k * sizeof(uint32_t));
+      std::fill(y, y + numel, 0.0f);
+      for (size_t i = 0; i < k; ++i) {
+        PADDLE_ENFORCE_LT(indices[i], numel, "The index is out of range");
+        y[indices[i]] = values[i];
+      }
+      break;
+    }
+    case kInt8: {
+      size_t block_size = header.param;
+      PADDLE_ENFORCE_GT(block_size, 0UL, "The block size should be > 0");
+      size_t num_blocks = (numel + block_size - 1) / block_size;
+      PADDLE_ENFORCE_EQ(payload_size, num_blocks * sizeof(float) + numel,
+                        "The compressed gradient is truncated");
+      auto* scales = reinterpret_cast<const float*>(payload);
+      auto* values =
+          reinterpret_cast<const int8_t*>(payload + num_blocks * sizeof(float));
+      for (size_t i = 0; i < numel; ++i) {
+        y[i] = values[i] * scales[i / block_size];
+      }
+      break;
+    }
+    case kFP16: {
+      PADDLE_ENFORCE_EQ(payload_size, numel * sizeof(platform::float16),
+                        "The compressed gradient is truncated");
+      auto* values = reinterpret_cast<const platform::float16*>(payload);
+      for (size_t i = 0; i < numel; ++i) {
+        y[i] = static_cast<float>(values[i]);
+      }
+      break;
+    }
+    default:
+      PADDLE_THROW("Unknown gradient codec %d", header.codec);
+  }
+  var->GetMutable<framework::LoDTensor>()->ShareDataWith(out);
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,70 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/variable.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+/*
+ * Compresses the dense float gradients sent to the parameter servers.
+ *
+ * A compressed gradient is sent as a 1-D UINT8 tensor, which starts with a
+ * header of the codec and the dims of the gradient. The server decodes it
+ * back into a float tensor before running the optimize blocks.
+ *
+ * The codecs are:
+ *   topk[:ratio]   only sends the ratio (default 0.01) of the elements of the
+ *                  largest magnitude. The rest are accumulated in a residual
+ *                  and added to the next gradient (error feedback).
+ *   int8[:block]   quantizes every block (default 256) of elements to int8
+ *                  with a float scale.
+ *   fp16           converts the elements to float16.
+ *
+ * A compressor keeps the residual of one gradient, so every split of a
+ * gradient has its own.
+ */
+class GradientCompressor {
+ public:
+  virtual ~GradientCompressor() {}
+
+  virtual void Encode(const framework::Tensor& grad,
+                      framework::LoDTensor* out) = 0;
+};
+
+// Returns null if codec is empty or "none".
+std::unique_ptr<GradientCompressor> CreateGradientCompressor(
+    const std::string& codec);
+
+// Finds the codec of var_name in config, a ';' separated list of
+// "var_name=codec" entries. An entry without var_name is the default of
+// all variables, e.g. "int8;fc_0.w_0@GRAD=topk:0.001;fc_0.b_0@GRAD=none".
+std::string GetGradientCodec(const std::string& config,
+                             const std::string& var_name);
+
+bool IsCompressedGradient(const framework::Variable& var);
+
+// Decodes the compressed gradient in var into a float LoDTensor.
+void DecodeGradient(framework::Variable* var);
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,103 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/distributed/gradient_compressor.h"
+
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+static framework::LoDTensor MakeGrad(const std::vector<float>& values,
+                                     const framework::DDim& dims) {
+  framework::LoDTensor grad;
+  grad.Resize(dims);
+  float* data = grad.mutable_data<float>(platform::CPUPlace());
+  std::copy(values.begin(), values.end(), data);
+  return grad;
+}
+
+static std::vector<float> EncodeAndDecode(GradientCompressor* compressor,
+                                          const framework::Tensor& grad) {
+  framework::Variable var;
+  auto* out = var.GetMutable<framework::LoDTensor>();
+  compressor->Encode(grad, out);
+  EXPECT_TRUE(IsCompressedGradient(var));
+  DecodeGradient(&var);
+  EXPECT_FALSE(IsCompressedGradient(var));
+  auto& decoded = var.Get<framework::LoDTensor>();
+  EXPECT_EQ(decoded.dims(), grad.dims());
+  return std::vector<float>(decoded.data<float>(),
+                            decoded.data<float>() + decoded.numel());
+}
+
+TEST(GradientCompressor, TopKWithErrorFeedback) {
+  auto compressor = CreateGradientCompressor("topk:0.25");
+  auto grad = MakeGrad({1, -8, 2, 3, 0.5, 7, -1.5, 4}, {2, 4});
+
+  // The 2 elements of the largest magnitude are sent.
+  std::vector<float> expected = {0, -8, 0, 0, 0, 7, 0, 0};
+  EXPECT_EQ(EncodeAndDecode(compressor.get(), grad), expected);
+
+  // The rest are added to the next gradient.
+  auto zeros = MakeGrad(std::vector<float>(8, 0), {2, 4});
+  expected = {0, 0, 0, 3, 0, 0, 0, 4};
+  EXPECT_EQ(EncodeAndDecode(compressor.get(), zeros), expected);
+  expected = {0, 0, 2, 0, 0, 0, -1.5, 0};
+  EXPECT_EQ(EncodeAndDecode(compressor.get(), zeros), expected);
+}
+
+TEST(GradientCompressor, Int8) {
+  std::vector<float> values;
+  for (int i = 0; i < 1000; ++i) values.push_back(std::sin(i) * (i % 17));
+  auto grad = MakeGrad(values, {10, 100});
+  auto compressor = CreateGradientCompressor("int8:64");
+  auto decoded = EncodeAndDecode(compressor.get(), grad);
+  for (size_t i = 0; i < values.size(); ++i) {
+    EXPECT_NEAR(decoded[i], values[i], 16.0 / 127 / 2 + 1e-5);
+  }
+
+  framework::LoDTensor out;
+  compressor->Encode(grad, &out);
+  EXPECT_LT(out.numel(), static_cast<int64_t>(values.size() * 2));
+}
+
+TEST(GradientCompressor, FP16) {
+  auto grad = MakeGrad({1.5, -0.25, 1024, 3e-3}, {4});
+  auto compressor = CreateGradientCompressor("fp16");
+  auto decoded = EncodeAndDecode(compressor.get(), grad);
+  EXPECT_EQ(decoded[0], 1.5);
+  EXPECT_EQ(decoded[1], -0.25);
+  EXPECT_EQ(decoded[2], 1024);
+  EXPECT_NEAR(decoded[3], 3e-3, 1e-5);
+}
+
+TEST(GradientCompressor, Codec) {
+  std::string config = "int8;w@GRAD=topk:0.001;b@GRAD=none";
+  EXPECT_EQ(GetGradientCodec(config, "w@GRAD"), "topk:0.001");
+  EXPECT_EQ(GetGradientCodec(config, "b@GRAD"), "none");
+  EXPECT_EQ(GetGradientCodec(config, "x@GRAD"), "int8");
+  EXPECT_EQ(GetGradientCodec("", "x@GRAD"), "");
+  EXPECT_EQ(CreateGradientCompressor("none"), nullptr);
+  EXPECT_EQ(CreateGradientCompressor(""), nullptr);
+  EXPECT_THROW(CreateGradientCompressor("zip"), platform::EnforceNotMet);
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -77,44 +77,49 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
                  typeid(var->Type()).name());
   }
 
-  std::string header;
-  request.AppendToString(&header);
-  auto buffer = std::unique_ptr<char[]>(new char[1024]);
-  void* buf = buffer.get();
-  ProtoEncodeHelper e(static_cast<char*>(buf), 1024);
-  e.WriteRawBytes(std::string(header.data(), header.size()));
+  // The metadata is serialized straight into the first slice, followed by
+  // the beginning of the serialized field. The payload is not copied, the
+  // slices reference the memory of the variable until grpc releases them.
+  char field_beginning[16];
+  ProtoEncodeHelper e(field_beginning, sizeof(field_beginning));
+  size_t payload_size = 0;
+#ifdef PADDLE_WITH_CUDA
+  if (var->IsType<ncclUniqueId>()) {
+    payload_size = NCCL_UNIQUE_ID_BYTES;
+  }
+#endif
+  if (payload != nullptr) {
+    payload_size = payload->memory_size();
+  }
+  if (payload_size >= std::numeric_limits<int>::max()) {
+    LOG(FATAL) << "FATAL error: varname:" << name << ", vlen:" << payload_size
+               << " >= std::numeric_limits<int>::max():"
+               << std::numeric_limits<int>::max() << ", so exit!";
+  }
+  e.WriteVarlengthBeginning(VarMsg::kSerializedFieldNumber, payload_size);
+
+  size_t header_size = request.ByteSizeLong();
+  ::grpc::Slice slices[4];  // metadata, tensor, rows meta, rows
+  int num_slices = 2;       // only SelectedRows have rows buffer
+  slices[0] = ::grpc::Slice(header_size + e.size() +
+                            (payload == nullptr ? payload_size : 0));
+  uint8_t* header = const_cast<uint8_t*>(slices[0].begin());
+  header = request.SerializeWithCachedSizesToArray(header);
+  memcpy(header, e.data(), e.size());
 // NCCLID is copied directly to the message, return bytebuffer
 // with only one slice if serializing NCCLID.
 #ifdef PADDLE_WITH_CUDA
   if (var->IsType<ncclUniqueId>()) {
-    e.WriteVarlengthBeginning(VarMsg::kSerializedFieldNumber,
-                              NCCL_UNIQUE_ID_BYTES);
     const ncclUniqueId& uid = var->Get<ncclUniqueId>();
-    e.WriteRawBytes(std::string(uid.internal, NCCL_UNIQUE_ID_BYTES));
-
-    // for serialize NCCL_ID
-    ::grpc::Slice slices(e.size());
-    memcpy(const_cast<uint8_t*>(slices.begin()), e.data(), e.size());
-    ::grpc::ByteBuffer tmp(&slices, 1);
+    memcpy(header + e.size(), uid.internal, NCCL_UNIQUE_ID_BYTES);
+    ::grpc::ByteBuffer tmp(&slices[0], 1);
     msg->Swap(&tmp);
     return;
   }
 #endif
   PADDLE_ENFORCE_NOT_NULL(payload);
 
-  e.WriteVarlengthBeginning(VarMsg::kSerializedFieldNumber,
-                            payload->memory_size());
-  if (payload->memory_size() >= std::numeric_limits<int>::max()) {
-    LOG(FATAL) << "FATAL error: varname:" << name
-               << ", vlen:" << payload->memory_size()
-               << " >= std::numeric_limits<int>::max():"
-               << std::numeric_limits<int>::max() << ", so exit!";
-  }
   // steal reference of tensor data
-  ::grpc::Slice slices[4];  // metadata, tensor, rows meta, rows
-  int num_slices = 2;       // only SelectedRows have rows buffer
-  slices[0] = ::grpc::Slice(e.size());
-  memcpy(const_cast<uint8_t*>(slices[0].begin()), e.data(), e.size());
   slices[1] = ::grpc::Slice(
       grpc_slice_new_with_user_data(payload->ptr(), payload->memory_size(),
                                     SerializeDestroyCallback, payload),
@@ -122,23 +127,20 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
 
   if (var->IsType<framework::SelectedRows>()) {
     auto* slr = var->GetMutable<framework::SelectedRows>();
-    ProtoEncodeHelper e2(static_cast<char*>(buf), 128);
-
     PADDLE_ENFORCE(VectorElemName(slr->rows()) == typeid(int64_t).name());
     size_t rows_memory_size = slr->rows().size() * sizeof(int64_t);
 
+    ProtoEncodeHelper e2(field_beginning, sizeof(field_beginning));
     e2.WriteVarlengthBeginning(VarMsg::kRowsFieldNumber, rows_memory_size);
     slices[2] = ::grpc::Slice(e2.size());
     memcpy(const_cast<uint8_t*>(slices[2].begin()), e2.data(), e2.size());
 
-    slices[3] = ::grpc::Slice(
-        grpc_slice_new_with_user_data(
-            const_cast<void*>(
-                reinterpret_cast<const void*>(slr->rows().data())),
-            rows_memory_size, [](void* backing) {},
-            const_cast<char*>(
-                reinterpret_cast<const char*>(slr->rows().data()))),
-        ::grpc::Slice::STEAL_REF);
+    // The rows are copied into the slice, so grpc does not depend on the
+    // variable. framework::Vector has no shared owner to hand over on CPU
+    // builds, and the rows are small next to the values.
+    slices[3] = ::grpc::Slice(rows_memory_size);
+    memcpy(const_cast<uint8_t*>(slices[3].begin()), slr->rows().data(),
+           rows_memory_size);
     num_slices = 4;
   }
 
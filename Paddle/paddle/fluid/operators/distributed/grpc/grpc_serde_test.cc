@@ -222,3 +222,75 @@ TEST(SelectedRows, Run) {
   RunSerdeTestSelectedRows(gpu);
 #endif
 }
+
+TEST(LodTensor, RecvIntoPreallocated) {
+  platform::CPUPlace place;
+  auto& ctx = *platform::DeviceContextPool::Instance().Get(place);
+
+  // The metadata of the long LoD is larger than a kilobyte.
+  framework::Variable var;
+  auto* tensor = var.GetMutable<framework::LoDTensor>();
+  tensor->Resize(framework::make_ddim({1000, 4}));
+  framework::LoD lod(1);
+  for (size_t i = 0; i <= 1000; ++i) lod[0].push_back(i);
+  tensor->set_lod(lod);
+  tensor->mutable_data<float>(place);
+  math::set_constant(ctx, tensor, 3.5);
+
+  ::grpc::ByteBuffer msg;
+  operators::distributed::SerializeToByteBuffer("myvar", &var, ctx, &msg);
+  std::vector<::grpc::Slice> slices;
+  (void)msg.Dump(&slices);
+  ASSERT_EQ(slices.size(), 2UL);
+  // The payload is not copied.
+  EXPECT_EQ(reinterpret_cast<const float*>(slices[1].begin()),
+            tensor->data<float>());
+
+  // Received into the rows of a larger tensor.
+  framework::Tensor whole;
+  whole.Resize(framework::make_ddim({3000, 4}));
+  float* whole_data = whole.mutable_data<float>(place);
+  framework::Scope scope;
+  scope.Var("myvar")->GetMutable<framework::LoDTensor>()->ShareDataWith(
+      whole.Slice(1000, 2000));
+  operators::distributed::GRPCVariableResponse resp(&scope, &ctx);
+  EXPECT_EQ(resp.Parse(msg), 0);
+
+  auto& tensor2 = scope.FindVar("myvar")->Get<framework::LoDTensor>();
+  EXPECT_EQ(tensor2.data<float>(), whole_data + 4000);
+  EXPECT_EQ(tensor2.lod(), lod);
+  for (int i = 0; i < 4000; ++i) EXPECT_FLOAT_EQ(whole_data[4000 + i], 3.5);
+}
+
+TEST(SelectedRows, RowsOutliveVariable) {
+  platform::CPUPlace place;
+  auto& ctx = *platform::DeviceContextPool::Instance().Get(place);
+
+  ::grpc::ByteBuffer msg;
+  {
+    framework::Variable var;
+    auto* slr = var.GetMutable<framework::SelectedRows>();
+    slr->set_height(100);
+    auto* tensor = slr->mutable_value();
+    tensor->Resize(framework::make_ddim({10, 2}));
+    tensor->mutable_data<float>(place);
+    math::set_constant(ctx, tensor, 1.5);
+    for (int i = 0; i < 10; ++i) slr->mutable_rows()->push_back(i * 3);
+    operators::distributed::SerializeToByteBuffer("myvar", &var, ctx, &msg);
+    // Changing the rows of the variable does not change the message.
+    slr->mutable_rows()->clear();
+  }
+
+  std::vector<::grpc::Slice> slices;
+  (void)msg.Dump(&slices);
+  std::string tmp;
+  for (const auto& s : slices) {
+    tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+  }
+  sendrecv::VariableMessage varmsg;
+  EXPECT_TRUE(varmsg.ParseFromString(tmp));
+  ASSERT_EQ(varmsg.rows().size(), 10 * sizeof(int64_t));
+  const int64_t* rows_data =
+      reinterpret_cast<const int64_t*>(varmsg.rows().data());
+  for (int i = 0; i < 10; ++i) EXPECT_EQ(rows_data[i], i * 3);
+}
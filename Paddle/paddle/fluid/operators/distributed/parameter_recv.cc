@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <memory>
+#include <numeric>
 #include <set>
 #include <string>
 #include <vector>
@@ -53,13 +54,36 @@ void ParameterRecv<T>::operator()(const RpcContext &rpc_ctx,
 
   auto *recv_var = scope.FindVar(rpc_ctx.var_name);
 
+  // When the height of every split is known, the splits of a dense
+  // parameter are received straight into their rows of the parameter,
+  // instead of temporary tensors concatenated afterwards.
+  bool recv_in_place = false;
+  if (recv_var->IsType<framework::LoDTensor>() &&
+      rpc_ctx.height_sections.size() == rpc_ctx.splited_var_names.size()) {
+    auto &recv_tensor = recv_var->Get<framework::LoDTensor>();
+    recv_in_place = recv_tensor.IsInitialized() &&
+                    platform::is_cpu_place(recv_tensor.place()) &&
+                    recv_tensor.dims().size() > 0 &&
+                    std::accumulate(rpc_ctx.height_sections.begin(),
+                                    rpc_ctx.height_sections.end(),
+                                    static_cast<int64_t>(0)) ==
+                        recv_tensor.dims()[0];
+  }
+
   // recv all vars to local scope
   if (recv_var->IsType<framework::LoDTensor>() ||
       recv_var->IsType<framework::SelectedRows>()) {
     std::vector<distributed::VarHandlePtr> rets;
+    int64_t row_begin = 0;
     for (size_t i = 0; i < rpc_ctx.splited_var_names.size(); i++) {
       auto &recv_var_name = rpc_ctx.splited_var_names[i];
-      local_scope->Var(recv_var_name);
+      auto *split_var = local_scope->Var(recv_var_name);
+      if (recv_in_place) {
+        int64_t row_end = row_begin + rpc_ctx.height_sections[i];
+        split_var->GetMutable<framework::LoDTensor>()->ShareDataWith(
+            recv_var->Get<framework::LoDTensor>().Slice(row_begin, row_end));
+        row_begin = row_end;
+      }
       VLOG(4) << "recv " << recv_var_name << " from " << rpc_ctx.epmap[i];
       if (recv_var->IsType<framework::LoDTensor>()) {
         // sparse param in recv_scope is LoDTensor
@@ -95,9 +119,12 @@ void ParameterRecv<T>::operator()(const RpcContext &rpc_ctx,
         recv_numel += in.numel();
         auto in_stride = framework::stride_numel(in.dims());
         auto out_stride = framework::stride_numel(recv_tensor->dims());
-        StridedNumelCopyWithAxis<T>(
-            dev_ctx, 0, recv_tensor->data<T>() + output_offset, out_stride,
-            in.data<T>(), in_stride, in_stride[0]);
+        // Received in place unless the split did not fit its rows.
+        if (in.data<T>() != recv_tensor->data<T>() + output_offset) {
+          StridedNumelCopyWithAxis<T>(
+              dev_ctx, 0, recv_tensor->data<T>() + output_offset, out_stride,
+              in.data<T>(), in_stride, in_stride[0]);
+        }
         output_offset += in_stride[0];
       } else if (recv_var->IsType<framework::SelectedRows>()) {
         auto &recv_slr = recv_var->Get<framework::SelectedRows>();
@@ -31,6 +31,7 @@
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/framework/var_type.h"
+#include "paddle/fluid/operators/distributed/sharded_param_table.h"
 #include "paddle/fluid/platform/macros.h"
 
 namespace paddle {
@@ -190,6 +191,12 @@ class RequestHandler {
     sparse_grad_to_param_ = g;
   }
 
+  // Used for async, the sparse gradients in g are applied by their tables
+  // instead of the optimize blocks.
+  void SetShardedParamTables(ShardedParamTables* g) {
+    sharded_param_tables_ = g;
+  }
+
   void SetLrDecayPreparedCtx(
       std::shared_ptr<framework::ExecutorPrepareContext> g) {
     lr_decay_prepared_ctx_ = g;
@@ -244,6 +251,7 @@ class RequestHandler {
                      std::shared_ptr<framework::ExecutorPrepareContext>>*
       grad_to_prepared_ctx_;
   std::unordered_map<std::string, std::string>* sparse_grad_to_param_;
+  ShardedParamTables* sharded_param_tables_{nullptr};
 
   // used for lr decay
   std::shared_ptr<framework::ExecutorPrepareContext> lr_decay_prepared_ctx_;
@@ -28,6 +28,7 @@
 #include "paddle/fluid/string/split.h"
 
 #include "paddle/fluid/operators/distributed/async_sparse_param_update_recorder.h"
+#include "paddle/fluid/operators/distributed/gradient_compressor.h"
 #include "paddle/fluid/operators/distributed/heart_beat_monitor.h"
 
 namespace paddle {
@@ -82,12 +83,25 @@ bool RequestSendHandler::Handle(const std::string& varname,
         scope->Rename(varname, run_varname);
       }
 
+      auto* run_var = scope->FindVar(run_varname);
+      if (run_var != nullptr && IsCompressedGradient(*run_var)) {
+        DecodeGradient(run_var);
+      }
+
       if (AsyncSparseParamUpdateRecorder::GetInstance()->HasGrad(run_varname)) {
         auto& grad_slr =
             scope->FindVar(run_varname)->Get<framework::SelectedRows>();
         AsyncSparseParamUpdateRecorder::GetInstance()->Update(run_varname,
                                                               grad_slr.rows());
       }
+      if (sharded_param_tables_ != nullptr && run_var != nullptr &&
+          run_var->IsType<framework::SelectedRows>()) {
+        auto it = sharded_param_tables_->find(run_varname);
+        if (it != sharded_param_tables_->end()) {
+          it->second->Push(run_var->Get<framework::SelectedRows>());
+          return true;
+        }
+      }
       executor_->RunPreparedContext((*grad_to_prepared_ctx_)[run_varname].get(),
                                     scope);
 
@@ -100,6 +114,9 @@ bool RequestSendHandler::Handle(const std::string& varname,
         LOG(FATAL) << "sync: Can not find server side var: " << varname;
         return false;
       }
+      if (IsCompressedGradient(*invar)) {
+        DecodeGradient(invar);
+      }
     }
   }
   return true;
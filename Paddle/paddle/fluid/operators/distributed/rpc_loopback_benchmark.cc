@@ -0,0 +1,152 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Measures the throughput of sending and receiving dense parameters through
+// a parameter server listening on the loopback interface, e.g.
+//   rpc_loopback_benchmark --numel=4194304 --splits=4 --repeat=100
+
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/operators/distributed/distributed.h"
+#include "paddle/fluid/operators/distributed/parameter_recv.h"
+#include "paddle/fluid/operators/distributed/request_handler.h"
+#include "paddle/fluid/operators/distributed/rpc_client.h"
+#include "paddle/fluid/operators/distributed/rpc_server.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/string/printf.h"
+
+DEFINE_int64(numel, 1 << 22, "The number of floats of the parameter.");
+DEFINE_int32(splits, 4, "The number of splits the parameter is sent in.");
+DEFINE_int32(burning, 10, "Burning times.");
+DEFINE_int32(repeat, 100, "Repeat times.");
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// Receives the variables into, and serves them from, the preallocated
+// variables of its scope, so only the transport is measured.
+class LoopbackHandler final : public RequestHandler {
+ public:
+  LoopbackHandler() : RequestHandler(true) {}
+
+  bool Handle(const std::string& varname, framework::Scope* scope,
+              framework::Variable* var, framework::Variable** outvar,
+              const int trainer_id, const std::string& out_var_name = "",
+              const std::string& table_name = "") override {
+    if (outvar != nullptr) {
+      *outvar = scope_->FindVar(varname);
+    }
+    return true;
+  }
+};
+
+static void InitSplits(framework::Scope* scope, const RpcContext& rpc_ctx) {
+  for (size_t i = 0; i < rpc_ctx.splited_var_names.size(); ++i) {
+    auto* tensor = scope->Var(rpc_ctx.splited_var_names[i])
+                       ->GetMutable<framework::LoDTensor>();
+    tensor->Resize({rpc_ctx.height_sections[i]});
+    float* data = tensor->mutable_data<float>(platform::CPUPlace());
+    std::fill(data, data + tensor->numel(), static_cast<float>(i));
+  }
+}
+
+static void Report(const std::string& name, const std::function<void()>& fn) {
+  for (int i = 0; i < FLAGS_burning; ++i) fn();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < FLAGS_repeat; ++i) fn();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  double bytes = static_cast<double>(FLAGS_numel) * sizeof(float);
+  LOG(INFO) << name << ": " << elapsed.count() * 1e3 / FLAGS_repeat
+            << " ms, " << bytes * FLAGS_repeat / elapsed.count() / (1 << 20)
+            << " MB/s";
+}
+
+void BenchmarkLoopback() {
+  PADDLE_ENFORCE_GT(FLAGS_numel, 0);
+  PADDLE_ENFORCE_GT(FLAGS_splits, 0);
+  PADDLE_ENFORCE_GT(FLAGS_repeat, 0);
+  setenv("http_proxy", "", 1);
+  setenv("https_proxy", "", 1);
+  platform::CPUPlace place;
+  platform::DeviceContextPool::Init({place});
+  auto& ctx = *platform::DeviceContextPool::Instance().Get(place);
+
+  framework::Scope server_scope;
+  LoopbackHandler handler;
+  handler.SetScope(&server_scope);
+  handler.SetDevCtx(&ctx);
+  std::unique_ptr<RPCServer> server(new RPCSERVER_T("127.0.0.1:0", 1));
+  server->RegisterRPC(kRequestSend, &handler);
+  server->RegisterRPC(kRequestGet, &handler);
+  handler.SetRPCServer(server.get());
+  std::thread server_thread(std::bind(&RPCServer::StartServer, server.get()));
+  server->WaitServerReady();
+  std::string ep = string::Sprintf("127.0.0.1:%d", server->GetSelectedPort());
+
+  std::vector<std::string> names;
+  std::vector<int64_t> sections;
+  for (int i = 0; i < FLAGS_splits; ++i) {
+    names.push_back(string::Sprintf("param.block%d", i));
+    sections.push_back(FLAGS_numel * (i + 1) / FLAGS_splits -
+                       FLAGS_numel * i / FLAGS_splits);
+  }
+  RpcContext rpc_ctx("param", names,
+                     std::vector<std::string>(FLAGS_splits, ep), sections, 0);
+  InitSplits(&server_scope, rpc_ctx);
+
+  framework::Scope scope;
+  InitSplits(&scope, rpc_ctx);
+  auto* param =
+      scope.Var(rpc_ctx.var_name)->GetMutable<framework::LoDTensor>();
+  param->Resize({FLAGS_numel});
+  param->mutable_data<float>(place);
+
+  RPCClient* client = RPCClient::GetInstance<RPCCLIENT_T>(0);
+  Report("send", [&] {
+    for (auto& name : rpc_ctx.splited_var_names) {
+      client->AsyncSendVar(ep, ctx, scope, name);
+    }
+    PADDLE_ENFORCE(client->Wait(), "internal error in RPCClient");
+  });
+  ParameterRecv<float> recv_functor;
+  Report("recv", [&] { recv_functor(rpc_ctx, scope); });
+
+  server->ShutDown();
+  server_thread.join();
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  paddle::operators::distributed::BenchmarkLoopback();
+  return 0;
+}
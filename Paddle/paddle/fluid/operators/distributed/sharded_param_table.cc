@@ -0,0 +1,143 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/distributed/sharded_param_table.h"
+
+#include <algorithm>
+#include <future>  // NOLINT
+#include <utility>
+
+#include "paddle/fluid/operators/jit/kernels.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+ShardedParamTable::ShardedParamTable(framework::Tensor* param,
+                                     const framework::Tensor* learning_rate,
+                                     int num_shards, int64_t max_pending_rows)
+    : param_(param), learning_rate_(learning_rate) {
+  PADDLE_ENFORCE_GT(num_shards, 0, "The number of shards should be > 0");
+  PADDLE_ENFORCE_GT(max_pending_rows, 0, "max_pending_rows should be > 0");
+  PADDLE_ENFORCE(platform::is_cpu_place(param_->place()) &&
+                     param_->type() == framework::proto::VarType::FP32,
+                 "The sharded parameter should be a float tensor on CPU");
+  PADDLE_ENFORCE_EQ(learning_rate_->numel(), 1,
+                    "The learning rate should have 1 element");
+  height_ = param_->dims()[0];
+  width_ = param_->numel() / std::max<int64_t>(height_, 1);
+  max_pending_values_ = max_pending_rows * width_;
+  for (int i = 0; i < num_shards; ++i) {
+    shards_.emplace_back(new Shard());
+    shards_.back()->writer.reset(new ::ThreadPool(1));
+  }
+}
+
+ShardedParamTable::~ShardedParamTable() { Flush(); }
+
+void ShardedParamTable::Push(const framework::SelectedRows& grad) {
+  auto& rows = grad.rows();
+  if (rows.empty()) return;
+  auto& value = grad.value();
+  PADDLE_ENFORCE(platform::is_cpu_place(value.place()) &&
+                     value.type() == framework::proto::VarType::FP32,
+                 "The sparse gradient should be a float tensor on CPU");
+  PADDLE_ENFORCE_EQ(value.numel(), static_cast<int64_t>(rows.size()) * width_,
+                    "The gradient rows should have the width of the param");
+  const float* values = value.data<float>();
+
+  size_t num_shards = shards_.size();
+  std::vector<std::vector<size_t>> shard_rows(num_shards);
+  for (size_t i = 0; i < rows.size(); ++i) {
+    PADDLE_ENFORCE(rows[i] >= 0 && rows[i] < height_,
+                   "The row %d is out of the param of height %d", rows[i],
+                   height_);
+    shard_rows[rows[i] % num_shards].push_back(i);
+  }
+
+  for (size_t i = 0; i < num_shards; ++i) {
+    if (shard_rows[i].empty()) continue;
+    Shard* shard = shards_[i].get();
+    std::unique_lock<std::mutex> lock(shard->mutex);
+    shard->cond.wait(lock, [this, shard] {
+      return shard->values.size() < max_pending_values_;
+    });
+    for (size_t index : shard_rows[i]) {
+      shard->rows.push_back(rows[index]);
+      shard->values.insert(shard->values.end(), values + index * width_,
+                           values + (index + 1) * width_);
+    }
+    if (!shard->scheduled) {
+      shard->scheduled = true;
+      shard->writer->enqueue([this, shard] { Apply(shard); });
+    }
+  }
+}
+
+void ShardedParamTable::Flush() {
+  // The writers run their tasks in order, so the updates pushed before are
+  // applied once the empty tasks finish.
+  std::vector<std::future<void>> fs;
+  for (auto& shard : shards_) {
+    fs.emplace_back(shard->writer->enqueue([] {}));
+  }
+  for (auto& f : fs) f.wait();
+}
+
+void ShardedParamTable::Apply(Shard* shard) {
+  std::vector<int64_t> rows;
+  std::vector<float> values;
+  {
+    std::lock_guard<std::mutex> guard(shard->mutex);
+    rows.swap(shard->rows);
+    values.swap(shard->values);
+    shard->scheduled = false;
+  }
+  shard->cond.notify_all();
+
+  auto& index = shard->merged_index;
+  auto& merged_rows = shard->merged_rows;
+  auto& merged_values = shard->merged_values;
+  index.clear();
+  merged_rows.clear();
+  merged_values.clear();
+  for (size_t i = 0; i < rows.size(); ++i) {
+    const float* row_values = values.data() + i * width_;
+    auto it = index.emplace(rows[i], merged_rows.size());
+    if (it.second) {
+      merged_rows.push_back(rows[i]);
+      merged_values.insert(merged_values.end(), row_values,
+                           row_values + width_);
+    } else {
+      float* merged = merged_values.data() + it.first->second * width_;
+      for (int64_t j = 0; j < width_; ++j) {
+        merged[j] += row_values[j];
+      }
+    }
+  }
+
+  int64_t num_rows = merged_rows.size();
+  jit::sgd_attr_t attr(height_, width_, num_rows, width_, num_rows);
+  auto sgd =
+      jit::KernelFuncs<jit::SgdTuple<float>, platform::CPUPlace>::Cache().At(
+          attr);
+  float* param_data = param_->data<float>();
+  sgd(learning_rate_->data<float>(), param_data, merged_values.data(),
+      merged_rows.data(), param_data, &attr);
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
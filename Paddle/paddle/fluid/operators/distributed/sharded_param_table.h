@@ -0,0 +1,101 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <ThreadPool.h>
+
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/framework/tensor.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+/*
+ * Applies the sparse SGD updates of the trainers to a dense parameter of the
+ * parameter server, without running the optimize block for every request.
+ *
+ * The rows of the parameter are striped over the shards by row % num_shards.
+ * Every shard has a single writer: a thread which owns its rows, so no locks
+ * are taken on the rows. Push only copies the rows of a gradient into the
+ * pending buffers of their shards. The writer takes all the pending rows of
+ * its shard at once, merges the duplicated rows, and applies SGD to every
+ * merged row once. Since SGD is linear, the result is the same as applying
+ * the gradients one by one.
+ *
+ * The learning rate is read when a batch is applied, so the learning rate
+ * decay of the server still takes effect.
+ */
+class ShardedParamTable {
+ public:
+  // param is a 2-D float tensor updated in place, and learning_rate is a
+  // float tensor of 1 element. Both should outlive the table.
+  ShardedParamTable(framework::Tensor* param,
+                    const framework::Tensor* learning_rate, int num_shards,
+                    int64_t max_pending_rows = 1 << 20);
+
+  // Applies the pending updates before returning.
+  ~ShardedParamTable();
+
+  // Queues the update of grad, whose rows are the row indices of the
+  // parameter. Blocks if a shard has more than max_pending_rows rows pending.
+  void Push(const framework::SelectedRows& grad);
+
+  // Blocks until all the pushed updates are applied.
+  void Flush();
+
+  int num_shards() const { return static_cast<int>(shards_.size()); }
+
+ private:
+  struct Shard {
+    std::mutex mutex;
+    std::condition_variable cond;
+    // The gradient rows pushed and not applied yet.
+    std::vector<int64_t> rows;
+    std::vector<float> values;
+    bool scheduled{false};
+    // Only used by the writer.
+    std::unordered_map<int64_t, int64_t> merged_index;
+    std::vector<int64_t> merged_rows;
+    std::vector<float> merged_values;
+    std::unique_ptr<::ThreadPool> writer;
+  };
+
+  void Apply(Shard* shard);
+
+  framework::Tensor* param_;
+  const framework::Tensor* learning_rate_;
+  int64_t height_;
+  int64_t width_;
+  size_t max_pending_values_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+// The tables of the sparse gradients whose optimize blocks are replaced,
+// indexed by the gradient names.
+using ShardedParamTables =
+    std::unordered_map<std::string, std::unique_ptr<ShardedParamTable>>;
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,167 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Measures the sparse updates applied per second by a parameter server in
+// async mode, as the number of clients pushing updates grows, e.g.
+//   sharded_param_table_benchmark --max_clients=16 --shards=8
+// Every client is a thread. The sgd_op mode runs the sgd op in a new scope
+// for every update like RequestSendHandler, and the table mode pushes the
+// updates to a ShardedParamTable.
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/operators/distributed/sharded_param_table.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/enforce.h"
+
+DEFINE_int64(height, 1 << 20, "The number of rows of the parameter.");
+DEFINE_int64(width, 64, "The width of the rows of the parameter.");
+DEFINE_int32(rows_per_update, 128, "The number of rows of an update.");
+DEFINE_int32(updates, 2000, "The number of updates sent by every client.");
+DEFINE_int32(max_clients, 16, "The clients grow from 1 to max_clients.");
+DEFINE_int32(shards, 8, "The number of shards of the table.");
+
+USE_OP(sgd);
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+static void InitGrads(int client, std::vector<framework::SelectedRows>* grads) {
+  std::mt19937 engine(client);
+  std::uniform_int_distribution<int64_t> row_dist(0, FLAGS_height - 1);
+  std::uniform_real_distribution<float> value_dist(-1.0f, 1.0f);
+  // The clients cycle through a few updates, so no time is spent on
+  // generating them.
+  grads->resize(8);
+  for (auto& grad : *grads) {
+    std::vector<int64_t> rows(FLAGS_rows_per_update);
+    for (auto& row : rows) row = row_dist(engine);
+    grad.set_height(FLAGS_height);
+    grad.set_rows(rows);
+    auto* value = grad.mutable_value();
+    value->Resize({FLAGS_rows_per_update, FLAGS_width});
+    float* data = value->mutable_data<float>(platform::CPUPlace());
+    for (int64_t i = 0; i < value->numel(); ++i) data[i] = value_dist(engine);
+  }
+}
+
+// Runs update(client, grad) for every update of the clients, and returns the
+// updates per second.
+static double RunClients(
+    int num_clients,
+    const std::function<void(int, const framework::SelectedRows&)>& update,
+    const std::function<void()>& finish) {
+  std::vector<std::vector<framework::SelectedRows>> grads(num_clients);
+  for (int i = 0; i < num_clients; ++i) InitGrads(i, &grads[i]);
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_clients; ++i) {
+    threads.emplace_back([&, i] {
+      for (int n = 0; n < FLAGS_updates; ++n) {
+        update(i, grads[i][n % grads[i].size()]);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  finish();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return static_cast<double>(num_clients) * FLAGS_updates / elapsed.count();
+}
+
+static double BenchmarkSGDOp(framework::Scope* scope, int num_clients) {
+  platform::CPUPlace place;
+  std::vector<std::unique_ptr<framework::OperatorBase>> ops;
+  for (int i = 0; i < num_clients; ++i) {
+    ops.emplace_back(framework::OpRegistry::CreateOp(
+        "sgd", {{"Param", {"param"}},
+                {"Grad", {"param@GRAD"}},
+                {"LearningRate", {"learning_rate"}}},
+        {{"ParamOut", {"param"}}}, framework::AttributeMap{}));
+  }
+  return RunClients(
+      num_clients,
+      [&](int client, const framework::SelectedRows& grad) {
+        auto& local_scope = scope->NewScope();
+        auto* var = local_scope.Var("param@GRAD");
+        auto* local_grad = var->GetMutable<framework::SelectedRows>();
+        local_grad->set_height(grad.height());
+        local_grad->set_rows(grad.rows());
+        local_grad->mutable_value()->ShareDataWith(grad.value());
+        ops[client]->Run(local_scope, place);
+        scope->DeleteScope(&local_scope);
+      },
+      [] {});
+}
+
+static double BenchmarkTable(framework::Scope* scope, int num_clients) {
+  auto* param = scope->FindVar("param")->GetMutable<framework::LoDTensor>();
+  auto& lr = scope->FindVar("learning_rate")->Get<framework::LoDTensor>();
+  ShardedParamTable table(param, &lr, FLAGS_shards);
+  return RunClients(num_clients,
+                    [&](int client, const framework::SelectedRows& grad) {
+                      table.Push(grad);
+                    },
+                    [&] { table.Flush(); });
+}
+
+void BenchmarkShardedParamTable() {
+  PADDLE_ENFORCE_GT(FLAGS_height, 0);
+  PADDLE_ENFORCE_GT(FLAGS_width, 0);
+  PADDLE_ENFORCE_GT(FLAGS_rows_per_update, 0);
+  PADDLE_ENFORCE_GT(FLAGS_max_clients, 0);
+  platform::CPUPlace place;
+  platform::DeviceContextPool::Init({place});
+
+  framework::Scope scope;
+  auto* param = scope.Var("param")->GetMutable<framework::LoDTensor>();
+  param->Resize({FLAGS_height, FLAGS_width});
+  float* param_data = param->mutable_data<float>(place);
+  std::fill(param_data, param_data + param->numel(), 0.0f);
+  auto* lr = scope.Var("learning_rate")->GetMutable<framework::LoDTensor>();
+  lr->Resize({1});
+  lr->mutable_data<float>(place)[0] = 0.01f;
+
+  for (int clients = 1; clients <= FLAGS_max_clients; clients *= 2) {
+    double op_rate = BenchmarkSGDOp(&scope, clients);
+    double table_rate = BenchmarkTable(&scope, clients);
+    LOG(INFO) << clients << " clients: sgd_op " << op_rate
+              << " updates/s, table " << table_rate << " updates/s";
+  }
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  paddle::operators::distributed::BenchmarkShardedParamTable();
+  return 0;
+}
@@ -0,0 +1,118 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/distributed/sharded_param_table.h"
+
+#include <algorithm>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+constexpr int64_t kHeight = 100;
+constexpr int64_t kWidth = 4;
+
+static void InitTensor(framework::Tensor* tensor, const framework::DDim& dims,
+                       float value) {
+  tensor->Resize(dims);
+  float* data = tensor->mutable_data<float>(platform::CPUPlace());
+  std::fill(data, data + tensor->numel(), value);
+}
+
+static void MakeGrad(const std::vector<int64_t>& rows, float value,
+                     framework::SelectedRows* grad) {
+  grad->set_height(kHeight);
+  grad->set_rows(rows);
+  InitTensor(grad->mutable_value(),
+             {static_cast<int64_t>(rows.size()), kWidth}, value);
+}
+
+static void TestConcurrentPush(int num_shards, int64_t max_pending_rows) {
+  framework::Tensor param, lr;
+  InitTensor(&param, {kHeight, kWidth}, 0.0f);
+  InitTensor(&lr, {1}, 0.5f);
+  ShardedParamTable table(&param, &lr, num_shards, max_pending_rows);
+
+  const int num_clients = 4;
+  const int num_updates = 50;
+  std::vector<int> counts(kHeight, 0);
+  std::vector<std::vector<int64_t>> client_rows;
+  for (int client = 0; client < num_clients; ++client) {
+    for (int i = 0; i < num_updates; ++i) {
+      // Some rows are duplicated in a gradient.
+      std::vector<int64_t> rows;
+      for (int k = 0; k < 5; ++k) {
+        rows.push_back((client * 7 + i * 3 + k * k) % kHeight);
+      }
+      rows.push_back(rows[0]);
+      for (auto row : rows) ++counts[row];
+      client_rows.push_back(rows);
+    }
+  }
+
+  std::vector<std::thread> threads;
+  for (int client = 0; client < num_clients; ++client) {
+    threads.emplace_back([&, client] {
+      for (int i = 0; i < num_updates; ++i) {
+        framework::SelectedRows grad;
+        MakeGrad(client_rows[client * num_updates + i], 1.0f, &grad);
+        table.Push(grad);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  table.Flush();
+
+  const float* data = param.data<float>();
+  for (int64_t row = 0; row < kHeight; ++row) {
+    for (int64_t j = 0; j < kWidth; ++j) {
+      ASSERT_EQ(data[row * kWidth + j], -0.5f * counts[row]);
+    }
+  }
+}
+
+TEST(ShardedParamTable, ConcurrentPush) { TestConcurrentPush(3, 1 << 20); }
+
+TEST(ShardedParamTable, PendingRowsLimit) { TestConcurrentPush(2, 1); }
+
+TEST(ShardedParamTable, ReadLearningRateWhenApplied) {
+  framework::Tensor param, lr;
+  InitTensor(&param, {kHeight, kWidth}, 1.0f);
+  InitTensor(&lr, {1}, 1.0f);
+  ShardedParamTable table(&param, &lr, 4);
+
+  framework::SelectedRows grad;
+  MakeGrad({3, 99}, 2.0f, &grad);
+  table.Push(grad);
+  table.Flush();
+  lr.data<float>()[0] = 0.25f;
+  table.Push(grad);
+  table.Flush();
+
+  const float* data = param.data<float>();
+  EXPECT_EQ(data[3 * kWidth], 1.0f - 2.0f - 0.5f);
+  EXPECT_EQ(data[99 * kWidth + kWidth - 1], 1.0f - 2.0f - 0.5f);
+  EXPECT_EQ(data[4 * kWidth], 1.0f);
+
+  MakeGrad({kHeight}, 1.0f, &grad);
+  EXPECT_THROW(table.Push(grad), platform::EnforceNotMet);
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
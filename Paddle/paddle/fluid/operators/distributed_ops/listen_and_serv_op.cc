@@ -16,7 +16,10 @@ limitations under the License. */
 #include <csignal>
 #include <cstdlib>
 #include <fstream>
+#include <memory>
+#include <string>
 #include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "gflags/gflags.h"
@@ -27,6 +30,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/distributed/async_sparse_param_update_recorder.h"
 #include "paddle/fluid/operators/distributed/heart_beat_monitor.h"
 #include "paddle/fluid/operators/distributed/request_handler_impl.h"
+#include "paddle/fluid/operators/distributed/sharded_param_table.h"
 #include "paddle/fluid/operators/distributed_ops/listen_and_serv_op.h"
 
 #include "paddle/fluid/platform/profiler.h"
@@ -34,6 +38,9 @@ limitations under the License. */
 DEFINE_int32(rpc_send_thread_num, 12, "number of threads for rpc send");
 DEFINE_int32(rpc_get_thread_num, 12, "number of threads for rpc get");
 DEFINE_int32(rpc_prefetch_thread_num, 12, "number of threads for rpc prefetch");
+DEFINE_int32(rpc_sparse_update_shards, 0,
+             "number of shards of the sparse sgd updates applied without the "
+             "optimize blocks in async mode, 0 to disable it");
 
 namespace paddle {
 namespace operators {
@@ -223,6 +230,42 @@ void ListenAndServOp::ResetReceivedVars(framework::Scope *recv_scope,
   }
 }
 
+// Returns the table applying the sparse gradients of grad, if its optimize
+// block only runs sgd on a dense float parameter, or null.
+static std::unique_ptr<distributed::ShardedParamTable> NewShardedParamTable(
+    const std::string &grad, const framework::ExecutorPrepareContext &ctx,
+    framework::Scope *scope) {
+  if (ctx.ops_.size() != 1 || ctx.ops_[0]->Type() != "sgd") {
+    return nullptr;
+  }
+  auto &op = *ctx.ops_[0];
+  if (op.Input("Grad") != grad || op.Output("ParamOut") != op.Input("Param")) {
+    return nullptr;
+  }
+  auto *param_var = scope->FindVar(op.Input("Param"));
+  auto *lr_var = scope->FindVar(op.Input("LearningRate"));
+  if (param_var == nullptr || lr_var == nullptr ||
+      !param_var->IsType<framework::LoDTensor>() ||
+      !lr_var->IsType<framework::LoDTensor>()) {
+    return nullptr;
+  }
+  auto *param = param_var->GetMutable<framework::LoDTensor>();
+  auto &lr = lr_var->Get<framework::LoDTensor>();
+  if (!param->IsInitialized() || param->dims().size() != 2 ||
+      !platform::is_cpu_place(param->place()) ||
+      param->type() != framework::proto::VarType::FP32 ||
+      !lr.IsInitialized() || lr.numel() != 1 ||
+      !platform::is_cpu_place(lr.place()) ||
+      lr.type() != framework::proto::VarType::FP32) {
+    return nullptr;
+  }
+  VLOG(1) << "apply the sparse gradients of " << grad << " in "
+          << FLAGS_rpc_sparse_update_shards << " shards";
+  return std::unique_ptr<distributed::ShardedParamTable>(
+      new distributed::ShardedParamTable(param, &lr,
+                                         FLAGS_rpc_sparse_update_shards));
+}
+
 void ListenAndServOp::RunAsyncLoop(framework::Executor *executor,
                                    framework::ProgramDesc *program,
                                    framework::Scope *recv_scope) const {
@@ -278,6 +321,18 @@ void ListenAndServOp::RunAsyncLoop(framework::Executor *executor,
   request_get_handler_->SetGradToPreparedCtx(&grad_to_prepared_ctx);
   request_prefetch_handler_->SetGradToPreparedCtx(&grad_to_prepared_ctx);
 
+  distributed::ShardedParamTables sharded_param_tables;
+  if (FLAGS_rpc_sparse_update_shards > 0) {
+    for (auto &grad_and_ctx : grad_to_prepared_ctx) {
+      auto table = NewShardedParamTable(grad_and_ctx.first,
+                                        *grad_and_ctx.second, recv_scope);
+      if (table != nullptr) {
+        sharded_param_tables[grad_and_ctx.first] = std::move(table);
+      }
+    }
+    request_send_handler_->SetShardedParamTables(&sharded_param_tables);
+  }
+
   while (true) {
     if (rpc_service_->IsExit()) {
       VLOG(4) << "get exit!rpc_processor break!";
@@ -286,6 +341,7 @@ void ListenAndServOp::RunAsyncLoop(framework::Executor *executor,
 
     sleep(1);
   }  // while(true)
+  request_send_handler_->SetShardedParamTables(nullptr);
 }
 
 static void FillRequestCtx(
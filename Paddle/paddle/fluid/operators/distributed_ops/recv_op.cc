@@ -60,8 +60,9 @@ class RecvOp : public framework::OperatorBase {
 
     if (recv_varnames.size() > 0) {
       auto recv_functor = distributed::ParameterRecv<float>();
-      auto rpc_ctx = distributed::RpcContext(outs[0], recv_varnames, epmap, {},
-                                             trainer_id);
+      auto rpc_ctx = distributed::RpcContext(
+          outs[0], recv_varnames, epmap,
+          Attr<std::vector<int64_t>>("sections"), trainer_id);
       recv_functor(rpc_ctx, scope);
     } else {
       std::vector<distributed::VarHandlePtr> rets;
@@ -124,6 +125,12 @@ This operator can get variables from server side.
         "(vector<string>) "
         "the splited parameter varnames to be recved from pserver")
         .SetDefault(std::vector<std::string>{});
+    AddAttr<std::vector<int64_t>>(
+        "sections",
+        "(vector<int64_t>) "
+        "the heights of the splited parameters in recv_varnames, used to "
+        "recv them straight into the parameter")
+        .SetDefault(std::vector<int64_t>{});
     AddAttr<int>("do_not_run", "if recv need to really run").SetDefault(0);
   }
 };
@@ -30,7 +30,7 @@ template <typename DeviceContext, typename T>
 void default_elementwise_div(const framework::ExecutionContext& ctx,
                              const framework::Tensor* x,
                              const framework::Tensor* y, framework::Tensor* z) {
-  int axis = ctx.Attr<int>("axis");
+  int axis = ctx.Attr<int>(kElementwiseAxis);
   ElementwiseComputeEx<DivFunctor<T>, DeviceContext, T>(ctx, x, y, axis,
                                                         DivFunctor<T>(), z);
 }
@@ -46,9 +46,9 @@ template <typename DeviceContext, typename T>
 class ElementwiseDivKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext& ctx) const override {
-    auto* x = ctx.Input<framework::LoDTensor>("X");
-    auto* y = ctx.Input<framework::LoDTensor>("Y");
-    auto* z = ctx.Output<framework::LoDTensor>("Out");
+    auto* x = ctx.Input<framework::LoDTensor>(kElementwiseX);
+    auto* y = ctx.Input<framework::LoDTensor>(kElementwiseY);
+    auto* z = ctx.Output<framework::LoDTensor>(kElementwiseOut);
     z->mutable_data<T>(ctx.GetPlace());
 
     auto dims_equal = x->dims() == y->dims();
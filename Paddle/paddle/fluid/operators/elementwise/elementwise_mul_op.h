@@ -25,7 +25,7 @@ template <typename DeviceContext, typename T>
 void default_elementwise_mul(const framework::ExecutionContext& ctx,
                              const framework::Tensor* x,
                              const framework::Tensor* y, framework::Tensor* z) {
-  int axis = ctx.Attr<int>("axis");
+  int axis = ctx.Attr<int>(kElementwiseAxis);
   ElementwiseComputeEx<MulFunctor<T>, DeviceContext, T>(ctx, x, y, axis,
                                                         MulFunctor<T>(), z);
 }
@@ -40,27 +40,27 @@ template <typename DeviceContext, typename T>
 class ElementwiseMulKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext& ctx) const override {
-    auto x_var = ctx.InputVar("X");
+    auto x_var = ctx.InputVar(kElementwiseX);
     PADDLE_ENFORCE(x_var != nullptr,
                    "Cannot get input Variable X, variable name = %s",
                    ctx.op().Input("X"));
-    auto* y = ctx.Input<framework::LoDTensor>("Y");
+    auto* y = ctx.Input<framework::LoDTensor>(kElementwiseY);
 
     framework::Tensor x, *z;
     if (x_var->IsType<framework::SelectedRows>()) {
       PADDLE_ENFORCE(y->dims().size() == 1 && y->dims()[0] == 1,
                      "For elementwise_op, if X is Sparse, Y must be scalar.");
       auto& x_sele = x_var->Get<framework::SelectedRows>();
-      auto out_sele = ctx.Output<framework::SelectedRows>("Out");
+      auto out_sele = ctx.Output<framework::SelectedRows>(kElementwiseOut);
       x = x_sele.value();
       out_sele->set_rows(x_sele.rows());
       out_sele->set_height(x_sele.height());
       out_sele->mutable_value()->Resize(x_sele.value().dims());
       out_sele->mutable_value()->mutable_data(ctx.GetPlace(), x.type());
-      z = ctx.Output<framework::SelectedRows>("Out")->mutable_value();
+      z = ctx.Output<framework::SelectedRows>(kElementwiseOut)->mutable_value();
     } else if (x_var->IsType<framework::LoDTensor>()) {
       x = x_var->Get<framework::LoDTensor>();
-      z = ctx.Output<framework::LoDTensor>("Out");
+      z = ctx.Output<framework::LoDTensor>(kElementwiseOut);
     } else {
       PADDLE_THROW("X's type[%s] is not supported by elementwise_op.",
                    framework::ToTypeName(x_var->Type()));
@@ -104,6 +104,12 @@ class ElementwiseOpInferVarType
   }
 };
 
+// The slots of ElementwiseOpMaker read by the forward kernels.
+constexpr framework::OpSlot kElementwiseX{0, "X"};
+constexpr framework::OpSlot kElementwiseY{1, "Y"};
+constexpr framework::OpSlot kElementwiseOut{0, "Out"};
+constexpr framework::OpSlot kElementwiseAxis{0, "axis"};
+
 class ElementwiseOpMaker : public framework::OpProtoAndCheckerMaker {
  public:
   void Make() final {
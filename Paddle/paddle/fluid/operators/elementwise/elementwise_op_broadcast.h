@@ -0,0 +1,285 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include "paddle/fluid/framework/ddim.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+
+/*
+ * The shape of X with Y broadcast to it, where the dims of Y are aligned to
+ * the dims of X starting at axis. Dims of size 1 are dropped and adjacent
+ * dims along which Y is either broadcast or not are merged. For example:
+ * 1. shape(X) = (2, 3, 4, 5), shape(Y) = (3, 1), with axis=1
+ *    dims = (2, 3, 20), y_strides = (0, 1, 0)
+ * 2. shape(X) = (2, 3, 4, 5), shape(Y) = (2, 1, 4, 5)
+ *    dims = (2, 3, 20), y_strides = (20, 0, 1)
+ *
+ * The innermost dim is processed as one contiguous run, along which Y is
+ * either contiguous too or a single value, so that the loops vectorize.
+ */
+struct BroadcastDims {
+  std::vector<int64_t> dims;
+  // The stride of Y along each dim, 0 where Y is broadcast.
+  std::vector<int64_t> y_strides;
+  int64_t x_numel;
+  int64_t y_numel;
+
+  int64_t inner() const { return dims.back(); }
+  int64_t rows() const { return x_numel / dims.back(); }
+  bool inner_broadcast() const { return y_strides.back() == 0; }
+};
+
+inline BroadcastDims CoalesceBroadcastDims(const framework::DDim &x_dims,
+                                           const framework::DDim &y_dims,
+                                           int axis) {
+  PADDLE_ENFORCE(axis >= 0 && axis + y_dims.size() <= x_dims.size(),
+                 "Axis should be in range [0, %d], but received %d",
+                 x_dims.size() - y_dims.size(), axis);
+  BroadcastDims result;
+  result.x_numel = framework::product(x_dims);
+  result.y_numel = framework::product(y_dims);
+  std::vector<bool> broadcast;
+  for (int i = 0; i < x_dims.size(); ++i) {
+    int64_t x_dim = x_dims[i];
+    int64_t y_dim =
+        (i >= axis && i < axis + y_dims.size()) ? y_dims[i - axis] : 1;
+    PADDLE_ENFORCE(y_dim == x_dim || y_dim == 1,
+                   "ShapeError: broadcast dimension mismatch. Operands could "
+                   "not be broadcast together with the shape of X = [%s] and "
+                   "the shape of Y = [%s].",
+                   x_dims, y_dims);
+    if (x_dim == 1) continue;
+    bool y_broadcast = y_dim != x_dim;
+    if (!broadcast.empty() && broadcast.back() == y_broadcast) {
+      result.dims.back() *= x_dim;
+    } else {
+      result.dims.push_back(x_dim);
+      broadcast.push_back(y_broadcast);
+    }
+  }
+  if (result.dims.empty()) {
+    result.dims.push_back(1);
+    broadcast.push_back(false);
+  }
+
+  result.y_strides.resize(result.dims.size());
+  int64_t stride = 1;
+  for (int i = static_cast<int>(result.dims.size()) - 1; i >= 0; --i) {
+    result.y_strides[i] = broadcast[i] ? 0 : stride;
+    if (!broadcast[i]) stride *= result.dims[i];
+  }
+  return result;
+}
+
+// Walks the rows of a BroadcastDims, i.e. all dims but the innermost one, and
+// keeps the offset of Y at the start of the current row.
+class BroadcastRowIterator {
+ public:
+  BroadcastRowIterator(const BroadcastDims &dims, int64_t row)
+      : dims_(dims), index_(dims.dims.size() - 1, 0), y_offset_(0) {
+    for (int i = static_cast<int>(index_.size()) - 1; i >= 0; --i) {
+      index_[i] = row % dims_.dims[i];
+      y_offset_ += index_[i] * dims_.y_strides[i];
+      row /= dims_.dims[i];
+    }
+  }
+
+  int64_t y_offset() const { return y_offset_; }
+
+  void Next() {
+    for (int i = static_cast<int>(index_.size()) - 1; i >= 0; --i) {
+      y_offset_ += dims_.y_strides[i];
+      if (++index_[i] < dims_.dims[i]) return;
+      y_offset_ -= dims_.y_strides[i] * dims_.dims[i];
+      index_[i] = 0;
+    }
+  }
+
+ private:
+  const BroadcastDims &dims_;
+  std::vector<int64_t> index_;
+  int64_t y_offset_;
+};
+
+// Calls f(first, last) on ranges of [0, n), in parallel on the intra-op
+// thread pool when the kernel touches enough elements.
+template <typename Function>
+void BroadcastParallelFor(const platform::CPUDeviceContext &ctx,
+                          int64_t numel, int64_t n, double bytes_per_item,
+                          double cycles_per_item, Function f) {
+  auto *device = ctx.eigen_pool_device(numel);
+  if (device == nullptr || n <= 1) {
+    f(0, n);
+    return;
+  }
+  device->parallelFor(
+      n, Eigen::TensorOpCost(bytes_per_item, 0, cycles_per_item),
+      [&f](Eigen::Index first, Eigen::Index last) { f(first, last); });
+}
+
+// Out = func(X, Y) with Y broadcast to the shape of X.
+template <typename Functor, typename T, typename OutType = T>
+void ElementwiseBroadcastCPU(const platform::CPUDeviceContext &ctx,
+                             const BroadcastDims &dims, const T *x,
+                             const T *y, OutType *z, Functor func) {
+  if (dims.x_numel == 0) return;
+  const int64_t inner = dims.inner();
+  auto run_rows = [&](int64_t first, int64_t last) {
+    BroadcastRowIterator it(dims, first);
+    for (int64_t row = first; row < last; ++row, it.Next()) {
+      const T *x_row = x + row * inner;
+      OutType *z_row = z + row * inner;
+      if (dims.inner_broadcast()) {
+        const T y_value = y[it.y_offset()];
+        for (int64_t k = 0; k < inner; ++k) {
+          z_row[k] = func(x_row[k], y_value);
+        }
+      } else {
+        const T *y_row = y + it.y_offset();
+        for (int64_t k = 0; k < inner; ++k) {
+          z_row[k] = func(x_row[k], y_row[k]);
+        }
+      }
+    }
+  };
+  BroadcastParallelFor(ctx, dims.x_numel, dims.rows(),
+                       inner * (2 * sizeof(T) + sizeof(OutType)), inner,
+                       run_rows);
+}
+
+// Computes dX and accumulates dY over rows [first, last). dY must be zeroed
+// before the first call.
+template <typename T, typename DX_OP, typename DY_OP>
+void ElemwiseGradBroadcastRows(const BroadcastDims &dims, const T *x,
+                               const T *y, const T *out, const T *dout,
+                               DX_OP dx_op, DY_OP dy_op, T *dx, T *dy,
+                               int64_t first, int64_t last) {
+  const int64_t inner = dims.inner();
+  BroadcastRowIterator it(dims, first);
+  for (int64_t row = first; row < last; ++row, it.Next()) {
+    const int64_t offset = row * inner;
+    const T *x_row = x + offset;
+    const T *out_row = out + offset;
+    const T *dout_row = dout + offset;
+    if (dims.inner_broadcast()) {
+      const T y_value = y[it.y_offset()];
+      if (dx != nullptr) {
+        T *dx_row = dx + offset;
+        for (int64_t k = 0; k < inner; ++k) {
+          dx_row[k] = dx_op(x_row[k], y_value, out_row[k], dout_row[k]);
+        }
+      }
+      if (dy != nullptr) {
+        T sum = static_cast<T>(0);
+        for (int64_t k = 0; k < inner; ++k) {
+          sum += dy_op(x_row[k], y_value, out_row[k], dout_row[k]);
+        }
+        dy[it.y_offset()] += sum;
+      }
+    } else {
+      const T *y_row = y + it.y_offset();
+      if (dx != nullptr) {
+        T *dx_row = dx + offset;
+        for (int64_t k = 0; k < inner; ++k) {
+          dx_row[k] = dx_op(x_row[k], y_row[k], out_row[k], dout_row[k]);
+        }
+      }
+      if (dy != nullptr) {
+        T *dy_row = dy + it.y_offset();
+        for (int64_t k = 0; k < inner; ++k) {
+          dy_row[k] += dy_op(x_row[k], y_row[k], out_row[k], dout_row[k]);
+        }
+      }
+    }
+  }
+}
+
+// dX = dx_op(X, Y, Out, dOut) and dY = sum of dy_op(X, Y, Out, dOut) over the
+// dims along which Y is broadcast. When Y is not broadcast along the
+// outermost dim, the threads reduce disjoint slices of dY. Otherwise each
+// thread reduces its rows into a private buffer, which are summed at the
+// end.
+template <typename T, typename DX_OP, typename DY_OP>
+void ElemwiseGradBroadcastCPU(const platform::CPUDeviceContext &ctx,
+                              const BroadcastDims &dims, const T *x,
+                              const T *y, const T *out, const T *dout,
+                              DX_OP dx_op, DY_OP dy_op, T *dx, T *dy) {
+  if (dy != nullptr) {
+    std::fill(dy, dy + dims.y_numel, static_cast<T>(0));
+  }
+  if (dims.x_numel == 0) return;
+  const int64_t rows = dims.rows();
+  const double bytes_per_row = dims.inner() * 5 * sizeof(T);
+  const double cycles_per_row = dims.inner() * 2;
+  auto run_rows = [&](int64_t first, int64_t last) {
+    ElemwiseGradBroadcastRows(dims, x, y, out, dout, dx_op, dy_op, dx, dy,
+                              first, last);
+  };
+
+  auto *device = ctx.eigen_pool_device(dims.x_numel);
+  if (dy == nullptr || device == nullptr || rows <= 1) {
+    BroadcastParallelFor(ctx, dims.x_numel, rows, bytes_per_row,
+                         cycles_per_row, run_rows);
+    return;
+  }
+
+  if (dims.dims.size() > 1 && dims.y_strides[0] != 0) {
+    // Rows of different outermost indices write disjoint slices of dY.
+    const int64_t rows_per_slice = rows / dims.dims[0];
+    BroadcastParallelFor(
+        ctx, dims.x_numel, dims.dims[0], rows_per_slice * bytes_per_row,
+        rows_per_slice * cycles_per_row, [&](int64_t first, int64_t last) {
+          run_rows(first * rows_per_slice, last * rows_per_slice);
+        });
+    return;
+  }
+
+  const int64_t num_chunks =
+      std::min<int64_t>(device->numThreads(), rows);
+  const int64_t rows_per_chunk = (rows + num_chunks - 1) / num_chunks;
+  // The first chunk accumulates into dY directly.
+  std::vector<T> partial((num_chunks - 1) * dims.y_numel, static_cast<T>(0));
+  BroadcastParallelFor(
+      ctx, dims.x_numel, num_chunks, rows_per_chunk * bytes_per_row,
+      rows_per_chunk * cycles_per_row, [&](int64_t first, int64_t last) {
+        for (int64_t c = first; c < last; ++c) {
+          T *chunk_dy =
+              c == 0 ? dy : partial.data() + (c - 1) * dims.y_numel;
+          ElemwiseGradBroadcastRows(
+              dims, x, y, out, dout, dx_op, dy_op, dx, chunk_dy,
+              c * rows_per_chunk, std::min(rows, (c + 1) * rows_per_chunk));
+        }
+      });
+  BroadcastParallelFor(ctx, dims.x_numel, dims.y_numel,
+                       num_chunks * sizeof(T), num_chunks,
+                       [&](int64_t first, int64_t last) {
+                         for (int64_t c = 1; c < num_chunks; ++c) {
+                           const T *chunk_dy =
+                               partial.data() + (c - 1) * dims.y_numel;
+                           for (int64_t j = first; j < last; ++j) {
+                             dy[j] += chunk_dy[j];
+                           }
+                         }
+                       });
+}
+
+}  // namespace operators
+}  // namespace paddle
@@ -21,6 +21,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/operators/elementwise/elementwise_op_broadcast.h"
 #include "paddle/fluid/platform/transform.h"
 
 #ifdef __NVCC__
@@ -352,28 +353,6 @@ struct ElemwiseGradNoBroadcast {
   T *dy_;
 };
 
-template <typename T, typename DX_OP, typename DY_OP>
-static void ElemwiseGradBroadcast1CPU(const T *x, const T *y, const T *out,
-                                      const T *dout, int h, int w, DX_OP dx_op,
-                                      DY_OP dy_op, T *dx, T *dy) {
-  for (int i = 0; i < h; ++i) {
-    for (int j = 0; j < w; ++j) {
-      int x_offset = i * w + j;
-      if (dx != nullptr) {
-        dx[x_offset] = dx_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
-      }
-      if (dy != nullptr) {
-        T tmp = dy_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
-        if (i == 0) {
-          dy[j] = tmp;
-        } else {
-          dy[j] += tmp;
-        }
-      }
-    }
-  }
-}
-
 #ifdef __NVCC__
 template <typename T, typename DX_OP, typename DY_OP>
 static __global__ void ElemwiseGradBroadcast1CUDAKernel(
@@ -477,31 +456,6 @@ static void ElemwiseGradBroadcast1CUDA(cudaStream_t stream, const T *x,
 
 #endif
 
-template <typename T, typename DX_OP, typename DY_OP>
-static void ElemwiseGradBroadcast2CPU(const T *x, const T *y, const T *out,
-                                      const T *dout, int pre, int n, int post,
-                                      DX_OP dx_op, DY_OP dy_op, T *dx, T *dy) {
-  for (int i = 0; i < pre; ++i) {
-    for (int j = 0; j < n; ++j) {
-      for (int k = 0; k < post; ++k) {
-        int x_offset = i * n * post + j * post + k;
-        if (dx != nullptr) {
-          dx[x_offset] =
-              dx_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
-        }
-        if (dy != nullptr) {
-          T tmp = dy_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
-          if (i == 0 && k == 0) {
-            dy[j] = tmp;
-          } else {
-            dy[j] += tmp;
-          }
-        }
-      }
-    }
-  }
-}
-
 #ifdef __NVCC__
 template <typename T, typename DX_OP, typename DY_OP>
 static __global__ void ElemwiseGradBroadcast2CUDAKernel(
@@ -554,34 +508,6 @@ static void ElemwiseGradBroadcast2CUDA(cudaStream_t stream, const T *x,
 
 #endif
 
-template <typename T, typename DX_OP, typename DY_OP>
-static void ElemwiseGradBroadcastMid2CPU(const T *x, const T *y, const T *out,
-                                         const T *dout, int pre, int n,
-                                         int post, DX_OP dx_op, DY_OP dy_op,
-                                         T *dx, T *dy) {
-  for (int i = 0; i < pre; ++i) {
-    for (int j = 0; j < n; ++j) {
-      for (int k = 0; k < post; ++k) {
-        int x_offset = i * n * post + j * post + k;
-        int y_offset = i * post + k;
-        if (dx != nullptr) {
-          dx[x_offset] =
-              dx_op(x[x_offset], y[y_offset], out[x_offset], dout[x_offset]);
-        }
-        if (dy != nullptr) {
-          T tmp =
-              dy_op(x[x_offset], y[y_offset], out[x_offset], dout[x_offset]);
-          if (j == 0) {
-            dy[y_offset] = tmp;
-          } else {
-            dy[y_offset] += tmp;
-          }
-        }
-      }
-    }
-  }
-}
-
 #ifdef __NVCC__
 template <typename T, typename DX_OP, typename DY_OP>
 static __global__ void ElemwiseGradBroadcastMid2CUDAKernel(
@@ -670,56 +596,37 @@ void ElemwiseGradComputeWithBroadcast(
 
   int pre, n, post, mid_flag = 0;
   get_mid_dims(x_dim, y_dim, axis, &pre, &n, &post, &mid_flag);
+  if (platform::is_cpu_place(ctx.GetPlace())) {
+    ElemwiseGradBroadcastCPU(
+        ctx.template device_context<platform::CPUDeviceContext>(),
+        CoalesceBroadcastDims(x_dim, y_dim, axis), x.data<T>(), y.data<T>(),
+        out.data<T>(), dout.data<T>(), dx_op, dy_op,
+        dx == nullptr ? nullptr : dx->mutable_data<T>(ctx.GetPlace()),
+        dy == nullptr ? nullptr : dy->mutable_data<T>(ctx.GetPlace()));
+    return;
+  }
+#ifdef __NVCC__
   if (mid_flag) {
     PADDLE_ENFORCE_EQ(mid_flag, 1, "mid_flag should be no more than 1.");
-    if (platform::is_gpu_place(ctx.GetPlace())) {
-#ifdef __NVCC__
-      ElemwiseGradBroadcastMid2CUDA(
-          ctx.template device_context<DeviceContext>().stream(), x.data<T>(),
-          y.data<T>(), out.data<T>(), dout.data<T>(), pre, n, post, dx_op,
-          dy_op, dx == nullptr ? nullptr : dx->mutable_data<T>(ctx.GetPlace()),
-          dy == nullptr ? nullptr : dy->mutable_data<T>(ctx.GetPlace()));
-#endif
-    } else {
-      ElemwiseGradBroadcastMid2CPU(
-          x.data<T>(), y.data<T>(), out.data<T>(), dout.data<T>(), pre, n, post,
-          dx_op, dy_op,
-          dx == nullptr ? nullptr : dx->mutable_data<T>(ctx.GetPlace()),
-          dy == nullptr ? nullptr : dy->mutable_data<T>(ctx.GetPlace()));
-    }
+    ElemwiseGradBroadcastMid2CUDA(
+        ctx.template device_context<DeviceContext>().stream(), x.data<T>(),
+        y.data<T>(), out.data<T>(), dout.data<T>(), pre, n, post, dx_op, dy_op,
+        dx == nullptr ? nullptr : dx->mutable_data<T>(ctx.GetPlace()),
+        dy == nullptr ? nullptr : dy->mutable_data<T>(ctx.GetPlace()));
   } else if (post == 1) {
-    if (platform::is_gpu_place(ctx.GetPlace())) {
-#ifdef __NVCC__
-      ElemwiseGradBroadcast1CUDA(
-          ctx.template device_context<DeviceContext>().stream(), x.data<T>(),
-          y.data<T>(), out.data<T>(), dout.data<T>(), pre, n, dx_op, dy_op,
-          dx == nullptr ? nullptr : dx->mutable_data<T>(ctx.GetPlace()),
-          dy == nullptr ? nullptr : dy->mutable_data<T>(ctx.GetPlace()));
-#endif
-    } else {
-      ElemwiseGradBroadcast1CPU(
-          x.data<T>(), y.data<T>(), out.data<T>(), dout.data<T>(), pre, n,
-          dx_op, dy_op,
-          dx == nullptr ? nullptr : dx->mutable_data<T>(ctx.GetPlace()),
-          dy == nullptr ? nullptr : dy->mutable_data<T>(ctx.GetPlace()));
-    }
+    ElemwiseGradBroadcast1CUDA(
+        ctx.template device_context<DeviceContext>().stream(), x.data<T>(),
+        y.data<T>(), out.data<T>(), dout.data<T>(), pre, n, dx_op, dy_op,
+        dx == nullptr ? nullptr : dx->mutable_data<T>(ctx.GetPlace()),
+        dy == nullptr ? nullptr : dy->mutable_data<T>(ctx.GetPlace()));
   } else {
-    if (platform::is_gpu_place(ctx.GetPlace())) {
-#ifdef __NVCC__
-      ElemwiseGradBroadcast2CUDA(
-          ctx.template device_context<DeviceContext>().stream(), x.data<T>(),
-          y.data<T>(), out.data<T>(), dout.data<T>(), pre, n, post, dx_op,
-          dy_op, dx == nullptr ? nullptr : dx->mutable_data<T>(ctx.GetPlace()),
-          dy == nullptr ? nullptr : dy->mutable_data<T>(ctx.GetPlace()));
-#endif
-    } else {
-      ElemwiseGradBroadcast2CPU(
-          x.data<T>(), y.data<T>(), out.data<T>(), dout.data<T>(), pre, n, post,
-          dx_op, dy_op,
-          dx == nullptr ? nullptr : dx->mutable_data<T>(ctx.GetPlace()),
-          dy == nullptr ? nullptr : dy->mutable_data<T>(ctx.GetPlace()));
-    }
+    ElemwiseGradBroadcast2CUDA(
+        ctx.template device_context<DeviceContext>().stream(), x.data<T>(),
+        y.data<T>(), out.data<T>(), dout.data<T>(), pre, n, post, dx_op, dy_op,
+        dx == nullptr ? nullptr : dx->mutable_data<T>(ctx.GetPlace()),
+        dy == nullptr ? nullptr : dy->mutable_data<T>(ctx.GetPlace()));
   }
+#endif
 }
 
 template <typename DeviceContext, typename T, typename DX_OP, typename DY_OP>
@@ -847,6 +754,13 @@ void ElementwiseComputeEx(const framework::ExecutionContext &ctx,
   axis = (y_dims.size() == 0) ? x_dims.size() : axis;
   int pre, n, post, mid_flag = 0;
   get_mid_dims(x_dims, y_dims, axis, &pre, &n, &post, &mid_flag);
+  if (platform::is_cpu_place(ctx.GetPlace())) {
+    ElementwiseBroadcastCPU<Functor, T, OutType>(
+        ctx.template device_context<platform::CPUDeviceContext>(),
+        CoalesceBroadcastDims(x_dims, y_dims, axis), x->data<T>(),
+        y->data<T>(), z->mutable_data<OutType>(ctx.GetPlace()), func);
+    return;
+  }
   if (mid_flag) {
     functor.RunMidRowWise(n, pre, post);
     return;
@@ -25,7 +25,7 @@ template <typename DeviceContext, typename T>
 void default_elementwise_sub(const framework::ExecutionContext& ctx,
                              const framework::Tensor* x,
                              const framework::Tensor* y, framework::Tensor* z) {
-  int axis = ctx.Attr<int>("axis");
+  int axis = ctx.Attr<int>(kElementwiseAxis);
   ElementwiseComputeEx<SubFunctor<T>, DeviceContext, T>(ctx, x, y, axis,
                                                         SubFunctor<T>(), z);
 }
@@ -41,9 +41,9 @@ template <typename DeviceContext, typename T>
 class ElementwiseSubKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext& ctx) const override {
-    auto* x = ctx.Input<framework::LoDTensor>("X");
-    auto* y = ctx.Input<framework::LoDTensor>("Y");
-    auto* z = ctx.Output<framework::LoDTensor>("Out");
+    auto* x = ctx.Input<framework::LoDTensor>(kElementwiseX);
+    auto* y = ctx.Input<framework::LoDTensor>(kElementwiseY);
+    auto* z = ctx.Output<framework::LoDTensor>(kElementwiseOut);
     z->mutable_data<T>(ctx.GetPlace());
 
     auto dims_equal = x->dims() == y->dims();
@@ -0,0 +1,162 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/elementwise/elementwise_op_broadcast.h"
+#include <random>
+#include <vector>
+#include "gflags/gflags.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/platform/cpu_helper.h"
+
+DECLARE_int64(cpu_eigen_parallel_min_numel);
+
+namespace paddle {
+namespace operators {
+
+struct SubFunctor {
+  float operator()(float x, float y) const { return x - y; }
+};
+
+// d(x * y) / dx and d(x * y) / dy
+struct MulGradDX {
+  float operator()(float x, float y, float out, float dout) const {
+    return dout * y;
+  }
+};
+
+struct MulGradDY {
+  float operator()(float x, float y, float out, float dout) const {
+    return dout * x;
+  }
+};
+
+// The index of Y broadcast to the element i of X.
+static int64_t YIndex(const framework::DDim &x_dims,
+                      const framework::DDim &y_dims, int axis, int64_t i) {
+  int64_t y_index = 0;
+  int64_t y_stride = 1;
+  for (int d = x_dims.size() - 1; d >= 0; --d) {
+    int64_t x_i = i % x_dims[d];
+    i /= x_dims[d];
+    if (d < axis || d >= axis + y_dims.size()) continue;
+    int64_t y_dim = y_dims[d - axis];
+    if (y_dim != 1) y_index += x_i * y_stride;
+    y_stride *= y_dim;
+  }
+  return y_index;
+}
+
+static std::vector<float> Random(int64_t n, std::mt19937 *engine) {
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<float> data(n);
+  for (auto &v : data) v = dist(*engine);
+  return data;
+}
+
+static void TestBroadcast(const std::vector<int64_t> &x_shape,
+                          const std::vector<int64_t> &y_shape, int axis) {
+  auto x_dims = framework::make_ddim(x_shape);
+  auto y_dims = framework::make_ddim(y_shape);
+  int64_t x_numel = framework::product(x_dims);
+  int64_t y_numel = framework::product(y_dims);
+  std::mt19937 engine(x_numel);
+  auto x = Random(x_numel, &engine);
+  auto y = Random(y_numel, &engine);
+  auto dout = Random(x_numel, &engine);
+
+  std::vector<float> out_ref(x_numel), dx_ref(x_numel), dy_ref(y_numel, 0);
+  for (int64_t i = 0; i < x_numel; ++i) {
+    int64_t j = YIndex(x_dims, y_dims, axis, i);
+    out_ref[i] = x[i] - y[j];
+    dx_ref[i] = dout[i] * y[j];
+    dy_ref[j] += dout[i] * x[i];
+  }
+
+  platform::CPUDeviceContext ctx;
+  auto dims = CoalesceBroadcastDims(x_dims, y_dims, axis);
+  for (int num_threads : {1, 4}) {
+    platform::SetNumThreads(num_threads);
+    std::vector<float> out(x_numel), dx(x_numel), dy(y_numel, 7.0f);
+    ElementwiseBroadcastCPU(ctx, dims, x.data(), y.data(), out.data(),
+                            SubFunctor());
+    ElemwiseGradBroadcastCPU(ctx, dims, x.data(), y.data(), out.data(),
+                             dout.data(), MulGradDX(), MulGradDY(), dx.data(),
+                             dy.data());
+    for (int64_t i = 0; i < x_numel; ++i) {
+      ASSERT_EQ(out[i], out_ref[i]);
+      ASSERT_EQ(dx[i], dx_ref[i]);
+    }
+    for (int64_t j = 0; j < y_numel; ++j) {
+      ASSERT_NEAR(dy[j], dy_ref[j], 1e-4);
+    }
+
+    // dX or dY alone.
+    std::fill(dy.begin(), dy.end(), 7.0f);
+    ElemwiseGradBroadcastCPU(ctx, dims, x.data(), y.data(), out.data(),
+                             dout.data(), MulGradDX(), MulGradDY(),
+                             static_cast<float *>(nullptr), dy.data());
+    for (int64_t j = 0; j < y_numel; ++j) {
+      ASSERT_NEAR(dy[j], dy_ref[j], 1e-4);
+    }
+    ElemwiseGradBroadcastCPU(ctx, dims, x.data(), y.data(), out.data(),
+                             dout.data(), MulGradDX(), MulGradDY(), dx.data(),
+                             static_cast<float *>(nullptr));
+    for (int64_t i = 0; i < x_numel; ++i) {
+      ASSERT_EQ(dx[i], dx_ref[i]);
+    }
+  }
+  platform::SetNumThreads(1);
+}
+
+TEST(CoalesceBroadcastDims, Merge) {
+  auto dims = CoalesceBroadcastDims(framework::make_ddim({2, 3, 4, 5}),
+                                    framework::make_ddim({3, 1}), 1);
+  EXPECT_EQ(dims.dims, std::vector<int64_t>({2, 3, 20}));
+  EXPECT_EQ(dims.y_strides, std::vector<int64_t>({0, 1, 0}));
+  EXPECT_TRUE(dims.inner_broadcast());
+
+  dims = CoalesceBroadcastDims(framework::make_ddim({2, 3, 4, 5}),
+                               framework::make_ddim({2, 1, 4, 5}), 0);
+  EXPECT_EQ(dims.dims, std::vector<int64_t>({2, 3, 20}));
+  EXPECT_EQ(dims.y_strides, std::vector<int64_t>({20, 0, 1}));
+  EXPECT_FALSE(dims.inner_broadcast());
+  EXPECT_EQ(dims.rows(), 6);
+
+  // Dims of size 1 in X are dropped.
+  dims = CoalesceBroadcastDims(framework::make_ddim({8, 1, 16}),
+                               framework::make_ddim({16}), 2);
+  EXPECT_EQ(dims.dims, std::vector<int64_t>({8, 16}));
+  EXPECT_EQ(dims.y_strides, std::vector<int64_t>({0, 1}));
+
+  EXPECT_THROW(CoalesceBroadcastDims(framework::make_ddim({2, 3}),
+                                     framework::make_ddim({2}), 1),
+               platform::EnforceNotMet);
+}
+
+TEST(ElementwiseBroadcastCPU, Shapes) {
+  // Small enough to run every case on the thread pool.
+  FLAGS_cpu_eigen_parallel_min_numel = 16;
+  TestBroadcast({6, 7}, {7}, 1);                // bias add
+  TestBroadcast({6, 7}, {6}, 0);                // scale rows, axis = 0
+  TestBroadcast({4, 3, 5, 6}, {3, 5}, 1);       // pre, n, post
+  TestBroadcast({4, 3, 5, 6}, {4, 1, 5, 6}, 0);  // mid broadcast
+  TestBroadcast({4, 3, 5, 6}, {4, 1, 1, 6}, 0);  // several broadcast dims
+  TestBroadcast({3, 5}, {1}, 1);                // scalar
+  TestBroadcast({1000, 3}, {3}, 1);             // more rows than threads
+  TestBroadcast({2, 1}, {1}, 1);
+  FLAGS_cpu_eigen_parallel_min_numel = 65536;
+}
+
+}  // namespace operators
+}  // namespace paddle
@@ -25,6 +25,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/platform/device_context.h"
 
 #define MAX_RANK_SUPPORTED 6
 
@@ -93,6 +94,33 @@ template <typename T, size_t D, int MajorType = Eigen::RowMajor,
           typename IndexType = Eigen::DenseIndex>
 using EigenTensor = framework::EigenTensor<T, D, MajorType, IndexType>;
 
+template <typename T, int Rank>
+struct ExpandFunctor {
+  template <typename EigenDevice>
+  void operator()(const EigenDevice& device, const Tensor* in,
+                  const Eigen::DSizes<int, Rank>& bcast_dims,
+                  Tensor* out) const {
+    auto x = EigenTensor<T, Rank>::From(*in);
+    auto y = EigenTensor<T, Rank>::From(*out);
+    y.device(device) = x.broadcast(bcast_dims);
+  }
+};
+
+template <typename T, int ReshapeRank, int ReduceRank>
+struct ExpandGradFunctor {
+  template <typename EigenDevice>
+  void operator()(const EigenDevice& device, const Tensor* out_grad_t,
+                  const Eigen::DSizes<int, ReshapeRank>& reshape_dims,
+                  const Eigen::DSizes<int, ReduceRank>& reduce_dims,
+                  Tensor* x_grad_t) const {
+    auto x_grad = EigenVector<T>::Flatten(*x_grad_t);
+    auto out_grad = EigenVector<T>::Flatten(*out_grad_t);
+    x_grad.device(device) = out_grad.reshape(reshape_dims)
+                                .sum(reduce_dims)
+                                .reshape(x_grad.dimensions());
+  }
+};
+
 template <typename DeviceContext, typename T>
 class ExpandKernel : public framework::OpKernel<T> {
  public:
@@ -128,12 +156,11 @@ class ExpandKernel : public framework::OpKernel<T> {
     }
 
     out0->Resize(out_dims);
-    auto x = EigenTensor<T, Rank>::From(*in0);
     out0->mutable_data<T>(context.GetPlace());
-    auto y = EigenTensor<T, Rank>::From(*out0);
-    auto& place =
-        *context.template device_context<DeviceContext>().eigen_device();
-    y.device(place) = x.broadcast(bcast_dims);
+    ExpandFunctor<T, Rank> functor;
+    platform::EigenDeviceRun(
+        context.template device_context<DeviceContext>(), out0->numel(),
+        &functor, in0, bcast_dims, out0);
   }
 };
 
@@ -203,7 +230,6 @@ class ExpandGradKernel : public framework::OpKernel<T> {
     auto* in0 = context.Input<Tensor>(framework::GradVarName("Out"));
     auto* out0 = context.Output<Tensor>(framework::GradVarName("X"));
     out0->mutable_data<T>(context.GetPlace());
-    auto x_grad = EigenVector<T>::Flatten(*out0);
     Eigen::DSizes<int, Dims / MAX_RANK_SUPPORTED + 1> reshape_dims;
     for (size_t i = 0; i < reshape_size; ++i) {
       reshape_dims[i] = reshape_dims_vec[i];
@@ -212,12 +238,12 @@ class ExpandGradKernel : public framework::OpKernel<T> {
     for (size_t i = 0; i < reduce_size; ++i) {
       reduce_dims[i] = reduce_dims_vec[i];
     }
-    auto out_grad = EigenVector<T>::Flatten(*in0);
-    x_grad.device(
-        *context.template device_context<DeviceContext>().eigen_device()) =
-        out_grad.reshape(reshape_dims)
-            .sum(reduce_dims)
-            .reshape(x_grad.dimensions());
+    ExpandGradFunctor<T, Dims / MAX_RANK_SUPPORTED + 1,
+                      Dims % MAX_RANK_SUPPORTED + 1>
+        functor;
+    platform::EigenDeviceRun(
+        context.template device_context<DeviceContext>(), in0->numel(),
+        &functor, in0, reshape_dims, reduce_dims, out0);
   }
 };
 
@@ -52,10 +52,6 @@ class FCOp : public framework::OperatorWithKernel {
                         "Activation %s is not supportetd in fc now.",
                         activation_type.c_str());
     }
-    if (ctx->Attrs().Get<bool>("use_mkldnn")) {
-      PADDLE_ENFORCE_EQ(in_dims.size() == 2 || in_dims.size() == 4, true,
-                        "Fully Connected input should be 2-D or 4-D tensor.");
-    }
     PADDLE_ENFORCE_EQ(w_dims.size(), 2,
                       "Fully Connected input should be 2-D tensor.");
     int in_num_col_dims = ctx->Attrs().Get<int>("in_num_col_dims");
@@ -138,6 +134,29 @@ class FCOpMaker : public framework::OpProtoAndCheckerMaker {
     AddAttr<bool>("use_mkldnn",
                   "(bool, default false) Only used in mkldnn kernel")
         .SetDefault(false);
+    AddAttr<bool>("use_quantizer",
+                  "(bool, default false) "
+                  "Set to true for operators that should be quantized and use "
+                  "int8 kernel. "
+                  "Only used on CPU.")
+        .SetDefault(false);
+    AddAttr<float>("Scale_in",
+                   "Scale_in to be used for int8 input data. "
+                   "Only used with MKL-DNN INT8.")
+        .SetDefault(1.0f);
+    AddAttr<std::vector<float>>(
+        "Scale_weights",
+        "Scale_weights to be used for int8 weights data. "
+        "Only used with MKL-DNN INT8.")
+        .SetDefault({1.0f});
+    AddAttr<float>("Scale_out",
+                   "Scale_out to be used for int8 output data. "
+                   "Only used with MKL-DNN INT8.")
+        .SetDefault(1.0f);
+    AddAttr<bool>("force_fp32_output",
+                  "(bool, default false) Force INT8 kernel output FP32, only "
+                  "used in MKL-DNN INT8")
+        .SetDefault(false);
     AddAttr<bool>(framework::kAllKernelsMustComputeRuntimeShape,
                   "Skip calling InferShape() function in the runtime.")
         .SetDefault(true);
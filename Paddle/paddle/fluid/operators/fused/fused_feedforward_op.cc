@@ -0,0 +1,194 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fused/fused_feedforward_op.h"
+#include <memory>
+#include <string>
+
+namespace paddle {
+namespace operators {
+
+class FusedFeedForwardOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    for (auto& name :
+         {"X", "Linear1W", "Linear1Bias", "Linear2W", "Linear2Bias"}) {
+      PADDLE_ENFORCE(ctx->HasInput(name),
+                     "Input(%s) of FusedFeedForwardOp should not be null.",
+                     name);
+    }
+    for (auto& name : {"Out", "Linear1Out", "Seed"}) {
+      PADDLE_ENFORCE(ctx->HasOutput(name),
+                     "Output(%s) of FusedFeedForwardOp should not be null.",
+                     name);
+    }
+    PADDLE_ENFORCE_GT(ctx->Attrs().Get<int>("tile_rows"), 0,
+                      "Attr(tile_rows) should be positive.");
+
+    auto x_dims = ctx->GetInputDim("X");
+    auto w1_dims = ctx->GetInputDim("Linear1W");
+    auto w2_dims = ctx->GetInputDim("Linear2W");
+    PADDLE_ENFORCE_GE(x_dims.size(), 2, "Input(X) should be [..., d_model].");
+    PADDLE_ENFORCE_EQ(w1_dims.size(), 2,
+                      "Input(Linear1W) should be [d_model, inner_size].");
+    PADDLE_ENFORCE_EQ(w2_dims.size(), 2,
+                      "Input(Linear2W) should be [inner_size, d_model].");
+    const int64_t d_model = x_dims[x_dims.size() - 1];
+    if (d_model > 0 && w1_dims[1] > 0) {
+      PADDLE_ENFORCE_EQ(w1_dims[0], d_model,
+                        "The rows of Input(Linear1W) should be the last "
+                        "dimension of Input(X).");
+      PADDLE_ENFORCE_EQ(w2_dims, framework::make_ddim({w1_dims[1], d_model}),
+                        "Input(Linear2W) should be [inner_size, d_model].");
+      PADDLE_ENFORCE_EQ(framework::product(ctx->GetInputDim("Linear1Bias")),
+                        w1_dims[1],
+                        "Input(Linear1Bias) should have inner_size elements.");
+      PADDLE_ENFORCE_EQ(framework::product(ctx->GetInputDim("Linear2Bias")),
+                        d_model,
+                        "Input(Linear2Bias) should have d_model elements.");
+    }
+
+    auto pre_dims = x_dims;
+    pre_dims[pre_dims.size() - 1] = w1_dims[1];
+    ctx->SetOutputDim("Out", x_dims);
+    ctx->SetOutputDim("Linear1Out", pre_dims);
+    ctx->SetOutputDim("Seed", {1});
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        OperatorWithKernel::IndicateVarDataType(ctx, "X"), ctx.GetPlace());
+  }
+};
+
+class FusedFeedForwardOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X", "(Tensor) [..., d_model].");
+    AddInput("Linear1W", "(Tensor) [d_model, inner_size].");
+    AddInput("Linear1Bias", "(Tensor) [inner_size].");
+    AddInput("Linear2W", "(Tensor) [inner_size, d_model].");
+    AddInput("Linear2Bias", "(Tensor) [d_model].");
+    AddOutput("Out", "(Tensor) [..., d_model].");
+    AddOutput("Linear1Out",
+              "(Tensor) [..., inner_size], the output of the first linear "
+              "before the GELU.")
+        .AsIntermediate();
+    AddOutput("Seed", "(Tensor<int>) The seed of the dropout mask.")
+        .AsIntermediate();
+    AddAttr<float>("dropout_prob",
+                   "(float, default 0.0) The dropout probability after the "
+                   "GELU.")
+        .SetDefault(0.0f)
+        .AddCustomChecker([](const float& prob) {
+          PADDLE_ENFORCE(prob >= 0.0f && prob <= 1.0f,
+                         "'dropout_prob' must be between 0.0 and 1.0.");
+        });
+    AddAttr<bool>("is_test",
+                  "(bool, default false) Set to true for inference only, the "
+                  "dropout is disabled.")
+        .SetDefault(false);
+    AddAttr<bool>("fix_seed",
+                  "(bool, default false) A flag indicating whether to use a "
+                  "fixed seed to generate the dropout mask.")
+        .SetDefault(false);
+    AddAttr<int>("seed", "(int, default 0) The fixed seed of the dropout.")
+        .SetDefault(0);
+    AddAttr<int>("tile_rows",
+                 "(int, default 32) The number of the rows computed at a "
+                 "time, the [tile_rows, inner_size] activation should fit in "
+                 "the cache.")
+        .SetDefault(32);
+    AddComment(R"DOC(
+FusedFeedForward Operator.
+
+The position-wise feed-forward block of the Transformer:
+
+    Linear1Out = X * Linear1W + Linear1Bias
+    Out = dropout(gelu(Linear1Out)) * Linear2W + Linear2Bias
+
+where gelu(x) = 0.5 * x * (1 + erf(x / sqrt(2))) and the dropout is
+upscale_in_train. The rows are computed tile_rows at a time, so only a tile
+of the activation is alive and it stays in the cache between the two linears.
+The backward recomputes the activation from Linear1Out and the saved dropout
+seed instead of keeping it.
+)DOC");
+  }
+};
+
+class FusedFeedForwardGradOpMaker : public framework::SingleGradOpDescMaker {
+ public:
+  using framework::SingleGradOpDescMaker::SingleGradOpDescMaker;
+
+ protected:
+  std::unique_ptr<framework::OpDesc> Apply() const override {
+    std::unique_ptr<framework::OpDesc> op(new framework::OpDesc());
+    op->SetType("fused_feedforward_grad");
+    for (auto& name :
+         {"X", "Linear1W", "Linear1Bias", "Linear2W", "Linear2Bias"}) {
+      op->SetInput(name, Input(name));
+      op->SetOutput(framework::GradVarName(name), InputGrad(name));
+    }
+    op->SetInput("Linear1Out", Output("Linear1Out"));
+    op->SetInput("Seed", Output("Seed"));
+    op->SetInput(framework::GradVarName("Out"), OutputGrad("Out"));
+    op->SetAttrMap(Attrs());
+    return op;
+  }
+};
+
+class FusedFeedForwardGradOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE_EQ(ctx->Attrs().Get<bool>("is_test"), false,
+                      "GradOp is only callable when is_test is false");
+    PADDLE_ENFORCE(ctx->HasInput(framework::GradVarName("Out")),
+                   "Input(Out@GRAD) should not be null.");
+    for (auto& name :
+         {"X", "Linear1W", "Linear1Bias", "Linear2W", "Linear2Bias"}) {
+      auto grad_name = framework::GradVarName(name);
+      if (ctx->HasOutput(grad_name)) {
+        ctx->SetOutputDim(grad_name, ctx->GetInputDim(name));
+      }
+    }
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(OperatorWithKernel::IndicateVarDataType(
+                                       ctx, framework::GradVarName("Out")),
+                                   ctx.GetPlace());
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(fused_feedforward, ops::FusedFeedForwardOp,
+                  ops::FusedFeedForwardOpMaker,
+                  ops::FusedFeedForwardGradOpMaker);
+REGISTER_OPERATOR(fused_feedforward_grad, ops::FusedFeedForwardGradOp);
+REGISTER_OP_CPU_KERNEL(fused_feedforward, ops::FusedFeedForwardKernel<float>,
+                       ops::FusedFeedForwardKernel<double>);
+REGISTER_OP_CPU_KERNEL(fused_feedforward_grad,
+                       ops::FusedFeedForwardGradKernel<float>,
+                       ops::FusedFeedForwardGradKernel<double>);
@@ -0,0 +1,243 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/jit/kernels.h"
+#include "paddle/fluid/operators/math/blas.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+/**
+ * The GELU and the dropout between the two linears of a feed-forward block,
+ * applied to one row of the [rows, inner_size] pre-activation at a time. The
+ * dropout mask of a row only depends on the seed and the index of the row, so
+ * the backward regenerates it instead of saving it.
+ */
+template <typename T>
+class FeedForwardActivation {
+ public:
+  FeedForwardActivation(int inner_size, float dropout_prob, int seed)
+      : inner_size_(inner_size),
+        dropout_prob_(dropout_prob),
+        seed_(seed),
+        gelu_(jit::KernelFuncs<jit::VGeluTuple<T>, platform::CPUPlace>::Cache()
+                  .At(inner_size)),
+        factors_(dropout_prob > 0 ? inner_size : 0) {}
+
+  // h = dropout(gelu(pre)) of the row.
+  void Forward(const T* pre, int row, T* h) {
+    gelu_(pre, h, inner_size_);
+    if (dropout_prob_ > 0) {
+      Factors(row);
+      for (int j = 0; j < inner_size_; ++j) h[j] *= factors_[j];
+    }
+  }
+
+  // d_pre = d_h * dropout_factors * gelu'(pre) of the row, d_pre can be d_h.
+  void Backward(const T* pre, const T* d_h, int row, T* d_pre) {
+    if (dropout_prob_ > 0) Factors(row);
+    const T kAlpha = static_cast<T>(M_SQRT1_2);
+    const T kBeta = static_cast<T>(M_2_SQRTPI * M_SQRT1_2 * 0.5);
+    for (int j = 0; j < inner_size_; ++j) {
+      const T x = pre[j];
+      const T cdf = static_cast<T>(0.5) * (1 + std::erf(x * kAlpha));
+      const T pdf = kBeta * std::exp(static_cast<T>(-0.5) * x * x);
+      const T d = dropout_prob_ > 0 ? d_h[j] * factors_[j] : d_h[j];
+      d_pre[j] = d * (cdf + x * pdf);
+    }
+  }
+
+ private:
+  // The upscaled dropout mask of the row.
+  void Factors(int row) {
+    std::seed_seq seq{static_cast<uint32_t>(seed_), static_cast<uint32_t>(row)};
+    std::minstd_rand engine(seq);
+    std::uniform_real_distribution<float> dist(0, 1);
+    const T keep = dropout_prob_ < 1 ? 1 / (1 - dropout_prob_) : 0;
+    for (int j = 0; j < inner_size_; ++j) {
+      factors_[j] = dist(engine) < dropout_prob_ ? 0 : keep;
+    }
+  }
+
+  const int inner_size_;
+  const float dropout_prob_;
+  const int seed_;
+  typename jit::VGeluTuple<T>::func_type gelu_;
+  std::vector<T> factors_;
+};
+
+// out = x * w + bias of a tile of rows, x is [rows, in], w is [in, out].
+template <typename T>
+void FeedForwardLinear(const math::BlasT<platform::CPUDeviceContext, T>& blas,
+                       const T* x, const T* w, const T* bias, int rows,
+                       int in_size, int out_size, T* out) {
+  blas.MatMul(rows, out_size, in_size, x, w, out);
+  for (int i = 0; i < rows; ++i) {
+    blas.AXPY(out_size, static_cast<T>(1), bias, out + i * out_size);
+  }
+}
+
+// The gradients of FeedForwardLinear of a tile of rows, any of them can be
+// null. d_w and d_bias are accumulated unless it is the first tile.
+template <typename T>
+void FeedForwardLinearGrad(
+    const math::BlasT<platform::CPUDeviceContext, T>& blas, const T* x,
+    const T* w, const T* d_out, int rows, int in_size, int out_size,
+    bool first_tile, T* d_x, T* d_w, T* d_bias) {
+  if (d_x) {
+    blas.GEMM(false, true, rows, in_size, out_size, static_cast<T>(1), d_out,
+              out_size, w, out_size, static_cast<T>(0), d_x, in_size);
+  }
+  if (d_w) {
+    blas.GEMM(true, false, in_size, out_size, rows, static_cast<T>(1), x,
+              in_size, d_out, out_size, static_cast<T>(first_tile ? 0 : 1),
+              d_w, out_size);
+  }
+  if (d_bias) {
+    if (first_tile) std::fill(d_bias, d_bias + out_size, static_cast<T>(0));
+    for (int i = 0; i < rows; ++i) {
+      blas.AXPY(out_size, static_cast<T>(1), d_out + i * out_size, d_bias);
+    }
+  }
+}
+
+template <typename T>
+class FusedFeedForwardKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* x = ctx.Input<Tensor>("X");
+    auto* w1 = ctx.Input<Tensor>("Linear1W");
+    auto* bias1 = ctx.Input<Tensor>("Linear1Bias");
+    auto* w2 = ctx.Input<Tensor>("Linear2W");
+    auto* bias2 = ctx.Input<Tensor>("Linear2Bias");
+    auto* pre_out = ctx.Output<Tensor>("Linear1Out");
+    auto* seed_out = ctx.Output<Tensor>("Seed");
+    auto* out = ctx.Output<Tensor>("Out");
+
+    const int d_model = w1->dims()[0];
+    const int inner_size = w1->dims()[1];
+    const int rows = x->numel() / d_model;
+    const int tile_rows = ctx.Attr<int>("tile_rows");
+    const float dropout_prob =
+        ctx.Attr<bool>("is_test") ? 0.0f : ctx.Attr<float>("dropout_prob");
+    // NOTE: fixed seed should only be used in unittest or for debug.
+    std::random_device rnd;
+    const int seed =
+        ctx.Attr<bool>("fix_seed") ? ctx.Attr<int>("seed") : rnd();
+    seed_out->mutable_data<int>({1}, platform::CPUPlace())[0] = seed;
+
+    auto place = ctx.GetPlace();
+    const T* x_data = x->data<T>();
+    T* pre_data = pre_out->mutable_data<T>(place);
+    T* out_data = out->mutable_data<T>(place);
+
+    // Only a tile of the activation is alive at a time.
+    auto blas = math::GetBlas<platform::CPUDeviceContext, T>(ctx);
+    FeedForwardActivation<T> act(inner_size, dropout_prob, seed);
+    Tensor h_t;
+    T* h = h_t.mutable_data<T>({tile_rows, inner_size}, platform::CPUPlace());
+    for (int r = 0; r < rows; r += tile_rows) {
+      const int n = std::min(tile_rows, rows - r);
+      T* pre = pre_data + r * inner_size;
+      FeedForwardLinear(blas, x_data + r * d_model, w1->data<T>(),
+                        bias1->data<T>(), n, d_model, inner_size, pre);
+      for (int i = 0; i < n; ++i) {
+        act.Forward(pre + i * inner_size, r + i, h + i * inner_size);
+      }
+      FeedForwardLinear(blas, h, w2->data<T>(), bias2->data<T>(), n,
+                        inner_size, d_model, out_data + r * d_model);
+    }
+  }
+};
+
+template <typename T>
+class FusedFeedForwardGradKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* x = ctx.Input<Tensor>("X");
+    auto* w1 = ctx.Input<Tensor>("Linear1W");
+    auto* w2 = ctx.Input<Tensor>("Linear2W");
+    auto* pre_out = ctx.Input<Tensor>("Linear1Out");
+    auto* seed = ctx.Input<Tensor>("Seed");
+    auto* d_out = ctx.Input<Tensor>(framework::GradVarName("Out"));
+    auto* d_x = ctx.Output<Tensor>(framework::GradVarName("X"));
+    auto* d_w1 = ctx.Output<Tensor>(framework::GradVarName("Linear1W"));
+    auto* d_bias1 = ctx.Output<Tensor>(framework::GradVarName("Linear1Bias"));
+    auto* d_w2 = ctx.Output<Tensor>(framework::GradVarName("Linear2W"));
+    auto* d_bias2 = ctx.Output<Tensor>(framework::GradVarName("Linear2Bias"));
+
+    const int d_model = w1->dims()[0];
+    const int inner_size = w1->dims()[1];
+    const int rows = x->numel() / d_model;
+    const int tile_rows = ctx.Attr<int>("tile_rows");
+    const float dropout_prob =
+        ctx.Attr<bool>("is_test") ? 0.0f : ctx.Attr<float>("dropout_prob");
+
+    auto place = ctx.GetPlace();
+    auto mutable_data = [&](Tensor* t) -> T* {
+      return t ? t->mutable_data<T>(place) : nullptr;
+    };
+    const T* x_data = x->data<T>();
+    const T* pre_data = pre_out->data<T>();
+    const T* d_out_data = d_out->data<T>();
+    T* d_x_data = mutable_data(d_x);
+    T* d_w1_data = mutable_data(d_w1);
+    T* d_bias1_data = mutable_data(d_bias1);
+    T* d_w2_data = mutable_data(d_w2);
+    T* d_bias2_data = mutable_data(d_bias2);
+
+    // The activation of a tile is recomputed from the saved pre-activation
+    // and the seed, then reused as the buffer of its gradient.
+    auto blas = math::GetBlas<platform::CPUDeviceContext, T>(ctx);
+    FeedForwardActivation<T> act(inner_size, dropout_prob,
+                                 seed->data<int>()[0]);
+    Tensor buffer_t;
+    T* h = buffer_t.mutable_data<T>({2, tile_rows * inner_size},
+                                    platform::CPUPlace());
+    T* d_h = h + tile_rows * inner_size;
+    for (int r = 0; r < rows; r += tile_rows) {
+      const int n = std::min(tile_rows, rows - r);
+      const bool first_tile = r == 0;
+      const T* pre = pre_data + r * inner_size;
+      if (d_w2_data) {
+        for (int i = 0; i < n; ++i) {
+          act.Forward(pre + i * inner_size, r + i, h + i * inner_size);
+        }
+      }
+      FeedForwardLinearGrad(blas, h, w2->data<T>(), d_out_data + r * d_model,
+                            n, inner_size, d_model, first_tile, d_h,
+                            d_w2_data, d_bias2_data);
+      for (int i = 0; i < n; ++i) {
+        act.Backward(pre + i * inner_size, d_h + i * inner_size, r + i,
+                     d_h + i * inner_size);
+      }
+      FeedForwardLinearGrad(blas, x_data + r * d_model, w1->data<T>(), d_h, n,
+                            d_model, inner_size, first_tile,
+                            d_x_data ? d_x_data + r * d_model : nullptr,
+                            d_w1_data, d_bias1_data);
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,212 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fused/fused_multihead_attention_op.h"
+#include <memory>
+#include <string>
+
+namespace paddle {
+namespace operators {
+
+class FusedMultiHeadAttentionOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    for (auto& name : {"X", "QKVW", "QKVBias", "OutLinearW", "OutLinearBias"}) {
+      PADDLE_ENFORCE(ctx->HasInput(name),
+                     "Input(%s) of FusedMultiHeadAttentionOp should not be "
+                     "null.",
+                     name);
+    }
+    for (auto& name : {"Out", "QKVOut", "AttnOut", "SoftmaxLse", "Seed"}) {
+      PADDLE_ENFORCE(ctx->HasOutput(name),
+                     "Output(%s) of FusedMultiHeadAttentionOp should not be "
+                     "null.",
+                     name);
+    }
+
+    auto x_dims = ctx->GetInputDim("X");
+    PADDLE_ENFORCE_EQ(x_dims.size(), 3,
+                      "Input(X) should be [batch_size, seq_len, hidden].");
+    const int64_t hidden = x_dims[2];
+    const int num_heads = ctx->Attrs().Get<int>("num_heads");
+    PADDLE_ENFORCE_GT(num_heads, 0, "Attr(num_heads) should be positive.");
+    if (hidden > 0) {
+      PADDLE_ENFORCE_EQ(hidden % num_heads, 0,
+                        "The hidden size should be divisible by num_heads.");
+      PADDLE_ENFORCE_EQ(ctx->GetInputDim("QKVW"),
+                        framework::make_ddim({hidden, 3 * hidden}),
+                        "Input(QKVW) should be [hidden, 3 * hidden].");
+      PADDLE_ENFORCE_EQ(framework::product(ctx->GetInputDim("QKVBias")),
+                        3 * hidden,
+                        "Input(QKVBias) should have 3 * hidden elements.");
+      PADDLE_ENFORCE_EQ(ctx->GetInputDim("OutLinearW"),
+                        framework::make_ddim({hidden, hidden}),
+                        "Input(OutLinearW) should be [hidden, hidden].");
+      PADDLE_ENFORCE_EQ(framework::product(ctx->GetInputDim("OutLinearBias")),
+                        hidden,
+                        "Input(OutLinearBias) should have hidden elements.");
+    }
+    if (ctx->HasInput("Mask") && ctx->IsRuntime()) {
+      PADDLE_ENFORCE_EQ(ctx->GetInputDim("Mask"),
+                        framework::make_ddim({x_dims[0], x_dims[1], x_dims[1]}),
+                        "Input(Mask) should be [batch_size, seq_len, "
+                        "seq_len].");
+    }
+
+    ctx->SetOutputDim("Out", x_dims);
+    ctx->SetOutputDim("QKVOut", {x_dims[0], x_dims[1], 3 * hidden});
+    ctx->SetOutputDim("AttnOut", x_dims);
+    ctx->SetOutputDim("SoftmaxLse", {x_dims[0], num_heads, x_dims[1]});
+    ctx->SetOutputDim("Seed", {1});
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        OperatorWithKernel::IndicateVarDataType(ctx, "X"), ctx.GetPlace());
+  }
+};
+
+class FusedMultiHeadAttentionOpMaker
+    : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X", "(Tensor) [batch_size, seq_len, hidden].");
+    AddInput("QKVW", "(Tensor) [hidden, 3 * hidden], the weight of Q, K, V.");
+    AddInput("QKVBias", "(Tensor) [3 * hidden], the bias of Q, K, V.");
+    AddInput("OutLinearW",
+             "(Tensor) [hidden, hidden], the weight of the output "
+             "projection.");
+    AddInput("OutLinearBias",
+             "(Tensor) [hidden], the bias of the output projection.");
+    AddInput("Mask",
+             "(Tensor) [batch_size, seq_len, seq_len], 1 for the positions "
+             "which are not attended to and 0 for the others.")
+        .AsDispensable();
+    AddOutput("Out", "(Tensor) [batch_size, seq_len, hidden].");
+    AddOutput("QKVOut", "(Tensor) [batch_size, seq_len, 3 * hidden].")
+        .AsIntermediate();
+    AddOutput("AttnOut",
+              "(Tensor) [batch_size, seq_len, hidden], the merged heads "
+              "before the output projection.")
+        .AsIntermediate();
+    AddOutput("SoftmaxLse",
+              "(Tensor) [batch_size, num_heads, seq_len], the log-sum-exp of "
+              "the rows of the attention scores.")
+        .AsIntermediate();
+    AddOutput("Seed", "(Tensor<int>) The seed of the dropout mask.")
+        .AsIntermediate();
+    AddAttr<int>("num_heads", "(int) The number of the heads.");
+    AddAttr<float>("dropout_prob",
+                   "(float, default 0.0) The dropout probability of the "
+                   "attention weights.")
+        .SetDefault(0.0f)
+        .AddCustomChecker([](const float& prob) {
+          PADDLE_ENFORCE(prob >= 0.0f && prob <= 1.0f,
+                         "'dropout_prob' must be between 0.0 and 1.0.");
+        });
+    AddAttr<bool>("is_test",
+                  "(bool, default false) Set to true for inference only, the "
+                  "dropout is disabled.")
+        .SetDefault(false);
+    AddAttr<bool>("fix_seed",
+                  "(bool, default false) A flag indicating whether to use a "
+                  "fixed seed to generate the dropout mask.")
+        .SetDefault(false);
+    AddAttr<int>("seed", "(int, default 0) The fixed seed of the dropout.")
+        .SetDefault(0);
+    AddComment(R"DOC(
+FusedMultiHeadAttention Operator.
+
+The multi-head self-attention with the input and output projections:
+
+    Q, K, V = split_heads(X * QKVW + QKVBias)
+    Weights = dropout(softmax(mask(Q * K^T / sqrt(head_dim)))) * (1 - Mask)
+    Out = merge_heads(Weights * V) * OutLinearW + OutLinearBias
+
+where the masked scores are -1e10 and the dropout is upscale_in_train. The
+[batch_size, num_heads, seq_len, seq_len] weights are computed one head at a
+time and never stored. The backward recomputes them from QKVOut, the saved
+log-sum-exp of the softmax rows and the saved dropout seed.
+)DOC");
+  }
+};
+
+class FusedMultiHeadAttentionGradOpMaker
+    : public framework::SingleGradOpDescMaker {
+ public:
+  using framework::SingleGradOpDescMaker::SingleGradOpDescMaker;
+
+ protected:
+  std::unique_ptr<framework::OpDesc> Apply() const override {
+    std::unique_ptr<framework::OpDesc> op(new framework::OpDesc());
+    op->SetType("fused_multihead_attention_grad");
+    for (auto& name : {"X", "QKVW", "QKVBias", "OutLinearW", "OutLinearBias"}) {
+      op->SetInput(name, Input(name));
+      op->SetOutput(framework::GradVarName(name), InputGrad(name));
+    }
+    op->SetInput("Mask", Input("Mask"));
+    for (auto& name : {"QKVOut", "AttnOut", "SoftmaxLse", "Seed"}) {
+      op->SetInput(name, Output(name));
+    }
+    op->SetInput(framework::GradVarName("Out"), OutputGrad("Out"));
+    op->SetAttrMap(Attrs());
+    return op;
+  }
+};
+
+class FusedMultiHeadAttentionGradOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE_EQ(ctx->Attrs().Get<bool>("is_test"), false,
+                      "GradOp is only callable when is_test is false");
+    PADDLE_ENFORCE(ctx->HasInput(framework::GradVarName("Out")),
+                   "Input(Out@GRAD) should not be null.");
+    for (auto& name : {"X", "QKVW", "QKVBias", "OutLinearW", "OutLinearBias"}) {
+      auto grad_name = framework::GradVarName(name);
+      if (ctx->HasOutput(grad_name)) {
+        ctx->SetOutputDim(grad_name, ctx->GetInputDim(name));
+      }
+    }
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(OperatorWithKernel::IndicateVarDataType(
+                                       ctx, framework::GradVarName("Out")),
+                                   ctx.GetPlace());
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(fused_multihead_attention, ops::FusedMultiHeadAttentionOp,
+                  ops::FusedMultiHeadAttentionOpMaker,
+                  ops::FusedMultiHeadAttentionGradOpMaker);
+REGISTER_OPERATOR(fused_multihead_attention_grad,
+                  ops::FusedMultiHeadAttentionGradOp);
+REGISTER_OP_CPU_KERNEL(fused_multihead_attention,
+                       ops::FusedMultiHeadAttentionKernel<float>,
+                       ops::FusedMultiHeadAttentionKernel<double>);
+REGISTER_OP_CPU_KERNEL(fused_multihead_attention_grad,
+                       ops::FusedMultiHeadAttentionGradKernel<float>,
+                       ops::FusedMultiHeadAttentionGradKernel<double>);
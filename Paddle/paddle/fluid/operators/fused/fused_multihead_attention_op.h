@@ -0,0 +1,354 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/blas.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+// The score of the masked positions, the same as the unfused attention.
+constexpr float kAttentionMaskScore = -1e10f;
+
+/**
+ * The attention of one (batch, head) block on the packed [batch, seq_len,
+ * 3 * hidden] QKV. The [seq_len, seq_len] weights only live in the buffers of
+ * a block: the backward recomputes the softmax from the saved log-sum-exp of
+ * every row, and the dropout mask from the saved seed.
+ */
+template <typename T>
+class MultiHeadAttentionBlock {
+ public:
+  MultiHeadAttentionBlock(
+      const math::BlasT<platform::CPUDeviceContext, T>& blas, int seq_len,
+      int hidden, int num_heads, float dropout_prob, int seed)
+      : blas_(blas),
+        seq_len_(seq_len),
+        hidden_(hidden),
+        num_heads_(num_heads),
+        head_dim_(hidden / num_heads),
+        scale_(static_cast<T>(1.0 / std::sqrt(hidden / num_heads))),
+        dropout_prob_(dropout_prob),
+        seed_(seed) {}
+
+  // Q, K and V of the head of the block.
+  const T* Query(const T* qkv, int block) const {
+    return qkv + Offset(block);
+  }
+  const T* Key(const T* qkv, int block) const {
+    return qkv + Offset(block) + hidden_;
+  }
+  const T* Value(const T* qkv, int block) const {
+    return qkv + Offset(block) + 2 * hidden_;
+  }
+
+  // probs = softmax(mask(scale * Q * K^T)). The log-sum-exp of the rows is
+  // taken from saved_lse if it is given, or written to lse.
+  void Softmax(const T* qkv, const T* mask, int block, const T* saved_lse,
+               T* lse, T* probs) const {
+    const int s = seq_len_;
+    blas_.GEMM(false, true, s, s, head_dim_, scale_, Query(qkv, block),
+               3 * hidden_, Key(qkv, block), 3 * hidden_, static_cast<T>(0),
+               probs, s);
+    const T* block_mask = mask ? mask + (block / num_heads_) * s * s : nullptr;
+    for (int i = 0; i < s; ++i) {
+      T* row = probs + i * s;
+      if (block_mask) {
+        const T* m = block_mask + i * s;
+        for (int j = 0; j < s; ++j) {
+          row[j] = (1 - m[j]) * row[j] + m[j] * kAttentionMaskScore;
+        }
+      }
+      T row_lse;
+      if (saved_lse) {
+        row_lse = saved_lse[i];
+      } else {
+        const T max = *std::max_element(row, row + s);
+        T sum = 0;
+        for (int j = 0; j < s; ++j) sum += std::exp(row[j] - max);
+        row_lse = lse[i] = max + std::log(sum);
+      }
+      for (int j = 0; j < s; ++j) row[j] = std::exp(row[j] - row_lse);
+    }
+  }
+
+  // The factors from the softmax to the attention weights, i.e. the upscaled
+  // dropout mask times (1 - mask).
+  void Factors(const T* mask, int block, T* factors) const {
+    const int numel = seq_len_ * seq_len_;
+    const T* block_mask =
+        mask ? mask + (block / num_heads_) * numel : nullptr;
+    if (dropout_prob_ > 0) {
+      std::seed_seq seq{static_cast<uint32_t>(seed_),
+                        static_cast<uint32_t>(block)};
+      std::minstd_rand engine(seq);
+      std::uniform_real_distribution<float> dist(0, 1);
+      const T keep = dropout_prob_ < 1 ? 1 / (1 - dropout_prob_) : 0;
+      for (int i = 0; i < numel; ++i) {
+        factors[i] = dist(engine) < dropout_prob_ ? 0 : keep;
+      }
+    } else {
+      std::fill(factors, factors + numel, static_cast<T>(1));
+    }
+    if (block_mask) {
+      for (int i = 0; i < numel; ++i) factors[i] *= 1 - block_mask[i];
+    }
+  }
+
+  // context = weights * V, written to the head of the block in [batch,
+  // seq_len, hidden].
+  void Context(const T* qkv, const T* weights, int block, T* context) const {
+    const int s = seq_len_;
+    blas_.GEMM(false, false, s, head_dim_, s, static_cast<T>(1), weights, s,
+               Value(qkv, block), 3 * hidden_, static_cast<T>(0),
+               context + ContextOffset(block), hidden_);
+  }
+
+  // Writes dQ, dK and dV of the block to d_qkv, weights and d_weights are
+  // [seq_len, seq_len] buffers.
+  void Backward(const T* qkv, const T* mask, const T* probs, const T* factors,
+                const T* d_context, int block, T* weights, T* d_weights,
+                T* d_qkv) const {
+    const int s = seq_len_;
+    const int numel = s * s;
+    for (int i = 0; i < numel; ++i) weights[i] = probs[i] * factors[i];
+    const T* d_ctx = d_context + ContextOffset(block);
+    T* d_block = d_qkv + Offset(block);
+    // dV = weights^T * dContext
+    blas_.GEMM(true, false, s, head_dim_, s, static_cast<T>(1), weights, s,
+               d_ctx, hidden_, static_cast<T>(0), d_block + 2 * hidden_,
+               3 * hidden_);
+    // dWeights = dContext * V^T, then dProbs = dWeights * factors
+    blas_.GEMM(false, true, s, s, head_dim_, static_cast<T>(1), d_ctx, hidden_,
+               Value(qkv, block), 3 * hidden_, static_cast<T>(0), d_weights,
+               s);
+    // dScores = probs * (dProbs - sum(dProbs * probs)) * (1 - mask). The
+    // probs of a fully masked row are not zero at the masked positions.
+    const T* block_mask = mask ? mask + (block / num_heads_) * numel : nullptr;
+    for (int i = 0; i < s; ++i) {
+      T* d_row = d_weights + i * s;
+      const T* p_row = probs + i * s;
+      const T* f_row = factors + i * s;
+      T dot = 0;
+      for (int j = 0; j < s; ++j) {
+        d_row[j] *= f_row[j];
+        dot += d_row[j] * p_row[j];
+      }
+      for (int j = 0; j < s; ++j) d_row[j] = p_row[j] * (d_row[j] - dot);
+      if (block_mask) {
+        const T* m = block_mask + i * s;
+        for (int j = 0; j < s; ++j) d_row[j] *= 1 - m[j];
+      }
+    }
+    // dQ = scale * dScores * K, dK = scale * dScores^T * Q
+    blas_.GEMM(false, false, s, head_dim_, s, scale_, d_weights, s,
+               Key(qkv, block), 3 * hidden_, static_cast<T>(0), d_block,
+               3 * hidden_);
+    blas_.GEMM(true, false, s, head_dim_, s, scale_, d_weights, s,
+               Query(qkv, block), 3 * hidden_, static_cast<T>(0),
+               d_block + hidden_, 3 * hidden_);
+  }
+
+ private:
+  int Offset(int block) const {
+    return (block / num_heads_) * seq_len_ * 3 * hidden_ +
+           (block % num_heads_) * head_dim_;
+  }
+  int ContextOffset(int block) const {
+    return (block / num_heads_) * seq_len_ * hidden_ +
+           (block % num_heads_) * head_dim_;
+  }
+
+  const math::BlasT<platform::CPUDeviceContext, T>& blas_;
+  const int seq_len_;
+  const int hidden_;
+  const int num_heads_;
+  const int head_dim_;
+  const T scale_;
+  const float dropout_prob_;
+  const int seed_;
+};
+
+// out = x * w + bias, x is [rows, in], w is [in, out].
+template <typename T>
+void AttentionLinear(const math::BlasT<platform::CPUDeviceContext, T>& blas,
+                     const T* x, const T* w, const T* bias, int rows,
+                     int in_size, int out_size, T* out) {
+  blas.MatMul(rows, out_size, in_size, x, w, out);
+  for (int i = 0; i < rows; ++i) {
+    blas.AXPY(out_size, static_cast<T>(1), bias, out + i * out_size);
+  }
+}
+
+// The gradients of AttentionLinear, any of them can be null.
+template <typename T>
+void AttentionLinearGrad(
+    const math::BlasT<platform::CPUDeviceContext, T>& blas, const T* x,
+    const T* w, const T* d_out, int rows, int in_size, int out_size, T* d_x,
+    T* d_w, T* d_bias) {
+  if (d_x) {
+    blas.GEMM(false, true, rows, in_size, out_size, static_cast<T>(1), d_out,
+              out_size, w, out_size, static_cast<T>(0), d_x, in_size);
+  }
+  if (d_w) {
+    blas.GEMM(true, false, in_size, out_size, rows, static_cast<T>(1), x,
+              in_size, d_out, out_size, static_cast<T>(0), d_w, out_size);
+  }
+  if (d_bias) {
+    std::fill(d_bias, d_bias + out_size, static_cast<T>(0));
+    for (int i = 0; i < rows; ++i) {
+      blas.AXPY(out_size, static_cast<T>(1), d_out + i * out_size, d_bias);
+    }
+  }
+}
+
+template <typename T>
+class FusedMultiHeadAttentionKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* x = ctx.Input<Tensor>("X");
+    auto* qkv_w = ctx.Input<Tensor>("QKVW");
+    auto* qkv_bias = ctx.Input<Tensor>("QKVBias");
+    auto* out_w = ctx.Input<Tensor>("OutLinearW");
+    auto* out_bias = ctx.Input<Tensor>("OutLinearBias");
+    auto* mask = ctx.Input<Tensor>("Mask");
+    auto* qkv_out = ctx.Output<Tensor>("QKVOut");
+    auto* attn_out = ctx.Output<Tensor>("AttnOut");
+    auto* lse = ctx.Output<Tensor>("SoftmaxLse");
+    auto* seed_out = ctx.Output<Tensor>("Seed");
+    auto* out = ctx.Output<Tensor>("Out");
+
+    const int batch_size = x->dims()[0];
+    const int seq_len = x->dims()[1];
+    const int hidden = x->dims()[2];
+    const int num_heads = ctx.Attr<int>("num_heads");
+    const float dropout_prob =
+        ctx.Attr<bool>("is_test") ? 0.0f : ctx.Attr<float>("dropout_prob");
+    // NOTE: fixed seed should only be used in unittest or for debug.
+    std::random_device rnd;
+    const int seed =
+        ctx.Attr<bool>("fix_seed") ? ctx.Attr<int>("seed") : rnd();
+    seed_out->mutable_data<int>({1}, platform::CPUPlace())[0] = seed;
+
+    auto place = ctx.GetPlace();
+    const T* mask_data = mask ? mask->data<T>() : nullptr;
+    T* qkv_data = qkv_out->mutable_data<T>(place);
+    T* attn_data = attn_out->mutable_data<T>(place);
+    T* lse_data = lse->mutable_data<T>(place);
+
+    auto blas = math::GetBlas<platform::CPUDeviceContext, T>(ctx);
+    const int rows = batch_size * seq_len;
+    AttentionLinear(blas, x->data<T>(), qkv_w->data<T>(),
+                    qkv_bias->data<T>(), rows, hidden, 3 * hidden, qkv_data);
+
+    MultiHeadAttentionBlock<T> attention(blas, seq_len, hidden, num_heads,
+                                         dropout_prob, seed);
+    Tensor probs_t;
+    Tensor factors_t;
+    T* probs =
+        probs_t.mutable_data<T>({seq_len, seq_len}, platform::CPUPlace());
+    T* factors =
+        factors_t.mutable_data<T>({seq_len, seq_len}, platform::CPUPlace());
+    for (int block = 0; block < batch_size * num_heads; ++block) {
+      attention.Softmax(qkv_data, mask_data, block, nullptr,
+                        lse_data + block * seq_len, probs);
+      attention.Factors(mask_data, block, factors);
+      for (int i = 0; i < seq_len * seq_len; ++i) probs[i] *= factors[i];
+      attention.Context(qkv_data, probs, block, attn_data);
+    }
+
+    AttentionLinear(blas, attn_data, out_w->data<T>(), out_bias->data<T>(),
+                    rows, hidden, hidden, out->mutable_data<T>(place));
+  }
+};
+
+template <typename T>
+class FusedMultiHeadAttentionGradKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* x = ctx.Input<Tensor>("X");
+    auto* qkv_w = ctx.Input<Tensor>("QKVW");
+    auto* out_w = ctx.Input<Tensor>("OutLinearW");
+    auto* mask = ctx.Input<Tensor>("Mask");
+    auto* qkv_out = ctx.Input<Tensor>("QKVOut");
+    auto* attn_out = ctx.Input<Tensor>("AttnOut");
+    auto* lse = ctx.Input<Tensor>("SoftmaxLse");
+    auto* seed = ctx.Input<Tensor>("Seed");
+    auto* d_out = ctx.Input<Tensor>(framework::GradVarName("Out"));
+    auto* d_x = ctx.Output<Tensor>(framework::GradVarName("X"));
+    auto* d_qkv_w = ctx.Output<Tensor>(framework::GradVarName("QKVW"));
+    auto* d_qkv_bias = ctx.Output<Tensor>(framework::GradVarName("QKVBias"));
+    auto* d_out_w = ctx.Output<Tensor>(framework::GradVarName("OutLinearW"));
+    auto* d_out_bias =
+        ctx.Output<Tensor>(framework::GradVarName("OutLinearBias"));
+
+    const int batch_size = x->dims()[0];
+    const int seq_len = x->dims()[1];
+    const int hidden = x->dims()[2];
+    const int num_heads = ctx.Attr<int>("num_heads");
+    const float dropout_prob =
+        ctx.Attr<bool>("is_test") ? 0.0f : ctx.Attr<float>("dropout_prob");
+
+    auto place = ctx.GetPlace();
+    auto mutable_data = [&](Tensor* t) -> T* {
+      return t ? t->mutable_data<T>(place) : nullptr;
+    };
+    const T* mask_data = mask ? mask->data<T>() : nullptr;
+    const T* qkv_data = qkv_out->data<T>();
+    const T* lse_data = lse->data<T>();
+
+    auto blas = math::GetBlas<platform::CPUDeviceContext, T>(ctx);
+    const int rows = batch_size * seq_len;
+    Tensor d_attn_t;
+    T* d_attn =
+        d_attn_t.mutable_data<T>({rows, hidden}, platform::CPUPlace());
+    AttentionLinearGrad(blas, attn_out->data<T>(), out_w->data<T>(),
+                        d_out->data<T>(), rows, hidden, hidden, d_attn,
+                        mutable_data(d_out_w), mutable_data(d_out_bias));
+
+    MultiHeadAttentionBlock<T> attention(blas, seq_len, hidden, num_heads,
+                                         dropout_prob, seed->data<int>()[0]);
+    Tensor d_qkv_t;
+    T* d_qkv =
+        d_qkv_t.mutable_data<T>({rows, 3 * hidden}, platform::CPUPlace());
+    Tensor buffer_t;
+    const int numel = seq_len * seq_len;
+    T* probs = buffer_t.mutable_data<T>({4, numel}, platform::CPUPlace());
+    T* factors = probs + numel;
+    T* weights = factors + numel;
+    T* d_weights = weights + numel;
+    for (int block = 0; block < batch_size * num_heads; ++block) {
+      attention.Softmax(qkv_data, mask_data, block,
+                        lse_data + block * seq_len, nullptr, probs);
+      attention.Factors(mask_data, block, factors);
+      attention.Backward(qkv_data, mask_data, probs, factors, d_attn, block,
+                         weights, d_weights, d_qkv);
+    }
+
+    AttentionLinearGrad(blas, x->data<T>(), qkv_w->data<T>(), d_qkv, rows,
+                        hidden, 3 * hidden, mutable_data(d_x),
+                        mutable_data(d_qkv_w), mutable_data(d_qkv_bias));
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,320 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/operators/fused/fusion_group_op.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/operators/jit/kernels.h"
+
+namespace paddle {
+namespace operators {
+
+using LoDTensor = framework::LoDTensor;
+
+void FusionGroupOp::InferShape(framework::InferShapeContext* ctx) const {
+  PADDLE_ENFORCE_GE(ctx->Inputs("Inputs").size(), 1UL,
+                    "Inputs(Inputs) of FusionGroupOp should not be empty.");
+  PADDLE_ENFORCE_GE(ctx->Outputs("Outs").size(), 1UL,
+                    "Outputs(Outs) of FusionGroupOp should not be empty.");
+  auto types = ctx->Attrs().Get<std::vector<std::string>>("op_types");
+  auto args = ctx->Attrs().Get<std::vector<int>>("op_args");
+  PADDLE_ENFORCE_EQ(args.size(), 3 * types.size(),
+                    "Each op of FusionGroupOp should have 3 op_args.");
+  auto out_ids = ctx->Attrs().Get<std::vector<int>>("out_ids");
+  PADDLE_ENFORCE_EQ(out_ids.size(), ctx->Outputs("Outs").size(),
+                    "Each output of FusionGroupOp should have an out_id.");
+
+  auto dims = ctx->GetInputsDim("Inputs");
+  if (ctx->IsRuntime()) {
+    for (size_t i = 1; i < dims.size(); ++i) {
+      PADDLE_ENFORCE_EQ(dims[i], dims[0],
+                        "All the inputs of FusionGroupOp should have the "
+                        "same shape.");
+    }
+  }
+  ctx->SetOutputsDim("Outs",
+                     std::vector<framework::DDim>(out_ids.size(), dims[0]));
+  for (size_t i = 0; i < out_ids.size(); ++i) {
+    ctx->ShareLoD("Inputs", "Outs", 0, i);
+  }
+}
+
+framework::OpKernelType FusionGroupOp::GetExpectedKernelType(
+    const framework::ExecutionContext& ctx) const {
+  return framework::OpKernelType(
+      OperatorWithKernel::IndicateVarDataType(ctx, "Inputs"), ctx.GetPlace());
+}
+
+void FusionGroupOpMaker::Make() {
+  AddInput("Inputs", "(LoDTensors) The inputs of the fused ops.")
+      .AsDuplicable();
+  AddOutput("Outs", "(LoDTensors) The outputs of the fused ops.")
+      .AsDuplicable();
+  AddAttr<std::vector<std::string>>(
+      "op_types",
+      "The fused ops in execution order, one of elementwise_add, "
+      "elementwise_sub, elementwise_mul, elementwise_div, elementwise_max, "
+      "elementwise_min, relu, sigmoid, tanh, exp, gelu and scale.");
+  AddAttr<std::vector<int>>(
+      "op_args",
+      "The variable ids of X, Y and Out of each op, with -1 as the Y of "
+      "unary ops. Ids [0, len(Inputs)) are the inputs.");
+  AddAttr<std::vector<float>>("op_scales",
+                              "The scale of each scale op, unused otherwise.")
+      .SetDefault({});
+  AddAttr<std::vector<float>>("op_biases",
+                              "The bias of each scale op, unused otherwise.")
+      .SetDefault({});
+  AddAttr<std::vector<int>>("out_ids", "The variable id of each of Outs.");
+  AddComment(R"DOC(
+Fusion Group Operator.
+
+Runs a group of elementwise ops on tensors of the same shape, built by
+fusion_group_pass, in a single pass over memory. The elements are processed
+in tiles that stay in the L1 cache: every op of the group runs on a tile
+before the next tile is loaded, so only the inputs and the outputs are read
+and written in memory. Scale computes Out = scale * X + bias.
+)DOC");
+}
+
+namespace {
+
+enum class FusionGroupOpType {
+  kAdd,
+  kSub,
+  kMul,
+  kDiv,
+  kMax,
+  kMin,
+  kRelu,
+  kSigmoid,
+  kTanh,
+  kExp,
+  kGelu,
+  kScale,
+};
+
+FusionGroupOpType ParseFusionGroupOpType(const std::string& type) {
+  static const std::unordered_map<std::string, FusionGroupOpType> types = {
+      {"elementwise_add", FusionGroupOpType::kAdd},
+      {"elementwise_sub", FusionGroupOpType::kSub},
+      {"elementwise_mul", FusionGroupOpType::kMul},
+      {"elementwise_div", FusionGroupOpType::kDiv},
+      {"elementwise_max", FusionGroupOpType::kMax},
+      {"elementwise_min", FusionGroupOpType::kMin},
+      {"relu", FusionGroupOpType::kRelu},
+      {"sigmoid", FusionGroupOpType::kSigmoid},
+      {"tanh", FusionGroupOpType::kTanh},
+      {"exp", FusionGroupOpType::kExp},
+      {"gelu", FusionGroupOpType::kGelu},
+      {"scale", FusionGroupOpType::kScale},
+  };
+  auto it = types.find(type);
+  PADDLE_ENFORCE(it != types.end(), "FusionGroupOp does not support op %s.",
+                 type);
+  return it->second;
+}
+
+template <typename T>
+struct FusionGroupInstruction {
+  FusionGroupOpType type;
+  int x;
+  int y;
+  int out;
+  T scale;
+  T bias;
+  // The jit kernels for a full tile and for the last, partial tile.
+  typename jit::XYZNTuple<T>::func_type binary_func[2];
+  typename jit::XYNTuple<T>::func_type unary_func[2];
+};
+
+template <typename KernelTuple>
+typename KernelTuple::func_type GetJitFunc(int n) {
+  return jit::KernelFuncs<KernelTuple, platform::CPUPlace>::Cache().At(n);
+}
+
+template <typename T>
+void ResolveJitFuncs(FusionGroupInstruction<T>* instr, int i, int n) {
+  instr->binary_func[i] = nullptr;
+  instr->unary_func[i] = nullptr;
+  switch (instr->type) {
+    case FusionGroupOpType::kAdd:
+      instr->binary_func[i] = GetJitFunc<jit::VAddTuple<T>>(n);
+      break;
+    case FusionGroupOpType::kSub:
+      instr->binary_func[i] = GetJitFunc<jit::VSubTuple<T>>(n);
+      break;
+    case FusionGroupOpType::kMul:
+      instr->binary_func[i] = GetJitFunc<jit::VMulTuple<T>>(n);
+      break;
+    case FusionGroupOpType::kRelu:
+      instr->unary_func[i] = GetJitFunc<jit::VReluTuple<T>>(n);
+      break;
+    case FusionGroupOpType::kSigmoid:
+      instr->unary_func[i] = GetJitFunc<jit::VSigmoidTuple<T>>(n);
+      break;
+    case FusionGroupOpType::kTanh:
+      instr->unary_func[i] = GetJitFunc<jit::VTanhTuple<T>>(n);
+      break;
+    case FusionGroupOpType::kExp:
+      instr->unary_func[i] = GetJitFunc<jit::VExpTuple<T>>(n);
+      break;
+    default:
+      break;
+  }
+}
+
+template <typename T>
+void RunInstruction(const FusionGroupInstruction<T>& instr, int i,
+                    const std::vector<T*>& vars, int n) {
+  const T* x = vars[instr.x];
+  const T* y = instr.y >= 0 ? vars[instr.y] : nullptr;
+  T* out = vars[instr.out];
+  if (instr.binary_func[i] != nullptr) {
+    instr.binary_func[i](x, y, out, n);
+    return;
+  }
+  if (instr.unary_func[i] != nullptr) {
+    instr.unary_func[i](x, out, n);
+    return;
+  }
+  switch (instr.type) {
+    case FusionGroupOpType::kDiv:
+      for (int k = 0; k < n; ++k) out[k] = x[k] / y[k];
+      break;
+    case FusionGroupOpType::kMax:
+      for (int k = 0; k < n; ++k) out[k] = x[k] > y[k] ? x[k] : y[k];
+      break;
+    case FusionGroupOpType::kMin:
+      for (int k = 0; k < n; ++k) out[k] = x[k] < y[k] ? x[k] : y[k];
+      break;
+    case FusionGroupOpType::kGelu:
+      // The same erf form as GeluFunctor.
+      for (int k = 0; k < n; ++k) {
+        T cdf = std::erf(x[k] * static_cast<T>(M_SQRT1_2));
+        out[k] = x[k] * static_cast<T>(0.5) * (static_cast<T>(1) + cdf);
+      }
+      break;
+    case FusionGroupOpType::kScale:
+      for (int k = 0; k < n; ++k) out[k] = instr.scale * x[k] + instr.bias;
+      break;
+    default:
+      PADDLE_THROW("Unreachable");
+  }
+}
+
+}  // namespace
+
+template <typename T>
+class FusionGroupKernel : public framework::OpKernel<T> {
+ public:
+  // The number of elements processed by all the ops at a time.
+  static constexpr int kTileSize = 512;
+
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto ins = ctx.MultiInput<LoDTensor>("Inputs");
+    auto outs = ctx.MultiOutput<LoDTensor>("Outs");
+    auto types = ctx.Attr<std::vector<std::string>>("op_types");
+    auto args = ctx.Attr<std::vector<int>>("op_args");
+    auto scales = ctx.Attr<std::vector<float>>("op_scales");
+    auto biases = ctx.Attr<std::vector<float>>("op_biases");
+    auto out_ids = ctx.Attr<std::vector<int>>("out_ids");
+
+    const int num_inputs = static_cast<int>(ins.size());
+    const int64_t numel = ins[0]->numel();
+    for (auto* in : ins) {
+      PADDLE_ENFORCE_EQ(in->numel(), numel,
+                        "All the inputs of FusionGroupOp should have the "
+                        "same number of elements.");
+    }
+    const int num_tiles =
+        static_cast<int>((numel + kTileSize - 1) / kTileSize);
+    const int tail = static_cast<int>(numel - (num_tiles - 1) * kTileSize);
+
+    int num_vars = num_inputs;
+    std::vector<FusionGroupInstruction<T>> program(types.size());
+    for (size_t i = 0; i < types.size(); ++i) {
+      auto& instr = program[i];
+      instr.type = ParseFusionGroupOpType(types[i]);
+      instr.x = args[3 * i];
+      instr.y = args[3 * i + 1];
+      instr.out = args[3 * i + 2];
+      PADDLE_ENFORCE_GE(instr.out, num_inputs,
+                        "The inputs of FusionGroupOp are read-only.");
+      instr.scale = static_cast<T>(i < scales.size() ? scales[i] : 1.0f);
+      instr.bias = static_cast<T>(i < biases.size() ? biases[i] : 0.0f);
+      ResolveJitFuncs(&instr, 0, kTileSize);
+      ResolveJitFuncs(&instr, 1, tail);
+      num_vars = std::max(num_vars, instr.out + 1);
+    }
+
+    std::vector<const T*> in_data(num_inputs);
+    for (int i = 0; i < num_inputs; ++i) in_data[i] = ins[i]->data<T>();
+    // The output each variable is written to, if any.
+    std::vector<T*> out_data(num_vars, nullptr);
+    for (size_t i = 0; i < outs.size(); ++i) {
+      PADDLE_ENFORCE(out_ids[i] >= num_inputs && out_ids[i] < num_vars,
+                     "Invalid out_id %d of FusionGroupOp.", out_ids[i]);
+      out_data[out_ids[i]] = outs[i]->mutable_data<T>(ctx.GetPlace());
+    }
+    if (numel == 0) return;
+
+    auto run_tiles = [&](int64_t first, int64_t last) {
+      std::vector<T> temps(static_cast<size_t>(num_vars) * kTileSize);
+      std::vector<T*> vars(num_vars);
+      for (int64_t tile = first; tile < last; ++tile) {
+        const int64_t offset = tile * kTileSize;
+        const int i = tile == num_tiles - 1 ? 1 : 0;
+        const int n = i == 1 ? tail : kTileSize;
+        for (int v = 0; v < num_vars; ++v) {
+          if (v < num_inputs) {
+            vars[v] = const_cast<T*>(in_data[v]) + offset;
+          } else if (out_data[v] != nullptr) {
+            vars[v] = out_data[v] + offset;
+          } else {
+            vars[v] = temps.data() + v * kTileSize;
+          }
+        }
+        for (auto& instr : program) {
+          RunInstruction(instr, i, vars, n);
+        }
+      }
+    };
+
+    auto* device = ctx.template device_context<platform::CPUDeviceContext>()
+                       .eigen_pool_device(numel * num_vars);
+    if (device == nullptr || num_tiles == 1) {
+      run_tiles(0, num_tiles);
+    } else {
+      const double bytes = (num_inputs + outs.size()) * kTileSize * sizeof(T);
+      device->parallelFor(
+          num_tiles, Eigen::TensorOpCost(bytes, 0, program.size() * kTileSize),
+          [&run_tiles](Eigen::Index first, Eigen::Index last) {
+            run_tiles(first, last);
+          });
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(fusion_group, ops::FusionGroupOp, ops::FusionGroupOpMaker);
+
+REGISTER_OP_CPU_KERNEL(fusion_group, ops::FusionGroupKernel<float>,
+                       ops::FusionGroupKernel<double>);
@@ -0,0 +1,188 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/operators/fused/logits_to_topk_op.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/operators/math/blas.h"
+
+namespace paddle {
+namespace operators {
+
+void LogitsToTopKOp::InferShape(framework::InferShapeContext* ctx) const {
+  PADDLE_ENFORCE(ctx->HasInput("X"),
+                 "Input(X) of LogitsToTopKOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasInput("W"),
+                 "Input(W) of LogitsToTopKOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                 "Output(Out) of LogitsToTopKOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasOutput("Indices"),
+                 "Output(Indices) of LogitsToTopKOp should not be null.");
+
+  auto x_dims = ctx->GetInputDim("X");
+  auto w_dims = ctx->GetInputDim("W");
+  PADDLE_ENFORCE_EQ(w_dims.size(), 2, "Input(W) should be a matrix.");
+  const bool transpose_w = ctx->Attrs().Get<bool>("transpose_w");
+  const int64_t hidden = transpose_w ? w_dims[1] : w_dims[0];
+  const int64_t vocab_size = transpose_w ? w_dims[0] : w_dims[1];
+  if (ctx->IsRuntime() || (hidden > 0 && x_dims[x_dims.size() - 1] > 0)) {
+    PADDLE_ENFORCE_EQ(x_dims[x_dims.size() - 1], hidden,
+                      "The last dimension of Input(X) should be the hidden "
+                      "size of Input(W).");
+  }
+  const int k = ctx->Attrs().Get<int>("k");
+  PADDLE_ENFORCE_GE(k, 1, "Attr(k) should be positive.");
+  if (vocab_size > 0) {
+    PADDLE_ENFORCE_LE(k, vocab_size,
+                      "Attr(k) should not be larger than the vocab size.");
+  }
+
+  x_dims[x_dims.size() - 1] = k;
+  ctx->SetOutputDim("Out", x_dims);
+  ctx->SetOutputDim("Indices", x_dims);
+  ctx->ShareLoD("X", "Out");
+  ctx->ShareLoD("X", "Indices");
+}
+
+framework::OpKernelType LogitsToTopKOp::GetExpectedKernelType(
+    const framework::ExecutionContext& ctx) const {
+  return framework::OpKernelType(
+      OperatorWithKernel::IndicateVarDataType(ctx, "X"), platform::CPUPlace());
+}
+
+void LogitsToTopKOpMaker::Make() {
+  AddInput("X", "(Tensor) The hidden states, [..., hidden_size].");
+  AddInput("W",
+           "(Tensor) The output projection, [vocab_size, hidden_size] (e.g. "
+           "the tied token embedding), or [hidden_size, vocab_size] if "
+           "transpose_w is false.");
+  AddOutput("Out",
+            "(Tensor) [..., k], the log probabilities of the k most likely "
+            "tokens, in descending order.");
+  AddOutput("Indices", "(Tensor<int64>) [..., k], the ids of the tokens.");
+  AddAttr<int>("k", "(int) The number of the selected tokens.");
+  AddAttr<bool>("transpose_w",
+                "(bool, default true) Whether W is [vocab_size, "
+                "hidden_size].")
+      .SetDefault(true);
+  AddAttr<int>("tile_size",
+               "(int, default 2048) The number of the tokens whose logits "
+               "are computed at a time.")
+      .SetDefault(2048);
+  AddComment(R"DOC(
+LogitsToTopK Operator.
+
+Out, Indices = topk(log_softmax(X * W^T), k)
+
+The logits are computed in tiles of tile_size tokens. Every tile updates a
+running log-sum-exp and a top-k heap of each row, so the [rows, vocab_size]
+logits and probabilities are never materialized.
+)DOC");
+}
+
+template <typename T>
+class LogitsToTopKKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* x = ctx.Input<Tensor>("X");
+    auto* w = ctx.Input<Tensor>("W");
+    auto* out = ctx.Output<Tensor>("Out");
+    auto* indices = ctx.Output<Tensor>("Indices");
+    const bool transpose_w = ctx.Attr<bool>("transpose_w");
+    const int k = ctx.Attr<int>("k");
+
+    auto& x_dims = x->dims();
+    const int hidden = x_dims[x_dims.size() - 1];
+    const int rows = x->numel() / hidden;
+    const int vocab_size = transpose_w ? w->dims()[0] : w->dims()[1];
+    const int tile_size = std::min(ctx.Attr<int>("tile_size"), vocab_size);
+    PADDLE_ENFORCE_GT(tile_size, 0, "Attr(tile_size) should be positive.");
+
+    const T* x_data = x->data<T>();
+    const T* w_data = w->data<T>();
+    T* out_data = out->mutable_data<T>(ctx.GetPlace());
+    int64_t* indices_data = indices->mutable_data<int64_t>(ctx.GetPlace());
+
+    Tensor tile;
+    T* tile_data =
+        tile.mutable_data<T>({rows, tile_size}, platform::CPUPlace());
+    std::vector<T> row_max(rows, -std::numeric_limits<T>::infinity());
+    std::vector<T> row_sum(rows, 0);
+    // A min-heap of the k largest (logit, token) of every row.
+    std::vector<std::vector<std::pair<T, int64_t>>> heaps(rows);
+    for (auto& heap : heaps) heap.reserve(k);
+    auto greater = std::greater<std::pair<T, int64_t>>();
+
+    auto blas = math::GetBlas<platform::CPUDeviceContext, T>(ctx);
+    for (int start = 0; start < vocab_size; start += tile_size) {
+      const int n = std::min(tile_size, vocab_size - start);
+      if (transpose_w) {
+        blas.GEMM(false, true, rows, n, hidden, static_cast<T>(1), x_data,
+                  hidden, w_data + start * hidden, hidden, static_cast<T>(0),
+                  tile_data, n);
+      } else {
+        blas.GEMM(false, false, rows, n, hidden, static_cast<T>(1), x_data,
+                  hidden, w_data + start, vocab_size, static_cast<T>(0),
+                  tile_data, n);
+      }
+
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+      for (int i = 0; i < rows; ++i) {
+        const T* logits = tile_data + i * n;
+        const T tile_max = *std::max_element(logits, logits + n);
+        const T new_max = std::max(row_max[i], tile_max);
+        T sum = row_sum[i] * std::exp(row_max[i] - new_max);
+        auto& heap = heaps[i];
+        for (int j = 0; j < n; ++j) {
+          sum += std::exp(logits[j] - new_max);
+          if (heap.size() < static_cast<size_t>(k)) {
+            heap.emplace_back(logits[j], start + j);
+            std::push_heap(heap.begin(), heap.end(), greater);
+          } else if (logits[j] > heap.front().first) {
+            std::pop_heap(heap.begin(), heap.end(), greater);
+            heap.back() = std::make_pair(logits[j], start + j);
+            std::push_heap(heap.begin(), heap.end(), greater);
+          }
+        }
+        row_max[i] = new_max;
+        row_sum[i] = sum;
+      }
+    }
+
+    for (int i = 0; i < rows; ++i) {
+      const T log_sum_exp = row_max[i] + std::log(row_sum[i]);
+      auto& heap = heaps[i];
+      std::sort_heap(heap.begin(), heap.end(), greater);
+      for (int j = 0; j < k; ++j) {
+        out_data[i * k + j] = heap[j].first - log_sum_exp;
+        indices_data[i * k + j] = heap[j].second;
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(logits_to_topk, ops::LogitsToTopKOp,
+                             ops::LogitsToTopKOpMaker);
+REGISTER_OP_CPU_KERNEL(logits_to_topk, ops::LogitsToTopKKernel<float>,
+                       ops::LogitsToTopKKernel<double>);
@@ -375,6 +375,78 @@ void BenchKernelMatMul() {
   }
 }
 
+// The shapes of the fc layers of a transformer decoder step: m is the batch
+// size (or beam width) and (k, n) are the hidden, ffn and vocab sizes.
+std::vector<std::pair<int, int>> DecodeShapes() {
+  return {{512, 512}, {512, 2048}, {2048, 512}, {1024, 4096}, {1024, 8000}};
+}
+
+// The weight-only kernels are compared with the fp32 matmul of the same shape
+template <typename T, typename PlaceType>
+void BenchDecodeMatMul(int m, int n, int k) {
+  Tensor a, b, c;
+  a.Resize({m * k});
+  b.Resize({k * n});
+  c.Resize({m * n});
+  RandomVec<T>(m * k, a.mutable_data<T>(PlaceType()), -2.f, 2.f);
+  RandomVec<T>(k * n, b.mutable_data<T>(PlaceType()), -2.f, 2.f);
+  const jit::matmul_attr_t attr{m, n, k};
+  BenchAllImpls<jit::MatMulTuple<T>, PlaceType>(
+      attr, a.data<T>(), b.data<T>(), c.mutable_data<T>(PlaceType()), &attr);
+}
+
+template <typename KernelTuple, typename PlaceType>
+void BenchKernelMatMulBF16Weight() {
+  using T = typename KernelTuple::data_type;
+  for (int m : {1, 2, 4, 8}) {
+    for (auto& shape : DecodeShapes()) {
+      int k = shape.first;
+      int n = shape.second;
+      BenchDecodeMatMul<T, PlaceType>(m, n, k);
+      Tensor x, y;
+      x.Resize({m * k});
+      y.Resize({m * n});
+      RandomVec<T>(m * k, x.mutable_data<T>(PlaceType()), -2.f, 2.f);
+      std::vector<uint16_t> w(n * k);
+      for (size_t i = 0; i < w.size(); ++i) {
+        w[i] = static_cast<uint16_t>(0x3c00 + i % 0x800);
+      }
+      const jit::matmul_weight_attr_t attr(m, n, k, n);
+      BenchAllImpls<KernelTuple, PlaceType>(attr, x.data<T>(), w.data(),
+                                            y.mutable_data<T>(PlaceType()),
+                                            &attr);
+    }
+  }
+}
+
+template <typename KernelTuple, typename PlaceType>
+void BenchKernelMatMulInt8Weight() {
+  using T = typename KernelTuple::data_type;
+  const int group_size = 64;
+  for (int m : {1, 2, 4, 8}) {
+    for (auto& shape : DecodeShapes()) {
+      int k = shape.first;
+      int n = shape.second;
+      BenchDecodeMatMul<T, PlaceType>(m, n, k);
+      Tensor x, y;
+      x.Resize({m * k});
+      y.Resize({m * n});
+      RandomVec<T>(m * k, x.mutable_data<T>(PlaceType()), -2.f, 2.f);
+      std::vector<int8_t> w(n * k);
+      for (size_t i = 0; i < w.size(); ++i) {
+        w[i] = static_cast<int8_t>(i % 255 - 127);
+      }
+      std::vector<float> scales(n * ((k + group_size - 1) / group_size));
+      RandomVec<float>(scales.size(), scales.data(), 0.01f, 0.1f);
+      const jit::matmul_weight_attr_t attr(m, n, k, n, group_size);
+      BenchAllImpls<KernelTuple, PlaceType>(attr, x.data<T>(), w.data(),
+                                            scales.data(),
+                                            y.mutable_data<T>(PlaceType()),
+                                            &attr);
+    }
+  }
+}
+
 template <typename KernelTuple, typename PlaceType>
 void BenchKernelSoftmax() {
   using T = typename KernelTuple::data_type;
@@ -490,6 +562,7 @@ void BenchKernelVBroadcast() {
 #define BenchKernelVExp BenchKernelXYN
 #define BenchKernelVSigmoid BenchKernelXYN
 #define BenchKernelVTanh BenchKernelXYN
+#define BenchKernelVGelu BenchKernelXYN
 #define BenchKernelVCopy BenchKernelXYN
 
 #define BenchKernelHMax BenchKernelXRN
@@ -526,6 +599,7 @@ BENCH_FP32_CPU(VSquare);
 BENCH_FP32_CPU(VExp);
 BENCH_FP32_CPU(VSigmoid);
 BENCH_FP32_CPU(VTanh);
+BENCH_FP32_CPU(VGelu);
 BENCH_FP32_CPU(VCopy);
 
 // xrn
@@ -547,6 +621,8 @@ BENCH_FP32_CPU(CRFDecoding);
 BENCH_FP32_CPU(SeqPool);
 BENCH_FP32_CPU(EmbSeqPool);
 BENCH_FP32_CPU(MatMul);
+BENCH_FP32_CPU(MatMulBF16Weight);
+BENCH_FP32_CPU(MatMulInt8Weight);
 BENCH_FP32_CPU(Softmax);
 BENCH_FP32_CPU(Sgd);
 BENCH_FP32_CPU(VBroadcast);
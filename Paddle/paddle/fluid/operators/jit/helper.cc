@@ -44,6 +44,7 @@ const char* to_string(KernelType kt) {
     ONE_CASE(kVSquare);
     ONE_CASE(kVSigmoid);
     ONE_CASE(kVTanh);
+    ONE_CASE(kVGelu);
     ONE_CASE(kLSTMCtHt);
     ONE_CASE(kLSTMC1H1);
     ONE_CASE(kGRUH1);
@@ -54,6 +55,8 @@ const char* to_string(KernelType kt) {
     ONE_CASE(kNCHW16CMulNC);
     ONE_CASE(kSeqPool);
     ONE_CASE(kMatMul);
+    ONE_CASE(kMatMulBF16Weight);
+    ONE_CASE(kMatMulInt8Weight);
     ONE_CASE(kHMax);
     ONE_CASE(kHSum);
     ONE_CASE(kStrideASum);
@@ -94,6 +97,8 @@ KernelType to_kerneltype(const std::string& act) {
     return kVSigmoid;
   } else if (lower == "tanh" || lower == "vtanh") {
     return kVTanh;
+  } else if (lower == "gelu" || lower == "vgelu") {
+    return kVGelu;
   }
   PADDLE_THROW("Not support type: %s, or forget to add this case", act);
   return kNone;
@@ -261,6 +261,13 @@ inline std::ostream& operator<<(std::ostream& os, const matmul_attr_t& attr) {
   return os;
 }
 
+inline std::ostream& operator<<(std::ostream& os,
+                                const matmul_weight_attr_t& attr) {
+  os << "M[" << attr.m << "],N[" << attr.n << "],K[" << attr.k << "],ldc["
+     << attr.ldc << "],group_size[" << attr.group_size << "]";
+  return os;
+}
+
 // expose the method to pack matmul weight
 template <typename T>
 void pack_weights(const T* src, T* dst, int n, int k);
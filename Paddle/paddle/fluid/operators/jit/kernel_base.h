@@ -35,6 +35,8 @@ typedef enum {
   kLSTMC1H1,
   kLayerNorm,
   kMatMul,
+  kMatMulBF16Weight,
+  kMatMulInt8Weight,
   kNCHW16CMulNC,
   kSeqPool,
   kSoftmax,
@@ -46,6 +48,7 @@ typedef enum {
   kVBroadcast,
   kVCopy,
   kVExp,
+  kVGelu,
   kVIdentity,
   kVMul,
   kVRelu,
@@ -127,6 +130,7 @@ DECLARE_KERNELTUPLE(XYNTuple, VSquare);
 DECLARE_KERNELTUPLE(XYNTuple, VExp);
 DECLARE_KERNELTUPLE(XYNTuple, VSigmoid);
 DECLARE_KERNELTUPLE(XYNTuple, VTanh);
+DECLARE_KERNELTUPLE(XYNTuple, VGelu);
 DECLARE_KERNELTUPLE(XYNTuple, VCopy);
 
 DECLARE_KERNELTUPLE(XRNTuple, HMax);
@@ -285,6 +289,40 @@ struct MatMulTuple {
   typedef void (*func_type)(const T*, const T*, T*, const matmul_attr_t*);
 };
 
+// y = x * w^T, x is (m, k), y is (m, n) with leading dimension ldc, and w is
+// the weight (n, k) stored in low precision, which is dequantized to float
+// on the fly. The int8 weight has one scale for every group_size elements of
+// a row, so the scales are (n, ceil(k / group_size)).
+typedef struct matmul_weight_attr_s {
+  int m, n, k;
+  int ldc;
+  int group_size;
+  matmul_weight_attr_s() = default;
+  explicit matmul_weight_attr_s(int m_, int n_, int k_, int ldc_,
+                                int group_size_ = 0)
+      : m(m_), n(n_), k(k_), ldc(ldc_), group_size(group_size_) {}
+} matmul_weight_attr_t;
+
+// the weight is bf16, which is the upper 16 bits of a float
+template <typename T>
+struct MatMulBF16WeightTuple {
+  static constexpr KernelType kernel_type = kMatMulBF16Weight;
+  typedef T data_type;
+  typedef matmul_weight_attr_t attr_type;
+  typedef void (*func_type)(const T*, const uint16_t*, T*,
+                            const matmul_weight_attr_t*);
+};
+
+// x, w, scales, y, attr
+template <typename T>
+struct MatMulInt8WeightTuple {
+  static constexpr KernelType kernel_type = kMatMulInt8Weight;
+  typedef T data_type;
+  typedef matmul_weight_attr_t attr_type;
+  typedef void (*func_type)(const T*, const int8_t*, const float*, T*,
+                            const matmul_weight_attr_t*);
+};
+
 template <typename T>
 struct CRFDecodingTuple {
   static constexpr KernelType kernel_type = kCRFDecoding;
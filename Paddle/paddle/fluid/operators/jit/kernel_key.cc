@@ -54,6 +54,12 @@ int64_t JitCodeKey<matmul_attr_t>(const matmul_attr_t& attr) {
   return XXH64(&attr, sizeof(int) * 3, 0);  // m, n, k
 }
 
+template <>
+int64_t JitCodeKey<matmul_weight_attr_t>(const matmul_weight_attr_t& attr) {
+  int keys[5] = {attr.m, attr.n, attr.k, attr.ldc, attr.group_size};
+  return XXH64(keys, sizeof(int) * 5, 0);
+}
+
 template <>
 int64_t JitCodeKey<emb_seq_pool_attr_t>(const emb_seq_pool_attr_t& attr) {
   return attr.table_width;
@@ -0,0 +1,159 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/operators/jit/more/intrinsic/weight_only_matmul.h"
+#include <algorithm>
+#include "paddle/fluid/operators/jit/refer/refer.h"
+#include "paddle/fluid/operators/jit/registry.h"
+#include "paddle/fluid/platform/cpu_info.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace more {
+namespace intrinsic {
+
+// The weight is dequantized to float in registers, 8 elements of K at a time,
+// and every dequantized block is reused by up to kRowBlock rows of x, which
+// covers the whole batch of a decode step.
+static constexpr int kRowBlock = 4;
+
+static inline float HSum(__m256 x) {
+  __m128 sum = _mm_add_ps(_mm256_castps256_ps128(x),
+                          _mm256_extractf128_ps(x, 1));
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+  return _mm_cvtss_f32(sum);
+}
+
+// 8 bf16 to 8 float
+static inline __m256 LoadBF16(const uint16_t* w) {
+  __m128i bits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w));
+  __m128i lo = _mm_slli_epi32(_mm_cvtepu16_epi32(bits), 16);
+  __m128i hi = _mm_slli_epi32(_mm_cvtepu16_epi32(_mm_srli_si128(bits, 8)), 16);
+  return _mm256_castsi256_ps(
+      _mm256_insertf128_si256(_mm256_castsi128_si256(lo), hi, 1));
+}
+
+// 8 int8 to 8 float
+static inline __m256 LoadInt8(const int8_t* w) {
+  __m128i bits = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(w));
+  __m128i lo = _mm_cvtepi8_epi32(bits);
+  __m128i hi = _mm_cvtepi8_epi32(_mm_srli_si128(bits, 4));
+  return _mm256_cvtepi32_ps(
+      _mm256_insertf128_si256(_mm256_castsi128_si256(lo), hi, 1));
+}
+
+void MatMulBF16Weight(const float* x, const uint16_t* w, float* y,
+                      const matmul_weight_attr_t* attr) {
+  const int K = attr->k;
+  const int end = K - K % YMM_FLOAT_BLOCK;
+  for (int m0 = 0; m0 < attr->m; m0 += kRowBlock) {
+    const int rows = std::min(kRowBlock, attr->m - m0);
+    const float* px = x + m0 * K;
+    float* py = y + m0 * attr->ldc;
+    for (int n = 0; n < attr->n; ++n) {
+      const uint16_t* pw = w + n * K;
+      __m256 acc[kRowBlock];
+      for (int r = 0; r < rows; ++r) acc[r] = _mm256_setzero_ps();
+      for (int k = 0; k < end; k += YMM_FLOAT_BLOCK) {
+        __m256 wv = LoadBF16(pw + k);
+        for (int r = 0; r < rows; ++r) {
+          acc[r] = _mm256_add_ps(
+              acc[r], _mm256_mul_ps(_mm256_loadu_ps(px + r * K + k), wv));
+        }
+      }
+      for (int r = 0; r < rows; ++r) {
+        float sum = HSum(acc[r]);
+        for (int k = end; k < K; ++k) {
+          sum += px[r * K + k] * refer::BF16ToFloat(pw[k]);
+        }
+        py[r * attr->ldc + n] = sum;
+      }
+    }
+  }
+}
+
+void MatMulInt8Weight(const float* x, const int8_t* w, const float* scales,
+                      float* y, const matmul_weight_attr_t* attr) {
+  const int K = attr->k;
+  const int group = attr->group_size;
+  const int groups = (K + group - 1) / group;
+  for (int m0 = 0; m0 < attr->m; m0 += kRowBlock) {
+    const int rows = std::min(kRowBlock, attr->m - m0);
+    const float* px = x + m0 * K;
+    float* py = y + m0 * attr->ldc;
+    for (int n = 0; n < attr->n; ++n) {
+      const int8_t* pw = w + n * K;
+      const float* ps = scales + n * groups;
+      __m256 acc[kRowBlock];
+      float tail[kRowBlock];
+      for (int r = 0; r < rows; ++r) {
+        acc[r] = _mm256_setzero_ps();
+        tail[r] = 0.f;
+      }
+      for (int g = 0; g < groups; ++g) {
+        const int begin = g * group;
+        const int len = std::min(group, K - begin);
+        const int end = begin + len - len % YMM_FLOAT_BLOCK;
+        __m256 part[kRowBlock];
+        for (int r = 0; r < rows; ++r) part[r] = _mm256_setzero_ps();
+        for (int k = begin; k < end; k += YMM_FLOAT_BLOCK) {
+          __m256 wv = LoadInt8(pw + k);
+          for (int r = 0; r < rows; ++r) {
+            part[r] = _mm256_add_ps(
+                part[r], _mm256_mul_ps(_mm256_loadu_ps(px + r * K + k), wv));
+          }
+        }
+        __m256 scale = _mm256_set1_ps(ps[g]);
+        for (int r = 0; r < rows; ++r) {
+          acc[r] = _mm256_add_ps(acc[r], _mm256_mul_ps(part[r], scale));
+          // only the last group may have a tail
+          float rest = 0.f;
+          for (int k = end; k < begin + len; ++k) {
+            rest += px[r * K + k] * static_cast<float>(pw[k]);
+          }
+          tail[r] += rest * ps[g];
+        }
+      }
+      for (int r = 0; r < rows; ++r) {
+        py[r * attr->ldc + n] = HSum(acc[r]) + tail[r];
+      }
+    }
+  }
+}
+
+bool MatMulBF16WeightKernel::CanBeUsed(
+    const matmul_weight_attr_t& attr) const {
+  return platform::MayIUse(platform::avx) && attr.k >= YMM_FLOAT_BLOCK;
+}
+
+bool MatMulInt8WeightKernel::CanBeUsed(
+    const matmul_weight_attr_t& attr) const {
+  return platform::MayIUse(platform::avx) && attr.k >= YMM_FLOAT_BLOCK &&
+         attr.group_size % YMM_FLOAT_BLOCK == 0;
+}
+
+}  // namespace intrinsic
+}  // namespace more
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
+
+namespace intrinsic = paddle::operators::jit::more::intrinsic;
+
+REGISTER_JITKERNEL_MORE(kMatMulBF16Weight, intrinsic,
+                        intrinsic::MatMulBF16WeightKernel);
+REGISTER_JITKERNEL_MORE(kMatMulInt8Weight, intrinsic,
+                        intrinsic::MatMulInt8WeightKernel);
@@ -0,0 +1,54 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include "paddle/fluid/operators/jit/kernel_base.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace more {
+namespace intrinsic {
+
+void MatMulBF16Weight(const float* x, const uint16_t* w, float* y,
+                      const matmul_weight_attr_t* attr);
+
+void MatMulInt8Weight(const float* x, const int8_t* w, const float* scales,
+                      float* y, const matmul_weight_attr_t* attr);
+
+class MatMulBF16WeightKernel
+    : public KernelMore<MatMulBF16WeightTuple<float>> {
+ public:
+  MatMulBF16WeightKernel() { this->func = MatMulBF16Weight; }
+  bool CanBeUsed(const typename MatMulBF16WeightTuple<float>::attr_type&)
+      const override;
+  const char* ImplType() const override { return "Intrinsic"; }
+};
+
+class MatMulInt8WeightKernel
+    : public KernelMore<MatMulInt8WeightTuple<float>> {
+ public:
+  MatMulInt8WeightKernel() { this->func = MatMulInt8Weight; }
+  bool CanBeUsed(const typename MatMulInt8WeightTuple<float>::attr_type&)
+      const override;
+  const char* ImplType() const override { return "Intrinsic"; }
+};
+
+}  // namespace intrinsic
+}  // namespace more
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
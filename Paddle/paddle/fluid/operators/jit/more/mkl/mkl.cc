@@ -108,6 +108,29 @@ void VExp<double>(const double* x, double* y, int n) {
   platform::dynload::vdExp(n, x, y);
 }
 
+// y = 0.5 * x * (1 + erf(x / sqrt(2))), the erf of VML is accurate to 1 ulp.
+template <>
+void VGelu<float>(const float* x, float* y, int n) {
+  for (int i = 0; i < n; ++i) {
+    y[i] = x[i] * static_cast<float>(M_SQRT1_2);
+  }
+  platform::dynload::vmsErf(n, y, y, VML_HA);
+  for (int i = 0; i < n; ++i) {
+    y[i] = 0.5f * x[i] * (1.f + y[i]);
+  }
+}
+
+template <>
+void VGelu<double>(const double* x, double* y, int n) {
+  for (int i = 0; i < n; ++i) {
+    y[i] = x[i] * M_SQRT1_2;
+  }
+  platform::dynload::vmdErf(n, y, y, VML_HA);
+  for (int i = 0; i < n; ++i) {
+    y[i] = 0.5 * x[i] * (1. + y[i]);
+  }
+}
+
 template <>
 void VSquare<float>(const float* x, float* y, int n) {
   platform::dynload::vsSqr(n, x, y);
@@ -214,6 +237,11 @@ bool VTanhKernel<float>::CanBeUsed(const int& d) const {
   return d > 7;
 }
 
+template <>
+bool VGeluKernel<float>::CanBeUsed(const int& d) const {
+  return d > 7;
+}
+
 template <>
 bool SeqPoolKernel<float>::CanBeUsed(const seq_pool_attr_t& attr) const {
   return true;
@@ -274,6 +302,7 @@ AWALYS_USE_ME_WITH_DOUBLE(StrideScal);
 AWALYS_USE_ME_WITH_DOUBLE(VExp);
 AWALYS_USE_ME_WITH_DOUBLE(VSigmoid);
 AWALYS_USE_ME_WITH_DOUBLE(VTanh);
+AWALYS_USE_ME_WITH_DOUBLE(VGelu);
 AWALYS_USE_ME_WITH_DOUBLE(VSquare);
 AWALYS_USE_ME_WITH_DOUBLE(VCopy);
 AWALYS_USE_ME_WITH_DOUBLE(Softmax);
@@ -302,6 +331,7 @@ REGISTER_MKL_KERNEL(VCopy);
 REGISTER_MKL_KERNEL(VBroadcast);
 REGISTER_MKL_KERNEL(VSigmoid);
 REGISTER_MKL_KERNEL(VTanh);
+REGISTER_MKL_KERNEL(VGelu);
 REGISTER_MKL_KERNEL(SeqPool);
 REGISTER_MKL_KERNEL(EmbSeqPool);
 REGISTER_MKL_KERNEL(Softmax);
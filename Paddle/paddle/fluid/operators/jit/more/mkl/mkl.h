@@ -41,6 +41,9 @@ void VScal(const T* a, const T* x, T* y, int n);
 template <typename T>
 void VExp(const T* x, T* y, int n);
 
+template <typename T>
+void VGelu(const T* x, T* y, int n);
+
 template <typename T>
 void VSquare(const T* x, T* y, int n);
 
@@ -214,6 +217,7 @@ DECLARE_MKL_KERNEL(StrideScal);
 DECLARE_MKL_KERNEL(VExp);
 DECLARE_MKL_KERNEL(VSigmoid);
 DECLARE_MKL_KERNEL(VTanh);
+DECLARE_MKL_KERNEL(VGelu);
 DECLARE_MKL_KERNEL(VSquare);
 DECLARE_MKL_KERNEL(VCopy);
 
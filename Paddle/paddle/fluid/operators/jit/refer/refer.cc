@@ -37,6 +37,7 @@ REGISTER_REFER_KERNEL(VSquare);
 REGISTER_REFER_KERNEL(VExp);
 REGISTER_REFER_KERNEL(VSigmoid);
 REGISTER_REFER_KERNEL(VTanh);
+REGISTER_REFER_KERNEL(VGelu);
 
 REGISTER_REFER_KERNEL(LSTMCtHt);
 REGISTER_REFER_KERNEL(LSTMC1H1);
@@ -50,6 +51,8 @@ REGISTER_REFER_KERNEL(LayerNorm);
 REGISTER_REFER_KERNEL(NCHW16CMulNC);
 REGISTER_REFER_KERNEL(SeqPool);
 REGISTER_REFER_KERNEL(MatMul);
+REGISTER_REFER_KERNEL(MatMulBF16Weight);
+REGISTER_REFER_KERNEL(MatMulInt8Weight);
 REGISTER_REFER_KERNEL(HMax);
 REGISTER_REFER_KERNEL(HSum);
 REGISTER_REFER_KERNEL(StrideASum);
@@ -14,7 +14,9 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <limits>
 #include <string>
 #include "paddle/fluid/operators/jit/helper.h"
@@ -135,6 +137,15 @@ void VTanh(const T* x, T* y, int n) {
   }
 }
 
+template <typename T>
+void VGelu(const T* x, T* y, int n) {
+  // y = 0.5 * x * (1 + erf(x / sqrt(2)))
+  for (int i = 0; i < n; ++i) {
+    y[i] = static_cast<T>(0.5) * x[i] *
+           (static_cast<T>(1) + std::erf(x[i] * static_cast<T>(M_SQRT1_2)));
+  }
+}
+
 template <typename T>
 void (*getActFunc(KernelType type))(const T*, T*, int) {  // NOLINT
   if (type == kVSigmoid) {
@@ -395,6 +406,58 @@ void MatMul(const T* A, const T* B, T* C, const matmul_attr_t* attr) {
   }
 }
 
+inline float BF16ToFloat(uint16_t x) {
+  uint32_t bits = static_cast<uint32_t>(x) << 16;
+  float res;
+  std::memcpy(&res, &bits, sizeof(res));
+  return res;
+}
+
+// X(M,K) * W(N,K)^T = Y(M,N), W is bf16
+template <typename T>
+void MatMulBF16Weight(const T* x, const uint16_t* w, T* y,
+                      const matmul_weight_attr_t* attr) {
+  for (int m = 0; m < attr->m; ++m) {
+    const T* px = x + m * attr->k;
+    T* py = y + m * attr->ldc;
+    for (int n = 0; n < attr->n; ++n) {
+      const uint16_t* pw = w + n * attr->k;
+      T sum = static_cast<T>(0);
+      for (int k = 0; k < attr->k; ++k) {
+        sum += px[k] * static_cast<T>(BF16ToFloat(pw[k]));
+      }
+      py[n] = sum;
+    }
+  }
+}
+
+// X(M,K) * W(N,K)^T = Y(M,N), W is int8 with one scale per group of a row
+template <typename T>
+void MatMulInt8Weight(const T* x, const int8_t* w, const float* scales, T* y,
+                      const matmul_weight_attr_t* attr) {
+  int K = attr->k;
+  int group = attr->group_size;
+  int groups = (K + group - 1) / group;
+  for (int m = 0; m < attr->m; ++m) {
+    const T* px = x + m * K;
+    T* py = y + m * attr->ldc;
+    for (int n = 0; n < attr->n; ++n) {
+      const int8_t* pw = w + n * K;
+      const float* ps = scales + n * groups;
+      T sum = static_cast<T>(0);
+      for (int g = 0; g < groups; ++g) {
+        int end = std::min(K, (g + 1) * group);
+        T part = static_cast<T>(0);
+        for (int k = g * group; k < end; ++k) {
+          part += px[k] * static_cast<T>(pw[k]);
+        }
+        sum += part * static_cast<T>(ps[g]);
+      }
+      py[n] = sum;
+    }
+  }
+}
+
 template <typename T>
 void HMax(const T* x, T* res, int n) {
   res[0] = x[0];
@@ -544,6 +607,7 @@ DECLARE_REFER_KERNEL(VIdentity);
 DECLARE_REFER_KERNEL(VExp);
 DECLARE_REFER_KERNEL(VSigmoid);
 DECLARE_REFER_KERNEL(VTanh);
+DECLARE_REFER_KERNEL(VGelu);
 DECLARE_REFER_KERNEL(VSquare);
 DECLARE_REFER_KERNEL(VCopy);
 
@@ -570,6 +634,9 @@ DECLARE_REFER_KERNEL(MatMul);
 DECLARE_REFER_KERNEL(Softmax);
 DECLARE_REFER_KERNEL(EmbSeqPool);
 DECLARE_REFER_KERNEL(Sgd);
+
+DECLARE_REFER_KERNEL(MatMulBF16Weight);
+DECLARE_REFER_KERNEL(MatMulInt8Weight);
 DECLARE_REFER_KERNEL(VBroadcast);
 
 #undef DECLARE_REFER_KERNEL
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <random>
 #include <string>
@@ -717,6 +718,97 @@ void TestKernelMatMul() {
   FLAGS_acc = last_acc;
 }
 
+template <typename KernelTuple, typename PlaceType>
+void TestKernelMatMulBF16Weight() {
+  using T = typename KernelTuple::data_type;
+  VLOG(10) << "Test JITKernel: " << jit::to_string(KernelTuple::kernel_type);
+  auto last_acc = FLAGS_acc;
+  FLAGS_acc = 1e-3;
+  for (int m : {1, 2, 3, 4, 5}) {
+    for (int n : {1, 2, 3, 7}) {
+      for (int k : TestSizes()) {
+        auto ref = jit::GetReferFunc<KernelTuple>();
+        EXPECT_TRUE(ref != nullptr);
+        // the output has a larger leading dimension than n
+        const int ldc = n + 1;
+        std::vector<T> x(m * k), y(m * ldc, static_cast<T>(0));
+        std::vector<float> wf(n * k);
+        std::vector<uint16_t> w(n * k);
+        RandomVec<T>(m * k, x.data());
+        RandomVec<float>(n * k, wf.data());
+        for (int i = 0; i < n * k; ++i) {
+          uint32_t bits;
+          std::memcpy(&bits, &wf[i], sizeof(bits));
+          w[i] = static_cast<uint16_t>(bits >> 16);
+        }
+        const jit::matmul_weight_attr_t attr(m, n, k, ldc);
+        ref(x.data(), w.data(), y.data(), &attr);
+        auto verifier = [](const typename KernelTuple::func_type tgt,
+                           const std::vector<T>& x,
+                           const std::vector<uint16_t>& w,
+                           const std::vector<T>& yref,
+                           const typename KernelTuple::attr_type& attr) {
+          EXPECT_TRUE(tgt != nullptr);
+          EXPECT_EQ(x.size(), static_cast<size_t>(attr.m * attr.k));
+          EXPECT_EQ(w.size(), static_cast<size_t>(attr.n * attr.k));
+          std::vector<T> y(yref.size(), static_cast<T>(0));
+          tgt(x.data(), w.data(), y.data(), &attr);
+          ExpectEQ<T>(y.data(), yref.data(), y.size());
+        };
+        TestAllImpls<KernelTuple, PlaceType>(attr, verifier, x, w, y, attr);
+      }
+    }
+  }
+  FLAGS_acc = last_acc;
+}
+
+template <typename KernelTuple, typename PlaceType>
+void TestKernelMatMulInt8Weight() {
+  using T = typename KernelTuple::data_type;
+  VLOG(10) << "Test JITKernel: " << jit::to_string(KernelTuple::kernel_type);
+  auto last_acc = FLAGS_acc;
+  FLAGS_acc = 1e-3;
+  for (int m : {1, 2, 3, 4, 5}) {
+    for (int n : {1, 2, 3, 7}) {
+      for (int k : TestSizes()) {
+        for (int group_size : {8, 16, 64}) {
+          auto ref = jit::GetReferFunc<KernelTuple>();
+          EXPECT_TRUE(ref != nullptr);
+          const int ldc = n + 1;
+          const int groups = (k + group_size - 1) / group_size;
+          std::vector<T> x(m * k), y(m * ldc, static_cast<T>(0));
+          std::vector<float> wf(n * k), scales(n * groups);
+          std::vector<int8_t> w(n * k);
+          RandomVec<T>(m * k, x.data());
+          RandomVec<float>(n * k, wf.data(), -8.f, 8.f);
+          RandomVec<float>(n * groups, scales.data(), 0.01f, 0.1f);
+          for (int i = 0; i < n * k; ++i) {
+            w[i] = static_cast<int8_t>(wf[i]);
+          }
+          const jit::matmul_weight_attr_t attr(m, n, k, ldc, group_size);
+          ref(x.data(), w.data(), scales.data(), y.data(), &attr);
+          auto verifier = [](const typename KernelTuple::func_type tgt,
+                             const std::vector<T>& x,
+                             const std::vector<int8_t>& w,
+                             const std::vector<float>& scales,
+                             const std::vector<T>& yref,
+                             const typename KernelTuple::attr_type& attr) {
+            EXPECT_TRUE(tgt != nullptr);
+            EXPECT_EQ(x.size(), static_cast<size_t>(attr.m * attr.k));
+            EXPECT_EQ(w.size(), static_cast<size_t>(attr.n * attr.k));
+            std::vector<T> y(yref.size(), static_cast<T>(0));
+            tgt(x.data(), w.data(), scales.data(), y.data(), &attr);
+            ExpectEQ<T>(y.data(), yref.data(), y.size());
+          };
+          TestAllImpls<KernelTuple, PlaceType>(attr, verifier, x, w, scales,
+                                               y, attr);
+        }
+      }
+    }
+  }
+  FLAGS_acc = last_acc;
+}
+
 template <typename KernelTuple, typename PlaceType>
 void TestKernelSoftmax() {
   using T = typename KernelTuple::data_type;
@@ -1154,6 +1246,7 @@ TEST(JITKernel_helper, attr) {
   EXPECT_EQ(jit::to_kerneltype("VEXP"), jit::kVExp);
   EXPECT_EQ(jit::to_kerneltype("SigmoiD"), jit::kVSigmoid);
   EXPECT_EQ(jit::to_kerneltype("VTanh"), jit::kVTanh);
+  EXPECT_EQ(jit::to_kerneltype("gelu"), jit::kVGelu);
 
   out.str("");
   out << jit::lstm_attr_t(8, jit::kVIdentity, jit::kVSigmoid, jit::kVTanh);
@@ -1178,6 +1271,10 @@ TEST(JITKernel_helper, attr) {
   out.str("");
   out << jit::matmul_attr_t(1, 2, 3);
   EXPECT_EQ(out.str().size(), 14);
+
+  out.str("");
+  out << jit::matmul_weight_attr_t(1, 2, 3, 2, 4);
+  EXPECT_EQ(out.str().size(), 35);
 }
 
 // test keys
@@ -1268,6 +1365,23 @@ TEST(JITKernel_key, matmul) {
   EXPECT_TRUE(key3 != key4);
 }
 
+TEST(JITKernel_key, matmul_weight) {
+  jit::matmul_weight_attr_t attr1(1, 2, 8, 2, 8);
+  jit::matmul_weight_attr_t attr2(1, 2, 8, 2, 8);
+  jit::matmul_weight_attr_t attr3(1, 2, 8, 3, 8);
+  jit::matmul_weight_attr_t attr4(1, 2, 8, 2, 16);
+
+  auto key1 = jit::JitCodeKey<jit::matmul_weight_attr_t>(attr1);
+  auto key2 = jit::JitCodeKey<jit::matmul_weight_attr_t>(attr2);
+  auto key3 = jit::JitCodeKey<jit::matmul_weight_attr_t>(attr3);
+  auto key4 = jit::JitCodeKey<jit::matmul_weight_attr_t>(attr4);
+
+  EXPECT_TRUE(key1 == key2);
+  EXPECT_TRUE(key2 != key3);
+  EXPECT_TRUE(key2 != key4);
+  EXPECT_TRUE(key3 != key4);
+}
+
 TEST(JITKernel_key, emb_seq_pool) {
   jit::emb_seq_pool_attr_t attr1(1, 2, 3, 4, 5, jit::SeqPoolType::kSum);
   jit::emb_seq_pool_attr_t attr2(1, 2, 3, 4, 5, jit::SeqPoolType::kSum);
@@ -1323,6 +1437,7 @@ TEST(JITKernel_key, sgd) {
 #define TestKernelVExp TestKernelXYN
 #define TestKernelVSigmoid TestKernelXYN
 #define TestKernelVTanh TestKernelXYN
+#define TestKernelVGelu TestKernelXYN
 #define TestKernelVCopy TestKernelXYN
 
 #define TestKernelHMax TestKernelXRN
@@ -1355,6 +1470,7 @@ TEST_CPU_KERNEL(VSquare);
 TEST_CPU_KERNEL(VExp);
 TEST_CPU_KERNEL(VSigmoid);
 TEST_CPU_KERNEL(VTanh);
+TEST_CPU_KERNEL(VGelu);
 TEST_CPU_KERNEL(VCopy);
 
 TEST_CPU_KERNEL(HMax);
@@ -1374,6 +1490,8 @@ TEST_CPU_KERNEL(CRFDecoding);
 TEST_CPU_KERNEL(SeqPool);
 TEST_CPU_KERNEL(EmbSeqPool);
 TEST_CPU_KERNEL(MatMul);
+TEST_CPU_KERNEL(MatMulBF16Weight);
+TEST_CPU_KERNEL(MatMulInt8Weight);
 TEST_CPU_KERNEL(Softmax);
 TEST_CPU_KERNEL(Sgd);
 TEST_CPU_KERNEL(VBroadcast);
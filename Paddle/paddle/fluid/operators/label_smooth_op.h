@@ -16,24 +16,19 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/platform/device_context.h"
 
 namespace paddle {
 namespace operators {
 
-template <typename DeviceContext, typename T>
-class LabelSmoothKernel : public framework::OpKernel<T> {
- public:
-  void Compute(const framework::ExecutionContext& ctx) const {
-    auto* out_t = ctx.Output<framework::LoDTensor>("Out");
-    auto* in_t = ctx.Input<framework::LoDTensor>("X");
-    auto* dist_t = ctx.Input<framework::Tensor>("PriorDist");
-    auto label_dim = in_t->dims()[1];
-    out_t->mutable_data<T>(ctx.GetPlace());
-
-    auto epsilon = ctx.Attr<float>("epsilon");
+template <typename T>
+struct LabelSmoothFunctor {
+  template <typename EigenDevice>
+  void operator()(const EigenDevice& dev, const framework::Tensor* in_t,
+                  const framework::Tensor* dist_t, float epsilon,
+                  int64_t label_dim, framework::Tensor* out_t) const {
     auto out = framework::EigenVector<T>::Flatten(*out_t);
     auto in = framework::EigenVector<T>::Flatten(*in_t);
-    auto& dev = *ctx.template device_context<DeviceContext>().eigen_device();
     if (dist_t) {
       auto dist = framework::EigenVector<T>::Flatten(*dist_t);
       out.device(dev) =
@@ -47,6 +42,35 @@ class LabelSmoothKernel : public framework::OpKernel<T> {
   }
 };
 
+template <typename T>
+struct LabelSmoothGradFunctor {
+  template <typename EigenDevice>
+  void operator()(const EigenDevice& dev, const framework::Tensor* d_out_t,
+                  float epsilon, framework::Tensor* d_in_t) const {
+    auto d_out = framework::EigenVector<T>::Flatten(*d_out_t);
+    auto d_in = framework::EigenVector<T>::Flatten(*d_in_t);
+    d_in.device(dev) = static_cast<T>(1 - epsilon) * d_out;
+  }
+};
+
+template <typename DeviceContext, typename T>
+class LabelSmoothKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const {
+    auto* out_t = ctx.Output<framework::LoDTensor>("Out");
+    auto* in_t = ctx.Input<framework::LoDTensor>("X");
+    auto* dist_t = ctx.Input<framework::Tensor>("PriorDist");
+    auto label_dim = in_t->dims()[1];
+    out_t->mutable_data<T>(ctx.GetPlace());
+
+    auto epsilon = ctx.Attr<float>("epsilon");
+    LabelSmoothFunctor<T> functor;
+    platform::EigenDeviceRun(ctx.template device_context<DeviceContext>(),
+                             in_t->numel(), &functor, in_t, dist_t, epsilon,
+                             static_cast<int64_t>(label_dim), out_t);
+  }
+};
+
 template <typename DeviceContext, typename T>
 class LabelSmoothGradKernel : public framework::OpKernel<T> {
  public:
@@ -55,12 +79,11 @@ class LabelSmoothGradKernel : public framework::OpKernel<T> {
     auto* d_in_t = ctx.Output<framework::Tensor>(framework::GradVarName("X"));
     d_in_t->mutable_data<T>(ctx.GetPlace());
 
-    auto d_out = framework::EigenVector<T>::Flatten(*d_out_t);
-    auto d_in = framework::EigenVector<T>::Flatten(*d_in_t);
-
     auto epsilon = ctx.Attr<float>("epsilon");
-    auto& dev = *ctx.template device_context<DeviceContext>().eigen_device();
-    d_in.device(dev) = static_cast<T>(1 - epsilon) * d_out;
+    LabelSmoothGradFunctor<T> functor;
+    platform::EigenDeviceRun(ctx.template device_context<DeviceContext>(),
+                             d_out_t->numel(), &functor, d_out_t, epsilon,
+                             d_in_t);
   }
 };
 }  // namespace operators
@@ -69,7 +69,31 @@ class RowwiseMean2D<platform::CPUDeviceContext, T> {
 
   void operator()(const platform::CPUDeviceContext& context,
                   const framework::Tensor& input, framework::Tensor* out) {
-    row_mean_(context, input, out);
+    auto* device = context.eigen_pool_device(input.numel());
+    if (device == nullptr) {
+      row_mean_(context, input, out);
+      return;
+    }
+    // The rows are spread over the intra-op thread pool.
+    auto& in_dims = input.dims();
+    PADDLE_ENFORCE_EQ(in_dims.size(), 2U);
+    const int64_t height = in_dims[0];
+    const int64_t size = in_dims[1];
+    PADDLE_ENFORCE_EQ(out->numel(), height);
+    const T inv_size = static_cast<T>(1.0 / size);
+    T* out_buf = out->mutable_data<T>(out->place());
+    const T* in_buf = input.data<T>();
+    device->parallelFor(
+        height, Eigen::TensorOpCost(size * sizeof(T), sizeof(T), size),
+        [=](Eigen::Index first, Eigen::Index last) {
+          for (Eigen::Index i = first; i < last; ++i) {
+            T sum = 0;
+            for (int64_t j = 0; j < size; ++j) {
+              sum += in_buf[i * size + j];
+            }
+            out_buf[i] = sum * inv_size;
+          }
+        });
   }
 
  private:
@@ -165,19 +189,29 @@ using Tensor = framework::Tensor;
 using LoDTensor = framework::LoDTensor;
 using DataLayout = framework::DataLayout;
 
+// The slots of LayerNormOpMaker read by LayerNormKernel.
+constexpr framework::OpSlot kLayerNormX{0, "X"};
+constexpr framework::OpSlot kLayerNormScale{1, "Scale"};
+constexpr framework::OpSlot kLayerNormBias{2, "Bias"};
+constexpr framework::OpSlot kLayerNormY{0, "Y"};
+constexpr framework::OpSlot kLayerNormMean{1, "Mean"};
+constexpr framework::OpSlot kLayerNormVariance{2, "Variance"};
+constexpr framework::OpSlot kLayerNormEpsilon{0, "epsilon"};
+constexpr framework::OpSlot kLayerNormBeginNormAxis{1, "begin_norm_axis"};
+
 template <typename DeviceContext, typename T>
 class LayerNormKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext& ctx) const override {
-    const float epsilon = ctx.Attr<float>("epsilon");
-    auto* scale = ctx.Input<Tensor>("Scale");
-    auto* bias = ctx.Input<Tensor>("Bias");
-    auto x = *ctx.Input<Tensor>("X");
-
-    auto* y = ctx.Output<Tensor>("Y");
-    auto* mean = ctx.Output<Tensor>("Mean");
-    auto* var = ctx.Output<Tensor>("Variance");
-    const auto begin_norm_axis = ctx.Attr<int>("begin_norm_axis");
+    const float epsilon = ctx.Attr<float>(kLayerNormEpsilon);
+    auto* scale = ctx.Input<Tensor>(kLayerNormScale);
+    auto* bias = ctx.Input<Tensor>(kLayerNormBias);
+    auto x = *ctx.Input<Tensor>(kLayerNormX);
+
+    auto* y = ctx.Output<Tensor>(kLayerNormY);
+    auto* mean = ctx.Output<Tensor>(kLayerNormMean);
+    auto* var = ctx.Output<Tensor>(kLayerNormVariance);
+    const auto begin_norm_axis = ctx.Attr<int>(kLayerNormBeginNormAxis);
 
     const auto x_dims = x.dims();
 
@@ -19,6 +19,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/cpu_vec.h"
 #include "paddle/fluid/platform/cpu_info.h"
+#include "paddle/fluid/platform/device_context.h"
 
 namespace paddle {
 namespace operators {
@@ -36,61 +37,72 @@ struct ValueClip {
   }
 };
 
+template <typename T>
+struct SoftmaxEigenFunctor {
+  template <typename EigenDevice>
+  void operator()(const EigenDevice& device, const int axis_dim,
+                  const framework::Tensor* X, framework::Tensor* Y) const {
+    constexpr int kBatchDim = 0;
+    constexpr int kClassDim = 1;
+    constexpr int kAxisDim = 1;
+
+    auto logits = EigenMatrix<T>::From(*X);
+    auto softmax = EigenMatrix<T>::From(*Y);
+
+    const int batch_size = logits.dimension(kBatchDim);
+    const int num_classes = logits.dimension(kClassDim);
+    const int num_remain = num_classes / axis_dim;
+
+    Eigen::DSizes<int, 1> along_axis(kAxisDim);
+    Eigen::DSizes<int, 2> batch_classes(batch_size, num_classes);
+    Eigen::DSizes<int, 2> batch_by_one(batch_size, 1);
+    Eigen::DSizes<int, 2> one_by_class(1, num_classes);
+    Eigen::DSizes<int, 3> batch_one_remain(batch_size, 1, num_remain);
+    Eigen::DSizes<int, 3> one_axis_one(1, axis_dim, 1);
+    Eigen::DSizes<int, 2> one_axis(1, axis_dim);
+    Eigen::DSizes<int, 3> batch_axis_remain(batch_size, axis_dim, num_remain);
+
+    // For numerical stability, logits should be shifted by maximum number
+    // along axis, calculate shifted_logits into softmax tensor for memory
+    // reuse.
+    if (num_remain == 1) {
+      // axis == -1, axis and class in same dimension, calculate along
+      // class dimension directly for higher performance
+      softmax.device(device) = (logits -
+                                logits.maximum(along_axis)
+                                    .eval()
+                                    .reshape(batch_by_one)
+                                    .broadcast(one_by_class))
+                                   .unaryExpr(ValueClip<T>());
+    } else {
+      // axis != -1, class dimension split into (axis, remain), max and sum
+      // should be calculated along axis dimension
+      softmax.device(device) =
+          (logits.reshape(batch_axis_remain) -
+           logits.reshape(batch_axis_remain)
+               .maximum(along_axis)
+               .eval()
+               .reshape(batch_one_remain)
+               .broadcast(one_axis_one)
+               .reshape(batch_classes))
+              .unaryExpr(ValueClip<T>());
+    }
+
+    softmax.device(device) = softmax.exp();
+    softmax.device(device) = (softmax *
+                              softmax.reshape(batch_axis_remain)
+                                  .sum(along_axis)
+                                  .inverse()
+                                  .eval()
+                                  .broadcast(one_axis));
+  }
+};
+
 template <typename DeviceContext, typename T, bool is_test>
 void SoftmaxEigen(const DeviceContext& context, const int axis_dim,
                   const framework::Tensor* X, framework::Tensor* Y) {
-  constexpr int kBatchDim = 0;
-  constexpr int kClassDim = 1;
-  constexpr int kAxisDim = 1;
-
-  auto logits = EigenMatrix<T>::From(*X);
-  auto softmax = EigenMatrix<T>::From(*Y);
-
-  const int batch_size = logits.dimension(kBatchDim);
-  const int num_classes = logits.dimension(kClassDim);
-  const int num_remain = num_classes / axis_dim;
-
-  Eigen::DSizes<int, 1> along_axis(kAxisDim);
-  Eigen::DSizes<int, 2> batch_classes(batch_size, num_classes);
-  Eigen::DSizes<int, 2> batch_by_one(batch_size, 1);
-  Eigen::DSizes<int, 2> one_by_class(1, num_classes);
-  Eigen::DSizes<int, 3> batch_one_remain(batch_size, 1, num_remain);
-  Eigen::DSizes<int, 3> one_axis_one(1, axis_dim, 1);
-  Eigen::DSizes<int, 2> one_axis(1, axis_dim);
-  Eigen::DSizes<int, 3> batch_axis_remain(batch_size, axis_dim, num_remain);
-
-  // For numerical stability, logits should be shifted by maximum number along
-  // axis, calculate shifted_logits into softmax tensor for memory reuse.
-  if (num_remain == 1) {
-    // axis == -1, axis and class in same dimension, calculate along
-    // class dimension directly for higher performance
-    softmax.device(*context.eigen_device()) = (logits -
-                                               logits.maximum(along_axis)
-                                                   .eval()
-                                                   .reshape(batch_by_one)
-                                                   .broadcast(one_by_class))
-                                                  .unaryExpr(ValueClip<T>());
-  } else {
-    // axis != -1, class dimension split into (axis, remain), max and sum
-    // should be calculated along axis dimension
-    softmax.device(*context.eigen_device()) =
-        (logits.reshape(batch_axis_remain) -
-         logits.reshape(batch_axis_remain)
-             .maximum(along_axis)
-             .eval()
-             .reshape(batch_one_remain)
-             .broadcast(one_axis_one)
-             .reshape(batch_classes))
-            .unaryExpr(ValueClip<T>());
-  }
-
-  softmax.device(*context.eigen_device()) = softmax.exp();
-  softmax.device(*context.eigen_device()) = (softmax *
-                                             softmax.reshape(batch_axis_remain)
-                                                 .sum(along_axis)
-                                                 .inverse()
-                                                 .eval()
-                                                 .broadcast(one_axis));
+  SoftmaxEigenFunctor<T> functor;
+  platform::EigenDeviceRun(context, X->numel(), &functor, axis_dim, X, Y);
 }
 
 template <typename DeviceContext, typename T, bool is_test, typename Enable>
@@ -161,34 +173,46 @@ class SoftmaxFunctor<DeviceContext, float, true, enable_if_CPU<DeviceContext>> {
   }
 };
 
+template <typename T>
+struct SoftmaxGradEigenFunctor {
+  template <typename EigenDevice>
+  void operator()(const EigenDevice& device, const int axis_dim,
+                  const framework::Tensor* y, const framework::Tensor* y_grad,
+                  framework::Tensor* x_grad) const {
+    auto softmax = EigenMatrix<T>::From(*y);
+    auto softmax_grad = EigenMatrix<T>::From(*y_grad);
+    auto logits_grad = EigenMatrix<T>::From(*x_grad);
+
+    constexpr int kBatchDim = 0;
+    constexpr int kClassDim = 1;
+
+    const int batch_size = softmax.dimension(kBatchDim);
+    const int num_classes = softmax.dimension(kClassDim);
+    const int num_remain = num_classes / axis_dim;
+
+    Eigen::DSizes<int, 1> along_class(kClassDim);
+    Eigen::DSizes<int, 2> batch_by_one(batch_size, 1);
+    Eigen::DSizes<int, 2> one_by_class(1, num_classes);
+    Eigen::DSizes<int, 3> batch_axis_remain(batch_size, axis_dim, num_remain);
+    Eigen::DSizes<int, 2> one_axis(1, axis_dim);
+
+    auto dot = (softmax * softmax_grad)
+                   .reshape(batch_axis_remain)
+                   .sum(along_class)
+                   .eval()
+                   .broadcast(one_axis);
+    logits_grad.device(device) = (softmax_grad - dot) * softmax;
+  }
+};
+
 template <typename DeviceContext, typename T>
 void SoftmaxGradEigen(const DeviceContext& context, const int axis_dim,
                       const framework::Tensor* y,
                       const framework::Tensor* y_grad,
                       framework::Tensor* x_grad) {
-  auto softmax = EigenMatrix<T>::From(*y);
-  auto softmax_grad = EigenMatrix<T>::From(*y_grad);
-  auto logits_grad = EigenMatrix<T>::From(*x_grad);
-
-  constexpr int kBatchDim = 0;
-  constexpr int kClassDim = 1;
-
-  const int batch_size = softmax.dimension(kBatchDim);
-  const int num_classes = softmax.dimension(kClassDim);
-  const int num_remain = num_classes / axis_dim;
-
-  Eigen::DSizes<int, 1> along_class(kClassDim);
-  Eigen::DSizes<int, 2> batch_by_one(batch_size, 1);
-  Eigen::DSizes<int, 2> one_by_class(1, num_classes);
-  Eigen::DSizes<int, 3> batch_axis_remain(batch_size, axis_dim, num_remain);
-  Eigen::DSizes<int, 2> one_axis(1, axis_dim);
-
-  auto dot = (softmax * softmax_grad)
-                 .reshape(batch_axis_remain)
-                 .sum(along_class)
-                 .eval()
-                 .broadcast(one_axis);
-  logits_grad.device(*context.eigen_device()) = (softmax_grad - dot) * softmax;
+  SoftmaxGradEigenFunctor<T> functor;
+  platform::EigenDeviceRun(context, y->numel(), &functor, axis_dim, y, y_grad,
+                           x_grad);
 }
 
 template <typename DeviceContext, typename T, typename Enable>
@@ -0,0 +1,148 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/weight_only_fc.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "paddle/fluid/operators/jit/kernels.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The columns of Y computed by one thread
+static constexpr int kBlockN = 64;
+
+uint16_t FloatToBF16(float x) {
+  uint32_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  if (std::isnan(x)) {
+    return static_cast<uint16_t>((bits >> 16) | 0x40);
+  }
+  bits += 0x7fff + ((bits >> 16) & 1);
+  return static_cast<uint16_t>(bits >> 16);
+}
+
+void PackWeightBF16(const float* w, int K, int N, bool trans_w,
+                    uint16_t* packed) {
+  for (int n = 0; n < N; ++n) {
+    for (int k = 0; k < K; ++k) {
+      packed[n * K + k] = FloatToBF16(trans_w ? w[n * K + k] : w[k * N + n]);
+    }
+  }
+}
+
+void PackWeightInt8(const float* w, int K, int N, bool trans_w, int group_size,
+                    int8_t* packed, float* scales) {
+  PADDLE_ENFORCE_GT(group_size, 0, "The group_size should be positive.");
+  const int groups = (K + group_size - 1) / group_size;
+  for (int n = 0; n < N; ++n) {
+    for (int g = 0; g < groups; ++g) {
+      const int begin = g * group_size;
+      const int end = std::min(K, begin + group_size);
+      float max_abs = 0.f;
+      for (int k = begin; k < end; ++k) {
+        float v = trans_w ? w[n * K + k] : w[k * N + n];
+        max_abs = std::max(max_abs, std::fabs(v));
+      }
+      const float scale = max_abs > 0.f ? max_abs / 127.f : 1.f;
+      scales[n * groups + g] = scale;
+      for (int k = begin; k < end; ++k) {
+        float v = trans_w ? w[n * K + k] : w[k * N + n];
+        float q = std::round(v / scale);
+        packed[n * K + k] =
+            static_cast<int8_t>(std::max(-127.f, std::min(127.f, q)));
+      }
+    }
+  }
+}
+
+template <typename T>
+static void AddBias(const int M, const int N, const T* B, T* Y, bool relu) {
+  if (B == nullptr) {
+    return;
+  }
+  if (relu) {
+    auto compute =
+        jit::KernelFuncs<jit::VAddReluTuple<T>, platform::CPUPlace>::Cache()
+            .At(N);
+    for (int i = 0; i < M; i++) {
+      T* dst = Y + i * N;
+      compute(B, dst, dst, N);
+    }
+  } else {
+    auto compute =
+        jit::KernelFuncs<jit::VAddTuple<T>, platform::CPUPlace>::Cache().At(N);
+    for (int i = 0; i < M; i++) {
+      T* dst = Y + i * N;
+      compute(B, dst, dst, N);
+    }
+  }
+}
+
+// In a decode step M is tiny and the weight dominates the memory traffic, so
+// the threads split the columns of Y, i.e. the rows of the packed weight.
+template <typename T>
+class WeightOnlyFCFunctor<platform::CPUDeviceContext, T> {
+ public:
+  void operator()(const platform::CPUDeviceContext& context, const int M,
+                  const int N, const int K, const T* X, const uint16_t* W,
+                  T* Y, const T* B = nullptr, bool relu = false) {
+    jit::matmul_weight_attr_t attr(M, N, K, N);
+    auto compute = jit::KernelFuncs<jit::MatMulBF16WeightTuple<T>,
+                                    platform::CPUPlace>::Cache()
+                       .At(attr);
+    const int blocks = (N + kBlockN - 1) / kBlockN;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int b = 0; b < blocks; ++b) {
+      const int n0 = b * kBlockN;
+      jit::matmul_weight_attr_t block_attr(M, std::min(kBlockN, N - n0), K,
+                                           N);
+      compute(X, W + n0 * K, Y + n0, &block_attr);
+    }
+    AddBias(M, N, B, Y, relu);
+  }
+
+  void operator()(const platform::CPUDeviceContext& context, const int M,
+                  const int N, const int K, const T* X, const int8_t* W,
+                  const float* scales, int group_size, T* Y,
+                  const T* B = nullptr, bool relu = false) {
+    jit::matmul_weight_attr_t attr(M, N, K, N, group_size);
+    auto compute = jit::KernelFuncs<jit::MatMulInt8WeightTuple<T>,
+                                    platform::CPUPlace>::Cache()
+                       .At(attr);
+    const int groups = (K + group_size - 1) / group_size;
+    const int blocks = (N + kBlockN - 1) / kBlockN;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int b = 0; b < blocks; ++b) {
+      const int n0 = b * kBlockN;
+      jit::matmul_weight_attr_t block_attr(M, std::min(kBlockN, N - n0), K, N,
+                                           group_size);
+      compute(X, W + n0 * K, scales + n0 * groups, Y + n0, &block_attr);
+    }
+    AddBias(M, N, B, Y, relu);
+  }
+};
+
+template class WeightOnlyFCFunctor<platform::CPUDeviceContext, float>;
+template class WeightOnlyFCFunctor<platform::CPUDeviceContext, double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
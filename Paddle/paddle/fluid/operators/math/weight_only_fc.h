@@ -0,0 +1,58 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The weight-only fc keeps the weight in low precision and dequantizes it to
+// float in the GEMM kernel, which halves (bf16) or quarters (int8) the memory
+// traffic of the weight. The packed weight is (N, K), i.e. the transpose of
+// the (K, N) fc weight, so that every output reads a contiguous row.
+
+// Rounds to the nearest even bf16
+uint16_t FloatToBF16(float x);
+
+// w is (K, N), or (N, K) if trans_w
+void PackWeightBF16(const float* w, int K, int N, bool trans_w,
+                    uint16_t* packed);
+
+// Quantizes every group_size elements of a row of the packed weight to int8
+// symmetrically with their own scale, scales is (N, ceil(K / group_size)).
+void PackWeightInt8(const float* w, int K, int N, bool trans_w, int group_size,
+                    int8_t* packed, float* scales);
+
+template <typename DeviceContext, typename T>
+class WeightOnlyFCFunctor {
+ public:
+  // Y(M, N) = X(M, K) * W(N, K)^T + B, W is bf16
+  void operator()(const DeviceContext& context, const int M, const int N,
+                  const int K, const T* X, const uint16_t* W, T* Y,
+                  const T* B = nullptr, bool relu = false);
+
+  // Y(M, N) = X(M, K) * W(N, K)^T + B, W is int8 with the group scales
+  void operator()(const DeviceContext& context, const int M, const int N,
+                  const int K, const T* X, const int8_t* W,
+                  const float* scales, int group_size, T* Y,
+                  const T* B = nullptr, bool relu = false);
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
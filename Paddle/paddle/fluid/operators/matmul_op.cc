@@ -18,6 +18,9 @@ limitations under the License. */
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/detail/safe_ref.h"
 #include "paddle/fluid/operators/math/blas.h"
+#ifdef PADDLE_WITH_MKLDNN
+#include "paddle/fluid/platform/mkldnn_helper.h"
+#endif
 
 namespace paddle {
 namespace operators {
@@ -54,26 +57,37 @@ static framework::DDim ColumnMatrixFromVector(const framework::DDim &y_dim) {
   return framework::make_ddim({y_dim[0], 1});
 }
 
+// The slots of MatMulOpMaker read by MatMulKernel.
+constexpr framework::OpSlot kMatMulX{0, "X"};
+constexpr framework::OpSlot kMatMulY{1, "Y"};
+constexpr framework::OpSlot kMatMulOut{0, "Out"};
+constexpr framework::OpSlot kMatMulTransposeX{0, "transpose_X"};
+constexpr framework::OpSlot kMatMulTransposeY{1, "transpose_Y"};
+constexpr framework::OpSlot kMatMulAlpha{2, "alpha"};
+constexpr framework::OpSlot kMatMulHeadNumber{3, "head_number"};
+
 template <typename DeviceContext, typename T>
 class MatMulKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext &context) const override {
-    auto &x =
-        detail::Ref(context.Input<framework::Tensor>("X"), "Cannot find X");
-    auto &y =
-        detail::Ref(context.Input<framework::Tensor>("Y"), "Cannot find Y");
-    auto *out = context.Output<framework::Tensor>("Out");
+    auto &x = detail::Ref(context.Input<framework::Tensor>(kMatMulX),
+                          "Cannot find X");
+    auto &y = detail::Ref(context.Input<framework::Tensor>(kMatMulY),
+                          "Cannot find Y");
+    auto *out = context.Output<framework::Tensor>(kMatMulOut);
     out->mutable_data<T>(context.GetPlace());
 
     auto blas = math::GetBlas<DeviceContext, T>(context);
-    auto mat_dim_a = math::CreateMatrixDescriptor(
-        RowMatrixFromVector(x.dims()), 0, context.Attr<bool>("transpose_X"));
-    auto mat_dim_b = math::CreateMatrixDescriptor(
-        ColumnMatrixFromVector(y.dims()), 0, context.Attr<bool>("transpose_Y"));
-    auto scale = static_cast<T>(context.Attr<float>("alpha"));
+    auto mat_dim_a =
+        math::CreateMatrixDescriptor(RowMatrixFromVector(x.dims()), 0,
+                                     context.Attr<bool>(kMatMulTransposeX));
+    auto mat_dim_b =
+        math::CreateMatrixDescriptor(ColumnMatrixFromVector(y.dims()), 0,
+                                     context.Attr<bool>(kMatMulTransposeY));
+    auto scale = static_cast<T>(context.Attr<float>(kMatMulAlpha));
 
 #if defined(PADDLE_WITH_MKLML) && !defined(PADDLE_WITH_CUDA)
-    int head_number = context.Attr<int>("head_number");
+    int head_number = context.Attr<int>(kMatMulHeadNumber);
     bool split_vertical_y = (mat_dim_a.width_ != mat_dim_b.height_);
 
     if (head_number > 1) {
@@ -383,6 +397,25 @@ class MatMulOp : public framework::OperatorWithKernel {
     context->SetOutputDim("Out", framework::make_ddim(dim_out));
     context->ShareLoD("X", /*->*/ "Out");
   }
+
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext &ctx) const override {
+#ifdef PADDLE_WITH_MKLDNN
+    // Only the quantized matmul has a MKL-DNN kernel. Its X is u8 or s8 and
+    // its Y is s8, so the kernel type follows X.
+    auto x_data_type = OperatorWithKernel::IndicateVarDataType(ctx, "X");
+    bool is_int8 =
+        x_data_type == framework::DataTypeTrait<int8_t>::DataType() ||
+        x_data_type == framework::DataTypeTrait<uint8_t>::DataType();
+    if (is_int8 && platform::CanMKLDNNBeUsed(ctx)) {
+      return framework::OpKernelType(x_data_type, ctx.GetPlace(),
+                                     framework::DataLayout::kMKLDNN,
+                                     framework::LibraryType::kMKLDNN);
+    }
+#endif
+    return framework::OpKernelType(OperatorWithKernel::IndicateDataType(ctx),
+                                   ctx.GetPlace());
+  }
 };
 
 class MatMulOpMaker : public framework::OpProtoAndCheckerMaker {
@@ -404,6 +437,31 @@ class MatMulOpMaker : public framework::OpProtoAndCheckerMaker {
     AddAttr<int>("head_number", "The number of heads of the matrix")
         .SetDefault(1);
 #endif
+    AddAttr<bool>("use_mkldnn",
+                  "(bool, default false) Only used in mkldnn kernel")
+        .SetDefault(false);
+    AddAttr<bool>("use_quantizer",
+                  "(bool, default false) "
+                  "Set to true for operators that should be quantized and use "
+                  "int8 kernel. "
+                  "Only used on CPU.")
+        .SetDefault(false);
+    AddAttr<float>("Scale_x",
+                   "Scale_x to be used for int8 input data X. "
+                   "Only used with MKL-DNN INT8.")
+        .SetDefault(1.0f);
+    AddAttr<float>("Scale_y",
+                   "Scale_y to be used for int8 input data Y. "
+                   "Only used with MKL-DNN INT8.")
+        .SetDefault(1.0f);
+    AddAttr<float>("Scale_out",
+                   "Scale_out to be used for int8 output data. "
+                   "Only used with MKL-DNN INT8.")
+        .SetDefault(1.0f);
+    AddAttr<bool>("force_fp32_output",
+                  "(bool, default false) Force INT8 kernel output FP32, only "
+                  "used in MKL-DNN INT8")
+        .SetDefault(false);
     AddComment(R"DOC(
 MatMul Operator.
 
@@ -75,8 +75,11 @@ class DeQuantOpKernel : public framework::OpKernel<T> {
       std::shared_ptr<primitive::at> src_memory_p =
           std::shared_ptr<primitive::at>(new primitive::at(*src_memory));
 
-      auto dst_md = platform::MKLDNNMemDesc({dst_tz}, memory::data_type::f32,
-                                            MKLDNNMemoryFormat::nchw);
+      // the output of fc, mul or matmul is not 4-D
+      auto dst_fmt = platform::MKLDNNFormatForSize(dst_tz.size(),
+                                                   MKLDNNMemoryFormat::nchw);
+      auto dst_md =
+          platform::MKLDNNMemDesc({dst_tz}, memory::data_type::f32, dst_fmt);
       auto dst_pd = mkldnn::memory::primitive_desc(dst_md, engine);
       dst_memory = std::make_shared<mkldnn::memory>(
           dst_pd, to_void_cast<float>(output_data));
@@ -14,6 +14,9 @@ limitations under the License. */
 
 #include <mkldnn/include/mkldnn_types.h>
 #include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/operators/fc_op.h"
 #include "paddle/fluid/platform/device_context.h"
@@ -37,43 +40,73 @@ using mkldnn::primitive;
 using mkldnn::stream;
 using mkldnn::prop_kind;
 
-template <typename T>
+/* T_in: input data type, T_w: weights data type, T_out: output data type.
+ * The INT8 fc takes u8 or s8 input, quantizes the fp32 weights to s8 and the
+ * bias to s32, and outputs s8, u8 (with relu) or fp32. */
+template <typename T_in, typename T_w, typename T_out>
 class FCPrimitiveFactory {
  public:
   explicit FCPrimitiveFactory(const mkldnn::engine& engine) : engine_(engine) {}
 
-  inner_product_forward CreateFcPrimitive(const LoDTensor* input,
-                                          const Tensor* weights,
-                                          const Tensor* bias, LoDTensor* output,
-                                          const ExecutionContext& ctx) {
+  void ExecuteFcPrimitive(const LoDTensor* input, const Tensor* weights,
+                          const Tensor* bias, LoDTensor* output,
+                          const ExecutionContext& ctx) {
     RecomputeOutputDims(ctx, input, weights, output);
+    // If the primitives have already been created and cached, only the data
+    // pointers of the input and output are updated
     if (fc_) {
       UpdateDataPointers(ctx, output, input);
-      return *fc_;
+    } else {
+      CreateFcPrimitive(input, weights, bias, output, ctx);
     }
-    auto src_desc = CreateMemDescriptor(input, input->format());
-    input_ = CreateMemory(src_desc, input);
 
-    weights_ = TransposeWeights(weights);
-    if (src_desc.data.ndims == 4) {
-      weights_ = CreateFourDimWeightsMemory(input, weights);
+    std::vector<primitive> pipeline;
+    if (input_reorder_) pipeline.push_back(*input_reorder_);
+    pipeline.push_back(*fc_);
+    stream(stream::kind::eager).submit(pipeline).wait();
+  }
+
+ private:
+  static constexpr bool is_int8_ =
+      std::is_same<T_in, int8_t>::value || std::is_same<T_in, uint8_t>::value;
+
+  void CreateFcPrimitive(const LoDTensor* input, const Tensor* weights,
+                         const Tensor* bias, LoDTensor* output,
+                         const ExecutionContext& ctx) {
+    int in_num_col_dims = ctx.Attr<int>("in_num_col_dims");
+    auto weights_format = MatchWeightFormat(input->format());
+    if (!is_int8_ && input->dims().size() == 4 && in_num_col_dims == 1 &&
+        weights_format != MKLDNNMemoryFormat::format_undef) {
+      // The 4-D fp32 input is used in its own format, the weights are
+      // reordered to match it
+      auto src_desc = CreateMemDescriptor<T_in>(input, input->format());
+      input_ = CreateMemory<T_in>(src_desc, input);
+      weights_ = TransposeWeights(weights, ctx);
+      weights_ = CreateFourDimWeightsMemory(input, weights, weights_format);
+    } else {
+      input_ = CreateMatrixInputMemory(input, in_num_col_dims);
+      weights_ = TransposeWeights(weights, ctx);
     }
 
-    auto dst_desc = CreateMemDescriptor(output, MKLDNNMemoryFormat::any);
+    auto dims = input_->get_primitive_desc().desc().data.dims;
+    std::vector<int> dst_dims = {dims[0], static_cast<int>(weights->dims()[1])};
+    auto dst_desc =
+        CreateMemDescriptor<T_out>(dst_dims, MKLDNNMemoryFormat::nc);
 
     fc_ = CreateFcPrimitive(*input_, *weights_, dst_desc, bias, output, ctx);
-    return *fc_;
   }
 
- private:
   void UpdateDataPointers(const ExecutionContext& ctx, Tensor* out,
                           const Tensor* in) {
-    input_->set_data_handle(const_cast<T*>(in->data<T>()));
-    output_->set_data_handle(out->mutable_data<T>(ctx.GetPlace()));
-    if (out->format() == MKLDNNMemoryFormat::format_undef) {
-      auto output_format = platform::GetMKLDNNFormat(*output_);
-      out->set_format((MKLDNNMemoryFormat)output_format);
+    auto* in_data = to_void_cast<T_in>(in->data<T_in>());
+    if (input_reorder_) {
+      user_input_->set_data_handle(in_data);
+    } else {
+      input_->set_data_handle(in_data);
     }
+    output_->set_data_handle(out->mutable_data<T_out>(ctx.GetPlace()));
+    out->set_format(platform::MKLDNNFormatForSize(out->dims().size(),
+                                                  MKLDNNMemoryFormat::nchw));
   }
 
   MKLDNNMemoryFormat MatchWeightFormat(MKLDNNMemoryFormat fmt) {
@@ -90,29 +123,44 @@ class FCPrimitiveFactory {
     }
   }
 
+  // The reorder quantizes the data if scales are given
   mkldnn::memory Reorder(const memory::desc& src_desc,
-                         const memory::desc& dst_desc, const void* src_data) {
+                         const memory::desc& dst_desc, const void* src_data,
+                         const std::vector<float>& scales = {}) {
     auto src_mem = memory({src_desc, engine_}, const_cast<void*>(src_data));
     auto dst_mem = memory({dst_desc, engine_});
 
-    auto reorder = mkldnn::reorder(src_mem, dst_mem);
-    stream(stream::kind::eager).submit({reorder}).wait();
+    if (scales.empty()) {
+      auto reorder = mkldnn::reorder(src_mem, dst_mem);
+      stream(stream::kind::eager).submit({reorder}).wait();
+    } else {
+      int mask = scales.size() > 1 ? 1 : 0;
+      mkldnn::primitive_attr attr;
+      attr.set_output_scales(mask, scales);
+      auto reorder_pd = mkldnn::reorder::primitive_desc(
+          src_mem.get_primitive_desc(), dst_mem.get_primitive_desc(), attr);
+      auto reorder = mkldnn::reorder(reorder_pd, src_mem, dst_mem);
+      stream(stream::kind::eager).submit({reorder}).wait();
+    }
 
     return dst_mem;
   }
 
+  template <typename T>
   static mkldnn::memory::desc CreateMemDescriptor(const std::vector<int>& dims,
                                                   MKLDNNMemoryFormat format) {
     return platform::MKLDNNMemDesc(dims, platform::MKLDNNGetDataType<T>(),
                                    format);
   }
 
+  template <typename T>
   static mkldnn::memory::desc CreateMemDescriptor(const Tensor* tensor,
                                                   MKLDNNMemoryFormat format) {
     auto dims = framework::vectorize<int>(tensor->dims());
-    return CreateMemDescriptor(dims, format);
+    return CreateMemDescriptor<T>(dims, format);
   }
 
+  template <typename T>
   mkldnn::memory CreateMemory(const mkldnn::memory::desc& desc,
                               const Tensor* tensor) {
     return CreateMemory(desc, tensor->data<T>());
@@ -123,12 +171,94 @@ class FCPrimitiveFactory {
     return memory({desc, engine_}, const_cast<void*>(data));
   }
 
-  mkldnn::memory TransposeWeights(const Tensor* weights) {
+  // The input of any rank is flattened to a matrix like the CPU kernel does.
+  // An input in a non-plain format, e.g. the nhwc output of quantize, is
+  // reordered to the plain format first.
+  mkldnn::memory CreateMatrixInputMemory(const Tensor* input,
+                                         int in_num_col_dims) {
+    auto in_dims = input->dims();
+    PADDLE_ENFORCE_LE(in_dims.size(), 5,
+                      "The MKL-DNN fc supports inputs of up to 5-D.");
+    auto plain_format = platform::MKLDNNFormatForSize(
+        in_dims.size(), MKLDNNMemoryFormat::nchw);
+    auto matrix_dims = framework::flatten_to_2d(in_dims, in_num_col_dims);
+    auto matrix_desc = CreateMemDescriptor<T_in>(
+        framework::vectorize<int>(matrix_dims), MKLDNNMemoryFormat::nc);
+
+    auto in_format = input->format();
+    if (in_format == plain_format ||
+        in_format == MKLDNNMemoryFormat::format_undef) {
+      return CreateMemory<T_in>(matrix_desc, input);
+    }
+
+    user_input_ =
+        CreateMemory<T_in>(CreateMemDescriptor<T_in>(input, in_format), input);
+    auto plain_desc = CreateMemDescriptor<T_in>(input, plain_format);
+    plain_input_ = memory({plain_desc, engine_});
+    input_reorder_ = mkldnn::reorder(*user_input_, *plain_input_);
+    return CreateMemory(matrix_desc, plain_input_->get_data_handle());
+  }
+
+  // The weights of shape (I, O) are reordered to oi, and quantized to s8 by
+  // Scale_weights in INT8
+  mkldnn::memory TransposeWeights(const Tensor* weights,
+                                  const ExecutionContext& ctx) {
     auto dims = framework::vectorize<int>(weights->dims());
     std::swap(dims[0], dims[1]);  // Correct output dimensions
-    auto src_desc = CreateMemDescriptor(dims, MKLDNNMemoryFormat::io);
-    auto dst_desc = CreateMemDescriptor(dims, MKLDNNMemoryFormat::oi);
-    return Reorder(src_desc, dst_desc, weights->data<T>());
+    auto src_desc = CreateMemDescriptor<float>(dims, MKLDNNMemoryFormat::io);
+    auto dst_desc = CreateMemDescriptor<T_w>(dims, MKLDNNMemoryFormat::oi);
+    if (is_int8_) {
+      return Reorder(src_desc, dst_desc, weights->data<float>(),
+                     ctx.Attr<std::vector<float>>("Scale_weights"));
+    }
+    return Reorder(src_desc, dst_desc, weights->data<float>());
+  }
+
+  // The fp32 bias is quantized to s32 by Scale_in * Scale_weights in INT8
+  mkldnn::memory CreateBiasMemory(const Tensor* bias,
+                                  const ExecutionContext& ctx) {
+    std::vector<int> dims = {static_cast<int>(bias->numel())};
+    auto bias_desc = CreateMemDescriptor<float>(dims, MKLDNNMemoryFormat::x);
+    if (!is_int8_) {
+      return CreateMemory(bias_desc, bias->data<float>());
+    }
+
+    auto scale_in = ctx.Attr<float>("Scale_in");
+    auto scale_weights = ctx.Attr<std::vector<float>>("Scale_weights");
+    std::vector<float> scales(scale_weights.size());
+    for (size_t i = 0; i < scales.size(); ++i) {
+      scales[i] = scale_in * scale_weights[i];
+    }
+    auto dst_desc = CreateMemDescriptor<int32_t>(dims, MKLDNNMemoryFormat::x);
+    return Reorder(bias_desc, dst_desc, bias->data<float>(), scales);
+  }
+
+  mkldnn::primitive_attr CreateFcAttr(const ExecutionContext& ctx) {
+    mkldnn::primitive_attr attr;
+    if (is_int8_) {
+      // Scale the s32 result to the scale of the output, or back to fp32
+      auto scale_in = ctx.Attr<float>("Scale_in");
+      auto scale_weights = ctx.Attr<std::vector<float>>("Scale_weights");
+      auto scale_out = ctx.Attr<bool>("force_fp32_output")
+                           ? 1.0f
+                           : ctx.Attr<float>("Scale_out");
+      std::vector<float> output_shift_scale(scale_weights.size());
+      for (size_t i = 0; i < output_shift_scale.size(); ++i) {
+        output_shift_scale[i] = scale_weights[i] == 0.0f
+                                    ? scale_out
+                                    : scale_out / (scale_in * scale_weights[i]);
+      }
+      int mask = output_shift_scale.size() > 1 ? 1 << 1 : 0;
+      attr.set_output_scales(mask, output_shift_scale);
+    }
+
+    if (ctx.Attr<std::string>("activation_type") == "relu") {
+      mkldnn::post_ops post_ops;
+      post_ops.append_eltwise(1.0f, mkldnn::algorithm::eltwise_relu, 0.0f,
+                              0.0f);
+      attr.set_post_ops(post_ops);
+    }
+    return attr;
   }
 
   inner_product_forward CreateFcPrimitive(const memory& src_memory,
@@ -138,18 +268,25 @@ class FCPrimitiveFactory {
                                           const ExecutionContext& ctx) {
     const auto weights_desc = weights_memory.get_primitive_desc().desc();
     const auto src_desc = src_memory.get_primitive_desc().desc();
+    const auto attr = CreateFcAttr(ctx);
     if (bias) {
-      auto bias_desc = CreateMemDescriptor(bias, bias->format());
-      bias_ = CreateMemory(bias_desc, bias);
+      bias_ = CreateBiasMemory(bias, ctx);
+      auto bias_desc = bias_->get_primitive_desc().desc();
+      auto fc_desc =
+          inner_product_forward::desc(prop_kind::forward_scoring, src_desc,
+                                      weights_desc, bias_desc, dst_desc);
       auto fc_prim_desc =
-          CreateFcPrimDesc(src_desc, weights_desc, bias_desc, dst_desc);
+          inner_product_forward::primitive_desc(fc_desc, attr, engine_);
 
       output_ = CreateDstMemory(fc_prim_desc, ctx, output);
 
       return inner_product_forward(fc_prim_desc, src_memory, weights_memory,
                                    *bias_, *output_);
     } else {
-      auto fc_prim_desc = CreateFcPrimDesc(src_desc, weights_desc, dst_desc);
+      auto fc_desc = inner_product_forward::desc(
+          prop_kind::forward_scoring, src_desc, weights_desc, dst_desc);
+      auto fc_prim_desc =
+          inner_product_forward::primitive_desc(fc_desc, attr, engine_);
 
       output_ = CreateDstMemory(fc_prim_desc, ctx, output);
 
@@ -158,49 +295,31 @@ class FCPrimitiveFactory {
     }
   }
 
-  mkldnn::inner_product_forward::primitive_desc CreateFcPrimDesc(
-      const mkldnn::memory::desc& input_desc,
-      const mkldnn::memory::desc& weights_desc,
-      const mkldnn::memory::desc& bias_desc,
-      const mkldnn::memory::desc& dst_desc) {
-    auto fc_desc =
-        inner_product_forward::desc(prop_kind::forward_scoring, input_desc,
-                                    weights_desc, bias_desc, dst_desc);
-
-    return inner_product_forward::primitive_desc(fc_desc, engine_);
-  }
-
-  mkldnn::inner_product_forward::primitive_desc CreateFcPrimDesc(
-      const mkldnn::memory::desc& input_desc,
-      const mkldnn::memory::desc& weights_desc,
-      const mkldnn::memory::desc& dst_desc) {
-    auto fc_desc = inner_product_forward::desc(prop_kind::forward, input_desc,
-                                               weights_desc, dst_desc);
-
-    return inner_product_forward::primitive_desc(fc_desc, engine_);
-  }
-
   mkldnn::memory CreateFourDimWeightsMemory(const Tensor* input,
-                                            const Tensor* weights) {
+                                            const Tensor* weights,
+                                            MKLDNNMemoryFormat dst_format) {
     auto input_dims = framework::vectorize<int>(input->dims());
     auto weight_dims = framework::vectorize<int>(weights->dims());
     auto dims = {weight_dims[1], input_dims[1], input_dims[2], input_dims[3]};
 
-    auto dst_format = MatchWeightFormat(input->format());
-    auto src_desc = CreateMemDescriptor(dims, MKLDNNMemoryFormat::oihw);
-    auto dst_desc = CreateMemDescriptor(dims, dst_format);
+    auto src_desc = CreateMemDescriptor<T_w>(dims, MKLDNNMemoryFormat::oihw);
+    auto dst_desc = CreateMemDescriptor<T_w>(dims, dst_format);
 
     return Reorder(src_desc, dst_desc, weights_->get_data_handle());
   }
 
+  // The output is a matrix in memory, so its format is the plain format of
+  // its rank
   mkldnn::memory CreateDstMemory(
       const mkldnn::inner_product_forward::primitive_desc& fc_prim_desc,
       const ExecutionContext& ctx, Tensor* output) {
     auto dst_prim_desc = fc_prim_desc.dst_primitive_desc();
     auto buffer_size = dst_prim_desc.get_size();
-    T* output_data = output->mutable_data<T>(ctx.GetPlace(), buffer_size);
-    memory dst_mem(dst_prim_desc, to_void_cast<T>(output_data));
-    output->set_format(platform::GetMKLDNNFormat(dst_mem));
+    T_out* output_data =
+        output->mutable_data<T_out>(ctx.GetPlace(), buffer_size);
+    memory dst_mem(dst_prim_desc, to_void_cast<T_out>(output_data));
+    output->set_format(platform::MKLDNNFormatForSize(output->dims().size(),
+                                                     MKLDNNMemoryFormat::nchw));
     return dst_mem;
   }
 
@@ -217,47 +336,67 @@ class FCPrimitiveFactory {
   const mkldnn::engine& engine_;
   boost::optional<memory> bias_;
   boost::optional<memory> input_;
+  boost::optional<memory> user_input_;
+  boost::optional<memory> plain_input_;
+  boost::optional<mkldnn::reorder> input_reorder_;
   boost::optional<memory> output_;
   boost::optional<memory> weights_;
   boost::optional<inner_product_forward> fc_;
 };
 
-template <typename T>
-std::shared_ptr<FCPrimitiveFactory<T>> GetPrimitiveFactory(
+template <typename T_in, typename T_w, typename T_out>
+std::shared_ptr<FCPrimitiveFactory<T_in, T_w, T_out>> GetPrimitiveFactory(
     const MKLDNNDeviceContext& dev_ctx, const ExecutionContext& ctx,
     const Tensor* input, const Tensor* weights,
     const mkldnn::engine& mkldnn_engine) {
   const std::string key = platform::CreateKey(
+      input->type(), framework::vectorize<int>(input->dims()), input->format(),
       framework::vectorize<int>(weights->dims()), ctx.op().Output("Out"));
 
   auto prim_creator =
-      std::static_pointer_cast<FCPrimitiveFactory<T>>(dev_ctx.GetBlob(key));
+      std::static_pointer_cast<FCPrimitiveFactory<T_in, T_w, T_out>>(
+          dev_ctx.GetBlob(key));
   if (prim_creator == nullptr) {
-    prim_creator = std::make_shared<FCPrimitiveFactory<T>>(mkldnn_engine);
+    prim_creator =
+        std::make_shared<FCPrimitiveFactory<T_in, T_w, T_out>>(mkldnn_engine);
     dev_ctx.SetBlob(key, prim_creator);
   }
 
   return prim_creator;
 }
 
-template <typename T>
-class FCMKLDNNOpKernel : public framework::OpKernel<T> {
+template <typename T_in, typename T_w, typename T_out>
+static void ExecuteFc(const MKLDNNDeviceContext& dev_ctx,
+                      const ExecutionContext& ctx, const LoDTensor* input,
+                      const Tensor* w, const Tensor* bias, LoDTensor* output) {
+  auto prim_creator = GetPrimitiveFactory<T_in, T_w, T_out>(
+      dev_ctx, ctx, input, w, dev_ctx.GetEngine());
+  prim_creator->ExecuteFcPrimitive(input, w, bias, output, ctx);
+}
+
+/* T_in: input data type, T_w: data type of the weights used by MKL-DNN */
+template <typename T_in, typename T_w>
+class FCMKLDNNOpKernel : public framework::OpKernel<T_in> {
  public:
   void Compute(const paddle::framework::ExecutionContext& ctx) const override {
     PADDLE_ENFORCE(platform::is_cpu_place(ctx.GetPlace()),
                    "It must use CPUPlace.");
     auto& dev_ctx = ctx.template device_context<MKLDNNDeviceContext>();
-    const auto& mkldnn_engine = dev_ctx.GetEngine();
 
     auto input = ctx.Input<LoDTensor>("Input");
     auto w = ctx.Input<Tensor>("W");
     auto bias = ctx.Input<Tensor>("Bias");
     auto output = ctx.Output<LoDTensor>("Out");
 
-    auto prim_creator =
-        GetPrimitiveFactory<T>(dev_ctx, ctx, input, w, mkldnn_engine);
-    auto fc = prim_creator->CreateFcPrimitive(input, w, bias, output, ctx);
-    stream(stream::kind::eager).submit({fc}).wait();
+    bool force_fp32_output = ctx.Attr<bool>("force_fp32_output");
+    bool fuse_relu = ctx.Attr<std::string>("activation_type") == "relu";
+    if (std::is_same<T_in, float>::value || force_fp32_output) {
+      ExecuteFc<T_in, T_w, float>(dev_ctx, ctx, input, w, bias, output);
+    } else if (fuse_relu) {
+      ExecuteFc<T_in, T_w, uint8_t>(dev_ctx, ctx, input, w, bias, output);
+    } else {
+      ExecuteFc<T_in, T_w, int8_t>(dev_ctx, ctx, input, w, bias, output);
+    }
 
     output->set_layout(DataLayout::kMKLDNN);
   }
@@ -266,4 +405,6 @@ class FCMKLDNNOpKernel : public framework::OpKernel<T> {
 }  // namespace paddle
 
 REGISTER_OP_KERNEL(fc, MKLDNN, ::paddle::platform::CPUPlace,
-                   paddle::operators::FCMKLDNNOpKernel<float>);
+                   paddle::operators::FCMKLDNNOpKernel<float, float>,
+                   paddle::operators::FCMKLDNNOpKernel<uint8_t, int8_t>,
+                   paddle::operators::FCMKLDNNOpKernel<int8_t, int8_t>);
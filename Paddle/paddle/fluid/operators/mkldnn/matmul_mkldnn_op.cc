@@ -0,0 +1,283 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <mkldnn/include/mkldnn_types.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/mkldnn_helper.h"
+#include "paddle/fluid/platform/variant.h"
+
+namespace paddle {
+namespace operators {
+
+using framework::DataLayout;
+using framework::ExecutionContext;
+using framework::Tensor;
+using mkldnn::inner_product_forward;
+using mkldnn::memory;
+using mkldnn::primitive;
+using mkldnn::prop_kind;
+using mkldnn::stream;
+using platform::MKLDNNDeviceContext;
+using platform::to_void_cast;
+
+/* XT: input x data type, OT: output data type.
+ * The INT8 matmul runs an MKL-DNN inner product for every batch, whose src is
+ * the X of the batch (M x K) and whose weights are the s8 Y of the batch
+ * (N x K). The transposes are done by reordering io to oi. When Y has no
+ * batch and X is not transposed, all batches of X are one inner product. */
+template <typename XT, typename OT>
+class MatMulPrimitiveFactory {
+ public:
+  explicit MatMulPrimitiveFactory(const mkldnn::engine& engine)
+      : engine_(engine) {}
+
+  void ExecuteMatMul(const Tensor* x, const Tensor* y, Tensor* out,
+                     const ExecutionContext& ctx) {
+    const XT* x_data = GetPlainData<XT>(x, &x_plain_);
+    const int8_t* y_data = GetPlainData<int8_t>(y, &y_plain_);
+    OT* out_data = out->mutable_data<OT>(ctx.GetPlace());
+    if (!matmul_) {
+      CreateMatMulPrimitive(x, y, x_data, y_data, out_data, ctx);
+    }
+
+    for (int64_t b = 0; b < batch_; ++b) {
+      std::vector<primitive> pipeline;
+      auto* x_batch = to_void_cast<XT>(x_data + b * M_ * K_);
+      if (x_transpose_) {
+        x_t_src_->set_data_handle(x_batch);
+        pipeline.push_back(*x_transpose_);
+      } else {
+        src_->set_data_handle(x_batch);
+      }
+      // the broadcast Y is only transposed for the first batch
+      int64_t y_batch = y_broadcast_ ? 0 : b;
+      auto* y_batch_data = to_void_cast<int8_t>(y_data + y_batch * N_ * K_);
+      if (y_transpose_) {
+        y_t_src_->set_data_handle(y_batch_data);
+        if (b == 0 || !y_broadcast_) pipeline.push_back(*y_transpose_);
+      } else {
+        weights_->set_data_handle(y_batch_data);
+      }
+      dst_->set_data_handle(to_void_cast<OT>(out_data + b * M_ * N_));
+      pipeline.push_back(*matmul_);
+      stream(stream::kind::eager).submit(pipeline).wait();
+    }
+  }
+
+ private:
+  struct PlainInput {
+    boost::optional<memory> user;
+    boost::optional<memory> plain;
+    boost::optional<mkldnn::reorder> reorder;
+  };
+
+  // Returns the data of the tensor in the plain format of its rank, e.g. the
+  // nwc output of quantize is reordered to ncw.
+  template <typename T>
+  const T* GetPlainData(const Tensor* tensor, PlainInput* input) {
+    auto format = tensor->format();
+    auto plain_format = platform::MKLDNNFormatForSize(
+        tensor->dims().size(), MKLDNNMemoryFormat::nchw);
+    if (format == plain_format || format == MKLDNNMemoryFormat::format_undef) {
+      return tensor->data<T>();
+    }
+
+    auto* data = to_void_cast<T>(tensor->data<T>());
+    if (!input->reorder) {
+      auto dims = framework::vectorize<int>(tensor->dims());
+      auto type = platform::MKLDNNGetDataType<T>();
+      input->user = memory(
+          {platform::MKLDNNMemDesc(dims, type, format), engine_}, data);
+      input->plain =
+          memory({platform::MKLDNNMemDesc(dims, type, plain_format), engine_});
+      input->reorder = mkldnn::reorder(*input->user, *input->plain);
+    } else {
+      input->user->set_data_handle(data);
+    }
+    stream(stream::kind::eager).submit({*input->reorder}).wait();
+    return static_cast<const T*>(input->plain->get_data_handle());
+  }
+
+  template <typename T>
+  memory CreateMemory(int64_t rows, int64_t cols, MKLDNNMemoryFormat format,
+                      const T* data = nullptr) {
+    auto desc = platform::MKLDNNMemDesc(
+        {static_cast<int>(rows), static_cast<int>(cols)},
+        platform::MKLDNNGetDataType<T>(), format);
+    return data ? memory({desc, engine_}, to_void_cast<T>(data))
+                : memory({desc, engine_});
+  }
+
+  void CreateMatMulPrimitive(const Tensor* x, const Tensor* y,
+                             const XT* x_data, const int8_t* y_data,
+                             OT* out_data, const ExecutionContext& ctx) {
+    bool transpose_x = ctx.Attr<bool>("transpose_X");
+    bool transpose_y = ctx.Attr<bool>("transpose_Y");
+    auto x_dims = x->dims();
+    auto y_dims = y->dims();
+    int x_rank = x_dims.size();
+    int y_rank = y_dims.size();
+    PADDLE_ENFORCE(x_rank >= 2 && x_rank <= 5 && y_rank >= 2 && y_rank <= 5,
+                   "The MKL-DNN matmul supports inputs of 2-D to 5-D.");
+    PADDLE_ENFORCE_EQ(y->type(), framework::proto::VarType::INT8,
+                      "Input(Y) of the MKL-DNN matmul should be s8.");
+
+    int64_t x_rows = x_dims[x_rank - 2];
+    int64_t x_cols = x_dims[x_rank - 1];
+    int64_t y_rows = y_dims[y_rank - 2];
+    int64_t y_cols = y_dims[y_rank - 1];
+    int64_t batch_x = x->numel() / (x_rows * x_cols);
+    int64_t batch_y = y->numel() / (y_rows * y_cols);
+    M_ = transpose_x ? x_cols : x_rows;
+    K_ = transpose_x ? x_rows : x_cols;
+    N_ = transpose_y ? y_rows : y_cols;
+    PADDLE_ENFORCE_EQ(K_, transpose_y ? y_cols : y_rows,
+                      "Input(X) and Input(Y) of matmul do not match.");
+    PADDLE_ENFORCE(batch_y == batch_x || batch_y == 1,
+                   "The batch of Input(Y) should be 1 or the batch of "
+                   "Input(X) in the MKL-DNN matmul.");
+    y_broadcast_ = batch_y == 1;
+    batch_ = batch_x;
+    if (y_broadcast_ && !transpose_x) {
+      M_ *= batch_;
+      batch_ = 1;
+    }
+
+    if (transpose_x) {
+      x_t_src_ = CreateMemory<XT>(M_, K_, MKLDNNMemoryFormat::io, x_data);
+      x_t_dst_ = CreateMemory<XT>(M_, K_, MKLDNNMemoryFormat::oi);
+      x_transpose_ = mkldnn::reorder(*x_t_src_, *x_t_dst_);
+      src_ = CreateMemory<XT>(
+          M_, K_, MKLDNNMemoryFormat::nc,
+          static_cast<const XT*>(x_t_dst_->get_data_handle()));
+    } else {
+      src_ = CreateMemory<XT>(M_, K_, MKLDNNMemoryFormat::nc, x_data);
+    }
+
+    if (!transpose_y) {
+      y_t_src_ = CreateMemory<int8_t>(N_, K_, MKLDNNMemoryFormat::io, y_data);
+      y_t_dst_ = CreateMemory<int8_t>(N_, K_, MKLDNNMemoryFormat::oi);
+      y_transpose_ = mkldnn::reorder(*y_t_src_, *y_t_dst_);
+      weights_ = CreateMemory<int8_t>(
+          N_, K_, MKLDNNMemoryFormat::oi,
+          static_cast<const int8_t*>(y_t_dst_->get_data_handle()));
+    } else {
+      weights_ = CreateMemory<int8_t>(N_, K_, MKLDNNMemoryFormat::oi, y_data);
+    }
+
+    dst_ = CreateMemory<OT>(M_, N_, MKLDNNMemoryFormat::nc, out_data);
+
+    auto matmul_desc = inner_product_forward::desc(
+        prop_kind::forward_scoring, src_->get_primitive_desc().desc(),
+        weights_->get_primitive_desc().desc(),
+        dst_->get_primitive_desc().desc());
+    auto matmul_prim_desc = inner_product_forward::primitive_desc(
+        matmul_desc, CreateMatMulAttr(ctx), engine_);
+    matmul_ = inner_product_forward(matmul_prim_desc, *src_, *weights_, *dst_);
+  }
+
+  mkldnn::primitive_attr CreateMatMulAttr(const ExecutionContext& ctx) {
+    auto alpha = ctx.Attr<float>("alpha");
+    auto scale_x = ctx.Attr<float>("Scale_x");
+    auto scale_y = ctx.Attr<float>("Scale_y");
+    auto scale_out = ctx.Attr<bool>("force_fp32_output")
+                         ? 1.0f
+                         : ctx.Attr<float>("Scale_out");
+
+    mkldnn::primitive_attr matmul_attr;
+    matmul_attr.set_output_scales(
+        0, {alpha * scale_out / (scale_x * scale_y)});
+    return matmul_attr;
+  }
+
+ private:
+  const mkldnn::engine& engine_;
+  int64_t batch_;
+  int64_t M_;
+  int64_t N_;
+  int64_t K_;
+  bool y_broadcast_;
+  PlainInput x_plain_;
+  PlainInput y_plain_;
+  boost::optional<memory> x_t_src_;
+  boost::optional<memory> x_t_dst_;
+  boost::optional<mkldnn::reorder> x_transpose_;
+  boost::optional<memory> y_t_src_;
+  boost::optional<memory> y_t_dst_;
+  boost::optional<mkldnn::reorder> y_transpose_;
+  boost::optional<memory> src_;
+  boost::optional<memory> weights_;
+  boost::optional<memory> dst_;
+  boost::optional<inner_product_forward> matmul_;
+};
+
+template <typename XT, typename OT>
+std::shared_ptr<MatMulPrimitiveFactory<XT, OT>> GetPrimitiveFactory(
+    const MKLDNNDeviceContext& dev_ctx, const ExecutionContext& ctx,
+    const Tensor* x, const Tensor* y) {
+  const std::string key = platform::CreateKey(
+      x->type(), framework::vectorize<int>(x->dims()), x->format(),
+      framework::vectorize<int>(y->dims()), y->format(),
+      ctx.op().Output("Out"));
+
+  auto prim_creator = std::static_pointer_cast<MatMulPrimitiveFactory<XT, OT>>(
+      dev_ctx.GetBlob(key));
+  if (prim_creator == nullptr) {
+    prim_creator =
+        std::make_shared<MatMulPrimitiveFactory<XT, OT>>(dev_ctx.GetEngine());
+    dev_ctx.SetBlob(key, prim_creator);
+  }
+
+  return prim_creator;
+}
+
+/* XT: input x data type */
+template <typename XT>
+class MatMulMKLDNNKernel : public framework::OpKernel<XT> {
+ public:
+  void Compute(const ExecutionContext& ctx) const override {
+    PADDLE_ENFORCE(platform::is_cpu_place(ctx.GetPlace()),
+                   "It must use CPUPlace.");
+    auto& dev_ctx = ctx.template device_context<MKLDNNDeviceContext>();
+
+    auto* x = ctx.Input<Tensor>("X");
+    auto* y = ctx.Input<Tensor>("Y");
+    auto* out = ctx.Output<Tensor>("Out");
+
+    if (ctx.Attr<bool>("force_fp32_output")) {
+      GetPrimitiveFactory<XT, float>(dev_ctx, ctx, x, y)
+          ->ExecuteMatMul(x, y, out, ctx);
+    } else {
+      GetPrimitiveFactory<XT, int8_t>(dev_ctx, ctx, x, y)
+          ->ExecuteMatMul(x, y, out, ctx);
+    }
+
+    out->set_layout(DataLayout::kMKLDNN);
+    out->set_format(platform::MKLDNNFormatForSize(out->dims().size(),
+                                                  MKLDNNMemoryFormat::nchw));
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_KERNEL(matmul, MKLDNN, ::paddle::platform::CPUPlace,
+                   ops::MatMulMKLDNNKernel<uint8_t>,
+                   ops::MatMulMKLDNNKernel<int8_t>);
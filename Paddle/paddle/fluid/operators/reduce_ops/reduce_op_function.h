@@ -57,15 +57,16 @@ void ReduceFunctor(const DeviceContext& context, const framework::Tensor& input,
                       dims_vector.end());
     out_dims = framework::make_ddim(dims_vector);
   }
-  auto& place = *context.eigen_device();
   Functor functor;
 
   if (D == 1) {
     auto out = EigenScalar<T>::From(*output);
-    functor(place, &x, &out, reduce_dim);
+    platform::EigenDeviceRun(context, input.numel(), &functor, &x, &out,
+                             reduce_dim);
   } else {
     auto out = EigenTensor<T, (D - R_D)>::From(*output, out_dims);
-    functor(place, &x, &out, reduce_dim);
+    platform::EigenDeviceRun(context, input.numel(), &functor, &x, &out,
+                             reduce_dim);
   }
 }
 
@@ -98,11 +99,10 @@ void ReduceGradFunctor(const DeviceContext& context,
   auto x_reduce = EigenTensor<T, D>::From(input1, reduced_dims);
   auto x_reduce_grad = EigenTensor<T, D>::From(input2, reduced_dims);
 
-  auto& place = *context.eigen_device();
-
   Functor functor;
-  functor(place, &x, &x_reduce, &x_grad, &x_reduce_grad, broadcast_dim,
-          broad_cats_times);
+  platform::EigenDeviceRun(context, output->numel(), &functor, &x, &x_reduce,
+                           &x_grad, &x_reduce_grad, broadcast_dim,
+                           broad_cats_times);
 }
 
 }  // namespace operators
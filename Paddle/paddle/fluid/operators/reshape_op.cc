@@ -312,24 +312,31 @@ class ReshapeGradOp : public framework::OperatorWithKernel {
   }
 };
 
+// The slots of ReshapeOpMaker, and Reshape2OpMaker which appends XShape to
+// its outputs, read by ReshapeKernel.
+constexpr framework::OpSlot kReshapeX{0, "X"};
+constexpr framework::OpSlot kReshapeShape{1, "Shape"};
+constexpr framework::OpSlot kReshapeShapeTensor{2, "ShapeTensor"};
+constexpr framework::OpSlot kReshapeOut{0, "Out"};
+
 class ReshapeKernel {
  public:
   void operator()(const framework::ExecutionContext &ctx) const {
-    auto *out = ctx.Output<framework::LoDTensor>("Out");
-    auto *in = ctx.Input<framework::LoDTensor>("X");
+    auto *out = ctx.Output<framework::LoDTensor>(kReshapeOut);
+    auto *in = ctx.Input<framework::LoDTensor>(kReshapeX);
 
     framework::DDim out_dims = out->dims();
 
     auto list_new_shape_tensor =
-        ctx.MultiInput<framework::Tensor>("ShapeTensor");
+        ctx.MultiInput<framework::Tensor>(kReshapeShapeTensor);
     if (list_new_shape_tensor.size() > 0) {
       // have shape tensor
       auto new_shape = get_new_shape(list_new_shape_tensor);
       out_dims = ReshapeOp::ValidateShape(new_shape, in->dims());
 
     } else {
-      auto *shape_tensor = ctx.HasInput("Shape")
-                               ? ctx.Input<framework::LoDTensor>("Shape")
+      auto *shape_tensor = ctx.HasInput(kReshapeShape)
+                               ? ctx.Input<framework::LoDTensor>(kReshapeShape)
                                : nullptr;
 
       if (shape_tensor) {
@@ -45,14 +45,19 @@ static inline int SizeFromAxis(const int axis, DDim dims) {
   return size;
 }
 
+// The slots of SoftmaxOpMaker read by SoftmaxKernel.
+constexpr framework::OpSlot kSoftmaxX{0, "X"};
+constexpr framework::OpSlot kSoftmaxOut{0, "Out"};
+constexpr framework::OpSlot kSoftmaxAxis{0, "axis"};
+
 template <typename DeviceContext, typename T>
 class SoftmaxKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext& context) const override {
-    auto* X = context.Input<Tensor>("X");
-    auto* Out = context.Output<Tensor>("Out");
+    auto* X = context.Input<Tensor>(kSoftmaxX);
+    auto* Out = context.Output<Tensor>(kSoftmaxOut);
     const int rank = X->dims().size();
-    const int axis = CanonicalAxis(context.Attr<int>("axis"), rank);
+    const int axis = CanonicalAxis(context.Attr<int>(kSoftmaxAxis), rank);
     int axis_dim = X->dims()[axis];
 
     // allocate memory on device.
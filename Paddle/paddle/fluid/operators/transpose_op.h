@@ -55,15 +55,21 @@ inline void TransCompute(const int dim, const DeviceContext& dev_ctx,
   }
 }
 
+// The slots of TransposeOpMaker, and Transpose2OpMaker which appends XShape
+// to its outputs, read by TransposeKernel.
+constexpr framework::OpSlot kTransposeX{0, "X"};
+constexpr framework::OpSlot kTransposeOut{0, "Out"};
+constexpr framework::OpSlot kTransposeAxis{0, "axis"};
+
 template <typename DeviceContext, typename T>
 class TransposeKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext& context) const override {
-    auto* x = context.Input<framework::Tensor>("X");
-    auto* out = context.Output<framework::Tensor>("Out");
+    auto* x = context.Input<framework::Tensor>(kTransposeX);
+    auto* out = context.Output<framework::Tensor>(kTransposeOut);
     out->mutable_data<T>(context.GetPlace());
 
-    std::vector<int> axis = context.Attr<std::vector<int>>("axis");
+    std::vector<int> axis = context.Attr<std::vector<int>>(kTransposeAxis);
     int ndims = axis.size();
     auto& dev_ctx = context.template device_context<DeviceContext>();
     TransCompute<DeviceContext, T>(ndims, dev_ctx, *x, out, axis);
@@ -0,0 +1,211 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/weight_only_fc.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+class WeightOnlyFCOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE_EQ(ctx->HasInput("Input"), true,
+                      "Input(Input) of WeightOnlyFCOp should not be null.");
+    PADDLE_ENFORCE_EQ(ctx->HasInput("W"), true,
+                      "Input(W) of WeightOnlyFCOp should not be null.");
+    PADDLE_ENFORCE_EQ(ctx->HasOutput("Out"), true,
+                      "Output(Out) of WeightOnlyFCOp should not be null.");
+
+    auto in_dims = ctx->GetInputDim("Input");
+    auto w_dims = ctx->GetInputDim("W");
+    PADDLE_ENFORCE_EQ(w_dims.size(), 2,
+                      "The packed weight of WeightOnlyFCOp should be 2-D.");
+    int in_num_col_dims = ctx->Attrs().Get<int>("in_num_col_dims");
+    PADDLE_ENFORCE_GT(in_dims.size(), in_num_col_dims,
+                      "The rank of Input(Input) of WeightOnlyFCOp should be "
+                      "larger than in_num_col_dims.");
+    auto in_mat_dims = framework::flatten_to_2d(in_dims, in_num_col_dims);
+    // the packed weight is (N, K)
+    PADDLE_ENFORCE_EQ(in_mat_dims[1], w_dims[1],
+                      "The input and the packed weight size do not match.");
+
+    auto& weight_type = ctx->Attrs().Get<std::string>("weight_type");
+    if (weight_type == "int8") {
+      PADDLE_ENFORCE_EQ(ctx->HasInput("Scales"), true,
+                        "Input(Scales) is needed by the int8 weight.");
+      int group_size = ctx->Attrs().Get<int>("group_size");
+      auto scales_dims = ctx->GetInputDim("Scales");
+      PADDLE_ENFORCE_EQ(scales_dims.size(), 2,
+                        "Input(Scales) of WeightOnlyFCOp should be 2-D.");
+      PADDLE_ENFORCE_EQ(scales_dims[0], w_dims[0],
+                        "Every row of the weight should have its scales.");
+      PADDLE_ENFORCE_EQ(scales_dims[1],
+                        (w_dims[1] + group_size - 1) / group_size,
+                        "Every group of the weight should have a scale.");
+    } else {
+      PADDLE_ENFORCE_EQ(weight_type, "bf16",
+                        "The weight_type should be bf16 or int8, but got %s.",
+                        weight_type);
+    }
+
+    if (ctx->HasInput("Bias")) {
+      auto bias_dims = ctx->GetInputDim("Bias");
+      PADDLE_ENFORCE_EQ(framework::product(bias_dims), w_dims[0],
+                        "The shape of Bias must be [1, dim].");
+    }
+    auto& activation_type = ctx->Attrs().Get<std::string>("activation_type");
+    if (!activation_type.empty()) {
+      PADDLE_ENFORCE_EQ(activation_type, "relu",
+                        "Activation %s is not supportetd in weight_only_fc.",
+                        activation_type);
+    }
+
+    std::vector<int64_t> output_dims;
+    for (int i = 0; i < in_num_col_dims; ++i) {
+      output_dims.push_back(in_dims[i]);
+    }
+    output_dims.push_back(w_dims[0]);
+    ctx->SetOutputDim("Out", framework::make_ddim(output_dims));
+    ctx->ShareLoD("Input", "Out");
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    // the weight is not of the data type of the kernel
+    return framework::OpKernelType(
+        OperatorWithKernel::IndicateVarDataType(ctx, "Input"),
+        ctx.GetPlace());
+  }
+};
+
+class WeightOnlyFCOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Input", "(Tensor), The input tensor of the fc.");
+    AddInput("W",
+             "(Tensor), The packed weight with shape (O, I), i.e. the "
+             "transpose of the fc weight. It is int16 holding the bits of "
+             "bf16 when weight_type is bf16, and int8 when it is int8.");
+    AddInput("Scales",
+             "(Tensor, optional) The scales of the int8 weight with shape "
+             "(O, ceil(I / group_size)).")
+        .AsDispensable();
+    AddInput("Bias", "(Tensor, optional) Bias vector with shape (1 x O)")
+        .AsDispensable();
+    AddOutput("Out", "(Tensor) The output tensor of the fc.");
+    AddAttr<int>("in_num_col_dims",
+                 "(int, default 1), The fc op can take tensors with more than "
+                 "two dimensions as its inputs.")
+        .SetDefault(1)
+        .EqualGreaterThan(1);
+    AddAttr<std::string>("activation_type",
+                         "Activation type used in fully connected operator.")
+        .SetDefault("");
+    AddAttr<std::string>("weight_type",
+                         "(string, default bf16) The storage of the weight, "
+                         "bf16 or int8.")
+        .SetDefault("bf16");
+    AddAttr<int>("group_size",
+                 "(int, default 64) The number of the int8 weights of a row "
+                 "sharing one scale.")
+        .SetDefault(64)
+        .GreaterThan(0);
+    AddAttr<float>("alpha", "(float, default 1.0) The scale of the output.")
+        .SetDefault(1.0f);
+    AddComment(R"DOC(
+Weight-only Fully Connected Operator.
+
+Out = alpha * Input * dequantize(W)^T + Bias
+
+The weight is stored in bf16 or in per-group int8 and dequantized to float
+tile by tile inside the GEMM kernel, while the input and the output stay in
+float. It is created by the weight_only_quant_pass for inference only.
+)DOC");
+  }
+};
+
+template <typename DeviceContext, typename T>
+class WeightOnlyFCKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* input = ctx.Input<framework::LoDTensor>("Input");
+    auto* w = ctx.Input<Tensor>("W");
+    auto* bias = ctx.Input<Tensor>("Bias");
+    auto* output = ctx.Output<framework::LoDTensor>("Out");
+    int in_num_col_dims = ctx.Attr<int>("in_num_col_dims");
+    bool with_relu = ctx.Attr<std::string>("activation_type") == "relu";
+    float alpha = ctx.Attr<float>("alpha");
+
+    auto in_dims = input->dims();
+    auto in_mat_dims = framework::flatten_to_2d(in_dims, in_num_col_dims);
+    int M = in_mat_dims[0];
+    int K = in_mat_dims[1];
+    int N = w->dims()[0];
+    std::vector<int64_t> output_dims;
+    for (int i = 0; i < in_num_col_dims; ++i) {
+      output_dims.push_back(in_dims[i]);
+    }
+    output_dims.push_back(N);
+    output->Resize(framework::make_ddim(output_dims));
+    output->set_lod(input->lod());
+
+    const T* input_data = input->data<T>();
+    const T* bias_data = bias ? bias->data<T>() : nullptr;
+    T* output_data = output->mutable_data<T>(ctx.GetPlace());
+    // alpha is applied before the bias and the relu
+    const T* fc_bias = alpha == 1.0f ? bias_data : nullptr;
+
+    auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    math::WeightOnlyFCFunctor<DeviceContext, T> fc;
+    if (ctx.Attr<std::string>("weight_type") == "int8") {
+      auto* scales = ctx.Input<Tensor>("Scales");
+      fc(dev_ctx, M, N, K, input_data, w->data<int8_t>(),
+         scales->data<float>(), ctx.Attr<int>("group_size"), output_data,
+         fc_bias, with_relu);
+    } else {
+      fc(dev_ctx, M, N, K, input_data,
+         reinterpret_cast<const uint16_t*>(w->data<int16_t>()), output_data,
+         fc_bias, with_relu);
+    }
+
+    if (alpha != 1.0f || (bias_data == nullptr && with_relu)) {
+      for (int i = 0; i < M; ++i) {
+        T* dst = output_data + i * N;
+        for (int j = 0; j < N; ++j) {
+          T v = static_cast<T>(alpha) * dst[j] +
+                (bias_data ? bias_data[j] : static_cast<T>(0));
+          dst[j] = with_relu && v < static_cast<T>(0) ? static_cast<T>(0) : v;
+        }
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(weight_only_fc, ops::WeightOnlyFCOp,
+                             ops::WeightOnlyFCOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    weight_only_fc,
+    ops::WeightOnlyFCKernel<paddle::platform::CPUDeviceContext, float>);
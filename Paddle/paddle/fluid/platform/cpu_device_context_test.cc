@@ -0,0 +1,99 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <thread>  // NOLINT
+#include <type_traits>
+#include <vector>
+#include "gflags/gflags.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/platform/cpu_helper.h"
+#include "paddle/fluid/platform/device_context.h"
+
+DECLARE_int64(cpu_eigen_parallel_min_numel);
+
+namespace paddle {
+namespace platform {
+
+struct RowSumFunctor {
+  template <typename EigenDevice>
+  void operator()(const EigenDevice& device, const std::vector<float>* x,
+                  std::vector<float>* y, bool* on_pool) const {
+    Eigen::TensorMap<const Eigen::Tensor<float, 2, Eigen::RowMajor>> x_t(
+        x->data(), static_cast<int>(y->size()),
+        static_cast<int>(x->size() / y->size()));
+    Eigen::TensorMap<Eigen::Tensor<float, 1, Eigen::RowMajor>> y_t(
+        y->data(), static_cast<int>(y->size()));
+    y_t.device(device) = x_t.sum(Eigen::array<int, 1>({{1}}));
+    *on_pool = std::is_same<EigenDevice, Eigen::ThreadPoolDevice>::value;
+  }
+};
+
+TEST(CPUDeviceContext, eigen_pool_device) {
+  CPUDeviceContext context;
+  SetNumThreads(1);
+  EXPECT_EQ(context.eigen_pool_device(1 << 30), nullptr);
+
+  SetNumThreads(4);
+  EXPECT_EQ(context.eigen_pool_device(FLAGS_cpu_eigen_parallel_min_numel - 1),
+            nullptr);
+  auto* device = context.eigen_pool_device(FLAGS_cpu_eigen_parallel_min_numel);
+  ASSERT_NE(device, nullptr);
+  EXPECT_EQ(device->numThreads(), 4);
+  // The pool is shared by all the contexts and threads.
+  CPUDeviceContext other_context;
+  EXPECT_EQ(other_context.eigen_pool_device(1 << 30), device);
+  Eigen::ThreadPoolDevice* other_thread_device = nullptr;
+  std::thread([&] {
+    other_thread_device = context.eigen_pool_device(1 << 30);
+  }).join();
+  EXPECT_EQ(other_thread_device, device);
+
+  SetNumThreads(2);
+  EXPECT_EQ(context.eigen_pool_device(1 << 30)->numThreads(), 2);
+  SetNumThreads(1);
+}
+
+#ifdef PADDLE_WITH_MKLDNN
+TEST(MKLDNNDeviceContext, eigen_pool_device) {
+  MKLDNNDeviceContext context(CPUPlace());
+  SetNumThreads(4);
+  EXPECT_EQ(context.eigen_pool_device(1 << 30), nullptr);
+  SetNumThreads(1);
+}
+#endif
+
+TEST(CPUDeviceContext, EigenDeviceRun) {
+  CPUDeviceContext context;
+  SetNumThreads(4);
+  const int rows = 1000;
+  const int cols = 300;
+  std::vector<float> x(rows * cols);
+  for (size_t i = 0; i < x.size(); ++i) x[i] = i % 7;
+  RowSumFunctor functor;
+  for (int64_t numel : {int64_t(rows), int64_t(x.size())}) {
+    std::vector<float> y(rows);
+    bool on_pool = false;
+    EigenDeviceRun(context, numel, &functor, &x, &y, &on_pool);
+    EXPECT_EQ(on_pool, numel >= FLAGS_cpu_eigen_parallel_min_numel);
+    for (int i = 0; i < rows; ++i) {
+      float expected = 0;
+      for (int j = 0; j < cols; ++j) expected += x[i * cols + j];
+      EXPECT_FLOAT_EQ(y[i], expected);
+    }
+  }
+  SetNumThreads(1);
+}
+
+}  // namespace platform
+}  // namespace paddle
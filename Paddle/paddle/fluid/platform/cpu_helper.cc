@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/platform/cpu_helper.h"
+#include <atomic>
 #include "paddle/fluid/platform/enforce.h"
 
 #ifdef PADDLE_WITH_MKLML
@@ -27,7 +28,10 @@ limitations under the License. */
 namespace paddle {
 namespace platform {
 
+static std::atomic<int> g_num_threads{1};
+
 void SetNumThreads(int num_threads) {
+  g_num_threads.store(num_threads > 1 ? num_threads : 1);
 #ifdef PADDLE_USE_OPENBLAS
 // windows has no support for openblas multi-thread
 // please refer to: https://github.com/PaddlePaddle/Paddle/issues/7234
@@ -47,5 +51,7 @@ void SetNumThreads(int num_threads) {
 #endif
 }
 
+int GetNumThreads() { return g_num_threads.load(); }
+
 }  // namespace platform
 }  // namespace paddle
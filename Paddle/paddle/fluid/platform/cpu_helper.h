@@ -19,8 +19,12 @@ limitations under the License. */
 namespace paddle {
 namespace platform {
 
-//! Set the number of threads in use.
+//! Set the number of threads of the CPU math library and of the intra-op
+//! thread pool of CPUDeviceContext.
 void SetNumThreads(int num_threads);
 
+//! Get the number of threads last set by SetNumThreads, 1 by default.
+int GetNumThreads();
+
 }  // namespace platform
 }  // namespace paddle
@@ -19,4 +19,7 @@ limitations under the License. */
 TEST(CpuHelper, SetNumThread) {
   paddle::platform::SetNumThreads(1);
   paddle::platform::SetNumThreads(4);
+  EXPECT_EQ(paddle::platform::GetNumThreads(), 4);
+  paddle::platform::SetNumThreads(0);
+  EXPECT_EQ(paddle::platform::GetNumThreads(), 1);
 }
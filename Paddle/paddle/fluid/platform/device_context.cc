@@ -10,20 +10,25 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 #include "paddle/fluid/platform/device_context.h"
+#include <map>
 #include <set>
 #include <string>
 #include <unordered_set>
 #include <vector>
 
 #include "paddle/fluid/memory/memory.h"
+#include "paddle/fluid/platform/cpu_helper.h"
 #ifdef PADDLE_WITH_CUDA
 #include "paddle/fluid/framework/rw_lock.h"
 #include "paddle/fluid/memory/allocation/cuda_device_context_allocator.h"
 #include "paddle/fluid/platform/cuda_device_guard.h"
 #endif
 
+#include "gflags/gflags.h"
 #include "glog/logging.h"
 
+DECLARE_int64(cpu_eigen_parallel_min_numel);
+
 namespace paddle {
 namespace memory {
 
@@ -129,6 +134,48 @@ Eigen::DefaultDevice* CPUDeviceContext::eigen_device() const {
   return eigen_device_.get();
 }
 
+namespace {
+struct EigenThreadPool {
+  explicit EigenThreadPool(int num_threads)
+      : pool(num_threads), device(&pool, num_threads) {}
+
+  Eigen::ThreadPool pool;
+  Eigen::ThreadPoolDevice device;
+};
+
+// The intra-op thread pools are shared by all CPUDeviceContexts, one per
+// number of threads. They are never destroyed, since kernels of other threads
+// may still run on a pool after SetNumThreads changed the number.
+Eigen::ThreadPoolDevice* GetEigenThreadPoolDevice(int num_threads) {
+  thread_local int cached_num_threads = 0;
+  thread_local Eigen::ThreadPoolDevice* cached_device = nullptr;
+  if (cached_num_threads != num_threads) {
+    static std::mutex mutex;
+    static auto* pools = new std::map<int, std::unique_ptr<EigenThreadPool>>();
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& pool = (*pools)[num_threads];
+    if (pool == nullptr) {
+      VLOG(3) << "Create the Eigen intra-op thread pool with " << num_threads
+              << " threads";
+      pool.reset(new EigenThreadPool(num_threads));
+    }
+    cached_device = &pool->device;
+    cached_num_threads = num_threads;
+  }
+  return cached_device;
+}
+}  // namespace
+
+Eigen::ThreadPoolDevice* CPUDeviceContext::eigen_pool_device(
+    int64_t numel) const {
+  int num_threads = GetNumThreads();
+  if (!use_eigen_pool_ || num_threads <= 1 ||
+      numel < FLAGS_cpu_eigen_parallel_min_numel) {
+    return nullptr;
+  }
+  return GetEigenThreadPoolDevice(num_threads);
+}
+
 Place CPUDeviceContext::GetPlace() const { return place_; }
 
 #ifdef PADDLE_WITH_CUDA
@@ -371,6 +418,9 @@ MKLDNNDeviceContext::MKLDNNDeviceContext(CPUPlace place)
     : CPUDeviceContext(place), engine_(mkldnn::engine::cpu, 0), p_blobmap_() {
   p_blobmap_.reset(new BlobMap());
   p_mutex_.reset(new std::mutex());
+  // MKL-DNN primitives run on the OpenMP threads, so the Eigen kernels stay
+  // serial instead of competing with them for the cores.
+  use_eigen_pool_ = false;
 }
 
 namespace {
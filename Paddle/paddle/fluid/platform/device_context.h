@@ -41,6 +41,11 @@ limitations under the License. */
 #endif
 #include "unsupported/Eigen/CXX11/Tensor"
 
+namespace Eigen {
+// Defined with EIGEN_USE_THREADS.
+struct ThreadPoolDevice;
+}  // namespace Eigen
+
 namespace paddle {
 namespace platform {
 
@@ -59,13 +64,45 @@ class CPUDeviceContext : public DeviceContext {
 
   Eigen::DefaultDevice* eigen_device() const;
 
+  /*! \brief  Return the Eigen device of the intra-op thread pool, which has
+   *          as many threads as set by SetNumThreads, for a kernel that
+   *          processes numel elements. Return nullptr if the pool has one
+   *          thread, numel is below FLAGS_cpu_eigen_parallel_min_numel or
+   *          the context does not use the pool, in which case the kernel
+   *          should run on eigen_device(). */
+  Eigen::ThreadPoolDevice* eigen_pool_device(int64_t numel) const;
+
   Place GetPlace() const override;
 
+ protected:
+  // Whether eigen_pool_device may return the intra-op thread pool.
+  bool use_eigen_pool_{true};
+
  private:
   CPUPlace place_;
   std::unique_ptr<Eigen::DefaultDevice> eigen_device_;
 };
 
+/*! \brief  Call functor(device, args...) with the Eigen device of context. */
+template <typename DeviceContext, typename Functor, typename... Args>
+inline void EigenDeviceRun(const DeviceContext& context, int64_t numel,
+                           Functor* functor, Args&&... args) {
+  (*functor)(*context.eigen_device(), std::forward<Args>(args)...);
+}
+
+/*! \brief  Call functor(device, args...) on the intra-op thread pool if the
+ *          kernel is large enough, see CPUDeviceContext::eigen_pool_device. */
+template <typename Functor, typename... Args>
+inline void EigenDeviceRun(const CPUDeviceContext& context, int64_t numel,
+                           Functor* functor, Args&&... args) {
+  auto* pool_device = context.eigen_pool_device(numel);
+  if (pool_device != nullptr) {
+    (*functor)(*pool_device, std::forward<Args>(args)...);
+  } else {
+    (*functor)(*context.eigen_device(), std::forward<Args>(args)...);
+  }
+}
+
 template <typename Place>
 struct DefaultDeviceContextType;
 
@@ -21,6 +21,20 @@
  * NOTE(paddle-dev): This file is designed to define all public FLAGS.
  */
 
+/**
+ * Paddle initialization related FLAG
+ * Name: FLAGS_cpu_eigen_parallel_min_numel
+ * Since Version: 1.7.0
+ * Value Range: int64, default=65536
+ * Example: FLAGS_cpu_eigen_parallel_min_numel=16384, CPU kernels that opt
+ * into the intra-op thread pool use it for tensors of 16384 elements or more.
+ * Note: The pool has as many threads as set by paddle_num_threads or
+ * AnalysisConfig::SetCpuMathLibraryNumThreads, and is unused with 1 thread.
+ */
+DEFINE_int64(cpu_eigen_parallel_min_numel, 65536,
+             "The minimum number of elements for which CPU Eigen kernels "
+             "run on the intra-op thread pool.");
+
 /**
  * Paddle initialization related FLAG
  * Name: FLAGS_paddle_num_threads
@@ -231,6 +245,21 @@ DEFINE_int32(communicator_send_queue_size, 20,
 DEFINE_int32(dist_threadpool_size, 0,
              "number of threads used for distributed executed.");
 
+/**
+ * Distributed related FLAG
+ * Name: FLAGS_cpu_parallel_use_shm
+ * Since Version: 1.7.0
+ * Value Range: bool, default=true
+ * Example: FLAGS_cpu_parallel_use_shm=false, the trainers of data parallel
+ * dygraph training on CPU all-reduce over TCP even on a single host.
+ * Note: Trainers whose endpoints are all on one host exchange gradients
+ *       through POSIX shared memory under /dev/shm, which may be too small in
+ *       containers.
+ */
+DEFINE_bool(cpu_parallel_use_shm, true,
+            "Whether the trainers of data parallel dygraph training on CPU "
+            "all-reduce over shared memory when they are on one host.");
+
 /**
  * Garbage collector related FLAG
  * Name: FLAGS_eager_delete_tensor_gb
@@ -275,6 +304,21 @@ DEFINE_bool(fast_eager_deletion_mode, true,
             "Fast eager deletion mode. If enabled, memory would release "
             "immediately without waiting GPU kernel ends.");
 
+/**
+ * Memory related FLAG
+ * Name: FLAGS_async_cpu_garbage_collection
+ * Since Version: 1.7.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_async_cpu_garbage_collection=true, CPU memory garbage is
+ *          released by a background thread.
+ * Note: Whether to release CPU memory garbage asynchronously, so that freeing
+ *       memory is not on the critical path of ops. Works for the executors
+ *       when garbage collection strategy is enabled, and for the variables
+ *       destroyed in dygraph mode.
+ */
+DEFINE_bool(async_cpu_garbage_collection, false,
+            "Release CPU memory garbage on a background thread.");
+
 /**
  * Memory related FLAG
  * Name: FLAGS_memory_fraction_of_eager_deletion
@@ -451,3 +495,61 @@ DEFINE_double(local_exe_sub_scope_limit, 256.0,  // MBytes
               "each CUDAPlace. If you don't need to limit the memory, "
               "you should set FLAGS_local_exe_sub_scope_limit=-1. "
               "The default value is 256 MBytes.");
+
+/**
+ * Operator related FLAG
+ * Name: FLAGS_enable_op_metrics
+ * Since Version: 1.7.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_enable_op_metrics=true, record latency histograms, call
+ * counts, allocated bytes and input sizes of every kernel invocation.
+ * Note: Unlike the profiler, the metrics are aggregated per thread and are
+ * cheap enough to stay enabled in production.
+ */
+DEFINE_bool(enable_op_metrics, false,
+            "Whether to record always-on per-op latency histograms and "
+            "counters.");
+
+/**
+ * Operator related FLAG
+ * Name: FLAGS_op_metrics_dump_path
+ * Since Version: 1.7.0
+ * Value Range: string, default=empty
+ * Example: FLAGS_op_metrics_dump_path=/tmp/paddle_op_metrics.prom
+ * Note: If set together with FLAGS_enable_op_metrics, the op metrics are
+ * written to this file in Prometheus text format when the process exits.
+ */
+DEFINE_string(op_metrics_dump_path, "",
+              "The file to dump the op metrics to in Prometheus text format "
+              "at exit. Empty means no dump.");
+
+/**
+ * Executor related FLAG
+ * Name: FLAGS_executor_plan_cache_capacity
+ * Since Version: 1.7.0
+ * Value Range: int32, default=0
+ * Example: FLAGS_executor_plan_cache_capacity=8, the Executor compiles a
+ * prepared block into an execution plan per shape signature of its feeds,
+ * and keeps the 8 most recently used plans.
+ * Note: Plans are only used when the block runs directly in the given scope,
+ * e.g. Executor.run with use_program_cache=True. 0 disables the plans.
+ */
+DEFINE_int32(executor_plan_cache_capacity, 0,
+             "The number of shape-specialized execution plans the Executor "
+             "caches per prepared block. 0 means no plan is used.");
+
+/**
+ * Executor related FLAG
+ * Name: FLAGS_executor_plan_static_memory
+ * Since Version: 1.7.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_executor_plan_static_memory=true, each execution plan places
+ * the intermediate tensors of its prepared ops in one preallocated workspace,
+ * so they are not allocated at runtime.
+ * Note: Works with FLAGS_executor_plan_cache_capacity > 0, and takes the
+ * lifetimes of the tensors from garbage collection, so
+ * FLAGS_eager_delete_tensor_gb must be >= 0.
+ */
+DEFINE_bool(executor_plan_static_memory, false,
+            "Whether execution plans place the intermediate tensors in one "
+            "preallocated workspace.");
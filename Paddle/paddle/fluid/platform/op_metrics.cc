@@ -0,0 +1,414 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/platform/op_metrics.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <tuple>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace platform {
+
+int LatencyHistogram::BucketIndex(uint64_t value) {
+  if (value < static_cast<uint64_t>(kSubBuckets)) {
+    return static_cast<int>(value);
+  }
+  int highest_bit = 63 - __builtin_clzll(value);
+  if (highest_bit >= kMaxBits) return kNumBuckets - 1;
+  int shift = highest_bit - kSubBucketBits;
+  int sub = static_cast<int>(value >> shift) - kSubBuckets;
+  return (shift + 1) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(int index) {
+  if (index < kSubBuckets) return static_cast<uint64_t>(index);
+  if (index >= kNumBuckets - 1) return std::numeric_limits<uint64_t>::max();
+  int shift = index / kSubBuckets - 1;
+  uint64_t sub = static_cast<uint64_t>(index % kSubBuckets);
+  uint64_t lower = (sub + kSubBuckets) << shift;
+  return lower + (1ULL << shift) - 1;
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+  if (other.count_ == 0) return;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    counts_[i] += other.counts_[i];
+  }
+  count_ += other.count_;
+  sum_ += other.sum_;
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+}
+
+void LatencyHistogram::Reset() {
+  counts_.fill(0);
+  count_ = 0;
+  sum_ = 0;
+  min_ = std::numeric_limits<uint64_t>::max();
+  max_ = 0;
+}
+
+uint64_t LatencyHistogram::Percentile(double q) const {
+  if (count_ == 0) return 0;
+  q = std::min(std::max(q, 0.0), 1.0);
+  uint64_t rank = static_cast<uint64_t>(q * (count_ - 1)) + 1;
+  uint64_t seen = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    seen += counts_[i];
+    if (seen >= rank) return std::min(BucketUpperBound(i), max_);
+  }
+  return max_;
+}
+
+void OpMetrics::Merge(const OpMetrics& other) {
+  calls += other.calls;
+  bytes_allocated += other.bytes_allocated;
+  latency_ns.Merge(other.latency_ns);
+  for (int i = 0; i < kNumShapeBuckets; ++i) {
+    input_numel_buckets[i] += other.input_numel_buckets[i];
+  }
+}
+
+void OpMetrics::Reset() {
+  calls = 0;
+  bytes_allocated = 0;
+  latency_ns.Reset();
+  input_numel_buckets.fill(0);
+}
+
+static thread_local uint64_t thread_allocated_bytes = 0;
+
+void RecordThreadAllocatedBytes(size_t bytes) {
+  thread_allocated_bytes += bytes;
+}
+
+uint64_t ThreadAllocatedBytes() { return thread_allocated_bytes; }
+
+static thread_local uint32_t op_latency_tick = 0;
+
+bool SampleOpLatency() {
+  return op_latency_tick++ % OpMetricsRegistry::kLatencySamplePeriod == 0;
+}
+
+OpMetricsRegistry::Counters::Counters() : calls(0), bytes_allocated(0) {
+  for (auto& count : input_numel_buckets) {
+    count.store(0, std::memory_order_relaxed);
+  }
+}
+
+// Owns the shard of one thread, and hands it back to the registry when the
+// thread exits so that its metrics are not lost.
+struct OpMetricsRegistry::ShardHolder {
+  ShardHolder() : shard(new Shard) {
+    auto& registry = OpMetricsRegistry::Instance();
+    std::lock_guard<std::mutex> guard(registry.mu_);
+    registry.shards_.emplace_back(shard);
+  }
+  ~ShardHolder() { OpMetricsRegistry::Instance().RetireShard(shard); }
+
+  std::shared_ptr<Shard> shard;
+};
+
+OpMetricsRegistry& OpMetricsRegistry::Instance() {
+  // Intentionally leaked: thread-local shard holders may be destroyed after
+  // static destructors have run.
+  static OpMetricsRegistry* registry = new OpMetricsRegistry();
+  return *registry;
+}
+
+static void DumpOpMetricsAtExit() {
+  if (!FLAGS_enable_op_metrics || FLAGS_op_metrics_dump_path.empty()) return;
+  try {
+    OpMetricsRegistry::Instance().DumpPrometheusText(
+        FLAGS_op_metrics_dump_path);
+  } catch (std::exception& ex) {
+    LOG(WARNING) << "Failed to dump op metrics: " << ex.what();
+  }
+}
+
+int OpMetricsRegistry::GetOrCreateKey(const std::string& op_type,
+                                      const std::string& kernel_key) {
+  // Registered lazily, after the flags have been constructed, so that the
+  // handler runs before they are destroyed.
+  static std::once_flag dump_at_exit_flag;
+  std::call_once(dump_at_exit_flag,
+                 [] { std::atexit(&DumpOpMetricsAtExit); });
+
+  std::string name = op_type + '\x01' + kernel_key;
+  std::lock_guard<std::mutex> guard(mu_);
+  auto it = key_ids_.find(name);
+  if (it != key_ids_.end()) return it->second;
+  int id = static_cast<int>(keys_.size());
+  keys_.emplace_back(op_type, kernel_key);
+  key_ids_.emplace(std::move(name), id);
+  return id;
+}
+
+OpMetricsRegistry::Shard* OpMetricsRegistry::LocalShard() {
+  // The cached pointer spares later calls the initialization check of the
+  // thread_local holder.
+  static thread_local Shard* shard = nullptr;
+  if (shard == nullptr) {
+    static thread_local ShardHolder holder;
+    shard = holder.shard.get();
+  }
+  return shard;
+}
+
+OpMetricsRegistry::Counters* OpMetricsRegistry::LocalCounters(Shard* shard,
+                                                              int key) {
+  PADDLE_ENFORCE_GE(key, 0, "Invalid op metrics key %d", key);
+  if (static_cast<size_t>(key) >= shard->counters.size()) {
+    std::lock_guard<std::mutex> guard(shard->mu);
+    shard->counters.resize(key + 1);
+  }
+  return &shard->counters[key];
+}
+
+// The owning thread is the only writer of a counter, so it needs no atomic
+// read-modify-write.
+static void Increment(std::atomic<uint64_t>* counter, uint64_t value) {
+  counter->store(counter->load(std::memory_order_relaxed) + value,
+                 std::memory_order_relaxed);
+}
+
+void OpMetricsRegistry::RecordCall(int key, uint64_t bytes_allocated,
+                                   int64_t input_numel) {
+  Counters* counters = LocalCounters(LocalShard(), key);
+  Increment(&counters->calls, 1);
+  Increment(&counters->bytes_allocated, bytes_allocated);
+  Increment(&counters->input_numel_buckets[ShapeBucketIndex(input_numel)], 1);
+}
+
+void OpMetricsRegistry::Record(int key, uint64_t elapsed_ns,
+                               uint64_t bytes_allocated, int64_t input_numel) {
+  RecordCall(key, bytes_allocated, input_numel);
+  Shard* shard = LocalShard();
+  std::lock_guard<std::mutex> guard(shard->mu);
+  if (static_cast<size_t>(key) >= shard->metrics.size()) {
+    shard->metrics.resize(key + 1);
+  }
+  shard->metrics[key].latency_ns.Record(elapsed_ns);
+}
+
+int OpMetricsRegistry::ShapeBucketIndex(int64_t numel) {
+  if (numel <= 0) return 0;
+  int bucket = 64 - __builtin_clzll(static_cast<uint64_t>(numel));
+  return std::min(bucket, OpMetrics::kNumShapeBuckets - 1);
+}
+
+void OpMetricsRegistry::LoadCounters(const Counters& counters,
+                                     OpMetrics* metrics) {
+  metrics->calls = counters.calls.load(std::memory_order_relaxed);
+  metrics->bytes_allocated =
+      counters.bytes_allocated.load(std::memory_order_relaxed);
+  for (int i = 0; i < OpMetrics::kNumShapeBuckets; ++i) {
+    metrics->input_numel_buckets[i] =
+        counters.input_numel_buckets[i].load(std::memory_order_relaxed);
+  }
+}
+
+void OpMetricsRegistry::MergeShard(const Shard& src,
+                                   std::vector<OpMetrics>* dst) {
+  if (dst->size() < src.counters.size()) dst->resize(src.counters.size());
+  OpMetrics metrics;
+  for (size_t i = 0; i < src.counters.size(); ++i) {
+    LoadCounters(src.counters[i], &metrics);
+    metrics.latency_ns.Reset();
+    if (i < src.metrics.size()) {
+      // Counted since the last Reset.
+      auto& origin = src.metrics[i];
+      metrics.calls -= origin.calls;
+      metrics.bytes_allocated -= origin.bytes_allocated;
+      for (int j = 0; j < OpMetrics::kNumShapeBuckets; ++j) {
+        metrics.input_numel_buckets[j] -= origin.input_numel_buckets[j];
+      }
+      metrics.latency_ns = origin.latency_ns;
+    }
+    (*dst)[i].Merge(metrics);
+  }
+}
+
+void OpMetricsRegistry::RetireShard(const std::shared_ptr<Shard>& shard) {
+  std::lock_guard<std::mutex> guard(mu_);
+  {
+    std::lock_guard<std::mutex> shard_guard(shard->mu);
+    MergeShard(*shard, &retired_);
+  }
+  shards_.erase(std::remove(shards_.begin(), shards_.end(), shard),
+                shards_.end());
+}
+
+std::vector<OpMetricsRecord> OpMetricsRegistry::Snapshot() const {
+  std::vector<OpMetrics> merged;
+  std::vector<std::pair<std::string, std::string>> keys;
+  {
+    std::lock_guard<std::mutex> guard(mu_);
+    keys = keys_;
+    merged = retired_;
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> shard_guard(shard->mu);
+      MergeShard(*shard, &merged);
+    }
+  }
+
+  std::vector<OpMetricsRecord> records;
+  for (size_t i = 0; i < merged.size(); ++i) {
+    if (merged[i].calls == 0) continue;
+    OpMetricsRecord record;
+    record.op_type = keys[i].first;
+    record.kernel_key = keys[i].second;
+    record.metrics = merged[i];
+    records.emplace_back(std::move(record));
+  }
+  std::sort(records.begin(), records.end(),
+            [](const OpMetricsRecord& a, const OpMetricsRecord& b) {
+              return std::tie(a.op_type, a.kernel_key) <
+                     std::tie(b.op_type, b.kernel_key);
+            });
+  return records;
+}
+
+std::vector<OpMetricsRecord> OpMetricsRegistry::SnapshotByOpType() const {
+  std::map<std::string, OpMetrics> by_type;
+  for (auto& record : Snapshot()) {
+    by_type[record.op_type].Merge(record.metrics);
+  }
+  std::vector<OpMetricsRecord> records;
+  records.reserve(by_type.size());
+  for (auto& pair : by_type) {
+    OpMetricsRecord record;
+    record.op_type = pair.first;
+    record.metrics = pair.second;
+    records.emplace_back(std::move(record));
+  }
+  return records;
+}
+
+void OpMetricsRegistry::Reset() {
+  std::lock_guard<std::mutex> guard(mu_);
+  retired_.clear();
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> shard_guard(shard->mu);
+    // The current counts become the origin of the next snapshots.
+    shard->metrics.resize(shard->counters.size());
+    for (size_t i = 0; i < shard->counters.size(); ++i) {
+      shard->metrics[i].latency_ns.Reset();
+      LoadCounters(shard->counters[i], &shard->metrics[i]);
+    }
+  }
+}
+
+static std::string EscapeLabel(const std::string& value) {
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (char c : value) {
+    if (c == '\\' || c == '"') {
+      escaped.push_back('\\');
+      escaped.push_back(c);
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped.push_back(c);
+    }
+  }
+  return escaped;
+}
+
+std::string OpMetricsRegistry::ToPrometheusText() const {
+  auto records = Snapshot();
+  std::ostringstream os;
+
+  auto labels = [](const OpMetricsRecord& record) {
+    return "op_type=\"" + EscapeLabel(record.op_type) + "\",kernel=\"" +
+           EscapeLabel(record.kernel_key) + "\"";
+  };
+
+  os << "# HELP paddle_op_calls_total Number of kernel invocations.\n"
+     << "# TYPE paddle_op_calls_total counter\n";
+  for (auto& record : records) {
+    os << "paddle_op_calls_total{" << labels(record) << "} "
+       << record.metrics.calls << "\n";
+  }
+
+  os << "# HELP paddle_op_allocated_bytes_total Bytes allocated by kernels.\n"
+     << "# TYPE paddle_op_allocated_bytes_total counter\n";
+  for (auto& record : records) {
+    os << "paddle_op_allocated_bytes_total{" << labels(record) << "} "
+       << record.metrics.bytes_allocated << "\n";
+  }
+
+  // Only the non-empty buckets are exported to keep the dump small; the
+  // cumulative counts stay correct because every emitted `le` is monotonic.
+  os << "# HELP paddle_op_latency_seconds Sampled kernel latency.\n"
+     << "# TYPE paddle_op_latency_seconds histogram\n";
+  for (auto& record : records) {
+    auto& hist = record.metrics.latency_ns;
+    uint64_t cumulative = 0;
+    for (int i = 0; i < LatencyHistogram::kNumBuckets - 1; ++i) {
+      if (hist.Buckets()[i] == 0) continue;
+      cumulative += hist.Buckets()[i];
+      os << "paddle_op_latency_seconds_bucket{" << labels(record) << ",le=\""
+         << (LatencyHistogram::BucketUpperBound(i) + 1) * 1e-9 << "\"} "
+         << cumulative << "\n";
+    }
+    os << "paddle_op_latency_seconds_bucket{" << labels(record)
+       << ",le=\"+Inf\"} " << hist.Count() << "\n";
+    os << "paddle_op_latency_seconds_sum{" << labels(record) << "} "
+       << hist.Sum() * 1e-9 << "\n";
+    os << "paddle_op_latency_seconds_count{" << labels(record) << "} "
+       << hist.Count() << "\n";
+  }
+
+  os << "# HELP paddle_op_input_numel Numel of the largest input.\n"
+     << "# TYPE paddle_op_input_numel histogram\n";
+  for (auto& record : records) {
+    uint64_t cumulative = 0;
+    for (int i = 0; i < OpMetrics::kNumShapeBuckets - 1; ++i) {
+      uint64_t count = record.metrics.input_numel_buckets[i];
+      if (count == 0) continue;
+      cumulative += count;
+      os << "paddle_op_input_numel_bucket{" << labels(record) << ",le=\""
+         << ((1ULL << i) - 1) << "\"} " << cumulative << "\n";
+    }
+    os << "paddle_op_input_numel_bucket{" << labels(record)
+       << ",le=\"+Inf\"} " << record.metrics.calls << "\n";
+    os << "paddle_op_input_numel_count{" << labels(record) << "} "
+       << record.metrics.calls << "\n";
+  }
+  return os.str();
+}
+
+void OpMetricsRegistry::DumpPrometheusText(const std::string& path) const {
+  // Write to a temporary file first so that scrapers never observe a
+  // partially written dump.
+  std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream fout(tmp_path, std::ios::out | std::ios::trunc);
+    PADDLE_ENFORCE(fout.is_open(), "Cannot open %s to dump op metrics",
+                   tmp_path);
+    fout << ToPrometheusText();
+  }
+  PADDLE_ENFORCE_EQ(std::rename(tmp_path.c_str(), path.c_str()), 0,
+                    "Cannot rename %s to %s", tmp_path, path);
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,246 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <gflags/gflags.h>
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/platform/macros.h"
+
+DECLARE_bool(enable_op_metrics);
+DECLARE_string(op_metrics_dump_path);
+
+namespace paddle {
+namespace platform {
+
+/**
+ * A log-linear latency histogram in the spirit of HdrHistogram. Values below
+ * kSubBuckets are stored exactly; larger values are grouped by their highest
+ * set bit, and every power of two is split into kSubBuckets linear buckets,
+ * so the relative error of any reported percentile is below 1/kSubBuckets.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 3;
+  static constexpr int kSubBuckets = 1 << kSubBucketBits;
+  // Values >= 2^kMaxBits are clamped into the last bucket (~39 hours in ns).
+  static constexpr int kMaxBits = 47;
+  static constexpr int kNumBuckets =
+      (kMaxBits - kSubBucketBits + 1) * kSubBuckets;
+
+  LatencyHistogram() { Reset(); }
+
+  void Record(uint64_t value) {
+    ++counts_[BucketIndex(value)];
+    ++count_;
+    sum_ += value;
+    if (value < min_) min_ = value;
+    if (value > max_) max_ = value;
+  }
+
+  void Merge(const LatencyHistogram& other);
+  void Reset();
+
+  uint64_t Count() const { return count_; }
+  uint64_t Sum() const { return sum_; }
+  uint64_t Min() const { return count_ == 0 ? 0 : min_; }
+  uint64_t Max() const { return max_; }
+  double Mean() const {
+    return count_ == 0 ? 0.0 : static_cast<double>(sum_) / count_;
+  }
+
+  // Returns the upper bound of the bucket that holds the q-th quantile,
+  // q in [0, 1].
+  uint64_t Percentile(double q) const;
+
+  const std::array<uint64_t, kNumBuckets>& Buckets() const { return counts_; }
+
+  static int BucketIndex(uint64_t value);
+  // The largest value that falls into bucket `index`.
+  static uint64_t BucketUpperBound(int index);
+
+ private:
+  std::array<uint64_t, kNumBuckets> counts_;
+  uint64_t count_;
+  uint64_t sum_;
+  uint64_t min_;
+  uint64_t max_;
+};
+
+/**
+ * The metrics of one (op type, kernel key) pair. Inputs are bucketed by the
+ * numel of the largest input, in powers of two. Calls, bytes and input numels
+ * are exact, while latency_ns only holds the sampled calls.
+ */
+struct OpMetrics {
+  static constexpr int kNumShapeBuckets = 32;
+
+  OpMetrics() { Reset(); }
+
+  void Merge(const OpMetrics& other);
+  void Reset();
+
+  uint64_t calls;
+  uint64_t bytes_allocated;
+  LatencyHistogram latency_ns;
+  std::array<uint64_t, kNumShapeBuckets> input_numel_buckets;
+};
+
+struct OpMetricsRecord {
+  std::string op_type;
+  std::string kernel_key;
+  OpMetrics metrics;
+};
+
+/**
+ * Process-wide registry of always-on operator metrics, enabled by
+ * FLAGS_enable_op_metrics.
+ *
+ * Every (op type, kernel key) pair is interned once into a dense id, which
+ * callers cache. Each thread records into its own shard, indexed by id. Calls
+ * are counted without any lock, and only one call in kLatencySamplePeriod per
+ * thread is timed and recorded under the shard's uncontended lock, since
+ * reading the clock costs more than the rest of the bookkeeping. Shards are
+ * merged when a snapshot is taken and folded into the retired metrics when
+ * their thread exits.
+ */
+class OpMetricsRegistry {
+ public:
+  static constexpr int kLatencySamplePeriod = 16;
+
+  static OpMetricsRegistry& Instance();
+
+  int GetOrCreateKey(const std::string& op_type, const std::string& kernel_key);
+
+  // Counts one call and records its latency.
+  void Record(int key, uint64_t elapsed_ns, uint64_t bytes_allocated,
+              int64_t input_numel);
+  // Counts one call whose latency is not sampled.
+  void RecordCall(int key, uint64_t bytes_allocated, int64_t input_numel);
+
+  // Metrics of every kernel key, sorted by op type and kernel key.
+  std::vector<OpMetricsRecord> Snapshot() const;
+  // Metrics aggregated over kernel keys, kernel_key is left empty.
+  std::vector<OpMetricsRecord> SnapshotByOpType() const;
+
+  void Reset();
+
+  std::string ToPrometheusText() const;
+  void DumpPrometheusText(const std::string& path) const;
+
+  static int ShapeBucketIndex(int64_t numel);
+
+ private:
+  // Only written by the thread owning the shard, so relaxed loads and stores
+  // are enough while snapshots read them concurrently. They never decrease,
+  // Reset records their values as the new origin instead.
+  struct Counters {
+    Counters();
+
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> bytes_allocated;
+    std::array<std::atomic<uint64_t>, OpMetrics::kNumShapeBuckets>
+        input_numel_buckets;
+  };
+  struct Shard {
+    std::mutex mu;
+    // Grown by the owning thread only, under mu.
+    std::deque<Counters> counters;
+    // Guarded by mu: the sampled latencies, and the counters at the last
+    // Reset.
+    std::vector<OpMetrics> metrics;
+  };
+  struct ShardHolder;
+
+  OpMetricsRegistry() = default;
+
+  Shard* LocalShard();
+  Counters* LocalCounters(Shard* shard, int key);
+  void RetireShard(const std::shared_ptr<Shard>& shard);
+  static void LoadCounters(const Counters& counters, OpMetrics* metrics);
+  static void MergeShard(const Shard& src, std::vector<OpMetrics>* dst);
+
+  mutable std::mutex mu_;
+  std::unordered_map<std::string, int> key_ids_;
+  std::vector<std::pair<std::string, std::string>> keys_;
+  std::vector<std::shared_ptr<Shard>> shards_;
+  // The metrics of exited threads, guarded by mu_.
+  std::vector<OpMetrics> retired_;
+
+  DISABLE_COPY_AND_ASSIGN(OpMetricsRegistry);
+};
+
+// A monotonic count of the bytes allocated by the current thread. Fed by
+// memory::Alloc when op metrics are enabled.
+void RecordThreadAllocatedBytes(size_t bytes);
+uint64_t ThreadAllocatedBytes();
+
+// Whether the latency of the current thread's next call should be sampled.
+bool SampleOpLatency();
+
+/**
+ * Measures one kernel invocation and records it on destruction. Does nothing
+ * if `key` is negative.
+ *
+ * Usage:
+ *   RecordOpMetrics record(key, input_numel);
+ *   kernel(ctx);
+ */
+class RecordOpMetrics {
+ public:
+  RecordOpMetrics(int key, int64_t input_numel)
+      : key_(key), input_numel_(input_numel) {
+    if (key_ < 0) return;
+    alloc_start_ = ThreadAllocatedBytes();
+    timed_ = SampleOpLatency();
+    if (timed_) start_ = std::chrono::steady_clock::now();
+  }
+
+  ~RecordOpMetrics() {
+    if (key_ < 0) return;
+    uint64_t bytes_allocated = ThreadAllocatedBytes() - alloc_start_;
+    if (!timed_) {
+      OpMetricsRegistry::Instance().RecordCall(key_, bytes_allocated,
+                                               input_numel_);
+      return;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - start_)
+                       .count();
+    OpMetricsRegistry::Instance().Record(key_, static_cast<uint64_t>(elapsed),
+                                         bytes_allocated, input_numel_);
+  }
+
+ private:
+  int key_;
+  int64_t input_numel_;
+  uint64_t alloc_start_;
+  bool timed_;
+  std::chrono::steady_clock::time_point start_;
+
+  DISABLE_COPY_AND_ASSIGN(RecordOpMetrics);
+};
+
+}  // namespace platform
+}  // namespace paddle
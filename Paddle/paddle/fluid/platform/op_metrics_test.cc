@@ -0,0 +1,220 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/platform/op_metrics.h"
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace platform {
+
+TEST(LatencyHistogram, BucketBounds) {
+  for (uint64_t v : {0ULL, 1ULL, 7ULL, 8ULL, 9ULL, 15ULL, 16ULL, 1000ULL,
+                     123456789ULL}) {
+    int idx = LatencyHistogram::BucketIndex(v);
+    EXPECT_LE(v, LatencyHistogram::BucketUpperBound(idx));
+    if (idx > 0) {
+      EXPECT_GT(v, LatencyHistogram::BucketUpperBound(idx - 1));
+    }
+  }
+  // Buckets are contiguous.
+  for (int i = 1; i < LatencyHistogram::kNumBuckets - 1; ++i) {
+    EXPECT_EQ(LatencyHistogram::BucketIndex(
+                  LatencyHistogram::BucketUpperBound(i - 1) + 1),
+              i);
+    EXPECT_EQ(
+        LatencyHistogram::BucketIndex(LatencyHistogram::BucketUpperBound(i)),
+        i);
+  }
+}
+
+TEST(LatencyHistogram, Percentile) {
+  LatencyHistogram hist;
+  for (uint64_t v = 1; v <= 1000; ++v) {
+    hist.Record(v * 1000);
+  }
+  EXPECT_EQ(hist.Count(), 1000UL);
+  EXPECT_EQ(hist.Min(), 1000UL);
+  EXPECT_EQ(hist.Max(), 1000000UL);
+  EXPECT_EQ(hist.Percentile(1.0), 1000000UL);
+  // The relative error is bounded by the sub-bucket resolution.
+  double p50 = static_cast<double>(hist.Percentile(0.5));
+  EXPECT_NEAR(p50, 500000.0, 500000.0 / LatencyHistogram::kSubBuckets);
+  double p99 = static_cast<double>(hist.Percentile(0.99));
+  EXPECT_NEAR(p99, 990000.0, 990000.0 / LatencyHistogram::kSubBuckets);
+}
+
+TEST(OpMetricsRegistry, RecordFromThreads) {
+  auto& registry = OpMetricsRegistry::Instance();
+  registry.Reset();
+  int cpu_key = registry.GetOrCreateKey("test_op", "place[CPUPlace]");
+  int other_key = registry.GetOrCreateKey("test_op", "place[CUDAPlace(0)]");
+  EXPECT_EQ(cpu_key, registry.GetOrCreateKey("test_op", "place[CPUPlace]"));
+  EXPECT_NE(cpu_key, other_key);
+
+  const int kThreads = 4;
+  const int kCalls = 100;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < kCalls; ++i) {
+        registry.Record(cpu_key, 1000, 16, 100);
+        registry.Record(other_key, 2000, 0, 1);
+      }
+    });
+  }
+  for (auto& th : threads) th.join();
+  // Metrics of exited threads are kept.
+  auto records = registry.Snapshot();
+  ASSERT_EQ(records.size(), 2UL);
+  for (auto& record : records) {
+    EXPECT_EQ(record.metrics.calls, static_cast<uint64_t>(kThreads * kCalls));
+  }
+  auto& cpu_record = records[0].kernel_key == "place[CPUPlace]" ? records[0]
+                                                                : records[1];
+  EXPECT_EQ(cpu_record.metrics.bytes_allocated,
+            static_cast<uint64_t>(16 * kThreads * kCalls));
+  EXPECT_EQ(cpu_record.metrics.input_numel_buckets[OpMetricsRegistry::
+                                                       ShapeBucketIndex(100)],
+            static_cast<uint64_t>(kThreads * kCalls));
+
+  auto by_type = registry.SnapshotByOpType();
+  ASSERT_EQ(by_type.size(), 1UL);
+  EXPECT_EQ(by_type[0].op_type, "test_op");
+  EXPECT_EQ(by_type[0].metrics.calls,
+            static_cast<uint64_t>(2 * kThreads * kCalls));
+
+  registry.Reset();
+  EXPECT_TRUE(registry.Snapshot().empty());
+}
+
+TEST(OpMetricsRegistry, RecordOpMetrics) {
+  auto& registry = OpMetricsRegistry::Instance();
+  registry.Reset();
+  int key = registry.GetOrCreateKey("scoped_op", "");
+  {
+    RecordOpMetrics record(key, 1024);
+    RecordThreadAllocatedBytes(256);
+  }
+  { RecordOpMetrics record(-1, 1024); }
+  auto records = registry.Snapshot();
+  ASSERT_EQ(records.size(), 1UL);
+  EXPECT_EQ(records[0].metrics.calls, 1UL);
+  EXPECT_EQ(records[0].metrics.bytes_allocated, 256UL);
+}
+
+TEST(OpMetricsRegistry, SampledLatency) {
+  auto& registry = OpMetricsRegistry::Instance();
+  registry.Reset();
+  int key = registry.GetOrCreateKey("sampled_op", "");
+  const int kRuns = 10 * OpMetricsRegistry::kLatencySamplePeriod;
+  for (int i = 0; i < kRuns; ++i) {
+    RecordOpMetrics record(key, 8);
+  }
+  auto records = registry.Snapshot();
+  ASSERT_EQ(records.size(), 1UL);
+  EXPECT_EQ(records[0].metrics.calls, static_cast<uint64_t>(kRuns));
+  EXPECT_EQ(records[0].metrics.input_numel_buckets[4],
+            static_cast<uint64_t>(kRuns));
+  EXPECT_EQ(records[0].metrics.latency_ns.Count(), 10UL);
+
+  // Reset restarts the counts, later calls are still counted.
+  registry.Reset();
+  EXPECT_TRUE(registry.Snapshot().empty());
+  { RecordOpMetrics record(key, 8); }
+  records = registry.Snapshot();
+  ASSERT_EQ(records.size(), 1UL);
+  EXPECT_EQ(records[0].metrics.calls, 1UL);
+  registry.Reset();
+}
+
+// The best of a few timings of fn, in ns per run.
+template <typename Fn>
+static double BestTimePerRun(int runs, Fn fn) {
+  double best = 0;
+  for (int repeat = 0; repeat < 5; ++repeat) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; ++i) fn(i);
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    double per_run = elapsed.count() / runs;
+    if (repeat == 0 || per_run < best) best = per_run;
+  }
+  return best;
+}
+
+TEST(OpMetricsRegistry, RecordOverhead) {
+  auto& registry = OpMetricsRegistry::Instance();
+  registry.Reset();
+  int key = registry.GetOrCreateKey("overhead_op", "");
+  const int kRuns = 100000;
+  double disabled_ns =
+      BestTimePerRun(kRuns, [](int i) { RecordOpMetrics record(-1, i); });
+  double enabled_ns =
+      BestTimePerRun(kRuns, [key](int i) { RecordOpMetrics record(key, i); });
+  double overhead_ns = enabled_ns - disabled_ns;
+
+  // A stand-in for a small CPU kernel: exp over 1024 floats.
+  std::vector<float> x(1024, 0.5f), y(1024);
+  double kernel_ns = BestTimePerRun(1000, [&](int i) {
+    x[0] = static_cast<float>(i % 7);
+    for (size_t j = 0; j < x.size(); ++j) y[j] = std::exp(x[j]);
+  });
+  LOG(INFO) << "RecordOpMetrics costs " << overhead_ns << " ns per run, "
+            << overhead_ns / kernel_ns * 100 << "% of a " << kernel_ns
+            << " ns kernel";
+#ifdef NDEBUG
+  // Timings are only meaningful in optimized builds.
+  EXPECT_LT(overhead_ns, 0.01 * kernel_ns);
+#endif
+  EXPECT_EQ(registry.Snapshot()[0].metrics.calls,
+            static_cast<uint64_t>(5 * kRuns));
+  registry.Reset();
+}
+
+TEST(OpMetricsRegistry, PrometheusText) {
+  auto& registry = OpMetricsRegistry::Instance();
+  registry.Reset();
+  int key = registry.GetOrCreateKey("prom_op", "data_type[float]");
+  registry.Record(key, 1500, 0, 8);
+  registry.Record(key, 3000000, 0, 8);
+
+  std::string text = registry.ToPrometheusText();
+  EXPECT_NE(text.find("# TYPE paddle_op_latency_seconds histogram"),
+            std::string::npos);
+  EXPECT_NE(text.find("paddle_op_calls_total{op_type=\"prom_op\","
+                      "kernel=\"data_type[float]\"} 2"),
+            std::string::npos);
+  EXPECT_NE(text.find("le=\"+Inf\"} 2"), std::string::npos);
+
+  std::string path = "op_metrics_test.prom";
+  registry.DumpPrometheusText(path);
+  std::ifstream fin(path);
+  std::stringstream buffer;
+  buffer << fin.rdbuf();
+  EXPECT_EQ(buffer.str(), text);
+  std::remove(path.c_str());
+  registry.Reset();
+}
+
+}  // namespace platform
+}  // namespace paddle
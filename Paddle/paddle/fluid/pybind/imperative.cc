@@ -25,9 +25,12 @@ limitations under the License. */
 #include <utility>
 #include <vector>
 #include "paddle/fluid/imperative/backward_strategy.h"
+#include "paddle/fluid/imperative/cpu_parallel_context.h"
+#include "paddle/fluid/imperative/gradient_accumulator.h"
 #include "paddle/fluid/imperative/layer.h"
 #include "paddle/fluid/imperative/nccl_context.h"
 #include "paddle/fluid/imperative/profiler.h"
+#include "paddle/fluid/imperative/reducer.h"
 #include "paddle/fluid/imperative/tracer.h"
 #include "paddle/fluid/imperative/type_defs.h"
 
@@ -310,7 +313,23 @@ void BindImperative(py::module *m_ptr) {
                     &imperative::VarBase::SetPersistable)
       .def_property("stop_gradient",
                     &imperative::VarBase::OverridedStopGradient,
-                    &imperative::VarBase::SetOverridedStopGradient);
+                    &imperative::VarBase::SetOverridedStopGradient)
+      .def_property("_accumulate_grad", &imperative::VarBase::AccumulateGrad,
+                    &imperative::VarBase::SetAccumulateGrad);
+
+  py::class_<imperative::GradientBuffer,
+             std::shared_ptr<imperative::GradientBuffer>>(
+      m, "GradientBuffer", R"DOC(
+      Keeps the gradients of parameters in one contiguous buffer, and sums the
+      gradients of successive backward into it. The parameters should be of
+      the same data type and place.
+      )DOC")
+      .def(py::init<const std::vector<std::shared_ptr<imperative::VarBase>>
+                        &>())
+      .def("clear", &imperative::GradientBuffer::Clear)
+      .def_property_readonly("buffer", &imperative::GradientBuffer::Buffer)
+      .def_property_readonly("num_params",
+                             &imperative::GradientBuffer::NumParams);
 
   py::class_<imperative::Layer, Layer /* <--- trampoline*/> layer(m, "Layer");
   layer.def(py::init<>())
@@ -348,7 +367,9 @@ void BindImperative(py::module *m_ptr) {
                self.TraceOp(type, std::move(ins_map), std::move(outs_map),
                             std::move(attrs), place, trace_backward);
              }
-           });
+           })
+      .def("_begin_checkpoint", &imperative::Tracer::BeginCheckpoint)
+      .def("_end_checkpoint", &imperative::Tracer::EndCheckpoint);
 
   // define parallel context
   py::class_<imperative::ParallelStrategy> parallel_strategy(
@@ -390,6 +411,60 @@ void BindImperative(py::module *m_ptr) {
                     const platform::CUDAPlace &>())
       .def("init", [](imperative::NCCLParallelContext &self) { self.Init(); });
 #endif
+#if !defined(_WIN32)
+  py::class_<imperative::CPUParallelContext,
+             std::shared_ptr<imperative::CPUParallelContext>>
+      cpu_ctx(m, "CPUParallelContext");
+
+  cpu_ctx
+      .def(py::init<const imperative::ParallelStrategy &,
+                    const platform::CPUPlace &>())
+      .def("init", &imperative::CPUParallelContext::Init,
+           py::call_guard<py::gil_scoped_release>())
+      .def("all_reduce",
+           [](imperative::CPUParallelContext &self,
+              imperative::VarBase &var) {
+             auto *tensor =
+                 var.MutableVar()->GetMutable<framework::LoDTensor>();
+             self.AllReduce(tensor);
+           },
+           py::call_guard<py::gil_scoped_release>())
+      .def("broadcast",
+           [](imperative::CPUParallelContext &self, imperative::VarBase &var,
+              int root) {
+             auto *tensor =
+                 var.MutableVar()->GetMutable<framework::LoDTensor>();
+             self.Broadcast(tensor, root);
+           },
+           py::call_guard<py::gil_scoped_release>())
+      .def_property_readonly("use_shared_memory",
+                             &imperative::CPUParallelContext::UseSharedMemory);
+
+  py::class_<imperative::Reducer, std::shared_ptr<imperative::Reducer>>(
+      m, "Reducer", R"DOC(
+      All-reduces the gradients of parameters in buckets of bucket_size bytes
+      while backward runs. The parameters should be in the reverse order of
+      forward, and finalize should be called after each backward.
+      )DOC")
+      .def(py::init([](std::shared_ptr<imperative::CPUParallelContext> ctx,
+                       const std::vector<std::shared_ptr<imperative::VarBase>>
+                           &params,
+                       size_t bucket_size, imperative::Tracer &tracer) {
+        auto reducer =
+            std::make_shared<imperative::Reducer>(ctx, params, bucket_size);
+        std::weak_ptr<imperative::Reducer> weak_reducer = reducer;
+        tracer.GetDefaultEngine()->AddGradReadyHook(
+            [weak_reducer](imperative::VarBase *grad) {
+              if (auto reducer = weak_reducer.lock()) {
+                reducer->MarkGradReady(grad);
+              }
+            });
+        return reducer;
+      }))
+      .def("finalize", &imperative::Reducer::Finalize,
+           py::call_guard<py::gil_scoped_release>())
+      .def_property_readonly("num_buckets", &imperative::Reducer::NumBuckets);
+#endif
 }
 
 }  // namespace pybind
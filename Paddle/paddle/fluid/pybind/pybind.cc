@@ -54,6 +54,7 @@ limitations under the License. */
 #include "paddle/fluid/platform/dynload/dynamic_loader.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/init.h"
+#include "paddle/fluid/platform/op_metrics.h"
 #include "paddle/fluid/platform/place.h"
 #include "paddle/fluid/platform/profiler.h"
 #include "paddle/fluid/pybind/box_helper_py.h"
@@ -306,23 +307,32 @@ PYBIND11_MODULE(core_noavx, m) {
 
   BindException(&m);
 
-  m.def("from_dlpack", [](py::capsule *dltensor) {
-    DLManagedTensor *dmt = reinterpret_cast<DLManagedTensor *>(
-        PyCapsule_GetPointer(dltensor->ptr(), "dltensor"));
-    PyCapsule_SetName(dltensor->ptr(), "used_dltensor");
-    DLTensor dl = dmt->dl_tensor;
-    Tensor tensor;
-
-    if (dl.ctx.device_type == kDLCPU) {
-      paddle::framework::TensorFromDLPack(dl, &tensor);
-    }
+  m.def("from_dlpack",
+        [](py::capsule *dltensor, bool zero_copy) {
+          DLManagedTensor *dmt = reinterpret_cast<DLManagedTensor *>(
+              PyCapsule_GetPointer(dltensor->ptr(), "dltensor"));
+          PyCapsule_SetName(dltensor->ptr(), "used_dltensor");
+          DLTensor dl = dmt->dl_tensor;
+          Tensor tensor;
+
+          // The tensor owns dmt from now on, and deletes it when its memory
+          // is released.
+          if (zero_copy &&
+              paddle::framework::TensorFromDLManagedTensor(dmt, &tensor)) {
+            return tensor;
+          }
+          if (dl.ctx.device_type == kDLCPU) {
+            paddle::framework::TensorFromDLPack(dl, &tensor);
+          }
 #ifdef PADDLE_WITH_CUDA
-    if (dl.ctx.device_type == kDLGPU) {
-      paddle::framework::TensorFromDLPack(dl, &tensor);
-    }
+          if (dl.ctx.device_type == kDLGPU) {
+            paddle::framework::TensorFromDLPack(dl, &tensor);
+          }
 #endif
-    return tensor;
-  });
+          if (dmt->deleter != nullptr) dmt->deleter(dmt);
+          return tensor;
+        },
+        py::arg("dltensor"), py::arg("zero_copy") = false);
 
   m.def("set_num_threads", &platform::SetNumThreads);
 
@@ -399,7 +409,8 @@ PYBIND11_MODULE(core_noavx, m) {
   BindImperative(&m);
 
   py::class_<Tensor>(m, "Tensor", py::buffer_protocol())
-      .def("__array__", [](Tensor &self) { return TensorToPyArray(self); })
+      .def("__array__",
+           [](Tensor &self) { return TensorToPyArray(self, true); })
       .def("_is_initialized",
            [](const Tensor &self) { return self.IsInitialized(); })
       .def("_get_dims",
@@ -456,6 +467,30 @@ PYBIND11_MODULE(core_noavx, m) {
              return reinterpret_cast<uintptr_t>(self.mutable_data(place, type));
            })
       .def("_clear", &Tensor::clear)
+      .def("_share_data_with_array", PyCPUTensorShareDataWithArray,
+           py::arg("array"), R"DOC(
+        Share the memory of a numpy array on CPUPlace instead of copying it.
+        The array is kept alive by the LoDTensor, and writes to either of
+        them are visible in both.
+
+        Args:
+          array (numpy.ndarray): The C-contiguous and writeable array to share,
+            whose data is aligned to its data type.
+
+        Returns:
+            bool: Whether the memory is shared. The LoDTensor is not changed
+            if the array can not be shared, e.g. it is a strided view.
+
+        Examples:
+            .. code-block:: python
+
+                import paddle.fluid as fluid
+                import numpy as np
+
+                t = fluid.LoDTensor()
+                if not t._share_data_with_array(np.ones([5, 30], 'float32')):
+                    t.set(np.ones([5, 30], 'float32'), fluid.CPUPlace())
+          )DOC")
       .def("set", PyCPUTensorSetFromArray<float>, py::arg("array"),
            py::arg("place"))
       .def("set", PyCPUTensorSetFromArray<int>, py::arg("array"),
@@ -543,27 +578,37 @@ PYBIND11_MODULE(core_noavx, m) {
                   print(t.shape())  # [5, 30]
            )DOC")
       .def("_to_dlpack",
-           [](Tensor &self) {
+           [](Tensor &self, bool cudf_compatible) {
              DLPackTensor dlpack_tensor(self, 1);
              DLManagedTensor *dmt =
-                 dlpack_tensor.ToCudfCompatibleDLManagedTensor();
+                 cudf_compatible
+                     ? dlpack_tensor.ToCudfCompatibleDLManagedTensor()
+                     : dlpack_tensor.ToDLManagedTensor();
              auto capsule = py::capsule(
                  static_cast<void *>(dmt), "dltensor", [](PyObject *ptr) {
-                   if (ptr) {
-                     auto dltensor = new DLManagedTensor;
-                     try {
-                       dltensor = reinterpret_cast<DLManagedTensor *>(
-                           PyCapsule_GetPointer(ptr, "used_dltensor"));
-                       return;
-                     } catch (...) {
-                       dltensor = reinterpret_cast<DLManagedTensor *>(
-                           PyCapsule_GetPointer(ptr, "dltensor"));
-                     }
+                   // A consumed tensor is renamed to used_dltensor, and is
+                   // deleted by its consumer.
+                   if (ptr && PyCapsule_IsValid(ptr, "dltensor")) {
+                     auto *dltensor = reinterpret_cast<DLManagedTensor *>(
+                         PyCapsule_GetPointer(ptr, "dltensor"));
                      dltensor->deleter(dltensor);
                    }
                  });
              return capsule;
-           })
+           },
+           py::arg("cudf_compatible") = true, R"DOC(
+           Export the LoDTensor as a DLPack capsule without copying.
+
+           Args:
+               cudf_compatible (bool): If True, the capsule is a tensor of
+                 rank 1 or 2 in the layout of cudf, which does not keep the
+                 memory of the LoDTensor alive. Otherwise, it is a compact
+                 tensor of any rank, which shares and keeps alive the memory
+                 until its consumer releases it. Default: True.
+
+           Returns:
+               PyCapsule: The DLPack capsule named "dltensor".
+           )DOC")
       .def("_set_float_element", TensorSetElement<float>)
       .def("_get_float_element", TensorGetElement<float>)
       .def("_set_double_element", TensorSetElement<double>)
@@ -662,7 +707,8 @@ PYBIND11_MODULE(core_noavx, m) {
           t = fluid.LoDTensor()
 
         )DOC")
-      .def("__array__", [](Tensor &self) { return TensorToPyArray(self); })
+      .def("__array__",
+           [](Tensor &self) { return TensorToPyArray(self, true); })
       .def("__init__",
            [](LoDTensor &instance, const std::vector<std::vector<size_t>>
                                        &recursive_sequence_lengths) {
@@ -1536,6 +1582,63 @@ All parameter, weight, gradient are variables in Paddle.
   m.def("disable_profiler", platform::DisableProfiler);
   m.def("is_profiler_enabled", platform::IsProfileEnabled);
   m.def("reset_profiler", platform::ResetProfiler);
+
+  py::class_<platform::LatencyHistogram>(m, "LatencyHistogram")
+      .def("count", &platform::LatencyHistogram::Count)
+      .def("sum", &platform::LatencyHistogram::Sum)
+      .def("min", &platform::LatencyHistogram::Min)
+      .def("max", &platform::LatencyHistogram::Max)
+      .def("mean", &platform::LatencyHistogram::Mean)
+      .def("percentile", &platform::LatencyHistogram::Percentile)
+      .def("buckets",
+           [](const platform::LatencyHistogram &self) {
+             // Only the non-empty buckets, as (upper_bound, count) pairs.
+             std::vector<std::pair<uint64_t, uint64_t>> buckets;
+             for (int i = 0; i < platform::LatencyHistogram::kNumBuckets;
+                  ++i) {
+               if (self.Buckets()[i] == 0) continue;
+               buckets.emplace_back(
+                   platform::LatencyHistogram::BucketUpperBound(i),
+                   self.Buckets()[i]);
+             }
+             return buckets;
+           });
+
+  py::class_<platform::OpMetricsRecord>(m, "OpMetricsRecord")
+      .def_readonly("op_type", &platform::OpMetricsRecord::op_type)
+      .def_readonly("kernel_key", &platform::OpMetricsRecord::kernel_key)
+      .def_property_readonly("calls",
+                             [](const platform::OpMetricsRecord &self) {
+                               return self.metrics.calls;
+                             })
+      .def_property_readonly("bytes_allocated",
+                             [](const platform::OpMetricsRecord &self) {
+                               return self.metrics.bytes_allocated;
+                             })
+      .def_property_readonly("latency_ns",
+                             [](const platform::OpMetricsRecord &self) {
+                               return self.metrics.latency_ns;
+                             })
+      .def_property_readonly("input_numel_buckets",
+                             [](const platform::OpMetricsRecord &self) {
+                               return self.metrics.input_numel_buckets;
+                             });
+
+  m.def("get_op_metrics",
+        [](bool by_op_type) {
+          auto &registry = platform::OpMetricsRegistry::Instance();
+          return by_op_type ? registry.SnapshotByOpType()
+                            : registry.Snapshot();
+        },
+        py::arg("by_op_type") = false);
+  m.def("reset_op_metrics",
+        [] { platform::OpMetricsRegistry::Instance().Reset(); });
+  m.def("op_metrics_to_prometheus_text", [] {
+    return platform::OpMetricsRegistry::Instance().ToPrometheusText();
+  });
+  m.def("dump_op_metrics", [](const std::string &path) {
+    platform::OpMetricsRegistry::Instance().DumpPrometheusText(path);
+  });
   m.def("get_pass", [](const std::string &pass_type) {
     auto pass = framework::ir::PassRegistry::Instance().Get(pass_type);
     return std::shared_ptr<framework::ir::Pass>(std::move(pass));
@@ -1691,6 +1794,18 @@ All parameter, weight, gradient are variables in Paddle.
           R"DOC(This config that how many iteration the executor will run when
                 user call exe.run() in python
               )DOC")
+      .def_property(
+          "use_work_stealing",
+          [](const ExecutionStrategy &self) { return self.use_work_stealing_; },
+          [](ExecutionStrategy &self, bool use_work_stealing) {
+            self.use_work_stealing_ = use_work_stealing;
+          },
+          R"DOC(The type is BOOL, use_work_stealing indicates whether the
+                experimental executor runs the operators on a work-stealing
+                thread pool, where each thread keeps its own queue of ready
+                operators and idle threads steal from the others. It reduces
+                the scheduling overhead of programs with many small operators.
+                Default False.)DOC")
       .def_property("_dry_run",
                     [](const ExecutionStrategy &self) { return self.dry_run_; },
                     [](ExecutionStrategy &self, bool dry_run) {
@@ -16,8 +16,10 @@ limitations under the License. */
 #include <Python.h>
 #include <algorithm>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/memory/memcpy.h"
@@ -102,6 +104,127 @@ inline void PyCPUTensorSetFromArray(
   std::memcpy(dst, array.data(), sizeof(uint16_t) * array.size());
 }
 
+namespace details {
+
+// Drops the references to Python objects released by threads which do not
+// hold the GIL, e.g. executor or garbage collector threads. Taking the GIL
+// there could deadlock with the Python thread waiting for them, so the
+// interpreter drops the references in a pending call instead.
+class PendingDecRefs {
+ public:
+  static PendingDecRefs &Instance() {
+    // Leaked, since it may be used after static destruction at exit.
+    static auto *instance = new PendingDecRefs();
+    return *instance;
+  }
+
+  void DecRef(PyObject *obj) {
+    if (!Py_IsInitialized()) return;
+#if PY_VERSION_HEX >= 0x03040000
+    if (PyGILState_Check()) {
+      Py_DECREF(obj);
+      return;
+    }
+#endif
+    std::lock_guard<std::mutex> guard(mutex_);
+    objs_.push_back(obj);
+    if (!scheduled_) {
+      scheduled_ = Py_AddPendingCall(&PendingDecRefs::Run, this) == 0;
+    }
+  }
+
+ private:
+  PendingDecRefs() = default;
+
+  static int Run(void *arg) {
+    auto *self = static_cast<PendingDecRefs *>(arg);
+    std::vector<PyObject *> objs;
+    {
+      std::lock_guard<std::mutex> guard(self->mutex_);
+      objs.swap(self->objs_);
+      self->scheduled_ = false;
+    }
+    for (auto *obj : objs) Py_DECREF(obj);
+    return 0;
+  }
+
+  std::mutex mutex_;
+  std::vector<PyObject *> objs_;
+  bool scheduled_{false};
+};
+
+// The memory of a numpy array shared with a Tensor, which holds a reference
+// to the array until the allocation is released.
+class PyArrayAllocation : public memory::Allocation {
+ public:
+  explicit PyArrayAllocation(py::array array)
+      : Allocation(array.mutable_data(), array.nbytes(), platform::CPUPlace()),
+        array_(array.release().ptr()) {}
+
+  ~PyArrayAllocation() { PendingDecRefs::Instance().DecRef(array_); }
+
+ private:
+  PyObject *array_;
+};
+
+inline bool PyArrayDTypeToTensorDType(const py::dtype &dtype,
+                                      framework::proto::VarType::Type *type) {
+  auto &api = py::detail::npy_api::get();
+#define PY_DTYPE_TO_TENSOR_DTYPE(py_dtype, proto_type)          \
+  if (api.PyArray_EquivTypes_(dtype.ptr(), (py_dtype).ptr())) { \
+    *type = proto_type;                                         \
+    return true;                                                \
+  }
+
+  PY_DTYPE_TO_TENSOR_DTYPE(py::dtype::of<float>(),
+                           framework::proto::VarType::FP32);
+  PY_DTYPE_TO_TENSOR_DTYPE(py::dtype::of<double>(),
+                           framework::proto::VarType::FP64);
+  PY_DTYPE_TO_TENSOR_DTYPE(py::dtype("e"), framework::proto::VarType::FP16);
+  PY_DTYPE_TO_TENSOR_DTYPE(py::dtype::of<int>(),
+                           framework::proto::VarType::INT32);
+  PY_DTYPE_TO_TENSOR_DTYPE(py::dtype::of<int64_t>(),
+                           framework::proto::VarType::INT64);
+  PY_DTYPE_TO_TENSOR_DTYPE(py::dtype::of<bool>(),
+                           framework::proto::VarType::BOOL);
+  PY_DTYPE_TO_TENSOR_DTYPE(py::dtype::of<uint8_t>(),
+                           framework::proto::VarType::UINT8);
+  PY_DTYPE_TO_TENSOR_DTYPE(py::dtype::of<int8_t>(),
+                           framework::proto::VarType::INT8);
+#undef PY_DTYPE_TO_TENSOR_DTYPE
+  return false;
+}
+
+}  // namespace details
+
+// Shares the memory of a numpy array with the tensor on CPU instead of
+// copying it, and keeps the array alive as long as the memory is used. The
+// array must be C-contiguous, writeable, aligned to its data type and of a
+// data type of Tensor. Returns false without changing the tensor otherwise.
+inline bool PyCPUTensorShareDataWithArray(framework::Tensor *self,
+                                          py::array array) {
+  framework::proto::VarType::Type type;
+  if (!details::PyArrayDTypeToTensorDType(array.dtype(), &type)) return false;
+  if (!(array.flags() & py::array::c_style) || !array.writeable()) {
+    return false;
+  }
+  if (reinterpret_cast<uintptr_t>(array.data()) %
+          framework::SizeOfType(type) !=
+      0) {
+    return false;
+  }
+
+  std::vector<int64_t> dims;
+  dims.reserve(array.ndim());
+  for (decltype(array.ndim()) i = 0; i < array.ndim(); ++i) {
+    dims.push_back(static_cast<int64_t>(array.shape()[i]));
+  }
+  self->Resize(framework::make_ddim(dims));
+  self->ResetHolderWithType(
+      std::make_shared<details::PyArrayAllocation>(std::move(array)), type);
+  return true;
+}
+
 template <typename T, size_t D>
 void _sliceCompute(const framework::Tensor *in, framework::Tensor *out,
                    const platform::CPUDeviceContext &ctx,
@@ -471,7 +594,11 @@ inline std::string TensorDTypeToPyDTypeStr(
 
 }  // namespace details
 
-inline py::array TensorToPyArray(const framework::Tensor &tensor) {
+// Returns the data of tensor as a numpy array. The array of a tensor on CPU
+// is a view of its memory, which keeps the memory alive, if zero_copy is true,
+// and a copy otherwise.
+inline py::array TensorToPyArray(const framework::Tensor &tensor,
+                                 bool zero_copy = false) {
   if (!tensor.IsInitialized()) {
     return py::array();
   }
@@ -494,6 +621,15 @@ inline py::array TensorToPyArray(const framework::Tensor &tensor) {
 
   std::string py_dtype_str = details::TensorDTypeToPyDTypeStr(tensor.type());
 
+  if (!is_gpu_tensor && zero_copy) {
+    auto *holder = new std::shared_ptr<memory::Allocation>(tensor.Holder());
+    py::capsule base(holder, [](void *ptr) {
+      delete static_cast<std::shared_ptr<memory::Allocation> *>(ptr);
+    });
+    return py::array(py::dtype(py_dtype_str), py_dims, py_strides,
+                     tensor_buf_ptr, base);
+  }
+
   if (!is_gpu_tensor) {
     return py::array(py::buffer_info(
         const_cast<void *>(tensor_buf_ptr), sizeof_dtype, py_dtype_str,
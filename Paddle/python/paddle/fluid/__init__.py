@@ -168,7 +168,10 @@ def __bootstrap__():
         'print_sub_graph_dir', 'pe_profile_fname', 'inner_op_parallelism',
         'enable_parallel_graph', 'fuse_parameter_groups_size',
         'multiple_of_cupti_buffer_size', 'fuse_parameter_memory_size',
-        'tracer_profile_fname', 'dygraph_debug'
+        'tracer_profile_fname', 'dygraph_debug', 'enable_op_metrics',
+        'op_metrics_dump_path', 'executor_plan_cache_capacity',
+        'executor_plan_static_memory', 'cpu_eigen_parallel_min_numel',
+        'async_cpu_garbage_collection', 'cpu_parallel_use_shm'
     ]
     if 'Darwin' not in sysstr:
         read_env_flags.append('use_pinned_memory')
@@ -191,6 +194,7 @@ def __bootstrap__():
         read_env_flags.append('rpc_send_thread_num')
         read_env_flags.append('rpc_get_thread_num')
         read_env_flags.append('rpc_prefetch_thread_num')
+        read_env_flags.append('rpc_sparse_update_shards')
         read_env_flags.append('rpc_disable_reuse_port')
 
         read_env_flags.append('worker_update_interval_secs')
@@ -206,6 +210,7 @@ def __bootstrap__():
         read_env_flags.append('communicator_send_wait_times')
         read_env_flags.append('communicator_merge_sparse_grad')
         read_env_flags.append('communicator_is_sgd_optimizer')
+        read_env_flags.append('communicator_grad_compression')
         if core.is_compiled_with_brpc():
             read_env_flags.append('max_body_size')
             #set brpc max body size
@@ -31,6 +31,9 @@ __all__ = [
     'match_matrix_tensor',
     'tree_conv',
     'multiclass_nms2',
+    'logits_to_topk',
+    'fused_multihead_attention',
+    'fused_feedforward',
 ]
 
 
@@ -563,3 +566,254 @@ def multiclass_nms2(bboxes,
     if return_index:
         return output, index
     return output
+
+
+def logits_to_topk(input, weight, k, transpose_w=True, tile_size=2048):
+    """
+    **Fused output projection, log_softmax and topk**
+
+    This function computes
+
+    .. math::
+
+        out, indices = topk(log\_softmax(input * weight^T), k)
+
+    without the logits of the whole vocabulary. The logits are computed in
+    tiles of :attr:`tile_size` tokens, which update a running log-sum-exp and
+    a top-k heap of every row. It only runs on CPU and has no gradient, so it
+    is meant for the output head of decoding.
+
+    Args:
+        input (Variable): The hidden states, [..., hidden_size], float32 or
+            float64.
+        weight (Variable): The projection, [vocab_size, hidden_size] like the
+            tied token embedding, or [hidden_size, vocab_size] if
+            :attr:`transpose_w` is False.
+        k (int): The number of the selected tokens.
+        transpose_w (bool): Whether :attr:`weight` is [vocab_size,
+            hidden_size]. Default True.
+        tile_size (int): The number of the tokens computed at a time.
+            Default 2048.
+
+    Returns:
+        tuple: The log probabilities of the top :attr:`k` tokens in
+            descending order and their int64 ids, both of [..., k].
+
+    Examples:
+        .. code-block:: python
+
+            import paddle.fluid as fluid
+
+            hidden = fluid.data(name='hidden', shape=[8, 64], dtype='float32')
+            embedding = fluid.layers.create_parameter(
+                shape=[1000, 64], dtype='float32')
+            log_probs, ids = fluid.contrib.layers.logits_to_topk(
+                hidden, embedding, k=6)
+    """
+    helper = LayerHelper('logits_to_topk', **locals())
+    out = helper.create_variable_for_type_inference(dtype=input.dtype)
+    indices = helper.create_variable_for_type_inference(dtype='int64')
+    helper.append_op(
+        type='logits_to_topk',
+        inputs={'X': input,
+                'W': weight},
+        outputs={'Out': out,
+                 'Indices': indices},
+        attrs={'k': k,
+               'transpose_w': transpose_w,
+               'tile_size': tile_size})
+    out.stop_gradient = True
+    indices.stop_gradient = True
+    return out, indices
+
+
+def fused_multihead_attention(input,
+                              qkv_weight,
+                              qkv_bias,
+                              out_weight,
+                              out_bias,
+                              num_heads,
+                              mask=None,
+                              dropout_prob=0.0,
+                              is_test=False,
+                              seed=None):
+    """
+    **Fused multi-head self-attention**
+
+    This function computes
+
+    .. math::
+
+        Q, K, V &= split\_heads(input * qkv\_weight + qkv\_bias)
+
+        W &= dropout(softmax(mask(Q * K^T / \sqrt{head\_dim}))) * (1 - mask)
+
+        out &= merge\_heads(W * V) * out\_weight + out\_bias
+
+    in one operator, where the masked scores are -1e10 and the dropout is
+    upscale_in_train. The [batch_size, num_heads, seq_len, seq_len] attention
+    weights are not kept for the backward, which recomputes them from the
+    saved log-sum-exp of the softmax and the dropout seed. It only runs on
+    CPU.
+
+    Args:
+        input (Variable): [batch_size, seq_len, hidden], float32 or float64.
+        qkv_weight (Variable): [hidden, 3 * hidden], the weight of Q, K, V.
+        qkv_bias (Variable): [3 * hidden], the bias of Q, K, V.
+        out_weight (Variable): [hidden, hidden], the weight of the output
+            projection.
+        out_bias (Variable): [hidden], the bias of the output projection.
+        num_heads (int): The number of the heads.
+        mask (Variable, optional): [batch_size, seq_len, seq_len], 1 for the
+            positions which are not attended to and 0 for the others.
+            Default None.
+        dropout_prob (float): The dropout probability of the attention
+            weights. Default 0.0.
+        is_test (bool): Whether the dropout is disabled. Default False.
+        seed (int, optional): The fixed seed of the dropout, only for the
+            tests. Default None.
+
+    Returns:
+        Variable: [batch_size, seq_len, hidden].
+
+    Examples:
+        .. code-block:: python
+
+            import paddle.fluid as fluid
+
+            x = fluid.data(name='x', shape=[2, 5, 8], dtype='float32')
+            qkv_w = fluid.layers.create_parameter(
+                shape=[8, 24], dtype='float32')
+            qkv_bias = fluid.layers.create_parameter(
+                shape=[24], dtype='float32', is_bias=True)
+            out_w = fluid.layers.create_parameter(shape=[8, 8], dtype='float32')
+            out_bias = fluid.layers.create_parameter(
+                shape=[8], dtype='float32', is_bias=True)
+            out = fluid.contrib.layers.fused_multihead_attention(
+                x, qkv_w, qkv_bias, out_w, out_bias, num_heads=2)
+    """
+    helper = LayerHelper('fused_multihead_attention', **locals())
+    dtype = input.dtype
+    inputs = {
+        'X': input,
+        'QKVW': qkv_weight,
+        'QKVBias': qkv_bias,
+        'OutLinearW': out_weight,
+        'OutLinearBias': out_bias
+    }
+    if mask is not None:
+        inputs['Mask'] = mask
+    out = helper.create_variable_for_type_inference(dtype=dtype)
+    qkv_out = helper.create_variable_for_type_inference(
+        dtype=dtype, stop_gradient=True)
+    attn_out = helper.create_variable_for_type_inference(
+        dtype=dtype, stop_gradient=True)
+    softmax_lse = helper.create_variable_for_type_inference(
+        dtype=dtype, stop_gradient=True)
+    dropout_seed = helper.create_variable_for_type_inference(
+        dtype='int32', stop_gradient=True)
+    helper.append_op(
+        type='fused_multihead_attention',
+        inputs=inputs,
+        outputs={
+            'Out': out,
+            'QKVOut': qkv_out,
+            'AttnOut': attn_out,
+            'SoftmaxLse': softmax_lse,
+            'Seed': dropout_seed
+        },
+        attrs={
+            'num_heads': num_heads,
+            'dropout_prob': dropout_prob,
+            'is_test': is_test,
+            'fix_seed': seed is not None,
+            'seed': seed if seed is not None else 0
+        })
+    return out
+
+
+def fused_feedforward(input,
+                      linear1_weight,
+                      linear1_bias,
+                      linear2_weight,
+                      linear2_bias,
+                      dropout_prob=0.0,
+                      is_test=False,
+                      seed=None,
+                      tile_rows=32):
+    """
+    **Fused feed-forward block**
+
+    This function computes
+
+    .. math::
+
+        out = dropout(gelu(input * linear1\_weight + linear1\_bias)) * linear2\_weight + linear2\_bias
+
+    in one operator, where :math:`gelu(x) = 0.5 * x * (1 + erf(x / \sqrt{2}))`
+    and the dropout is upscale_in_train. The rows are computed tile_rows at a
+    time, so the activation of a tile stays in the cache between the two
+    linears. Only the output of the first linear is kept for the backward,
+    which recomputes the GELU and the dropout from it and the dropout seed.
+    It only runs on CPU.
+
+    Args:
+        input (Variable): [..., d_model], float32 or float64.
+        linear1_weight (Variable): [d_model, inner_size].
+        linear1_bias (Variable): [inner_size].
+        linear2_weight (Variable): [inner_size, d_model].
+        linear2_bias (Variable): [d_model].
+        dropout_prob (float): The dropout probability after the GELU.
+            Default 0.0.
+        is_test (bool): Whether the dropout is disabled. Default False.
+        seed (int, optional): The fixed seed of the dropout, only for the
+            tests. Default None.
+        tile_rows (int): The number of the rows computed at a time. Default 32.
+
+    Returns:
+        Variable: [..., d_model].
+
+    Examples:
+        .. code-block:: python
+
+            import paddle.fluid as fluid
+
+            x = fluid.data(name='x', shape=[2, 5, 8], dtype='float32')
+            w1 = fluid.layers.create_parameter(shape=[8, 32], dtype='float32')
+            b1 = fluid.layers.create_parameter(
+                shape=[32], dtype='float32', is_bias=True)
+            w2 = fluid.layers.create_parameter(shape=[32, 8], dtype='float32')
+            b2 = fluid.layers.create_parameter(
+                shape=[8], dtype='float32', is_bias=True)
+            out = fluid.contrib.layers.fused_feedforward(
+                x, w1, b1, w2, b2, dropout_prob=0.1)
+    """
+    helper = LayerHelper('fused_feedforward', **locals())
+    dtype = input.dtype
+    out = helper.create_variable_for_type_inference(dtype=dtype)
+    linear1_out = helper.create_variable_for_type_inference(
+        dtype=dtype, stop_gradient=True)
+    dropout_seed = helper.create_variable_for_type_inference(
+        dtype='int32', stop_gradient=True)
+    helper.append_op(
+        type='fused_feedforward',
+        inputs={
+            'X': input,
+            'Linear1W': linear1_weight,
+            'Linear1Bias': linear1_bias,
+            'Linear2W': linear2_weight,
+            'Linear2Bias': linear2_bias
+        },
+        outputs={
+            'Out': out,
+            'Linear1Out': linear1_out,
+            'Seed': dropout_seed
+        },
+        attrs={
+            'dropout_prob': dropout_prob,
+            'is_test': is_test,
+            'fix_seed': seed is not None,
+            'seed': seed if seed is not None else 0,
+            'tile_rows': tile_rows
+        })
+    return out
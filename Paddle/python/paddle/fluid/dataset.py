@@ -677,6 +677,55 @@ class QueueDataset(DatasetBase):
         self.dataset.set_data_feed_desc(self.desc())
         self.dataset.create_readers()
 
+    def set_shuffle_buffer_size(self, shuffle_buffer_size):
+        """
+        Shuffle the streamed data in a buffer of shuffle_buffer_size
+        instances of every thread, so the memory used is bounded.
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset("QueueDataset")
+              dataset.set_shuffle_buffer_size(10000)
+
+        Args:
+            shuffle_buffer_size(int): the number of instances in the buffer,
+                                      0 to read the data in order.
+
+        """
+        self.proto_desc.shuffle_buffer_size = shuffle_buffer_size
+
+    def set_batch_token_budget(self, batch_token_budget,
+                               bucket_pool_size=4096):
+        """
+        Batch the instances with others of similar length to reduce padding.
+        Every thread sorts bucket_pool_size instances by length at a time,
+        and splits them into batches of at most batch_size instances, which
+        have at most batch_token_budget tokens after padding to their longest
+        instance. The length of an instance is the most values in its slots.
+        The batches are returned in random order. When loaded by
+        fluid.io.DataLoader.from_dataset, drop_last should be False, or the
+        batches of less than batch_size instances are dropped.
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset("QueueDataset")
+              dataset.set_batch_size(256)
+              dataset.set_batch_token_budget(4096)
+
+        Args:
+            batch_token_budget(int): the most tokens of a batch after padding,
+                                     0 to batch batch_size instances in order.
+            bucket_pool_size(int): the number of instances sorted by length at
+                                   a time. Default is 4096.
+
+        """
+        self.proto_desc.batch_token_budget = batch_token_budget
+        self.proto_desc.bucket_pool_size = bucket_pool_size
+
     def local_shuffle(self):
         """
         Local shuffle data.
@@ -149,7 +149,7 @@ def _print_debug_msg(limit=5, is_test=False):
 
 
 @framework.dygraph_only
-def to_variable(value, block=None, name=None):
+def to_variable(value, block=None, name=None, zero_copy=False):
     """
     The API will create a ``Variable`` object from numpy\.ndarray or Variable object.
 
@@ -157,6 +157,7 @@ def to_variable(value, block=None, name=None):
         value(ndarray): The numpy\.ndarray object that needs to be converted, it can be multi-dimension, and the data type is one of numpy\.{float16, float32, float64, int16, int32, int64, uint8, uint16}.
         block(fluid.Block, optional): Which block this variable will be in. Default: None.
         name(str, optional): The default value is None. Normally there is no need for user to set this property. For more information, please refer to :ref:`api_guide_Name`
+        zero_copy(bool, optional): Whether to share the memory of ``value`` instead of copying it when the current place is CPUPlace. ``value`` is kept alive by the ``Variable``, and must not be modified while the ``Variable`` is used. It is copied if its memory can not be shared, e.g. it is not C-contiguous. Default: False.
 
     Returns:
         Variable: ``Tensor`` created from the specified numpy\.ndarray object, data type and shape is the same as ``value`` .
@@ -188,9 +189,13 @@ def to_variable(value, block=None, name=None):
             stop_gradient=True)
         var = py_var._ivar.value()
         tensor = var.get_tensor()
+        place = framework._current_expected_place()
+        if zero_copy and isinstance(place, core.CPUPlace):
+            if tensor._share_data_with_array(value):
+                return py_var
         if value.dtype == np.float16:
             value = value.view(np.uint16)
-        tensor.set(value, framework._current_expected_place())
+        tensor.set(value, place)
         return py_var
     elif isinstance(value, framework.Variable):
         return value
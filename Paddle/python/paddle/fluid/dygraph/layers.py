@@ -29,6 +29,16 @@ from paddle.fluid.framework import Variable
 __all__ = ['Layer']
 
 
+def _flatten_ivars(outputs):
+    if isinstance(outputs, Variable):
+        return [outputs._ivar]
+    if isinstance(outputs, dict):
+        outputs = list(outputs.values())
+    if isinstance(outputs, (list, tuple)):
+        return [ivar for out in outputs for ivar in _flatten_ivars(out)]
+    return []
+
+
 class Layer(core.Layer):
     """Dynamic graph Layer based on OOD, includes the parameters of the layer, the structure of the forward graph and so on.
 
@@ -50,6 +60,9 @@ class Layer(core.Layer):
         self._full_name = unique_name.generate(name_scope + "/" +
                                                self.__class__.__name__)
         self._built = False
+        self._checkpoint = False
+        self._grad_buffer = None
+        self._buffered_params = set()
         self._dtype = dtype
         self._parameters = collections.OrderedDict()
         self._sub_layers = collections.OrderedDict()
@@ -63,6 +76,40 @@ class Layer(core.Layer):
     def eval(self):
         framework._dygraph_tracer().eval_mode()
 
+    def checkpoint(self, enable=True):
+        """Marks this layer as a checkpoint of the activation recomputation.
+
+        In training, only the inputs and the outputs of a checkpointed layer
+        keep their memory after its forward. The other variables created in
+        the forward are released, and recomputed with the same random seeds
+        before the backward of the layer runs. The variables created in the
+        forward should not be used outside the layer except the outputs.
+        The persistable variables updated in the forward, e.g. the running
+        statistics of BatchNorm, are not updated again by the recomputation.
+
+        Parameters:
+            enable(bool, optional): Whether to checkpoint the layer.
+                Default: True.
+
+        Returns:
+            None
+
+        Examples:
+            .. code-block:: python
+
+                import numpy as np
+                import paddle.fluid as fluid
+
+                with fluid.dygraph.guard():
+                    fc = fluid.dygraph.FC("fc", 10, act="relu")
+                    fc.checkpoint()
+                    x = fluid.dygraph.to_variable(
+                        np.random.rand(4, 8).astype("float32"))
+                    loss = fluid.layers.reduce_mean(fc(x))
+                    loss.backward()
+        """
+        self._checkpoint = enable
+
     def full_name(self):
         """Full name for this layer, composed by name_scope + "/" + MyLayer.__class__.__name__
 
@@ -161,9 +208,63 @@ class Layer(core.Layer):
                     ret.append(sub_l)
         return ret
 
+    def accumulate_gradients(self, coalesce=True):
+        """Sums the gradients of successive backward into the gradients of
+        the trainable parameters of this layer, until they are cleared by
+        :code:`clear_gradients`. It should be called after all parameters are
+        created, e.g. after the first forward.
+
+        With :code:`coalesce`, the gradients are views of one contiguous
+        buffer, which is cleared by one memset and read by the optimizer in
+        place. Only the parameters of the same data type as the first one are
+        coalesced.
+
+        Parameters:
+            coalesce(bool, optional): Whether to keep the gradients in one
+                contiguous buffer. Default: True.
+
+        Returns:
+            None
+
+        Examples:
+            .. code-block:: python
+
+                import numpy as np
+                import paddle.fluid as fluid
+
+                with fluid.dygraph.guard():
+                    fc = fluid.dygraph.FC("fc", 10)
+                    adam = fluid.optimizer.AdamOptimizer()
+                    for i in range(4):
+                        x = fluid.dygraph.to_variable(
+                            np.random.rand(4, 8).astype("float32"))
+                        loss = fluid.layers.reduce_mean(fc(x)) / 4
+                        if i == 0:
+                            fc.accumulate_gradients()
+                        loss.backward()
+                    adam.minimize(loss, parameter_list=fc.parameters())
+                    fc.clear_gradients()
+        """
+        params = []
+        names = set()
+        for p in self.parameters():
+            if p.trainable and p.name not in names:
+                names.add(p.name)
+                params.append(p)
+        for p in params:
+            p._ivar._accumulate_grad = True
+        if not coalesce or not params:
+            return
+
+        params = [p for p in params if p.dtype == params[0].dtype]
+        self._grad_buffer = core.GradientBuffer([p._ivar for p in params])
+        self._buffered_params = set(p.name for p in params)
+
     def clear_gradients(self):
+        if self._grad_buffer is not None:
+            self._grad_buffer.clear()
         for p in self.parameters():
-            if p.trainable:
+            if p.trainable and p.name not in self._buffered_params:
                 p.clear_gradient()
 
     def _build_once(self, *args, **kwargs):
@@ -175,7 +276,16 @@ class Layer(core.Layer):
             if parallel_helper._is_data_parallel_mode():
                 parallel_helper._broadcast_parameters(self._parameters.values())
 
-        outputs = self.forward(*inputs, **kwargs)
+        tracer = framework._dygraph_tracer()
+        if self._checkpoint and tracer is not None and tracer._train_mode:
+            tracer._begin_checkpoint()
+            outputs = None
+            try:
+                outputs = self.forward(*inputs, **kwargs)
+            finally:
+                tracer._end_checkpoint(_flatten_ivars(outputs))
+        else:
+            outputs = self.forward(*inputs, **kwargs)
         self._built = True
         return outputs
 
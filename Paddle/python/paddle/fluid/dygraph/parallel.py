@@ -44,9 +44,11 @@ def prepare_context(strategy=None):
     if isinstance(place, core.CUDAPlace):
         parallel_helper._set_parallel_ctx(
             core.NCCLParallelContext(strategy, place))
+    elif isinstance(place, core.CPUPlace):
+        parallel_helper._set_parallel_ctx(
+            core.CPUParallelContext(strategy, place))
     else:
-        # TODO(Yancey1989): add Gloo Parallel Context to support CPU parallel computation
-        assert ("Only support CUDAPlace for now.")
+        assert ("Only support CUDAPlace and CPUPlace for now.")
     parallel_helper._init_parallel_ctx()
     return strategy
 
@@ -143,9 +145,30 @@ class DataParallel(layers.Layer):
 
         self._layers = layers
         self._strategy = strategy
+        self._reducer = None
+        self._reducer_created = False
 
     def forward(self, *inputs, **kwargs):
-        return self._layers(*inputs, **kwargs)
+        outputs = self._layers(*inputs, **kwargs)
+        # The parameters are all created after the first forward.
+        if not self._reducer_created and self._is_data_parallel_mode():
+            self._reducer = self._create_reducer()
+            self._reducer_created = True
+        return outputs
+
+    def _create_reducer(self):
+        ctx = parallel_helper._get_parallel_ctx()
+        if not parallel_helper._is_cpu_parallel_ctx(ctx):
+            return None
+        # The gradients are ready about in the reverse order of parameters,
+        # and all-reduced in buckets of 32 MB while backward runs.
+        params = [
+            param._ivar for param in self._layers.parameters()
+            if param.trainable
+        ]
+        bucket_size = 32 * 1024 * 1024
+        return core.Reducer(ctx, params[::-1], bucket_size,
+                            framework._dygraph_tracer())
 
     def scale_loss(self, loss):
         """
@@ -205,6 +228,11 @@ class DataParallel(layers.Layer):
         if not self._is_data_parallel_mode():
             return
 
+        if self._reducer is not None:
+            # Waits for the gradients all-reduced during backward.
+            self._reducer.finalize()
+            return
+
         grad_var_set = set()
         grad_vars = []
         for param in self._layers.parameters():
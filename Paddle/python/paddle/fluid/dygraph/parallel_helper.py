@@ -12,6 +12,7 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 import os
+from .. import core
 from ..layers import collective
 from ..framework import Parameter
 __parallel_ctx__clz__ = None
@@ -37,7 +38,21 @@ def _init_parallel_ctx():
     __parallel_ctx__clz__.init()
 
 
+def _get_parallel_ctx():
+    global __parallel_ctx__clz__
+    return __parallel_ctx__clz__
+
+
+def _is_cpu_parallel_ctx(ctx):
+    return hasattr(core, "CPUParallelContext") and isinstance(
+        ctx, core.CPUParallelContext)
+
+
 def _broadcast_parameters(parameters):
+    ctx = _get_parallel_ctx()
     for param in parameters:
         if isinstance(param, Parameter) and param.trainable:
-            collective._broadcast(param, 0, sync_mode=True)
+            if _is_cpu_parallel_ctx(ctx):
+                ctx.broadcast(param._ivar, 0)
+            else:
+                collective._broadcast(param, 0, sync_mode=True)
@@ -795,7 +795,8 @@ class Variable(object):
             raise ValueError("%s is Empty, Please check if it has no data in" %
                              self.name)
         new_ivar = self._ivar._copy_to(core.CPUPlace(), True)
-        return np.array(new_ivar.value().get_tensor())
+        # A view of the copy, which is kept alive by the returned array.
+        return np.array(new_ivar.value().get_tensor(), copy=False)
 
     @dygraph_only
     def set_value(self, value):
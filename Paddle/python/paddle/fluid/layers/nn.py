@@ -223,6 +223,8 @@ __all__ = [
     'shard_index',
     'hard_swish',
     'gather_tree',
+    'beam_search_step',
+    'beam_reorder',
     'mse_loss',
     'uniform_random',
 ]
@@ -17727,6 +17729,169 @@ def gather_tree(ids, parents):
     return out
 
 
+def beam_search_step(scores,
+                     beam_size,
+                     eos_id,
+                     pad_id,
+                     pre_ids=None,
+                     pre_scores=None,
+                     step=1,
+                     unk_id=-1,
+                     ignore_unk=False,
+                     min_gen_len=1,
+                     length_average=False,
+                     length_penalty=-1.0,
+                     ids=None,
+                     name=None):
+    """
+    One step of beam search on dense tensors. It penalizes [UNK] and early
+    [EOS], normalizes the scores by the length and selects the best
+    :attr:`beam_size` candidates of every batch, in one pass over the scores.
+    The beams which ended with :attr:`eos_id` or :attr:`pad_id` only go on
+    with :attr:`pad_id` and keep their scores.
+
+    The accumulated score of an unfinished beam is
+    :math:`pre\_score * a + score * b`, where :math:`a = 1 - 1 / step,
+    b = 1 / step` with :attr:`length_average`, :math:`a = ((4 + step) /
+    (5 + step))^{\alpha}, b = (1 / (5 + step))^{\alpha}` with a non-negative
+    :attr:`length_penalty` :math:`\alpha`, and :math:`a = b = 1` otherwise.
+
+    Args:
+        scores(Variable): The log probabilities of the next tokens, whose last
+            dimension is the vocabulary size and whose rows are
+            :attr:`[batch_size * beam_size]`, or :attr:`[batch_size]` in the
+            first step. The data type should be float32 or float64.
+        beam_size(int): The beam size.
+        eos_id(int): The id of [EOS].
+        pad_id(int): The id of [PAD].
+        pre_ids(Variable, optional): The int64 tensor of
+            :attr:`[batch_size, beam_size]` selected by the previous step.
+            None in the first step.
+        pre_scores(Variable, optional): The accumulated scores of
+            :attr:`pre_ids`. None in the first step.
+        step(int|Variable): The 1-based step. Default 1.
+        unk_id(int): The id of [UNK]. Default -1.
+        ignore_unk(bool): Whether [UNK] is never generated. Default False.
+        min_gen_len(int): [EOS] is not generated until this step. Default 1.
+        length_average(bool): Whether to average the scores by the length.
+            Default False.
+        length_penalty(float): The alpha of the length penalty, disabled if
+            it is negative. Default -1.0.
+        ids(Variable, optional): The int64 tokens of :attr:`scores`, e.g. the
+            indices of :ref:`api_fluid_contrib_layers_logits_to_topk`. Then
+            only these tokens are the candidates of every beam, and the
+            result is the same as the dense one if they are the top
+            :attr:`beam_size + 2` tokens. None means the whole vocabulary.
+            Default None.
+        name(str, optional): Normally there is no need for user to set this
+            property. For more information, please refer to
+            :ref:`api_guide_Name`. Default None.
+
+    Returns:
+        tuple: The selected ids, their accumulated scores in descending order
+            and the index of their parent beams in :attr:`[0, beam_size)`,
+            all of shape :attr:`[batch_size, beam_size]`.
+
+    Examples:
+        .. code-block:: python
+
+            import paddle.fluid as fluid
+
+            scores = fluid.data(name='scores', shape=[8, 100], dtype='float32')
+            pre_ids = fluid.data(name='pre_ids', shape=[2, 4], dtype='int64')
+            pre_scores = fluid.data(
+                name='pre_scores', shape=[2, 4], dtype='float32')
+            ids, scores, parents = fluid.layers.beam_search_step(
+                scores, beam_size=4, eos_id=2, pad_id=0, pre_ids=pre_ids,
+                pre_scores=pre_scores, step=2)
+    """
+    helper = LayerHelper('beam_search_step', **locals())
+    inputs = {"Scores": scores}
+    if ids is not None:
+        inputs["Ids"] = ids
+    if pre_ids is not None:
+        inputs["PreIds"] = pre_ids
+        inputs["PreScores"] = pre_scores
+    attrs = {
+        "beam_size": beam_size,
+        "eos_id": eos_id,
+        "pad_id": pad_id,
+        "unk_id": unk_id,
+        "ignore_unk": ignore_unk,
+        "min_gen_len": min_gen_len,
+        "length_average": length_average,
+        "length_penalty": length_penalty
+    }
+    if isinstance(step, Variable):
+        inputs["Step"] = step
+    else:
+        attrs["step"] = step
+
+    selected_ids = helper.create_variable_for_type_inference(dtype="int64")
+    selected_scores = helper.create_variable_for_type_inference(
+        dtype=scores.dtype)
+    parent_idx = helper.create_variable_for_type_inference(dtype="int64")
+    helper.append_op(
+        type="beam_search_step",
+        inputs=inputs,
+        outputs={
+            "SelectedIds": selected_ids,
+            "SelectedScores": selected_scores,
+            "ParentIdx": parent_idx
+        },
+        attrs=attrs)
+    for var in (selected_ids, selected_scores, parent_idx):
+        var.stop_gradient = True
+    return selected_ids, selected_scores, parent_idx
+
+
+def beam_reorder(states, parent_idx, inplace=True):
+    """
+    Reorders the states of the beams by the :attr:`parent_idx` of
+    :ref:`api_fluid_layers_beam_search_step`, i.e.
+    :math:`out[b * beam\_size + k] = state[b * beam\_size + parent\_idx[b, k]]`
+    for every state.
+
+    Args:
+        states(Variable|list(Variable)): The states, the rows of every state
+            are :attr:`[batch_size * beam_size]`. They can be of any data type.
+        parent_idx(Variable): The int64 tensor of
+            :attr:`[batch_size, beam_size]`.
+        inplace(bool): Whether the states are reordered in place. Default True.
+
+    Returns:
+        Variable|list(Variable): The reordered states, which are
+            :attr:`states` if :attr:`inplace` is True.
+
+    Examples:
+        .. code-block:: python
+
+            import paddle.fluid as fluid
+
+            cache = fluid.data(name='cache', shape=[8, 16, 64], dtype='float32')
+            parent_idx = fluid.data(
+                name='parent_idx', shape=[2, 4], dtype='int64')
+            fluid.layers.beam_reorder(cache, parent_idx)
+    """
+    helper = LayerHelper('beam_reorder', **locals())
+    is_list = isinstance(states, (list, tuple))
+    if not is_list:
+        states = [states]
+    if inplace:
+        outs = list(states)
+    else:
+        outs = [
+            helper.create_variable_for_type_inference(dtype=state.dtype)
+            for state in states
+        ]
+    helper.append_op(
+        type="beam_reorder",
+        inputs={"X": states,
+                "ParentIdx": parent_idx},
+        outputs={"Out": outs})
+    return outs if is_list else outs[0]
+
+
 def mse_loss(input, label):
     """
     This op accepts input predications and target label and returns the mean square error.
@@ -0,0 +1,196 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+import paddle.fluid as fluid
+
+
+def beam_search_step(scores, pre_ids, pre_scores, beam_size, step, eos_id,
+                     pad_id, unk_id, ignore_unk, min_gen_len, length_average,
+                     length_penalty):
+    vocab_size = scores.shape[-1]
+    scores = scores.reshape([-1, vocab_size]).astype("float64")
+    if ignore_unk:
+        scores[:, unk_id] += -1e10
+    if step <= min_gen_len:
+        scores[:, eos_id] += -1e10
+    if pre_ids is None:
+        candidates = scores.reshape([-1, 1, vocab_size])
+    else:
+        if length_average:
+            pre_scale, scale = 1 - 1.0 / step, 1.0 / step
+        elif length_penalty >= 0:
+            pre_scale = np.power((4.0 + step) / (5.0 + step), length_penalty)
+            scale = np.power(1.0 / (5.0 + step), length_penalty)
+        else:
+            pre_scale, scale = 1.0, 1.0
+        batch_size, pre_beam = pre_ids.shape
+        candidates = pre_scores.reshape([-1, 1]) * pre_scale + scores * scale
+        finished = np.logical_or(pre_ids == eos_id,
+                                 pre_ids == pad_id).reshape([-1])
+        candidates[finished, :] = -np.inf
+        candidates[finished, pad_id] = pre_scores.reshape([-1])[finished]
+        candidates = candidates.reshape([batch_size, pre_beam, vocab_size])
+
+    flat = candidates.reshape([candidates.shape[0], -1])
+    index = np.argsort(-flat, axis=1, kind="mergesort")[:, :beam_size]
+    selected_scores = flat[np.arange(flat.shape[0]).reshape([-1, 1]), index]
+    return (index % vocab_size, selected_scores, index // vocab_size)
+
+
+class TestBeamSearchStepOp(OpTest):
+    def setUp(self):
+        self.op_type = "beam_search_step"
+        self.batch_size, self.beam_size, self.vocab_size = 3, 4, 20
+        self.eos_id, self.pad_id, self.unk_id = 1, 0, 2
+        self.step = 3
+        self.ignore_unk = True
+        self.min_gen_len = 1
+        self.length_average = False
+        self.length_penalty = -1.0
+        self.first_step = False
+        self.sparse = False
+        self.set_config()
+
+        rows = self.batch_size * (1 if self.first_step else self.beam_size)
+        scores = np.log(
+            np.random.dirichlet(
+                np.ones(self.vocab_size), size=rows)).astype("float32")
+        if self.sparse:
+            # Only the top beam_size + 2 tokens of every beam.
+            ids = np.argsort(-scores, axis=1)[:, :self.beam_size + 2]
+            self.inputs = {
+                "Scores": scores[np.arange(rows).reshape([-1, 1]), ids],
+                "Ids": ids.astype("int64")
+            }
+        else:
+            self.inputs = {"Scores": scores}
+        pre_ids, pre_scores = None, None
+        if not self.first_step:
+            pre_ids = np.random.randint(
+                3, self.vocab_size,
+                (self.batch_size, self.beam_size)).astype("int64")
+            pre_ids[0, 1] = self.eos_id
+            pre_ids[1, 2] = self.pad_id
+            pre_scores = -np.random.uniform(
+                1, 5, (self.batch_size, self.beam_size)).astype("float32")
+            self.inputs["PreIds"] = pre_ids
+            self.inputs["PreScores"] = pre_scores
+        self.attrs = {
+            "beam_size": self.beam_size,
+            "step": self.step,
+            "eos_id": self.eos_id,
+            "pad_id": self.pad_id,
+            "unk_id": self.unk_id,
+            "ignore_unk": self.ignore_unk,
+            "min_gen_len": self.min_gen_len,
+            "length_average": self.length_average,
+            "length_penalty": self.length_penalty
+        }
+        ids, selected_scores, parents = beam_search_step(
+            scores, pre_ids, pre_scores, self.beam_size, self.step,
+            self.eos_id, self.pad_id, self.unk_id, self.ignore_unk,
+            self.min_gen_len, self.length_average, self.length_penalty)
+        self.outputs = {
+            "SelectedIds": ids.astype("int64"),
+            "SelectedScores": selected_scores.astype("float32"),
+            "ParentIdx": parents.astype("int64")
+        }
+
+    def set_config(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output(atol=1e-5)
+
+
+class TestBeamSearchStepOpFirstStep(TestBeamSearchStepOp):
+    def set_config(self):
+        self.first_step = True
+        self.step = 1
+        self.min_gen_len = 2
+
+
+class TestBeamSearchStepOpLengthAverage(TestBeamSearchStepOp):
+    def set_config(self):
+        self.length_average = True
+        self.min_gen_len = 3
+
+
+class TestBeamSearchStepOpLengthPenalty(TestBeamSearchStepOp):
+    def set_config(self):
+        self.ignore_unk = False
+        self.length_penalty = 0.6
+
+
+class TestBeamSearchStepOpSparse(TestBeamSearchStepOp):
+    def set_config(self):
+        self.sparse = True
+        self.min_gen_len = 3
+        self.length_penalty = 0.6
+
+
+class TestBeamSearchStepOpSparseFirstStep(TestBeamSearchStepOp):
+    def set_config(self):
+        self.sparse = True
+        self.first_step = True
+        self.step = 1
+
+
+class TestBeamReorderOp(OpTest):
+    def setUp(self):
+        self.op_type = "beam_reorder"
+        batch_size, beam_size = 3, 4
+        parents = np.random.randint(
+            0, beam_size, (batch_size, beam_size)).astype("int64")
+        parents[1] = np.arange(beam_size)
+        index = (np.arange(batch_size).reshape([-1, 1]) * beam_size + parents
+                 ).reshape([-1])
+        x0 = np.random.random((batch_size * beam_size, 5)).astype("float32")
+        x1 = np.random.randint(0, 10, (batch_size * beam_size, 2,
+                                       3)).astype("int64")
+        self.inputs = {"X": [("x0", x0), ("x1", x1)], "ParentIdx": parents}
+        self.outputs = {"Out": [("out0", x0[index]), ("out1", x1[index])]}
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestBeamSearchStepAPI(unittest.TestCase):
+    def test_case(self):
+        scores = fluid.data(name='scores', shape=[8, 10], dtype='float32')
+        pre_ids = fluid.data(name='pre_ids', shape=[2, 4], dtype='int64')
+        pre_scores = fluid.data(
+            name='pre_scores', shape=[2, 4], dtype='float32')
+        cache = fluid.data(name='cache', shape=[8, 6], dtype='float32')
+        ids, selected_scores, parents = fluid.layers.beam_search_step(
+            scores,
+            beam_size=4,
+            eos_id=1,
+            pad_id=0,
+            pre_ids=pre_ids,
+            pre_scores=pre_scores,
+            step=2,
+            length_penalty=0.6)
+        out = fluid.layers.beam_reorder(cache, parents)
+        self.assertEqual(out.name, cache.name)
+        self.assertEqual(list(ids.shape), [2, 4])
+
+
+if __name__ == "__main__":
+    unittest.main()
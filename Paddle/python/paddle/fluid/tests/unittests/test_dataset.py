@@ -404,6 +404,60 @@ class TestDataset(unittest.TestCase):
         os.remove("./test_queue_dataset_run_a.txt")
         os.remove("./test_queue_dataset_run_b.txt")
 
+    def test_queue_dataset_run_bucketing(self):
+        """
+        Testcase for QueueDataset with shuffle buffer and length bucketing.
+        """
+        with open("test_queue_dataset_run_bucketing.txt", "w") as f:
+            for i in range(1, 21):
+                length = i % 5 + 1
+                f.write("%d %s 1 %d\n" % (length, " ".join([str(i)] * length),
+                                          i))
+
+        slots = ["bucket_slot1", "bucket_slot2"]
+        slots_vars = []
+        for slot in slots:
+            var = fluid.layers.data(
+                name=slot, shape=[1], dtype="int64", lod_level=1)
+            slots_vars.append(var)
+
+        batch_token_budget = 8
+        dataset = fluid.DatasetFactory().create_dataset("QueueDataset")
+        dataset.set_batch_size(4)
+        dataset.set_thread(1)
+        dataset.set_filelist(["test_queue_dataset_run_bucketing.txt"])
+        dataset.set_pipe_command("cat")
+        dataset.set_use_var(slots_vars)
+        dataset.set_shuffle_buffer_size(3)
+        dataset.set_batch_token_budget(batch_token_budget, bucket_pool_size=7)
+
+        exe = fluid.Executor(fluid.CPUPlace())
+        exe.run(fluid.default_startup_program())
+        if self.use_data_loader:
+            data_loader = fluid.io.DataLoader.from_dataset(
+                dataset, fluid.cpu_places(), self.drop_last)
+            for i in range(self.epoch_num):
+                ids = []
+                for data in data_loader():
+                    lod = data[0]["bucket_slot1"].recursive_sequence_lengths()
+                    lengths = lod[0]
+                    self.assertLessEqual(len(lengths), 4)
+                    if len(lengths) > 1:
+                        self.assertLessEqual(
+                            max(lengths) * len(lengths), batch_token_budget)
+                    ids.extend(
+                        np.array(data[0]["bucket_slot2"]).flatten().tolist())
+                self.assertEqual(sorted(ids), list(range(1, 21)))
+        else:
+            for i in range(self.epoch_num):
+                try:
+                    exe.train_from_dataset(fluid.default_main_program(),
+                                           dataset)
+                except Exception as e:
+                    self.assertTrue(False)
+
+        os.remove("./test_queue_dataset_run_bucketing.txt")
+
 
 class TestDatasetWithDataLoader(TestDataset):
     def setUp(self):
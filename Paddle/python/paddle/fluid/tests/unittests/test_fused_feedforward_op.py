@@ -0,0 +1,111 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import math
+import unittest
+import numpy as np
+from op_test import OpTest
+import paddle.fluid as fluid
+
+
+def gelu(x):
+    return 0.5 * x * (1 + np.vectorize(math.erf)(x / np.sqrt(2)))
+
+
+class TestFusedFeedForwardOp(OpTest):
+    def setUp(self):
+        self.op_type = "fused_feedforward"
+        self.dtype = "float64"
+        self.batch_size, self.seq_len, self.d_model = 2, 5, 8
+        self.inner_size = 32
+        self.tile_rows = 4
+        self.dropout_prob = 0.0
+        self.set_config()
+
+        x = np.random.uniform(
+            -1, 1,
+            [self.batch_size, self.seq_len, self.d_model]).astype(self.dtype)
+        w1 = np.random.uniform(
+            -0.5, 0.5, [self.d_model, self.inner_size]).astype(self.dtype)
+        b1 = np.random.uniform(-0.5, 0.5, [self.inner_size]).astype(self.dtype)
+        w2 = np.random.uniform(
+            -0.5, 0.5, [self.inner_size, self.d_model]).astype(self.dtype)
+        b2 = np.random.uniform(-0.5, 0.5, [self.d_model]).astype(self.dtype)
+        self.inputs = {
+            "X": x,
+            "Linear1W": w1,
+            "Linear1Bias": b1,
+            "Linear2W": w2,
+            "Linear2Bias": b2
+        }
+        self.attrs = {
+            "dropout_prob": self.dropout_prob,
+            "fix_seed": True,
+            "seed": 1,
+            "tile_rows": self.tile_rows
+        }
+
+        pre = np.dot(x, w1) + b1
+        out = np.dot(gelu(pre), w2) + b2
+        self.outputs = {
+            "Out": out,
+            "Linear1Out": pre,
+            "Seed": np.array([1]).astype("int32")
+        }
+
+    def set_config(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output(atol=1e-8)
+
+    def test_check_grad(self):
+        self.check_grad(
+            ["X", "Linear1W", "Linear1Bias", "Linear2W", "Linear2Bias"],
+            "Out")
+
+
+class TestFusedFeedForwardOpOneTile(TestFusedFeedForwardOp):
+    def set_config(self):
+        self.tile_rows = 32
+
+
+class TestFusedFeedForwardOpDropout(TestFusedFeedForwardOp):
+    def set_config(self):
+        self.dropout_prob = 0.3
+
+    def test_check_output(self):
+        # The dropout mask can't be reproduced, the gradients are checked
+        # against the forward with the same seed.
+        pass
+
+
+class TestFusedFeedForwardAPI(unittest.TestCase):
+    def test_case(self):
+        x = fluid.data(name='x', shape=[2, 5, 8], dtype='float32')
+        w1 = fluid.layers.create_parameter(shape=[8, 32], dtype='float32')
+        b1 = fluid.layers.create_parameter(
+            shape=[32], dtype='float32', is_bias=True)
+        w2 = fluid.layers.create_parameter(shape=[32, 8], dtype='float32')
+        b2 = fluid.layers.create_parameter(
+            shape=[8], dtype='float32', is_bias=True)
+        out = fluid.contrib.layers.fused_feedforward(
+            x, w1, b1, w2, b2, dropout_prob=0.1)
+        self.assertEqual(list(out.shape), [2, 5, 8])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,142 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+import paddle.fluid as fluid
+
+
+def multihead_attention(x, qkv_w, qkv_bias, out_w, out_bias, mask,
+                        num_heads):
+    batch_size, seq_len, hidden = x.shape
+    head_dim = hidden // num_heads
+    qkv = np.dot(x, qkv_w) + qkv_bias
+    # shape: [3, batch_size, num_heads, seq_len, head_dim]
+    q, k, v = qkv.reshape([batch_size, seq_len, 3, num_heads,
+                           head_dim]).transpose([2, 0, 3, 1, 4])
+    scores = np.matmul(q, k.transpose([0, 1, 3, 2])) / np.sqrt(head_dim)
+    if mask is not None:
+        m = mask[:, np.newaxis]
+        scores = (1 - m) * scores + m * -1e10
+    row_max = scores.max(axis=-1, keepdims=True)
+    lse = row_max + np.log(
+        np.exp(scores - row_max).sum(axis=-1, keepdims=True))
+    weights = np.exp(scores - lse)
+    if mask is not None:
+        weights = (1 - m) * weights
+    attn = np.matmul(weights, v).transpose([0, 2, 1, 3]).reshape(
+        [batch_size, seq_len, hidden])
+    out = np.dot(attn, out_w) + out_bias
+    return out, qkv, attn, lse[..., 0]
+
+
+class TestFusedMultiHeadAttentionOp(OpTest):
+    def setUp(self):
+        self.op_type = "fused_multihead_attention"
+        self.dtype = "float64"
+        self.batch_size, self.seq_len, self.hidden = 2, 5, 8
+        self.num_heads = 2
+        self.with_mask = True
+        self.dropout_prob = 0.0
+        self.set_config()
+
+        hidden = self.hidden
+        x = np.random.uniform(
+            -1, 1, [self.batch_size, self.seq_len, hidden]).astype(self.dtype)
+        qkv_w = np.random.uniform(-0.5, 0.5,
+                                  [hidden, 3 * hidden]).astype(self.dtype)
+        qkv_bias = np.random.uniform(-0.5, 0.5, [3 * hidden]).astype(self.dtype)
+        out_w = np.random.uniform(-0.5, 0.5,
+                                  [hidden, hidden]).astype(self.dtype)
+        out_bias = np.random.uniform(-0.5, 0.5, [hidden]).astype(self.dtype)
+        self.inputs = {
+            "X": x,
+            "QKVW": qkv_w,
+            "QKVBias": qkv_bias,
+            "OutLinearW": out_w,
+            "OutLinearBias": out_bias
+        }
+        mask = None
+        if self.with_mask:
+            # causal, and the last position of the first batch is a padding
+            mask = np.triu(
+                np.ones([self.seq_len, self.seq_len]), 1).astype(self.dtype)
+            mask = np.tile(mask, [self.batch_size, 1, 1])
+            mask[0, :, -1] = 1
+            mask[0, -1, :] = 1
+            self.inputs["Mask"] = mask
+        self.attrs = {
+            "num_heads": self.num_heads,
+            "dropout_prob": self.dropout_prob,
+            "fix_seed": True,
+            "seed": 1
+        }
+
+        out, qkv, attn, lse = multihead_attention(
+            x, qkv_w, qkv_bias, out_w, out_bias, mask, self.num_heads)
+        self.outputs = {
+            "Out": out,
+            "QKVOut": qkv,
+            "AttnOut": attn,
+            "SoftmaxLse": lse,
+            "Seed": np.array([1]).astype("int32")
+        }
+
+    def set_config(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output(atol=1e-8)
+
+    def test_check_grad(self):
+        self.check_grad(
+            ["X", "QKVW", "QKVBias", "OutLinearW", "OutLinearBias"], "Out")
+
+
+class TestFusedMultiHeadAttentionOpNoMask(TestFusedMultiHeadAttentionOp):
+    def set_config(self):
+        self.with_mask = False
+        self.num_heads = 4
+
+
+class TestFusedMultiHeadAttentionOpDropout(TestFusedMultiHeadAttentionOp):
+    def set_config(self):
+        self.dropout_prob = 0.3
+
+    def test_check_output(self):
+        # The dropout mask can't be reproduced, the gradients are checked
+        # against the forward with the same seed.
+        pass
+
+
+class TestFusedMultiHeadAttentionAPI(unittest.TestCase):
+    def test_case(self):
+        x = fluid.data(name='x', shape=[2, 5, 8], dtype='float32')
+        mask = fluid.data(name='mask', shape=[2, 5, 5], dtype='float32')
+        qkv_w = fluid.layers.create_parameter(shape=[8, 24], dtype='float32')
+        qkv_bias = fluid.layers.create_parameter(
+            shape=[24], dtype='float32', is_bias=True)
+        out_w = fluid.layers.create_parameter(shape=[8, 8], dtype='float32')
+        out_bias = fluid.layers.create_parameter(
+            shape=[8], dtype='float32', is_bias=True)
+        out = fluid.contrib.layers.fused_multihead_attention(
+            x, qkv_w, qkv_bias, out_w, out_bias, num_heads=2, mask=mask)
+        self.assertEqual(list(out.shape), [2, 5, 8])
+
+
+if __name__ == "__main__":
+    unittest.main()
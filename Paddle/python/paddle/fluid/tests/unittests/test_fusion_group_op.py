@@ -0,0 +1,107 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import math
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+class TestFusionGroupOp(OpTest):
+    def setUp(self):
+        self.op_type = 'fusion_group'
+        self.shape = [8, 37]
+        self.set_conf()
+        mask = np.random.randint(0, 2, self.shape).astype('float32')
+        scores = np.random.uniform(-1, 1, self.shape).astype('float32')
+
+        # (1 - mask) * scores + scale(mask, -1e10), with variables
+        # 0: mask, 1: scores, 2: 1 - mask, 3: (1 - mask) * scores,
+        # 4: -1e10 * mask, 5: out
+        self.attrs = {
+            'op_types':
+            ['scale', 'elementwise_mul', 'scale', 'elementwise_add'],
+            'op_args': [0, -1, 2, 2, 1, 3, 0, -1, 4, 3, 4, 5],
+            'op_scales': [-1.0, 1.0, -1e10, 1.0],
+            'op_biases': [1.0, 0.0, 0.0, 0.0],
+            'out_ids': [5],
+        }
+        out = (1 - mask) * scores + mask * np.float32(-1e10)
+        self.inputs = {'Inputs': [('mask', mask), ('scores', scores)]}
+        self.outputs = {'Outs': [('out', out)]}
+
+    def test_check_output(self):
+        self.check_output()
+
+    def set_conf(self):
+        pass
+
+
+class TestFusionGroupOpLarge(TestFusionGroupOp):
+    def set_conf(self):
+        # Several tiles and a partial tail.
+        self.shape = [7, 1000]
+
+
+class TestFusionGroupOpActivations(OpTest):
+    def setUp(self):
+        self.op_type = 'fusion_group'
+        x = np.random.uniform(-2, 2, [4, 300]).astype('float32')
+        y = np.random.uniform(0.5, 2, [4, 300]).astype('float32')
+
+        # Two outputs: relu(x) / y and sigmoid(tanh(relu(x) / y) - x).
+        self.attrs = {
+            'op_types': [
+                'relu', 'elementwise_div', 'tanh', 'elementwise_sub',
+                'sigmoid'
+            ],
+            'op_args':
+            [0, -1, 2, 2, 1, 3, 3, -1, 4, 4, 0, 5, 5, -1, 6],
+            'out_ids': [3, 6],
+        }
+        div = np.maximum(x, 0) / y
+        out = 1 / (1 + np.exp(-(np.tanh(div) - x)))
+        self.inputs = {'Inputs': [('x', x), ('y', y)]}
+        self.outputs = {'Outs': [('div', div), ('out', out)]}
+
+    def test_check_output(self):
+        self.check_output(atol=1e-5)
+
+
+class TestFusionGroupOpGelu(OpTest):
+    def setUp(self):
+        self.op_type = 'fusion_group'
+        x = np.random.uniform(-2, 2, [4, 300]).astype('float32')
+        b = np.random.uniform(-1, 1, [4, 300]).astype('float32')
+
+        # gelu(x + b)
+        self.attrs = {
+            'op_types': ['elementwise_add', 'gelu'],
+            'op_args': [0, 1, 2, 2, -1, 3],
+            'out_ids': [3],
+        }
+        add = x + b
+        erf = np.vectorize(math.erf)(add / math.sqrt(2))
+        out = (0.5 * add * (1 + erf)).astype('float32')
+        self.inputs = {'Inputs': [('x', x), ('b', b)]}
+        self.outputs = {'Outs': [('out', out)]}
+
+    def test_check_output(self):
+        self.check_output(atol=1e-5)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,144 @@
+# Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import paddle.fluid as fluid
+import numpy as np
+from paddle.fluid.dygraph import FC, Embedding, Layer
+
+
+class MLP(Layer):
+    def __init__(self, name_scope):
+        super(MLP, self).__init__(name_scope)
+        self._fc1 = FC(self.full_name(), 16, num_flatten_dims=2, act="tanh")
+        self._fc2 = FC(self.full_name(), 8, num_flatten_dims=2)
+
+    def forward(self, x):
+        return self._fc2(self._fc1(x))
+
+
+class TestImperativeGradientAccumulation(unittest.TestCase):
+    def backward(self, mlp, x_np):
+        loss = fluid.layers.reduce_mean(mlp(fluid.dygraph.to_variable(x_np)))
+        loss.backward()
+        return [p.gradient() for p in mlp.parameters()]
+
+    def check_accumulation(self, coalesce):
+        with fluid.dygraph.guard():
+            mlp = MLP("mlp")
+            x1 = np.random.uniform(-1, 1, [2, 3, 8]).astype("float32")
+            x2 = np.random.uniform(-1, 1, [2, 3, 8]).astype("float32")
+            grads1 = self.backward(mlp, x1)
+            mlp.clear_gradients()
+            grads2 = self.backward(mlp, x2)
+            mlp.clear_gradients()
+
+            mlp.accumulate_gradients(coalesce)
+            mlp.clear_gradients()
+            self.backward(mlp, x1)
+            grads = self.backward(mlp, x2)
+            for grad, grad1, grad2 in zip(grads, grads1, grads2):
+                self.assertTrue(np.allclose(grad, grad1 + grad2, atol=1e-6))
+
+            if coalesce:
+                buffer = mlp._grad_buffer
+                self.assertEqual(buffer.num_params, len(mlp.parameters()))
+                self.assertEqual(
+                    np.array(buffer.buffer.value().get_tensor()).size,
+                    sum(np.prod(p.shape) for p in mlp.parameters()))
+
+            mlp.clear_gradients()
+            for p in mlp.parameters():
+                self.assertTrue(np.all(p.gradient() == 0))
+            grads = self.backward(mlp, x1)
+            for grad, grad1 in zip(grads, grads1):
+                self.assertTrue(np.allclose(grad, grad1, atol=1e-6))
+
+    def test_accumulate(self):
+        self.check_accumulation(False)
+
+    def test_accumulate_coalesced(self):
+        self.check_accumulation(True)
+
+    def check_sparse_accumulation(self, coalesce):
+        weight = np.random.uniform(-1, 1, [10, 4]).astype("float32")
+        ids = [
+            np.array([[1], [3], [1]]).astype("int64"),
+            np.array([[3], [7]]).astype("int64")
+        ]
+        expected = np.zeros_like(weight)
+        for x in ids:
+            np.add.at(expected, x.flatten(), 2 * weight[x.flatten()])
+
+        with fluid.dygraph.guard():
+            for is_sparse in [False, True]:
+                emb = Embedding(
+                    "emb",
+                    size=[10, 4],
+                    is_sparse=is_sparse,
+                    param_attr=fluid.ParamAttr(
+                        initializer=fluid.initializer.NumpyArrayInitializer(
+                            weight)))
+                emb.accumulate_gradients(coalesce)
+                for x in ids:
+                    out = emb(fluid.dygraph.to_variable(x))
+                    loss = fluid.layers.reduce_sum(out * out)
+                    loss.backward()
+                grad = emb.weight.gradient()
+                self.assertTrue(np.allclose(grad, expected, atol=1e-6))
+
+                emb.clear_gradients()
+                self.assertTrue(np.all(emb.weight.gradient() == 0))
+
+    def test_accumulate_sparse(self):
+        self.check_sparse_accumulation(False)
+
+    def test_accumulate_sparse_coalesced(self):
+        self.check_sparse_accumulation(True)
+
+    def test_optimizer(self):
+        with fluid.dygraph.guard():
+            x_np = np.random.uniform(-1, 1, [4, 3, 8]).astype("float32")
+            fluid.default_main_program().random_seed = 90
+            mlp = MLP("mlp")
+            mlp(fluid.dygraph.to_variable(x_np))
+            params = [p.numpy() for p in mlp.parameters()]
+            sgd = fluid.optimizer.SGDOptimizer(learning_rate=0.1)
+
+            # One step of the whole batch.
+            loss = fluid.layers.reduce_mean(
+                mlp(fluid.dygraph.to_variable(x_np)))
+            loss.backward()
+            sgd.minimize(loss, parameter_list=mlp.parameters())
+            mlp.clear_gradients()
+            expected = [p.numpy() for p in mlp.parameters()]
+
+            # One step of two accumulated halves.
+            for p, value in zip(mlp.parameters(), params):
+                p.set_value(value)
+            mlp.accumulate_gradients()
+            for x in np.split(x_np, 2):
+                loss = fluid.layers.reduce_mean(
+                    mlp(fluid.dygraph.to_variable(x))) / 2
+                loss.backward()
+            sgd.minimize(loss, parameter_list=mlp.parameters())
+            mlp.clear_gradients()
+            for p, value in zip(mlp.parameters(), expected):
+                self.assertTrue(np.allclose(p.numpy(), value, atol=1e-6))
+
+
+if __name__ == '__main__':
+    unittest.main()
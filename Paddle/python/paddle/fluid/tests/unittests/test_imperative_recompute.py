@@ -0,0 +1,96 @@
+# Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import paddle.fluid as fluid
+import numpy as np
+from paddle.fluid.dygraph import BatchNorm, FC, Layer
+
+
+class MLP(Layer):
+    def __init__(self, name_scope):
+        super(MLP, self).__init__(name_scope)
+        self._fc1 = FC(self.full_name(), 16, num_flatten_dims=2, act="tanh")
+        self._fc2 = FC(self.full_name(), 8, num_flatten_dims=2)
+
+    def forward(self, x):
+        return self._fc2(self._fc1(x))
+
+
+class Dropout(Layer):
+    def forward(self, x):
+        out = fluid.layers.dropout(
+            x, 0.5, dropout_implementation="upscale_in_train")
+        return fluid.layers.scale(out, scale=2.0)
+
+
+class TestImperativeRecompute(unittest.TestCase):
+    def run_mlp(self, mlp, x_np, checkpoint):
+        mlp.checkpoint(checkpoint)
+        x = fluid.dygraph.to_variable(x_np)
+        x.stop_gradient = False
+        loss = fluid.layers.reduce_mean(mlp(x))
+        loss.backward()
+        grads = [x.gradient()] + [p.gradient() for p in mlp.parameters()]
+        mlp.clear_gradients()
+        return loss.numpy(), grads
+
+    def test_same_gradients(self):
+        with fluid.dygraph.guard():
+            mlp = MLP("mlp")
+            x_np = np.random.uniform(-1, 1, [2, 3, 8]).astype("float32")
+            loss, grads = self.run_mlp(mlp, x_np, False)
+            ckpt_loss, ckpt_grads = self.run_mlp(mlp, x_np, True)
+            self.assertTrue(np.array_equal(loss, ckpt_loss))
+            for grad, ckpt_grad in zip(grads, ckpt_grads):
+                self.assertTrue(np.allclose(grad, ckpt_grad))
+
+    def test_same_dropout_mask(self):
+        with fluid.dygraph.guard():
+            layer = Dropout("dropout")
+            layer.checkpoint()
+            x_np = np.random.uniform(1, 2, [4, 32]).astype("float32")
+            x = fluid.dygraph.to_variable(x_np)
+            x.stop_gradient = False
+            out = layer(x)
+            loss = fluid.layers.reduce_sum(out)
+            loss.backward()
+            # The gradient is 2 * mask / (1 - p) only if the recomputed mask
+            # is the same as the one of the forward.
+            self.assertTrue(
+                np.allclose(x.gradient(), out.numpy() / x_np, atol=1e-6))
+
+    def run_batch_norm(self, checkpoint):
+        bn = BatchNorm("bn", 4)
+        bn.checkpoint(checkpoint)
+        x_np = np.arange(24).reshape([2, 4, 3]).astype("float32")
+        x = fluid.dygraph.to_variable(x_np)
+        x.stop_gradient = False
+        loss = fluid.layers.reduce_mean(fluid.layers.tanh(bn(x)))
+        loss.backward()
+        return x.gradient(), bn._mean.numpy(), bn._variance.numpy()
+
+    def test_running_stats_updated_once(self):
+        with fluid.dygraph.guard():
+            grad, mean, variance = self.run_batch_norm(False)
+            ckpt_grad, ckpt_mean, ckpt_variance = self.run_batch_norm(True)
+            self.assertTrue(np.allclose(grad, ckpt_grad))
+            self.assertTrue(np.array_equal(mean, ckpt_mean))
+            self.assertTrue(np.array_equal(variance, ckpt_variance))
+
+
+if __name__ == '__main__':
+    unittest.main()
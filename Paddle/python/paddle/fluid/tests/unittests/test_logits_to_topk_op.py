@@ -0,0 +1,95 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+import paddle.fluid as fluid
+
+
+def logits_to_topk(x, w, k, transpose_w):
+    hidden = x.shape[-1]
+    logits = np.dot(
+        x.reshape([-1, hidden]).astype("float64"),
+        (w.T if transpose_w else w).astype("float64"))
+    logits -= logits.max(axis=1, keepdims=True)
+    log_probs = logits - np.log(np.exp(logits).sum(axis=1, keepdims=True))
+    indices = np.argsort(-log_probs, axis=1, kind="mergesort")[:, :k]
+    out = log_probs[np.arange(log_probs.shape[0]).reshape([-1, 1]), indices]
+    out_shape = list(x.shape[:-1]) + [k]
+    return out.reshape(out_shape), indices.reshape(out_shape)
+
+
+class TestLogitsToTopKOp(OpTest):
+    def setUp(self):
+        self.op_type = "logits_to_topk"
+        self.x_shape = [6, 32]
+        self.vocab_size = 100
+        self.k = 5
+        self.transpose_w = True
+        self.tile_size = 16
+        self.set_config()
+
+        hidden = self.x_shape[-1]
+        x = np.random.uniform(-1, 1, self.x_shape).astype("float32")
+        w_shape = [self.vocab_size, hidden] if self.transpose_w else [
+            hidden, self.vocab_size
+        ]
+        w = np.random.uniform(-1, 1, w_shape).astype("float32")
+        out, indices = logits_to_topk(x, w, self.k, self.transpose_w)
+        self.inputs = {"X": x, "W": w}
+        self.attrs = {
+            "k": self.k,
+            "transpose_w": self.transpose_w,
+            "tile_size": self.tile_size
+        }
+        self.outputs = {
+            "Out": out.astype("float32"),
+            "Indices": indices.astype("int64")
+        }
+
+    def set_config(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output(atol=1e-4)
+
+
+class TestLogitsToTopKOpNotTransposed(TestLogitsToTopKOp):
+    def set_config(self):
+        self.x_shape = [2, 3, 16]
+        self.transpose_w = False
+
+
+class TestLogitsToTopKOpOneTile(TestLogitsToTopKOp):
+    def set_config(self):
+        self.k = 1
+        self.tile_size = 2048
+
+
+class TestLogitsToTopKAPI(unittest.TestCase):
+    def test_case(self):
+        hidden = fluid.data(name='hidden', shape=[8, 64], dtype='float32')
+        embedding = fluid.layers.create_parameter(
+            shape=[1000, 64], dtype='float32')
+        log_probs, ids = fluid.contrib.layers.logits_to_topk(
+            hidden, embedding, k=6)
+        self.assertEqual(list(log_probs.shape), [8, 6])
+        self.assertEqual(list(ids.shape), [8, 6])
+
+
+if __name__ == "__main__":
+    unittest.main()
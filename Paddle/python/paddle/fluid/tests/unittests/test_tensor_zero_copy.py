@@ -0,0 +1,128 @@
+# Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import gc
+import sys
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+class TestTensorShareDataWithArray(unittest.TestCase):
+    def test_share(self):
+        for dtype in [
+                'float16', 'float32', 'float64', 'int32', 'int64', 'uint8',
+                'int8', 'bool'
+        ]:
+            arr = np.arange(24).reshape([2, 3, 4]).astype(dtype)
+            t = fluid.LoDTensor()
+            self.assertTrue(t._share_data_with_array(arr))
+            self.assertEqual(t.shape(), [2, 3, 4])
+            view = np.array(t, copy=False)
+            self.assertEqual(view.dtype, arr.dtype)
+            self.assertEqual(view.ctypes.data, arr.ctypes.data)
+
+    def test_keep_alive(self):
+        arr = np.ones([8, 16], 'float32')
+        refcount = sys.getrefcount(arr)
+        t = fluid.LoDTensor()
+        self.assertTrue(t._share_data_with_array(arr))
+        self.assertEqual(sys.getrefcount(arr), refcount + 1)
+        arr[0, 0] = 2
+        self.assertEqual(np.array(t)[0, 0], 2)
+        del t
+        gc.collect()
+        self.assertEqual(sys.getrefcount(arr), refcount)
+
+    def test_not_shared(self):
+        arr = np.ones([8, 16], 'float32')
+        t = fluid.LoDTensor()
+        # Strided, read-only and unsupported arrays are not shared.
+        self.assertFalse(t._share_data_with_array(arr[:, ::2]))
+        readonly = arr.copy()
+        readonly.flags.writeable = False
+        self.assertFalse(t._share_data_with_array(readonly))
+        self.assertFalse(
+            t._share_data_with_array(np.ones([2], 'complex64')))
+        self.assertFalse(t._is_initialized())
+
+
+class TestTensorToNumpyView(unittest.TestCase):
+    def test_view(self):
+        t = fluid.LoDTensor()
+        t.set(np.arange(6).reshape([2, 3]).astype('int64'), fluid.CPUPlace())
+        view = np.array(t, copy=False)
+        copy = np.array(t)
+        view[1, 2] = 100
+        self.assertEqual(np.array(t)[1, 2], 100)
+        self.assertEqual(copy[1, 2], 5)
+        # The view keeps the memory alive after the tensor is cleared.
+        t._clear()
+        del t
+        gc.collect()
+        self.assertEqual(view[1, 2], 100)
+
+
+class TestDLPackZeroCopy(unittest.TestCase):
+    def test_round_trip(self):
+        arr = np.random.random([2, 3, 4]).astype('float32')
+        t = fluid.LoDTensor()
+        t.set(arr, fluid.CPUPlace())
+        capsule = t._to_dlpack(cudf_compatible=False)
+        t2 = core.from_dlpack(capsule, zero_copy=True)
+        self.assertEqual(t2.shape(), [2, 3, 4])
+        self.assertEqual(
+            np.array(t, copy=False).ctypes.data,
+            np.array(t2, copy=False).ctypes.data)
+        del t
+        gc.collect()
+        self.assertTrue(np.array_equal(np.array(t2), arr))
+
+    def test_unconsumed_capsule(self):
+        t = fluid.LoDTensor()
+        t.set(np.ones([4, 4], 'float32'), fluid.CPUPlace())
+        capsule = t._to_dlpack(cudf_compatible=False)
+        del capsule
+        gc.collect()
+        self.assertTrue(np.array_equal(np.array(t), np.ones([4, 4])))
+
+
+class TestDygraphZeroCopy(unittest.TestCase):
+    def test_to_variable(self):
+        arr = np.random.random([4, 5]).astype('float32')
+        with fluid.dygraph.guard(fluid.CPUPlace()):
+            var = fluid.dygraph.to_variable(arr, zero_copy=True)
+            out = fluid.layers.scale(var, scale=2.0)
+            self.assertTrue(np.allclose(out.numpy(), arr * 2))
+            arr[0, 0] = 10
+            self.assertEqual(var.numpy()[0, 0], 10)
+
+            # Strided arrays are copied.
+            strided = np.random.random([4, 10]).astype('float32')[:, ::2]
+            var = fluid.dygraph.to_variable(strided, zero_copy=True)
+            self.assertTrue(np.array_equal(var.numpy(), strided))
+
+    def test_numpy_is_a_copy(self):
+        with fluid.dygraph.guard(fluid.CPUPlace()):
+            var = fluid.dygraph.to_variable(np.zeros([3], 'float32'))
+            value = var.numpy()
+            value[0] = 1
+            self.assertEqual(var.numpy()[0], 0)
+
+
+if __name__ == '__main__':
+    unittest.main()
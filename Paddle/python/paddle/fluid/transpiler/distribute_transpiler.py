@@ -799,9 +799,12 @@ class DistributeTranspiler(object):
                 need_sparse_update_params[param_varname] = (eps, table_names)
             else:
                 recv_varnames = []
+                recv_sections = []
                 if self.config.runtime_split_send_recv:
                     orig_param = program.global_block().vars[param_varname]
                     recv_varnames = [var.name for var in splited_var]
+                    recv_sections = self._get_splited_var_sections(
+                        splited_var)
                     splited_var = [orig_param]
                 all_recv_outputs.extend(splited_var)
 
@@ -812,6 +815,7 @@ class DistributeTranspiler(object):
                     attrs={
                         "epmap": eps,
                         "recv_varnames": recv_varnames,
+                        "sections": recv_sections,
                         "trainer_id": self.trainer_id,
                         RPC_OP_ROLE_ATTR_NAME: RPC_OP_ROLE_ATTR_VALUE,
                         OP_ROLE_VAR_ATTR_NAME:
@@ -60,6 +60,21 @@ def gather(var, idx):
         return var
 
 
+def unique_vars(var, out=None):
+    if out is None:
+        out = []
+    if isinstance(var, list):
+        for x in var:
+            unique_vars(x, out)
+    elif isinstance(var, dict):
+        for x in var.values():
+            unique_vars(x, out)
+    elif isinstance(var, Variable):
+        if all(x is not var for x in out):
+            out.append(var)
+    return out
+
+
 class Generator(object):
     """ Genrator class. """
 
@@ -258,7 +273,7 @@ class TopKSampling(Sampling):
             o = np.random.choice(ids, p=p)
             preds.append(o)
         preds = np.array(preds, dtype="int64")
-        return fluid.dygraph.to_variable(preds)
+        return fluid.dygraph.to_variable(preds, zero_copy=True)
 
 
 class TopPSampling(Sampling):
@@ -287,7 +302,7 @@ class TopPSampling(Sampling):
             o = np.random.choice(ids[:i], p=p[:i]/np.sum(p[:i]))
             preds.append(o)
         preds = np.array(preds, dtype="int64")
-        return fluid.dygraph.to_variable(preds)
+        return fluid.dygraph.to_variable(preds, zero_copy=True)
 
 
 class BeamSearch(Generator):
@@ -303,6 +318,10 @@ class BeamSearch(Generator):
                            help="The parameter(alpha) of length penalty.")
         group.add_argument("--ignore_unk", type=str2bool, default=True,
                            help="Whether to ignore unkown token in generation.")
+        group.add_argument("--fused_topk", type=str2bool, default=False,
+                           help="Whether the model only computes the top "
+                           "beam_size + 2 tokens of every step. It only "
+                           "applies when decoding on CPU.")
         return group
 
     def __init__(self, hparams, bpe):
@@ -311,8 +330,15 @@ class BeamSearch(Generator):
         self.length_average = hparams.length_average
         self.length_penalty = hparams.length_penalty
         self.ignore_unk = hparams.ignore_unk
+        self.fused_topk = hparams.fused_topk
         return
 
+    def _split_scores(self, scores):
+        """ Returns the scores and the ids of the top-k tokens, or None. """
+        if isinstance(scores, tuple):
+            return scores
+        return scores, None
+
     def __call__(self, step_fn, state):
         """
         Running beam search.
@@ -323,6 +349,110 @@ class BeamSearch(Generator):
         @param : state : initial state
         @type : dict
         """
+        # beam_search_step and beam_reorder only have CPU kernels, so other
+        # places keep gathering the state on the device instead of copying
+        # it to CPU and back at every step.
+        if isinstance(fluid.framework._current_expected_place(),
+                      fluid.CPUPlace):
+            return self._dense_search(step_fn, state)
+        return self._gather_search(step_fn, state)
+
+    def _best_results(self, predictions, pre_ids, sequence_scores,
+                      pos_index, batch_size):
+        """ Returns the best finished beam of every example. """
+        beam_size = self.beam_size
+
+        # Only the beams ending with [EOS] or [PAD] are finished.
+        pre_eos_mask = F.equal(pre_ids, self.eos_id) + F.equal(pre_ids, self.pad_id)
+        sequence_scores = sequence_scores * pre_eos_mask + layers.scale(1 - pre_eos_mask, -1e10)
+
+        _, indices = layers.argsort(sequence_scores, axis=1)
+        indices = indices + pos_index
+        indices = layers.reshape(indices, [-1])
+        sequence_scores = layers.reshape(sequence_scores, [batch_size * beam_size])
+        predictions = layers.reshape(predictions, [batch_size * beam_size, -1])
+        sequence_scores = gather(sequence_scores, indices)
+        predictions = layers.gather(predictions, indices)
+        sequence_scores = layers.reshape(sequence_scores, [batch_size, beam_size])
+        predictions = layers.reshape(predictions, [batch_size, beam_size, -1])
+
+        results = {
+            "preds": predictions[:, -1],
+            "scores": sequence_scores[:, -1]
+        }
+        return results
+
+    def _dense_search(self, step_fn, state):
+        """ Beam search with the fused beam_search_step and beam_reorder. """
+        batch_size = state["batch_size"]
+        beam_size = self.beam_size
+
+        # shape: [batch_size, 1]
+        pos_index = layers.range(0, batch_size, 1, dtype="int64")
+        pos_index = layers.scale(pos_index, beam_size)
+        pos_index = F.unsqueeze(pos_index, [1])
+
+        # The top beam_size + 2 tokens always hold the best beam_size ones
+        # except [UNK] and [EOS].
+        if self.fused_topk:
+            state["decode_topk"] = beam_size + 2
+
+        # initial input
+        state["pred_token"] = layers.fill_constant(shape=[batch_size, 1, 1],
+                                                   dtype="int64",
+                                                   value=self.bos_id)
+        # shape: [batch_size, vocab_size]
+        scores, state = step_fn(state)
+        scores, ids = self._split_scores(scores)
+
+        # shape: [batch_size, beam_size]
+        pre_ids, sequence_scores, parent_idx = layers.beam_search_step(
+            scores, beam_size, self.eos_id, self.pad_id, step=1,
+            unk_id=self.unk_id, ignore_unk=self.ignore_unk,
+            min_gen_len=self.min_gen_len, ids=ids)
+
+        state = repeat(state, beam_size)
+
+        pred_list = [pre_ids]
+        parent_idx_list = [parent_idx]
+
+        for step in range(2, self.max_gen_len + 1):
+            state["pred_token"] = layers.reshape(pre_ids, shape=[batch_size * beam_size, 1, 1])
+            state["pred_mask"] = 1 - F.equal(state["pred_token"], self.pad_id)
+            state["pred_pos"] = state["pred_pos"] + 1
+            scores, state = step_fn(state)
+            scores, ids = self._split_scores(scores)
+
+            # Generate next
+            # scores shape: [batch_size * beam_size, vocab_size]
+            pre_ids, sequence_scores, parent_idx = layers.beam_search_step(
+                scores, beam_size, self.eos_id, self.pad_id,
+                pre_ids=pre_ids, pre_scores=sequence_scores, step=step,
+                unk_id=self.unk_id, ignore_unk=self.ignore_unk,
+                min_gen_len=self.min_gen_len,
+                length_average=self.length_average,
+                length_penalty=self.length_penalty, ids=ids)
+
+            # Reorder state in place
+            layers.beam_reorder(unique_vars(state), parent_idx)
+
+            pred_list.append(pre_ids)
+            parent_idx_list.append(parent_idx)
+
+        # shape: [batch_size, beam_size, max_gen_len]
+        predictions = layers.gather_tree(layers.stack(pred_list),
+                                         layers.stack(parent_idx_list))
+        predictions = layers.transpose(predictions, [1, 2, 0])
+        bos = layers.fill_constant(shape=[batch_size, beam_size, 1],
+                                   dtype="int64",
+                                   value=self.bos_id)
+        predictions = layers.concat([bos, predictions], axis=2)
+
+        return self._best_results(predictions, pre_ids, sequence_scores,
+                                  pos_index, batch_size)
+
+    def _gather_search(self, step_fn, state):
+        """ Beam search with topk and gather. """
         batch_size = state["batch_size"]
         beam_size = self.beam_size
 
@@ -420,24 +550,9 @@ class BeamSearch(Generator):
             predictions = layers.concat([predictions, F.unsqueeze(preds, [2])], axis=2)
 
         pre_ids = predictions[:, :, -1]
-        pre_eos_mask = F.equal(pre_ids, self.eos_id) + F.equal(pre_ids, self.pad_id)
-        sequence_scores = sequence_scores * pre_eos_mask + layers.scale(1 - pre_eos_mask, -1e10)
+        return self._best_results(predictions, pre_ids, sequence_scores,
+                                  pos_index, batch_size)
 
-        _, indices = layers.argsort(sequence_scores, axis=1)
-        indices = indices + pos_index
-        indices = layers.reshape(indices, [-1])
-        sequence_scores = layers.reshape(sequence_scores, [batch_size * beam_size])
-        predictions = layers.reshape(predictions, [batch_size * beam_size, -1])
-        sequence_scores = gather(sequence_scores, indices)
-        predictions = layers.gather(predictions, indices)
-        sequence_scores = layers.reshape(sequence_scores, [batch_size, beam_size])
-        predictions = layers.reshape(predictions, [batch_size, beam_size, -1])
-
-        results = {
-            "preds": predictions[:, -1],
-            "scores": sequence_scores[:, -1]
-        }
-        return results
 
 BeamSearch.register("BeamSearch")
 GreedySampling.register("GreedySampling")
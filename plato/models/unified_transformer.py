@@ -70,6 +70,15 @@ class UnifiedTransformer(ModelBase):
                            help="The dropout ratio of multi head attention.")
         group.add_argument("--ff_dropout", type=float, default=0.1,
                            help="The dropout ratio of feed forward network.")
+        group.add_argument("--fused_attention", type=str2bool, default=False,
+                           help="Whether to use the fused multi head attention operator "
+                           "(CPU only) when there is no decoding cache.")
+        group.add_argument("--fused_feedforward", type=str2bool, default=False,
+                           help="Whether to use the fused feed forward operator (CPU only).")
+        group.add_argument("--recompute", type=str2bool, default=False,
+                           help="Whether to recompute the activations of transformer blocks "
+                           "in backward instead of keeping them, which saves memory for "
+                           "long contexts.")
         group.add_argument("--use_discriminator", type=str2bool, default=False,
                            help="Whether to use discriminator loss.")
         group.add_argument("--dis_ratio", type=float, default=1.0,
@@ -95,6 +104,9 @@ class UnifiedTransformer(ModelBase):
                            help="The weight decay for Adam.")
         group.add_argument("--max_grad_norm", type=float, default=None,
                            help="The maximum norm of gradient.")
+        group.add_argument("--accumulate_steps", type=int, default=1,
+                           help="The number of batches whose gradients are accumulated "
+                           "in place before each update of parameters.")
         return group
 
     def __init__(self, name_scope, hparams, generator, dtype="float32"):
@@ -116,6 +128,9 @@ class UnifiedTransformer(ModelBase):
         self.embed_dropout = hparams.embed_dropout
         self.attn_dropout = hparams.attn_dropout
         self.ff_dropout = hparams.ff_dropout
+        self.fused_attention = hparams.fused_attention
+        self.fused_feedforward = hparams.fused_feedforward
+        self.recompute = hparams.recompute
         self.use_discriminator = hparams.use_discriminator
         self.weight_sharing = hparams.weight_sharing
         self.pos_trainable = hparams.pos_trainable
@@ -148,7 +163,11 @@ class UnifiedTransformer(ModelBase):
                                      self.num_heads,
                                      self.dropout,
                                      self.attn_dropout,
-                                     self.ff_dropout)
+                                     self.ff_dropout,
+                                     fused_attention=self.fused_attention,
+                                     fused_feedforward=self.fused_feedforward)
+            if self.recompute:
+                layer.checkpoint()
             self.layers.append(layer)
             self.add_sublayer(f"layer_{i}", layer)
 
@@ -183,6 +202,8 @@ class UnifiedTransformer(ModelBase):
                                     bias_attr=False)
 
         self.max_grad_norm = hparams.max_grad_norm
+        self.accumulate_steps = hparams.accumulate_steps
+        self.accumulated_steps = 0
         if self.max_grad_norm is not None:
             self.grad_clip = fluid.dygraph_grad_clip.GradClipByGlobalNorm(hparams.max_grad_norm)
         else:
@@ -538,7 +559,16 @@ class UnifiedTransformer(ModelBase):
         """ Optimize loss function and update model. """
         if self.before_backward_fn is not None:
             loss = self.before_backward_fn(loss)
+        if self.accumulate_steps > 1:
+            if self._grad_buffer is None:
+                # The parameters are all created after the first forward.
+                self.accumulate_gradients()
+            loss = layers.scale(loss, scale=1.0 / self.accumulate_steps)
         loss.backward()
+        self.accumulated_steps += 1
+        if self.accumulated_steps < self.accumulate_steps:
+            return
+        self.accumulated_steps = 0
         if self.after_backward_fn is not None:
             self.after_backward_fn()
         self.optimizer.minimize(loss,
@@ -653,6 +683,18 @@ class UnifiedTransformer(ModelBase):
         # shape: [batch_size, 1, vocab_size]
         if self.two_layer_predictor:
             pred_embed = self.pre_predictor(pred_embed)
+        # logits_to_topk only has a CPU kernel, other places would copy the
+        # embedding to CPU at every step.
+        if self.weight_sharing and "decode_topk" in state and \
+                isinstance(fluid.framework._current_expected_place(),
+                           fluid.CPUPlace):
+            # Only the top-k tokens, the logits of the whole vocabulary are
+            # never materialized.
+            token_embedding = self.embedder.token_embedding._w
+            pred_logits, pred_ids = fluid.contrib.layers.logits_to_topk(
+                pred_embed[:, 0], token_embedding, state["decode_topk"])
+            state["mask"] = mask
+            return (pred_logits, pred_ids), state
         if self.weight_sharing:
             token_embedding = self.embedder.token_embedding._w
             pred_logits = layers.matmul(
@@ -28,7 +28,7 @@ class FeedForward(Layer):
     Positional feed forward layer.
     """
 
-    def __init__(self, name_scope, hidden_dim, inner_dim, dropout):
+    def __init__(self, name_scope, hidden_dim, inner_dim, dropout, fused=False):
         super().__init__(name_scope)
 
         self.hidden_dim = hidden_dim
@@ -41,9 +41,24 @@ class FeedForward(Layer):
                              size=hidden_dim,
                              num_flatten_dims=2)
         self.dropout = dropout
+        self.fused = fused
         return
 
+    def _fused_forward(self, x):
+        """ Fused forward process, which shares the parameters of FC layers. """
+        F.build(self.linear_hidden, x)
+        if not self.linear_out._built:
+            hidden = layers.fill_constant([1, 1, self.inner_dim], x.dtype, 0.0)
+            F.build(self.linear_out, hidden)
+        return fluid.contrib.layers.fused_feedforward(
+            x, self.linear_hidden.weight, self.linear_hidden.bias,
+            self.linear_out.weight, self.linear_out.bias,
+            dropout_prob=self.dropout)
+
     def forward(self, x):
+        if self.fused:
+            return self._fused_forward(x)
+
         out = self.linear_hidden(x)
         out = F.dropout(out, self.dropout)
         out = self.linear_out(out)
@@ -17,6 +17,7 @@ Helpful functions.
 
 import numpy as np
 import Paddle.paddle.fluid as fluid
+from Paddle.paddle.fluid.dygraph import parallel_helper
 import Paddle.paddle.fluid.layers as layers
 
 
@@ -54,7 +55,7 @@ def equal(x, y, dtype=None):
     if isinstance(y, fluid.framework.Variable):
         y = y.numpy()
     out = np.equal(x, y).astype(dtype)
-    return fluid.dygraph.to_variable(out)
+    return fluid.dygraph.to_variable(out, zero_copy=True)
 
 
 def not_equal(x, y, dtype=None):
@@ -65,3 +66,12 @@ def not_equal(x, y, dtype=None):
 def dropout(x, p):
     """ Implement dropout function like tensorflow/pytorch. """
     return layers.dropout(x, p, dropout_implementation="upscale_in_train")
+
+
+def build(layer, inp):
+    """ Create the parameters of a layer for the input without running it. """
+    if not layer._built:
+        layer._build_once(inp)
+        if parallel_helper._is_data_parallel_mode():
+            parallel_helper._broadcast_parameters(layer._parameters.values())
+        layer._built = True
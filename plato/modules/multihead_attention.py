@@ -28,7 +28,7 @@ class MultiheadAttention(Layer):
     Multi head attention layer.
     """
 
-    def __init__(self, name_scope, hidden_dim, num_heads, dropout):
+    def __init__(self, name_scope, hidden_dim, num_heads, dropout, fused=False):
         assert hidden_dim % num_heads == 0
         super().__init__(name_scope)
 
@@ -43,6 +43,7 @@ class MultiheadAttention(Layer):
                              size=hidden_dim,
                              num_flatten_dims=2)
         self.dropout = dropout
+        self.fused = fused
         return
 
     def _split_heads(self, x, is_key=False):
@@ -76,8 +77,22 @@ class MultiheadAttention(Layer):
         out = layers.matmul(x=attn, y=value)
         return out
 
+    def _fused_forward(self, inp, mask):
+        """ Fused forward process, which shares the parameters of FC layers. """
+        F.build(self.linear_qkv, inp)
+        F.build(self.linear_out, inp)
+        if mask is not None:
+            mask.stop_gradient = True
+        return fluid.contrib.layers.fused_multihead_attention(
+            inp, self.linear_qkv.weight, self.linear_qkv.bias,
+            self.linear_out.weight, self.linear_out.bias, self.num_heads,
+            mask=mask, dropout_prob=self.dropout)
+
     def forward(self, inp, mask=None, cache=None):
         """ Forward process of self attention. """
+        if self.fused and cache is None:
+            return self._fused_forward(inp, mask)
+
         # shape: [batch_size, seq_len, 3 * hidden_dim]
         qkv = self.linear_qkv(inp)
         query, key, value = layers.split(qkv, num_or_sections=3, dim=2)
@@ -47,9 +47,11 @@ def prepare_context(strategy=None):
     if isinstance(place, core.CUDAPlace):
         parallel_helper._set_parallel_ctx(
             core.NCCLParallelContext(strategy, place))
+    elif isinstance(place, core.CPUPlace):
+        parallel_helper._set_parallel_ctx(
+            core.CPUParallelContext(strategy, place))
     else:
-        # TODO(Yancey1989): add Gloo Parallel Context to support CPU parallel computation
-        assert ("Only support CUDAPlace for now.")
+        assert ("Only support CUDAPlace and CPUPlace for now.")
     parallel_helper._init_parallel_ctx()
     return strategy
 
@@ -57,12 +59,12 @@ def prepare_context(strategy=None):
 class Env(object):
     """ Copy codes. """
     def __init__(self):
-        self._nranks = int(os.getenv("Paddle.paddle_TRAINERS_NUM", "1"))
-        self._local_rank = int(os.getenv("Paddle.paddle_TRAINER_ID", "0"))
+        self._nranks = int(os.getenv("PADDLE_TRAINERS_NUM", "1"))
+        self._local_rank = int(os.getenv("PADDLE_TRAINER_ID", "0"))
         self._dev_id = int(os.getenv("FLAGS_selected_gpus", "0"))
-        self._trainer_endpoints = os.getenv("Paddle.paddle_TRAINER_ENDPOINTS",
+        self._trainer_endpoints = os.getenv("PADDLE_TRAINER_ENDPOINTS",
                                             "").split(",")
-        self._current_endpoint = os.getenv("Paddle.paddle_CURRENT_ENDPOINT", "")
+        self._current_endpoint = os.getenv("PADDLE_CURRENT_ENDPOINT", "")
 
     @property
     def nranks(self):
@@ -146,15 +148,39 @@ class DataParallel(layers.Layer):
         Layer: The data paralleled module.
     """
 
-    def __init__(self, layers, strategy):
+    def __init__(self, layers, strategy, use_reducer=True):
         super(DataParallel,
               self).__init__(layers.full_name() + "_data_parallel")
 
         self._layers = layers
         self._strategy = strategy
+        self._reducer = None
+        # The reducer all-reduces the gradients during every backward, so it
+        # should not be used with the gradients accumulated over backward.
+        self._reducer_created = not use_reducer
 
     def forward(self, *inputs, **kwargs):
-        return self._layers(*inputs, **kwargs)
+        outputs = self._layers(*inputs, **kwargs)
+        # The parameters are all created after the first forward.
+        if not self._reducer_created and self._is_data_parallel_mode():
+            self._reducer = self._create_reducer()
+            self._reducer_created = True
+        return outputs
+
+    def _create_reducer(self):
+        """ Creates the reducer of gradients on CPU. """
+        ctx = parallel_helper._get_parallel_ctx()
+        if not parallel_helper._is_cpu_parallel_ctx(ctx):
+            return None
+        # The gradients are ready about in the reverse order of parameters,
+        # and all-reduced in buckets of 32 MB while backward runs.
+        params = [
+            param._ivar for param in self._layers.parameters()
+            if param.trainable
+        ]
+        bucket_size = 32 * 1024 * 1024
+        return core.Reducer(ctx, params[::-1], bucket_size,
+                            framework._dygraph_tracer())
 
     def __call__(self, *args, **kwargs):
         # Reimplement __call__ function
@@ -222,6 +248,28 @@ class DataParallel(layers.Layer):
         if not self._is_data_parallel_mode():
             return
 
+        if self._reducer is not None:
+            # Waits for the gradients all-reduced during backward.
+            self._reducer.finalize()
+            return
+
+        grad_buffer = self._layers._grad_buffer
+        num_params = len(
+            set(p.name for p in self._layers.parameters() if p.trainable))
+        if grad_buffer is not None and grad_buffer.num_params == num_params:
+            # All gradients are in one buffer, which is all-reduced in place.
+            ctx = parallel_helper._get_parallel_ctx()
+            if parallel_helper._is_cpu_parallel_ctx(ctx):
+                ctx.all_reduce(grad_buffer.buffer)
+            else:
+                buffer = framework.Variable(
+                    block=self._helper.main_program.current_block(),
+                    name=grad_buffer.buffer.name,
+                    stop_gradient=True,
+                    ivar=grad_buffer.buffer)
+                collective._allreduce(buffer, buffer, sync_mode=False)
+            return
+
         grad_var_set = set()
         grad_vars = []
         for param in self._layers.parameters():
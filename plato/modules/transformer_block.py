@@ -31,13 +31,15 @@ class TransformerBlock(Layer):
     Transformer block module.
     """
 
-    def __init__(self, name_scope, hidden_dim, num_heads, dropout, attn_dropout, ff_dropout):
+    def __init__(self, name_scope, hidden_dim, num_heads, dropout, attn_dropout, ff_dropout,
+                 fused_attention=False, fused_feedforward=False):
         super().__init__(name_scope)
 
         self.attn = MultiheadAttention(name_scope=self.full_name(),
                                        hidden_dim=hidden_dim,
                                        num_heads=num_heads,
-                                       dropout=attn_dropout)
+                                       dropout=attn_dropout,
+                                       fused=fused_attention)
         self.attn_norm = LayerNorm(name_scope=self.full_name(),
                                    begin_norm_axis=2,
                                    epsilon=1e-12,
@@ -48,7 +50,8 @@ class TransformerBlock(Layer):
         self.ff = FeedForward(name_scope=self.full_name(),
                               hidden_dim=hidden_dim,
                               inner_dim=4 * hidden_dim,
-                              dropout=ff_dropout)
+                              dropout=ff_dropout,
+                              fused=fused_feedforward)
         self.ff_norm = LayerNorm(name_scope=self.full_name(),
                                  begin_norm_axis=2,
                                  epsilon=1e-12,
@@ -125,7 +125,10 @@ class Trainer(object):
         if hparams.use_data_distributed:
             strategy = parallel.prepare_context()
             if strategy is not None:
-                parallel_model = parallel.DataParallel(model, strategy)
+                # The gradients accumulated over batches are all-reduced once
+                # before the update, instead of during every backward.
+                use_reducer = getattr(model, "accumulate_steps", 1) == 1
+                parallel_model = parallel.DataParallel(model, strategy, use_reducer)
                 model.before_backward_fn = parallel_model.scale_loss
                 model.after_backward_fn = parallel_model.apply_collective_grads
                 model = parallel_model
@@ -48,6 +48,9 @@ def main():
                         "Stay 'None': infer on entrie test dataset.")
     parser.add_argument("--hparams_file", type=str, default=None,
                         help="Loading hparams setting from file(.json format).")
+    parser.add_argument("--use_gpu", type=str2bool, default=True,
+                        help="Whether to run on GPU, otherwise every trainer "
+                        "runs on CPU.")
     BPETextField.add_cmdline_argument(parser)
     Dataset.add_cmdline_argument(parser)
     Trainer.add_cmdline_argument(parser)
@@ -100,9 +103,11 @@ def main():
 
     def to_tensor(array):
         array = np.expand_dims(array, -1)
-        return fluid.dygraph.to_variable(array)
+        return fluid.dygraph.to_variable(array, zero_copy=True)
 
-    if hparams.use_data_distributed:
+    if not hparams.use_gpu:
+        place = fluid.CPUPlace()
+    elif hparams.use_data_distributed:
         place = fluid.CUDAPlace(parallel.Env().dev_id)
     else:
         place = fluid.CUDAPlace(0)